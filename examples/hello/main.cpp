@@ -24,6 +24,16 @@
 int main()
 {
     auto engine = ice::Engine{};
+
+    // on_* return an ice::Connection, keep it to disconnect the slot later
+    auto connection = engine.get_keyboard().on_key_down([&] (ice::KeyMod, ice::Key key) {
+        if (key == ice::Key::ESCAPE)
+        {
+            engine.stop();
+        }
+    });
+
     engine.run();
+    connection.disconnect();
     return 0;
 }
@@ -0,0 +1,268 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/BinaryLog.h>
+#include <ice/Log.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    class NullSink : public ice::LogSink
+    {
+    public:
+        void write(const ice::LogMessage&) override {}
+    };
+
+    std::vector<std::string> decode(const std::filesystem::path& file)
+    {
+        auto input  = std::ifstream{file, std::ios::binary};
+        auto output = std::stringstream{};
+        ice::decode_binary_log(input, output);
+
+        auto lines = std::vector<std::string>{};
+        auto line  = std::string{};
+        while (std::getline(output, line))
+        {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    class BinaryLogTest : public testing::Test
+    {
+    protected:
+        std::filesystem::path file = std::filesystem::temp_directory_path() / "binary_log_test.blog";
+
+        void TearDown() override
+        {
+            ice::BinaryLog::get().close();
+            ice::BinaryLog::get().set_buffer_size(64u << 10u);
+            std::filesystem::remove(file);
+        }
+    };
+}
+
+TEST_F(BinaryLogTest, round_trip) {
+    auto& log = ice::BinaryLog::get();
+    log.open(file);
+
+    ICE_BLOG(ice::LOG_ENGINE, INFO, "frame {} took {} ms", 42, 1.5);
+    ICE_BLOG(ice::LOG_RENDER, WARNING, "no arguments");
+    log.close();
+
+    const auto lines = decode(file);
+    ASSERT_EQ(2u, lines.size());
+    EXPECT_NE(std::string::npos, lines[0].find("binary_log_test.cpp("));
+    EXPECT_NE(std::string::npos, lines[0].find("TestBody"));
+    EXPECT_TRUE(lines[0].ends_with("[engine] info: frame 42 took 1.5 ms"));
+    EXPECT_TRUE(lines[1].ends_with("[render] warning: no arguments"));
+}
+
+TEST_F(BinaryLogTest, forked_child_exits) {
+    auto& log = ice::BinaryLog::get();
+    log.open(file);
+
+    ICE_BLOG(ice::LOG_ENGINE, INFO, "parent");
+    log.flush();
+    // with the fast death test style the child is forked and exits through the binary log
+    EXPECT_EXIT({
+        std::exit(0);
+    }, testing::ExitedWithCode(0), "");
+    log.close();
+
+    const auto lines = decode(file);
+    ASSERT_EQ(1u, lines.size());
+    EXPECT_TRUE(lines[0].ends_with("[engine] info: parent"));
+}
+
+TEST_F(BinaryLogTest, argument_types) {
+    auto& log = ice::BinaryLog::get();
+    log.open(file);
+
+    const auto name = std::string{"player"};
+    enum class Mode : uint8_t { A, B };
+    ICE_BLOG(ice::LOG_GENERAL, INFO, "{} {} {} {} {} {}", -7, 8u, true, 'x', name, Mode::B);
+    ICE_BLOG(ice::LOG_GENERAL, INFO, "{} {}", "literal", static_cast<const char*>(nullptr));
+    log.close();
+
+    const auto lines = decode(file);
+    ASSERT_EQ(2u, lines.size());
+    EXPECT_TRUE(lines[0].ends_with(": -7 8 true x player 1"));
+    EXPECT_TRUE(lines[1].ends_with(": literal "));
+}
+
+TEST_F(BinaryLogTest, format_syntax) {
+    auto& log = ice::BinaryLog::get();
+    log.open(file);
+
+    ICE_BLOG(ice::LOG_GENERAL, INFO, "{{{1} {0}}} {}", 1, 2);
+    log.close();
+
+    const auto lines = decode(file);
+    ASSERT_EQ(1u, lines.size());
+    EXPECT_TRUE(lines[0].ends_with(": {2 1} {}"));
+}
+
+TEST_F(BinaryLogTest, call_site_registers_once) {
+    auto& log = ice::BinaryLog::get();
+    log.open(file);
+
+    const auto before = log.get_stats();
+    for (auto i = 0; i < 10; i++)
+    {
+        ICE_BLOG(ice::LOG_GENERAL, INFO, "{}", i);
+    }
+    log.flush();
+    const auto after = log.get_stats();
+    EXPECT_EQ(before.formats + 1u, after.formats);
+    EXPECT_EQ(before.written + 10u, after.written);
+    log.close();
+
+    const auto lines = decode(file);
+    ASSERT_EQ(10u, lines.size());
+    EXPECT_TRUE(lines[9].ends_with(": 9"));
+}
+
+TEST_F(BinaryLogTest, reopen_rewrites_formats) {
+    auto& log = ice::BinaryLog::get();
+    for (auto i = 0; i < 2; i++)
+    {
+        log.open(file);
+        ICE_BLOG(ice::LOG_GENERAL, INFO, "run {}", i);
+        log.close();
+
+        const auto lines = decode(file);
+        ASSERT_EQ(1u, lines.size());
+        EXPECT_TRUE(lines[0].ends_with(": run " + std::to_string(i)));
+    }
+}
+
+TEST_F(BinaryLogTest, nothing_written_when_closed) {
+    const auto before = ice::BinaryLog::get().get_stats();
+    ICE_BLOG(ice::LOG_GENERAL, INFO, "{}", 1);
+    ice::BinaryLog::get().flush();
+    EXPECT_EQ(before.written, ice::BinaryLog::get().get_stats().written);
+}
+
+TEST_F(BinaryLogTest, threads) {
+    auto& log = ice::BinaryLog::get();
+    log.set_buffer_size(1u << 20u);
+    log.open(file);
+
+    auto threads = std::vector<std::thread>{};
+    for (auto t = 0; t < 4; t++)
+    {
+        threads.emplace_back([t] () {
+            for (auto i = 0; i < 1000; i++)
+            {
+                ICE_BLOG(ice::LOG_GENERAL, INFO, "{} {}", t, i);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    log.close();
+
+    EXPECT_EQ(4000u, decode(file).size());
+}
+
+TEST_F(BinaryLogTest, truncated_file) {
+    auto& log = ice::BinaryLog::get();
+    log.open(file);
+    ICE_BLOG(ice::LOG_GENERAL, INFO, "{}", std::string{"first"});
+    ICE_BLOG(ice::LOG_GENERAL, INFO, "{}", std::string{"second"});
+    log.close();
+
+    std::filesystem::resize_file(file, std::filesystem::file_size(file) - 3u);
+    const auto lines = decode(file);
+    ASSERT_EQ(1u, lines.size());
+    EXPECT_TRUE(lines[0].ends_with(": first"));
+}
+
+TEST_F(BinaryLogTest, rejects_other_files) {
+    auto input  = std::stringstream{"not a binary log"};
+    auto output = std::stringstream{};
+    EXPECT_THROW(ice::decode_binary_log(input, output), std::runtime_error);
+}
+
+TEST_F(BinaryLogTest, benchmark_binary_log) {
+    auto& logger = ice::Logger::get();
+    logger.clear_sinks();
+    logger.add_sink(std::make_shared<NullSink>());
+    logger.set_overflow(ice::LogOverflow::BLOCK);
+
+    auto& log = ice::BinaryLog::get();
+    log.set_buffer_size(16u << 20u);
+    log.open(file);
+
+    const auto count = 100000u;
+    const auto to_ns = [&] (auto d) { return std::chrono::duration<double, std::nano>(d).count() / count; };
+
+    // a fresh thread picks up the buffer size
+    auto trace_time  = std::chrono::steady_clock::duration{};
+    auto binary_time = std::chrono::steady_clock::duration{};
+    std::thread([&] () {
+        const auto trace_start = std::chrono::steady_clock::now();
+        for (auto i = 0u; i < count; i++)
+        {
+            ice::trace(std::format("frame {} took {} ms", i, 1.5));
+        }
+        trace_time = std::chrono::steady_clock::now() - trace_start;
+
+        // touch the buffer once, page faults would dominate otherwise
+        for (auto i = 0u; i < count; i++)
+        {
+            ICE_BLOG(ice::LOG_GENERAL, INFO, "frame {} took {} ms", i, 1.5);
+        }
+        log.flush();
+
+        const auto binary_start = std::chrono::steady_clock::now();
+        for (auto i = 0u; i < count; i++)
+        {
+            ICE_BLOG(ice::LOG_GENERAL, INFO, "frame {} took {} ms", i, 1.5);
+        }
+        binary_time = std::chrono::steady_clock::now() - binary_start;
+    }).join();
+
+    logger.flush();
+    log.close();
+
+    logger.clear_sinks();
+    logger.add_sink(std::make_shared<ice::DebugSink>());
+    logger.set_overflow(ice::LogOverflow::DROP);
+
+    std::cout << "format + trace: " << to_ns(trace_time) << " ns/call" << std::endl;
+    std::cout << "binary log:     " << to_ns(binary_time) << " ns/call" << std::endl;
+    std::cout << "dropped:        " << log.get_stats().dropped << std::endl;
+}
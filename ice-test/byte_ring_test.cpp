@@ -0,0 +1,100 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/ByteRing.h>
+
+#include <cstring>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    bool push(ice::ByteRing& ring, const std::string_view text)
+    {
+        auto dst = ring.reserve(text.size());
+        if (dst == nullptr)
+        {
+            return false;
+        }
+        std::memcpy(dst, text.data(), text.size());
+        ring.commit();
+        return true;
+    }
+
+    std::string_view peek(ice::ByteRing& ring)
+    {
+        auto record = ring.peek();
+        return {reinterpret_cast<const char*>(record.data()), record.size()};
+    }
+}
+
+TEST(ByteRing, records_in_order)
+{
+    auto ring = ice::ByteRing{100u};
+    EXPECT_EQ(128u, ring.get_capacity());
+    EXPECT_TRUE(ring.is_empty());
+
+    EXPECT_TRUE(push(ring, "one"));
+    EXPECT_TRUE(push(ring, "two"));
+    EXPECT_FALSE(ring.is_empty());
+
+    EXPECT_EQ("one", peek(ring));
+    ring.pop();
+    EXPECT_EQ("two", peek(ring));
+    ring.pop();
+    EXPECT_TRUE(ring.peek().empty());
+    EXPECT_TRUE(ring.is_empty());
+}
+
+TEST(ByteRing, rejects_when_full)
+{
+    auto ring = ice::ByteRing{64u};
+
+    // each record takes 16 bytes with its header
+    for (auto i = 0u; i < 4u; i++)
+    {
+        EXPECT_TRUE(push(ring, "abcdefgh"));
+    }
+    EXPECT_FALSE(push(ring, "abcdefgh"));
+
+    EXPECT_EQ("abcdefgh", peek(ring));
+    ring.pop();
+    EXPECT_TRUE(push(ring, "abcdefgh"));
+}
+
+TEST(ByteRing, records_do_not_wrap)
+{
+    auto ring = ice::ByteRing{64u};
+
+    EXPECT_TRUE(push(ring, "0123456789abcdef0123"));
+    EXPECT_TRUE(push(ring, "x"));
+    EXPECT_EQ("0123456789abcdef0123", peek(ring));
+    ring.pop();
+
+    // 24 bytes are left at the end, the record needs 32 and starts at 0
+    EXPECT_TRUE(push(ring, "0123456789abcdef0123"));
+    EXPECT_EQ("x", peek(ring));
+    ring.pop();
+    EXPECT_EQ("0123456789abcdef0123", peek(ring));
+    ring.pop();
+    EXPECT_TRUE(ring.is_empty());
+}
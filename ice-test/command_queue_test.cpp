@@ -0,0 +1,138 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/CommandQueue.h>
+
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(CommandQueue, runs_commands_in_order)
+{
+    auto queue  = ice::CommandQueue{16u};
+    auto values = std::vector<int>{};
+
+    for (auto i = 0; i < 10; i++)
+    {
+        EXPECT_TRUE(queue.push([&values, i] () {
+            values.push_back(i);
+        }));
+    }
+
+    EXPECT_EQ(10u, queue.run());
+    EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), values);
+    EXPECT_EQ(0u, queue.run());
+}
+
+TEST(CommandQueue, rejects_when_full)
+{
+    auto queue = ice::CommandQueue{5u};
+    EXPECT_EQ(8u, queue.get_capacity());
+
+    auto count = 0u;
+    for (auto i = 0u; i < 8u; i++)
+    {
+        EXPECT_TRUE(queue.push([&count] () { count++; }));
+    }
+    EXPECT_FALSE(queue.push([&count] () { count++; }));
+
+    EXPECT_TRUE(queue.run_one());
+    EXPECT_TRUE(queue.push([&count] () { count++; }));
+    EXPECT_EQ(8u, queue.run());
+    EXPECT_EQ(9u, count);
+}
+
+TEST(CommandQueue, leaves_commands_pushed_while_running)
+{
+    auto queue = ice::CommandQueue{4u};
+    auto count = 0u;
+
+    // a command that queues itself again must not keep run going
+    auto repost = std::function<void ()>{};
+    repost = [&] () {
+        count++;
+        queue.push([&repost] () { repost(); });
+    };
+    queue.push([&repost] () { repost(); });
+
+    EXPECT_EQ(1u, queue.run());
+    EXPECT_EQ(1u, count);
+    EXPECT_EQ(1u, queue.run());
+    EXPECT_EQ(2u, count);
+}
+
+TEST(CommandQueue, destroys_pending_commands)
+{
+    auto shared = std::make_shared<int>(42);
+    {
+        auto queue = ice::CommandQueue{4u};
+        queue.push([shared] () {});
+        queue.push([shared] () {});
+        EXPECT_EQ(3, shared.use_count());
+    }
+    EXPECT_EQ(1, shared.use_count());
+}
+
+TEST(CommandQueue, stress_many_producers)
+{
+    constexpr auto producer_count = 8u;
+    constexpr auto command_count  = 100000u;
+
+    auto queue = ice::CommandQueue{256u};
+
+    auto last  = std::vector<unsigned int>(producer_count, 0u);
+    auto total = 0u;
+    auto ordered = true;
+
+    auto producers = std::vector<std::jthread>{};
+    for (auto p = 0u; p < producer_count; p++)
+    {
+        producers.emplace_back([&, p] () {
+            for (auto i = 1u; i <= command_count; i++)
+            {
+                auto cmd = [&, p, i] () {
+                    ordered = ordered && (last[p] + 1u == i);
+                    last[p] = i;
+                    total++;
+                };
+                while (!queue.push(cmd))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    while (total < producer_count * command_count)
+    {
+        if (queue.run() == 0u)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    producers.clear();
+    EXPECT_EQ(producer_count * command_count, total);
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(0u, queue.run());
+}
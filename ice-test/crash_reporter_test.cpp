@@ -0,0 +1,177 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifdef __linux__
+
+#include <ice/CrashReporter.h>
+#include <ice/Log.h>
+
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    std::string read_file(const std::filesystem::path& file)
+    {
+        auto input  = std::ifstream{file};
+        auto buffer = std::stringstream{};
+        buffer << input.rdbuf();
+        return buffer.str();
+    }
+
+    ICE_NOINLINE void crash_null()
+    {
+        // through a register, a store to a constant address may not fault on every VM
+        volatile uintptr_t address = 0u;
+        *reinterpret_cast<volatile int*>(address) = 42;
+    }
+
+    ICE_NOINLINE unsigned int overflow(unsigned int depth)
+    {
+        volatile char block[1024];
+        block[0] = static_cast<char>(depth);
+        if (depth == ~0u)
+        {
+            return block[0];
+        }
+        return overflow(depth + 1u) + block[0];
+    }
+
+    class CrashReporterTest : public testing::Test
+    {
+    protected:
+        std::filesystem::path file = std::filesystem::temp_directory_path() / "crash_reporter_test.txt";
+
+        void SetUp() override
+        {
+            // the child runs from the start, the logger thread does not survive a fork
+            GTEST_FLAG_SET(death_test_style, "threadsafe");
+            std::filesystem::remove(file);
+        }
+
+        void TearDown() override
+        {
+            std::filesystem::remove(file);
+        }
+    };
+}
+
+TEST_F(CrashReporterTest, reports_segfault)
+{
+    EXPECT_EXIT({
+        auto reporter = ice::CrashReporter{file};
+        ice::trace("Last words.");
+        ice::Logger::get().flush();
+        crash_null();
+    }, testing::KilledBySignal(SIGSEGV), "");
+
+    const auto report = read_file(file);
+    EXPECT_TRUE(report.starts_with("ice crash report\nsignal: SIGSEGV")) << report;
+    EXPECT_NE(std::string::npos, report.find("address: 0x0000000000000000"));
+    #if defined(__x86_64__)
+    EXPECT_NE(std::string::npos, report.find("\n  rip 0x"));
+    #endif
+    EXPECT_NE(std::string::npos, report.find("\nstack:\n  0x"));
+    EXPECT_NE(std::string::npos, report.find("\nmappings:\n"));
+    EXPECT_NE(std::string::npos, report.find(" (crashed)\n"));
+    EXPECT_NE(std::string::npos, report.find("Last words.\n"));
+}
+
+TEST_F(CrashReporterTest, reports_abort)
+{
+    EXPECT_EXIT({
+        auto reporter = ice::CrashReporter{file};
+        std::abort();
+    }, testing::KilledBySignal(SIGABRT), "");
+
+    const auto report = read_file(file);
+    EXPECT_TRUE(report.starts_with("ice crash report\nsignal: SIGABRT")) << report;
+}
+
+TEST_F(CrashReporterTest, reports_failed_check)
+{
+    EXPECT_EXIT({
+        auto reporter = ice::CrashReporter{file};
+        ice::fail("Broken invariant.");
+    }, testing::KilledBySignal(SIGABRT), "");
+
+    const auto report = read_file(file);
+    EXPECT_TRUE(report.starts_with("ice crash report\nsignal: SIGABRT")) << report;
+    EXPECT_NE(std::string::npos, report.find("Broken invariant.\n"));
+}
+
+TEST_F(CrashReporterTest, reports_stack_overflow)
+{
+    EXPECT_EXIT({
+        auto reporter = ice::CrashReporter{file};
+        overflow(0u);
+    }, testing::KilledBySignal(SIGSEGV), "");
+
+    const auto report = read_file(file);
+    EXPECT_TRUE(report.starts_with("ice crash report\nsignal: SIGSEGV")) << report;
+    EXPECT_NE(std::string::npos, report.find("\nlog:\n"));
+}
+
+TEST_F(CrashReporterTest, lists_threads)
+{
+    EXPECT_EXIT({
+        auto reporter = ice::CrashReporter{file};
+        auto worker = std::thread([] () {
+            ice::prepare_crash_thread();
+            pthread_setname_np(pthread_self(), "worker");
+            crash_null();
+        });
+        worker.join();
+    }, testing::KilledBySignal(SIGSEGV), "");
+
+    const auto report = read_file(file);
+    EXPECT_NE(std::string::npos, report.find(" worker (crashed)\n")) << report;
+}
+
+TEST_F(CrashReporterTest, removes_file_without_crash)
+{
+    {
+        auto reporter = ice::CrashReporter{file};
+        EXPECT_TRUE(std::filesystem::exists(file));
+        EXPECT_THROW(ice::CrashReporter{file.string() + ".2"}, std::runtime_error);
+    }
+    EXPECT_FALSE(std::filesystem::exists(file));
+}
+
+TEST_F(CrashReporterTest, write_report)
+{
+    ice::CrashReporter::write_report(file);
+
+    const auto report = read_file(file);
+    EXPECT_TRUE(report.starts_with("ice crash report\nsignal: none\n")) << report;
+    EXPECT_EQ(std::string::npos, report.find("registers:"));
+    EXPECT_NE(std::string::npos, report.find("\nstack:\n  0x"));
+    EXPECT_NE(std::string::npos, report.find("\nthreads:\n"));
+}
+
+#endif
@@ -30,7 +30,7 @@
 using namespace std::chrono_literals;
 
 TEST(Engine, stops) {
-    auto engine = ice::Engine{};
+    auto engine = ice::Engine{ice::EngineMode::HEADLESS};
 
     c9y::async([&] () {
         std::this_thread::sleep_for(100ms);
@@ -40,4 +40,124 @@ TEST(Engine, stops) {
     engine.run();
 }
 
+TEST(Engine, headless) {
+    auto engine = ice::Engine{ice::EngineMode::HEADLESS};
+    EXPECT_TRUE(engine.is_headless());
 
+    auto updates = 0u;
+    engine.on_update([&] (float) {
+        if (++updates == 10u)
+        {
+            engine.stop();
+        }
+    });
+
+    engine.run();
+    EXPECT_EQ(10u, updates);
+}
+
+TEST(Engine, frame_stats) {
+    auto engine = ice::Engine{ice::EngineMode::HEADLESS};
+
+    auto updates = 0u;
+    engine.on_update([&] (float) {
+        if (++updates == 10u)
+        {
+            engine.stop();
+        }
+    });
+
+    engine.run();
+
+    const auto& stats = engine.get_frame_stats();
+    EXPECT_EQ(10u, stats.get_frame_count());
+    const auto frame = stats.get(ice::FramePhase::FRAME);
+    EXPECT_LE(frame.min, frame.p50);
+    EXPECT_LE(frame.p50, frame.p99);
+    EXPECT_LE(frame.p99, frame.max);
+    EXPECT_LE(stats.get(ice::FramePhase::UPDATE).max, frame.max);
+}
+
+TEST(Engine, stops_in_idle_mode) {
+    auto engine = ice::Engine{ice::EngineMode::HEADLESS};
+    engine.set_idle_mode(true);
+    engine.set_idle_timeout(10s);
+
+    c9y::async([&] () {
+        std::this_thread::sleep_for(100ms);
+        engine.stop();
+    });
+
+    const auto start = std::chrono::steady_clock::now();
+    engine.run();
+    EXPECT_GT(5s, std::chrono::steady_clock::now() - start);
+}
+
+TEST(Engine, frame_rate_limit) {
+    auto engine = ice::Engine{ice::EngineMode::HEADLESS};
+    engine.set_frame_rate_limit(30u);
+
+    auto updates = 0u;
+    engine.on_update([&] (float) {
+        updates++;
+    });
+
+    c9y::async([&] () {
+        std::this_thread::sleep_for(500ms);
+        engine.stop();
+    });
+
+    engine.run();
+    EXPECT_GE(20u, updates);
+}
+
+TEST(Engine, update_jobs_complete) {
+    auto engine = ice::Engine{ice::EngineMode::HEADLESS};
+
+    auto values = std::vector<unsigned int>(1000u, 0u);
+    auto ok     = true;
+    engine.on_update([&] (float) {
+        for (auto v : values)
+        {
+            ok = ok && (v == values.front());
+        }
+
+        auto& jobs = engine.get_job_system();
+        jobs.parallel_for(engine.get_update_jobs(), 0u, values.size(), 100u, [&] (size_t first, size_t last) {
+            for (auto i = first; i < last; i++)
+            {
+                values[i]++;
+            }
+        });
+    });
+
+    c9y::async([&] () {
+        std::this_thread::sleep_for(100ms);
+        engine.stop();
+    });
+
+    engine.run();
+    EXPECT_TRUE(ok);
+}
+
+TEST(Engine, runs_posted_commands) {
+    auto engine = ice::Engine{ice::EngineMode::HEADLESS};
+    engine.set_idle_mode(true);
+
+    auto count = 0u;
+    c9y::async([&] () {
+        for (auto i = 0u; i < 100u; i++)
+        {
+            while (!engine.post([&count] () { count++; }))
+            {
+                std::this_thread::yield();
+            }
+        }
+        engine.post([&engine] () {
+            engine.stop();
+        });
+    });
+
+    engine.run();
+    EXPECT_EQ(100u, count);
+}
@@ -0,0 +1,131 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/EventPump.h>
+
+#include <SDL2/SDL.h>
+#include <gtest/gtest.h>
+
+namespace
+{
+    class EventPumpTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            ASSERT_EQ(0, SDL_Init(SDL_INIT_EVENTS));
+            SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+        }
+
+        void TearDown() override
+        {
+            SDL_Quit();
+        }
+
+        void push_motion(int x, int y, int xrel, int yrel)
+        {
+            auto event = SDL_Event{};
+            event.type        = SDL_MOUSEMOTION;
+            event.motion.x    = x;
+            event.motion.y    = y;
+            event.motion.xrel = xrel;
+            event.motion.yrel = yrel;
+            SDL_PushEvent(&event);
+        }
+
+        void push_button()
+        {
+            auto event = SDL_Event{};
+            event.type          = SDL_MOUSEBUTTONDOWN;
+            event.button.button = 1;
+            SDL_PushEvent(&event);
+        }
+    };
+}
+
+TEST_F(EventPumpTest, pumps_all_events)
+{
+    auto pump = ice::EventPump{4u};
+
+    for (auto i = 0; i < 10; i++)
+    {
+        push_motion(i, i, 1, 1);
+    }
+
+    auto events = pump.pump();
+    ASSERT_EQ(10u, events.size());
+    EXPECT_EQ(9, events[9].motion.x);
+    EXPECT_EQ(10u, pump.get_stats().received);
+    EXPECT_EQ(10u, pump.get_stats().events);
+    EXPECT_EQ(0u, pump.get_stats().coalesced);
+
+    EXPECT_EQ(0u, pump.pump().size());
+}
+
+TEST_F(EventPumpTest, coalesces_motion)
+{
+    auto pump = ice::EventPump{};
+    pump.set_coalesce_motion(true);
+
+    push_motion(1, 1, 1, 1);
+    push_motion(3, 2, 2, 1);
+    push_button();
+    push_motion(4, 2, 1, 0);
+    push_motion(6, 5, 2, 3);
+    push_motion(7, 5, 1, 0);
+
+    auto events = pump.pump();
+    ASSERT_EQ(3u, events.size());
+
+    EXPECT_EQ(SDL_MOUSEMOTION, events[0].type);
+    EXPECT_EQ(3, events[0].motion.x);
+    EXPECT_EQ(2, events[0].motion.y);
+    EXPECT_EQ(3, events[0].motion.xrel);
+    EXPECT_EQ(2, events[0].motion.yrel);
+
+    EXPECT_EQ(SDL_MOUSEBUTTONDOWN, events[1].type);
+
+    EXPECT_EQ(SDL_MOUSEMOTION, events[2].type);
+    EXPECT_EQ(7, events[2].motion.x);
+    EXPECT_EQ(5, events[2].motion.y);
+    EXPECT_EQ(4, events[2].motion.xrel);
+    EXPECT_EQ(3, events[2].motion.yrel);
+
+    EXPECT_EQ(6u, pump.get_stats().received);
+    EXPECT_EQ(3u, pump.get_stats().coalesced);
+}
+
+TEST_F(EventPumpTest, disabled_events_are_dropped)
+{
+    auto pump = ice::EventPump{};
+    pump.set_enabled(SDL_MOUSEMOTION, false);
+    EXPECT_FALSE(pump.is_enabled(SDL_MOUSEMOTION));
+
+    push_motion(1, 1, 1, 1);
+    push_button();
+
+    auto events = pump.pump();
+    ASSERT_EQ(1u, events.size());
+    EXPECT_EQ(SDL_MOUSEBUTTONDOWN, events[0].type);
+
+    pump.set_enabled(SDL_MOUSEMOTION, true);
+    EXPECT_TRUE(pump.is_enabled(SDL_MOUSEMOTION));
+}
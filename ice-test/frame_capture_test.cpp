@@ -0,0 +1,166 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/FrameCapture.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+namespace
+{
+    std::filesystem::path temp_file(const char* name)
+    {
+        return std::filesystem::temp_directory_path() / name;
+    }
+
+    ice::Image make_image(unsigned int width, unsigned int height, uint8_t r, uint8_t g, uint8_t b)
+    {
+        auto image = ice::Image{};
+        image.size = {width, height};
+        image.pixels.resize(width * height * 4u);
+        for (auto i = 0u; i < width * height; i++)
+        {
+            image.pixels[i * 4u + 0u] = r;
+            image.pixels[i * 4u + 1u] = g;
+            image.pixels[i * 4u + 2u] = b;
+            image.pixels[i * 4u + 3u] = 255u;
+        }
+        return image;
+    }
+
+    std::string read_file(const std::filesystem::path& file)
+    {
+        auto input = std::ifstream(file, std::ios::binary);
+        return {std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+    }
+}
+
+TEST(FrameCapture, writes_y4m) {
+    auto file = temp_file("ice_capture.y4m");
+    {
+        auto capture = ice::FrameCapture{file, {ice::CaptureFormat::Y4M, 30u}};
+        // odd sizes are cut to even
+        capture.push(make_image(5u, 4u, 255u, 255u, 255u));
+        capture.push(make_image(5u, 4u, 255u, 0u, 0u));
+    }
+
+    auto data   = read_file(file);
+    auto header = std::string("YUV4MPEG2 W4 H4 F30:1 Ip A1:1 C420jpeg\n");
+    ASSERT_EQ(header.size() + 2u * (6u + 16u + 4u + 4u), data.size());
+    EXPECT_EQ(header, data.substr(0u, header.size()));
+
+    auto frame0 = data.substr(header.size(), 6u + 24u);
+    EXPECT_EQ("FRAME\n", frame0.substr(0u, 6u));
+    EXPECT_EQ(char(255), frame0[6u]);
+    EXPECT_EQ(char(128), frame0[6u + 16u]);
+    EXPECT_EQ(char(128), frame0[6u + 20u]);
+
+    auto frame1 = data.substr(header.size() + 30u);
+    EXPECT_EQ(char(77), frame1[6u]);
+    EXPECT_EQ(char(85), frame1[6u + 16u]);
+    EXPECT_EQ(char(255), frame1[6u + 20u]);
+
+    std::filesystem::remove(file);
+}
+
+TEST(FrameCapture, y4m_rate_follows_interval) {
+    auto file = temp_file("ice_capture_interval.y4m");
+    {
+        auto settings = ice::CaptureSettings{};
+        settings.frame_rate = 60u;
+        settings.interval   = 2u;
+        auto capture = ice::FrameCapture{file, settings};
+        capture.push(make_image(4u, 4u, 0u, 0u, 0u));
+    }
+
+    auto data = read_file(file);
+    EXPECT_EQ(0u, data.find("YUV4MPEG2 W4 H4 F60:2 Ip"));
+
+    std::filesystem::remove(file);
+}
+
+TEST(FrameCapture, writes_raw) {
+    auto file = temp_file("ice_capture.raw");
+    ice::CaptureStats stats;
+    {
+        auto settings = ice::CaptureSettings{};
+        settings.format = ice::CaptureFormat::RAW;
+        auto capture = ice::FrameCapture{file, settings};
+        capture.push(make_image(3u, 3u, 1u, 2u, 3u));
+        capture.push(make_image(3u, 3u, 1u, 2u, 3u));
+        capture.push(make_image(2u, 2u, 1u, 2u, 3u));
+        // let the writer finish
+        while (capture.get_stats().written + capture.get_stats().dropped_size < 3u)
+        {
+            std::this_thread::yield();
+        }
+        stats = capture.get_stats();
+    }
+
+    EXPECT_EQ(2u * 3u * 3u * 4u, read_file(file).size());
+    EXPECT_EQ(2u, stats.written);
+    EXPECT_EQ(1u, stats.dropped_size);
+
+    std::filesystem::remove(file);
+}
+
+TEST(FrameCapture, counts_skipped_and_dropped_frames) {
+    auto file = temp_file("ice_capture_drop.raw");
+    auto settings = ice::CaptureSettings{};
+    settings.format     = ice::CaptureFormat::RAW;
+    settings.interval   = 2u;
+    settings.queue_size = 1u;
+
+    auto pushed = 0u;
+    ice::CaptureStats stats;
+    {
+        auto capture = ice::FrameCapture{file, settings};
+        for (auto frame = 0u; frame < 100u; frame++)
+        {
+            if (capture.want_frame(frame))
+            {
+                if (frame % 10u == 0u)
+                {
+                    capture.drop_readback();
+                }
+                else
+                {
+                    capture.push(make_image(64u, 64u, 0u, 0u, 0u));
+                    pushed++;
+                }
+            }
+        }
+        stats = capture.get_stats();
+    }
+
+    EXPECT_EQ(100u, stats.frames);
+    EXPECT_EQ(50u, stats.skipped);
+    EXPECT_EQ(10u, stats.dropped_readback);
+    EXPECT_EQ(40u, pushed);
+    EXPECT_GE(pushed, stats.dropped_queue);
+
+    std::filesystem::remove(file);
+}
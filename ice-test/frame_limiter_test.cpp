@@ -0,0 +1,66 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/FrameLimiter.h>
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+TEST(FrameLimiter, unlimited_does_not_wait)
+{
+    auto limiter = ice::FrameLimiter{};
+
+    const auto start = std::chrono::steady_clock::now();
+    for (auto i = 0u; i < 100u; i++)
+    {
+        limiter.wait();
+    }
+    EXPECT_GT(10ms, std::chrono::steady_clock::now() - start);
+}
+
+TEST(FrameLimiter, paces_to_rate)
+{
+    auto limiter = ice::FrameLimiter{100u};
+
+    const auto start = std::chrono::steady_clock::now();
+    for (auto i = 0u; i < 10u; i++)
+    {
+        limiter.wait();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_LE(99ms, elapsed);
+    EXPECT_GT(150ms, elapsed);
+}
+
+TEST(FrameLimiter, does_not_catch_up)
+{
+    auto limiter = ice::FrameLimiter{100u};
+
+    std::this_thread::sleep_for(50ms);
+    limiter.wait();
+
+    const auto start = std::chrono::steady_clock::now();
+    limiter.wait();
+    EXPECT_LE(9ms, std::chrono::steady_clock::now() - start);
+}
@@ -0,0 +1,385 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/FrameReadback.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <SDL2/SDL_opengl.h>
+#include <gtest/gtest.h>
+
+namespace
+{
+    // A tiny fake GPU: buffers live in memory and fences signal when the
+    // test says the GPU caught up.
+    std::map<unsigned int, std::vector<uint8_t>> buffers;
+    unsigned int next_buffer = 1u;
+    unsigned int pack_buffer = 0u;
+    uintptr_t    next_fence  = 1u;
+    uintptr_t    gpu_done    = 0u;
+    unsigned int live_fences = 0u;
+    unsigned int live_maps   = 0u;
+    bool         fail_wait   = false;
+    bool         fail_map    = false;
+
+    unsigned int read_framebuffer = 0u;
+    glm::ivec4   blit_source      = {0, 0, 0, 0};
+    glm::ivec4   blit_target      = {0, 0, 0, 0};
+    glm::uvec2   read_size        = {0u, 0u};
+
+    void ICE_APIENTRY fake_gen_buffers(int n, unsigned int* ids)
+    {
+        for (auto i = 0; i < n; i++)
+        {
+            ids[i] = next_buffer++;
+            buffers[ids[i]];
+        }
+    }
+
+    void ICE_APIENTRY fake_delete_buffers(int n, const unsigned int* ids)
+    {
+        for (auto i = 0; i < n; i++)
+        {
+            buffers.erase(ids[i]);
+        }
+    }
+
+    void ICE_APIENTRY fake_bind_buffer(unsigned int target, unsigned int id)
+    {
+        EXPECT_EQ(GL_PIXEL_PACK_BUFFER, target);
+        pack_buffer = id;
+    }
+
+    void ICE_APIENTRY fake_buffer_data(unsigned int, ptrdiff_t size, const void*, unsigned int)
+    {
+        buffers[pack_buffer].resize(size);
+    }
+
+    // every byte holds the row number, GL counts rows from the bottom
+    void ICE_APIENTRY fake_read_pixels(int, int, int width, int height, unsigned int format, unsigned int, void* data)
+    {
+        EXPECT_EQ(GL_RGBA, format);
+        EXPECT_EQ(nullptr, data);
+        read_size = {width, height};
+        auto& buffer = buffers[pack_buffer];
+        for (auto y = 0; y < height; y++)
+        {
+            std::fill_n(buffer.begin() + y * width * 4, width * 4, static_cast<uint8_t>(y));
+        }
+    }
+
+    void* ICE_APIENTRY fake_map_buffer_range(unsigned int, ptrdiff_t, ptrdiff_t, unsigned int)
+    {
+        if (fail_map)
+        {
+            return nullptr;
+        }
+        live_maps++;
+        return buffers[pack_buffer].data();
+    }
+
+    unsigned char ICE_APIENTRY fake_unmap_buffer(unsigned int)
+    {
+        live_maps--;
+        return 1u;
+    }
+
+    void* ICE_APIENTRY fake_fence_sync(unsigned int, unsigned int)
+    {
+        live_fences++;
+        return reinterpret_cast<void*>(next_fence++);
+    }
+
+    unsigned int ICE_APIENTRY fake_client_wait_sync(void* sync, unsigned int, uint64_t)
+    {
+        if (fail_wait)
+        {
+            return GL_WAIT_FAILED;
+        }
+        return reinterpret_cast<uintptr_t>(sync) <= gpu_done ? GL_ALREADY_SIGNALED : GL_TIMEOUT_EXPIRED;
+    }
+
+    void ICE_APIENTRY fake_delete_sync(void*)
+    {
+        live_fences--;
+    }
+
+    void ICE_APIENTRY fake_gen_names(int n, unsigned int* ids)
+    {
+        std::fill_n(ids, n, 42u);
+    }
+
+    void ICE_APIENTRY fake_delete_names(int, const unsigned int*) {}
+
+    void ICE_APIENTRY fake_bind_framebuffer(unsigned int target, unsigned int id)
+    {
+        if (target == GL_READ_FRAMEBUFFER)
+        {
+            read_framebuffer = id;
+        }
+    }
+
+    void ICE_APIENTRY fake_bind_renderbuffer(unsigned int, unsigned int) {}
+
+    void ICE_APIENTRY fake_renderbuffer_storage(unsigned int, unsigned int, int, int) {}
+
+    void ICE_APIENTRY fake_framebuffer_renderbuffer(unsigned int, unsigned int, unsigned int, unsigned int) {}
+
+    void ICE_APIENTRY fake_blit_framebuffer(int x0, int y0, int x1, int y1, int dx0, int dy0, int dx1, int dy1, unsigned int, unsigned int filter)
+    {
+        EXPECT_EQ(GL_LINEAR, filter);
+        blit_source = {x0, y0, x1, y1};
+        blit_target = {dx0, dy0, dx1, dy1};
+    }
+
+    ice::ReadbackFunctions fake_functions()
+    {
+        auto result = ice::ReadbackFunctions{};
+        result.gen_buffers      = fake_gen_buffers;
+        result.delete_buffers   = fake_delete_buffers;
+        result.bind_buffer      = fake_bind_buffer;
+        result.buffer_data      = fake_buffer_data;
+        result.read_pixels      = fake_read_pixels;
+        result.map_buffer_range = fake_map_buffer_range;
+        result.unmap_buffer     = fake_unmap_buffer;
+        result.fence_sync       = fake_fence_sync;
+        result.client_wait_sync = fake_client_wait_sync;
+        result.delete_sync      = fake_delete_sync;
+
+        result.gen_framebuffers         = fake_gen_names;
+        result.delete_framebuffers      = fake_delete_names;
+        result.bind_framebuffer         = fake_bind_framebuffer;
+        result.gen_renderbuffers        = fake_gen_names;
+        result.delete_renderbuffers     = fake_delete_names;
+        result.bind_renderbuffer        = fake_bind_renderbuffer;
+        result.renderbuffer_storage     = fake_renderbuffer_storage;
+        result.framebuffer_renderbuffer = fake_framebuffer_renderbuffer;
+        result.blit_framebuffer         = fake_blit_framebuffer;
+        return result;
+    }
+
+    class FrameReadbackTest : public testing::Test
+    {
+    protected:
+        std::mutex                    mutex;
+        std::vector<ice::Image>       images;
+        std::vector<std::thread::id>  threads;
+
+        void SetUp() override
+        {
+            buffers.clear();
+            pack_buffer = 0u;
+            gpu_done    = next_fence - 1u;
+            live_fences = 0u;
+            live_maps   = 0u;
+            fail_wait   = false;
+            fail_map    = false;
+        }
+
+        ice::ReadbackFailure count(std::atomic<unsigned int>& failures)
+        {
+            return [&failures] () {
+                failures++;
+            };
+        }
+
+        size_t get_image_count()
+        {
+            auto lock = std::unique_lock<std::mutex>{mutex};
+            return images.size();
+        }
+
+        // the buffers are unmapped by the update after the thread copied them
+        void finish(ice::FrameReadback& readback)
+        {
+            while (readback.get_pending() > 0u)
+            {
+                readback.update();
+                std::this_thread::yield();
+            }
+        }
+
+        ice::ReadbackCallback collect()
+        {
+            return [this] (ice::Image&& image) {
+                auto lock = std::unique_lock<std::mutex>{mutex};
+                images.push_back(std::move(image));
+                threads.push_back(std::this_thread::get_id());
+            };
+        }
+    };
+}
+
+TEST_F(FrameReadbackTest, waits_for_gpu) {
+    {
+        auto readback = ice::FrameReadback{fake_functions()};
+
+        EXPECT_TRUE(readback.read({4u, 3u}, 7u, collect()));
+        readback.update();
+        EXPECT_EQ(1u, readback.get_pending());
+
+        gpu_done = next_fence - 1u;
+        finish(readback);
+        EXPECT_EQ(0u, live_maps);
+    }
+
+    ASSERT_EQ(1u, images.size());
+    EXPECT_NE(std::this_thread::get_id(), threads[0]);
+
+    auto& image = images[0];
+    EXPECT_EQ(glm::uvec2(4u, 3u), image.size);
+    EXPECT_EQ(7u, image.frame);
+    ASSERT_EQ(4u * 3u * 4u, image.pixels.size());
+    // top row first
+    EXPECT_EQ(2u, image.pixels.front());
+    EXPECT_EQ(0u, image.pixels.back());
+    EXPECT_EQ(0u, live_fences);
+}
+
+TEST_F(FrameReadbackTest, completes_in_order) {
+    {
+        auto readback = ice::FrameReadback{fake_functions(), 3u};
+
+        readback.read({2u, 2u}, 1u, collect());
+        readback.read({2u, 2u}, 2u, collect());
+        gpu_done = next_fence - 2u;
+        readback.read({2u, 2u}, 3u, collect());
+        while (get_image_count() < 1u)
+        {
+            readback.update();
+            std::this_thread::yield();
+        }
+        readback.update();
+        EXPECT_EQ(2u, readback.get_pending());
+
+        gpu_done = next_fence - 1u;
+        finish(readback);
+        EXPECT_EQ(3u, readback.get_stats().requested);
+    }
+
+    ASSERT_EQ(3u, images.size());
+    EXPECT_EQ(1u, images[0].frame);
+    EXPECT_EQ(2u, images[1].frame);
+    EXPECT_EQ(3u, images[2].frame);
+}
+
+TEST_F(FrameReadbackTest, drops_when_ring_is_full) {
+    auto readback = ice::FrameReadback{fake_functions(), 2u};
+
+    EXPECT_TRUE(readback.read({2u, 2u}, 1u, collect()));
+    EXPECT_TRUE(readback.read({2u, 2u}, 2u, collect()));
+    EXPECT_FALSE(readback.read({2u, 2u}, 3u, collect()));
+
+    auto stats = readback.get_stats();
+    EXPECT_EQ(3u, stats.requested);
+    EXPECT_EQ(1u, stats.dropped);
+
+    gpu_done = next_fence - 1u;
+    finish(readback);
+    EXPECT_TRUE(readback.read({2u, 2u}, 4u, collect()));
+}
+
+TEST_F(FrameReadbackTest, unmaps_on_destruction) {
+    {
+        auto readback = ice::FrameReadback{fake_functions(), 2u};
+        readback.read({2u, 2u}, 1u, collect());
+        readback.read({2u, 2u}, 2u, collect());
+        gpu_done = next_fence - 2u;
+        readback.update();
+        EXPECT_EQ(1u, live_maps);
+    }
+
+    EXPECT_EQ(1u, images.size());
+    EXPECT_EQ(0u, live_maps);
+    EXPECT_EQ(0u, live_fences);
+}
+
+TEST_F(FrameReadbackTest, reuses_pixel_memory) {
+    auto readback = ice::FrameReadback{fake_functions()};
+    auto pixels   = std::vector<const uint8_t*>{};
+    auto keep     = [&] (ice::Image&& image) {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        pixels.push_back(image.pixels.data());
+    };
+
+    for (auto frame = 0u; frame < 3u; frame++)
+    {
+        readback.read({8u, 8u}, frame, keep);
+        gpu_done = next_fence - 1u;
+        finish(readback);
+    }
+
+    ASSERT_EQ(3u, pixels.size());
+    EXPECT_EQ(pixels[0], pixels[1]);
+    EXPECT_EQ(pixels[0], pixels[2]);
+}
+
+TEST_F(FrameReadbackTest, downscales_before_reading) {
+    {
+        auto readback = ice::FrameReadback{fake_functions()};
+        EXPECT_TRUE(readback.read({8u, 6u}, 1u, collect(), {}, 2u));
+        EXPECT_EQ(glm::ivec4(0, 0, 8, 6), blit_source);
+        EXPECT_EQ(glm::ivec4(0, 0, 4, 3), blit_target);
+        EXPECT_EQ(glm::uvec2(4u, 3u), read_size);
+        EXPECT_EQ(0u, read_framebuffer);
+
+        // too small to scale down
+        EXPECT_FALSE(readback.read({1u, 1u}, 2u, collect(), {}, 2u));
+
+        gpu_done = next_fence - 1u;
+        finish(readback);
+    }
+
+    ASSERT_EQ(1u, images.size());
+    EXPECT_EQ(glm::uvec2(4u, 3u), images[0].size);
+    EXPECT_EQ(4u * 3u * 4u, images[0].pixels.size());
+}
+
+TEST_F(FrameReadbackTest, reports_lost_readbacks) {
+    auto failures = std::atomic<unsigned int>{0u};
+    {
+        auto readback = ice::FrameReadback{fake_functions()};
+
+        fail_wait = true;
+        readback.read({2u, 2u}, 1u, collect(), count(failures));
+        finish(readback);
+        EXPECT_EQ(1u, failures);
+        fail_wait = false;
+
+        fail_map = true;
+        readback.read({2u, 2u}, 2u, collect(), count(failures));
+        gpu_done = next_fence - 1u;
+        finish(readback);
+        EXPECT_EQ(2u, failures);
+        fail_map = false;
+
+        // still on the GPU when the readback goes away
+        readback.read({2u, 2u}, 3u, collect(), count(failures));
+        EXPECT_EQ(3u, readback.get_stats().requested);
+    }
+
+    EXPECT_EQ(3u, failures);
+    EXPECT_TRUE(images.empty());
+    EXPECT_EQ(0u, live_fences);
+}
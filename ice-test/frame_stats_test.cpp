@@ -0,0 +1,97 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/FrameStats.h>
+
+#include <sstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+TEST(FrameStats, empty) {
+    auto stats = ice::FrameStats{};
+    EXPECT_EQ(0u, stats.get_frame_count());
+    EXPECT_EQ(0.0, stats.get(ice::FramePhase::FRAME).max);
+}
+
+TEST(FrameStats, percentiles) {
+    auto stats = ice::FrameStats{100u};
+    // shuffled order, the result must not depend on it
+    for (auto i = 0u; i < 100u; i++)
+    {
+        stats.add(ice::FramePhase::FRAME, std::chrono::milliseconds((i * 37u) % 100u + 1u));
+        stats.end_frame();
+    }
+
+    const auto frame = stats.get(ice::FramePhase::FRAME);
+    EXPECT_DOUBLE_EQ(1.0, frame.min);
+    EXPECT_DOUBLE_EQ(50.5, frame.avg);
+    EXPECT_DOUBLE_EQ(50.0, frame.p50);
+    EXPECT_DOUBLE_EQ(95.0, frame.p95);
+    EXPECT_DOUBLE_EQ(99.0, frame.p99);
+    EXPECT_DOUBLE_EQ(100.0, frame.max);
+
+    // phases without time count as 0
+    EXPECT_DOUBLE_EQ(0.0, stats.get(ice::FramePhase::DRAW).max);
+}
+
+TEST(FrameStats, sums_phase_time_per_frame) {
+    auto stats = ice::FrameStats{};
+    stats.add(ice::FramePhase::UPDATE, 2ms);
+    stats.add(ice::FramePhase::UPDATE, 3ms);
+    stats.end_frame();
+
+    EXPECT_EQ(1u, stats.get_frame_count());
+    EXPECT_DOUBLE_EQ(5.0, stats.get(ice::FramePhase::UPDATE).p50);
+}
+
+TEST(FrameStats, rolls_over) {
+    auto stats = ice::FrameStats{10u};
+    for (auto i = 0u; i < 10u; i++)
+    {
+        stats.add(ice::FramePhase::FRAME, 100ms);
+        stats.end_frame();
+    }
+    for (auto i = 0u; i < 10u; i++)
+    {
+        stats.add(ice::FramePhase::FRAME, 1ms);
+        stats.end_frame();
+    }
+
+    EXPECT_EQ(10u, stats.get_frame_count());
+    EXPECT_DOUBLE_EQ(1.0, stats.get(ice::FramePhase::FRAME).max);
+}
+
+TEST(FrameStats, writes_table) {
+    auto stats = ice::FrameStats{};
+    stats.add(ice::FramePhase::SWAP, 1500us);
+    stats.end_frame();
+
+    auto output = std::stringstream{};
+    output << stats;
+    const auto text = output.str();
+
+    EXPECT_NE(std::string::npos, text.find("p99"));
+    EXPECT_NE(std::string::npos, text.find("swap"));
+    EXPECT_NE(std::string::npos, text.find("1.5"));
+}
@@ -0,0 +1,134 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/GLState.h>
+
+#include <SDL2/SDL_opengl.h>
+#include <gtest/gtest.h>
+
+namespace
+{
+    unsigned int gl_calls = 0u;
+
+    void ICE_APIENTRY fake_viewport(int, int, int, int) { gl_calls++; }
+    void ICE_APIENTRY fake_clear_color(float, float, float, float) { gl_calls++; }
+    void ICE_APIENTRY fake_use_program(unsigned int) { gl_calls++; }
+    void ICE_APIENTRY fake_bind_buffer(unsigned int, unsigned int) { gl_calls++; }
+    void ICE_APIENTRY fake_enable(unsigned int) { gl_calls++; }
+    void ICE_APIENTRY fake_disable(unsigned int) { gl_calls++; }
+    void ICE_APIENTRY fake_blend_func(unsigned int, unsigned int) { gl_calls++; }
+
+    ice::GLFunctions fake_functions()
+    {
+        auto result = ice::GLFunctions{};
+        result.viewport    = fake_viewport;
+        result.clear_color = fake_clear_color;
+        result.use_program = fake_use_program;
+        result.bind_buffer = fake_bind_buffer;
+        result.enable      = fake_enable;
+        result.disable     = fake_disable;
+        result.blend_func  = fake_blend_func;
+        return result;
+    }
+
+    class GLStateTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            gl_calls = 0u;
+        }
+    };
+}
+
+TEST_F(GLStateTest, skips_redundant_calls) {
+    auto state = ice::GLState{fake_functions()};
+
+    state.viewport({0, 0, 800, 600});
+    state.viewport({0, 0, 800, 600});
+    state.use_program(3u);
+    state.use_program(3u);
+    state.use_program(4u);
+    state.clear_color({0.0f, 0.0f, 0.0f, 1.0f});
+    state.clear_color({0.0f, 0.0f, 0.0f, 1.0f});
+    state.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    state.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    EXPECT_EQ(5u, gl_calls);
+    EXPECT_EQ(5u, state.get_stats().issued);
+    EXPECT_EQ(4u, state.get_stats().skipped);
+}
+
+TEST_F(GLStateTest, caches_buffers_per_target) {
+    auto state = ice::GLState{fake_functions()};
+
+    state.bind_buffer(GL_ARRAY_BUFFER, 1u);
+    state.bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 1u);
+    state.bind_buffer(GL_ARRAY_BUFFER, 1u);
+    state.bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 2u);
+    // not cached
+    state.bind_buffer(GL_PIXEL_PACK_BUFFER, 1u);
+    state.bind_buffer(GL_PIXEL_PACK_BUFFER, 1u);
+
+    EXPECT_EQ(5u, gl_calls);
+    EXPECT_EQ(1u, state.get_stats().skipped);
+}
+
+TEST_F(GLStateTest, caches_capabilities) {
+    auto state = ice::GLState{fake_functions()};
+
+    state.set_enabled(GL_BLEND, true);
+    state.set_enabled(GL_BLEND, true);
+    state.set_enabled(GL_DEPTH_TEST, true);
+    state.set_enabled(GL_BLEND, false);
+    state.set_enabled(GL_BLEND, false);
+
+    EXPECT_EQ(3u, gl_calls);
+    EXPECT_EQ(2u, state.get_stats().skipped);
+}
+
+TEST_F(GLStateTest, invalidate) {
+    auto state = ice::GLState{fake_functions()};
+
+    state.use_program(1u);
+    state.invalidate();
+    state.use_program(1u);
+
+    EXPECT_EQ(2u, gl_calls);
+}
+
+TEST_F(GLStateTest, frame_stats) {
+    auto state = ice::GLState{fake_functions()};
+
+    state.use_program(1u);
+    state.use_program(1u);
+    state.end_frame();
+
+    EXPECT_EQ(1u, state.get_frame_stats().issued);
+    EXPECT_EQ(1u, state.get_frame_stats().skipped);
+    EXPECT_EQ(0u, state.get_stats().issued);
+    EXPECT_EQ(0u, state.get_stats().skipped);
+
+    state.use_program(1u);
+    state.end_frame();
+    EXPECT_EQ(0u, state.get_frame_stats().issued);
+    EXPECT_EQ(1u, state.get_frame_stats().skipped);
+}
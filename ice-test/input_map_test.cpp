@@ -0,0 +1,243 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/InputMap.h>
+#include <ice/KeyNames.h>
+
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+static_assert(ice::parse_key("SPACE") == ice::Key::SPACE);
+static_assert(ice::parse_key("lshift") == ice::Key::LSHIFT);
+static_assert(ice::parse_key("Kp0") == ice::Key::KP0);
+static_assert(ice::parse_key("NOT_A_KEY") == ice::Key::UNDEFINED);
+static_assert(ice::parse_key("") == ice::Key::UNDEFINED);
+
+TEST(KeyNames, parse_all) {
+    for (const auto& [name, key] : ice::key_names)
+    {
+        EXPECT_EQ(key, ice::parse_key(name)) << name;
+        EXPECT_EQ(name, ice::get_key_name(key));
+    }
+}
+
+TEST(KeyNames, hash_table_is_current) {
+    const auto table = ice::detail::make_key_hash_table();
+    if (table != ice::detail::key_hash_table)
+    {
+        auto out = std::stringstream{};
+        for (auto seed : table.seeds)
+        {
+            out << seed << ", ";
+        }
+        out << "\n";
+        for (auto slot : table.slots)
+        {
+            out << static_cast<unsigned int>(slot) << ", ";
+        }
+        FAIL() << "key_hash_table is out of date, the new table is:\n" << out.str();
+    }
+}
+
+TEST(InputMap, bind_key) {
+    auto map  = ice::InputMap{};
+    auto jump = map.get_action_id("jump");
+    map.get_context("game").bind(jump, ice::Key::SPACE);
+    map.push_context("game");
+
+    EXPECT_EQ(jump, map.lookup(ice::Key::SPACE));
+    EXPECT_EQ(jump, map.lookup(ice::Key::SPACE, ice::KeyMod::SHIFT));
+    EXPECT_EQ(ice::NO_ACTION, map.lookup(ice::Key::A));
+
+    map.handle_key_down(ice::KeyMod::NONE, ice::Key::SPACE);
+    EXPECT_TRUE(map.is_active(jump));
+    EXPECT_TRUE(map.was_triggered(jump));
+
+    map.begin_frame();
+    map.handle_key_down(ice::KeyMod::NONE, ice::Key::SPACE); // repeat
+    EXPECT_TRUE(map.is_active(jump));
+    EXPECT_FALSE(map.was_triggered(jump));
+
+    map.begin_frame();
+    map.handle_key_up(ice::KeyMod::NONE, ice::Key::SPACE);
+    EXPECT_FALSE(map.is_active(jump));
+    EXPECT_TRUE(map.was_released(jump));
+}
+
+TEST(InputMap, modifiers) {
+    auto map   = ice::InputMap{};
+    auto type  = map.get_action_id("type");
+    auto save  = map.get_action_id("save");
+    auto& game = map.get_context("game");
+    game.bind(type, ice::Key::S);
+    game.bind(save, ice::Key::S, ice::KeyMod::CTRL);
+    map.push_context("game");
+
+    EXPECT_EQ(type, map.lookup(ice::Key::S));
+    EXPECT_EQ(type, map.lookup(ice::Key::S, ice::KeyMod::SHIFT));
+    EXPECT_EQ(save, map.lookup(ice::Key::S, ice::KeyMod::CTRL));
+    EXPECT_EQ(save, map.lookup(ice::Key::S, ice::KeyMod::CTRL|ice::KeyMod::SHIFT));
+
+    // releasing the modifier first releases the same action
+    map.handle_key_down(ice::KeyMod::CTRL, ice::Key::S);
+    map.handle_key_up(ice::KeyMod::NONE, ice::Key::S);
+    EXPECT_TRUE(map.was_triggered(save));
+    EXPECT_TRUE(map.was_released(save));
+    EXPECT_FALSE(map.was_triggered(type));
+}
+
+TEST(InputMap, context_stack) {
+    auto map  = ice::InputMap{};
+    auto jump = map.get_action_id("jump");
+    auto menu = map.get_action_id("menu");
+    auto ok   = map.get_action_id("ok");
+    map.get_context("game").bind(jump, ice::Key::SPACE);
+    map.get_context("game").bind(menu, ice::Key::ESCAPE);
+    map.get_context("menu").bind(ok, ice::Key::SPACE);
+
+    map.push_context("game");
+    EXPECT_EQ(jump, map.lookup(ice::Key::SPACE));
+
+    map.push_context("menu");
+    EXPECT_EQ(2u, map.get_context_depth());
+    EXPECT_EQ(ok, map.lookup(ice::Key::SPACE));
+    EXPECT_EQ(menu, map.lookup(ice::Key::ESCAPE));
+
+    map.pop_context();
+    EXPECT_EQ(jump, map.lookup(ice::Key::SPACE));
+}
+
+TEST(InputMap, mouse_button) {
+    auto map  = ice::InputMap{};
+    auto fire = map.get_action_id("fire");
+    map.get_context("game").bind(fire, ice::MouseButton::LEFT);
+    map.push_context("game");
+
+    auto downs = 0u;
+    map.on_action_down([&] (ice::ActionId action) {
+        EXPECT_EQ(fire, action);
+        downs++;
+    });
+
+    map.handle_button_down(ice::MouseButton::LEFT);
+    EXPECT_TRUE(map.is_active(fire));
+    map.handle_button_up(ice::MouseButton::LEFT);
+    EXPECT_FALSE(map.is_active(fire));
+    EXPECT_EQ(1u, downs);
+}
+
+TEST(InputMap, mouse_button_uses_held_modifiers) {
+    auto map  = ice::InputMap{};
+    auto fire = map.get_action_id("fire");
+    auto alt  = map.get_action_id("alt_fire");
+    auto& game = map.get_context("game");
+    game.bind(fire, ice::MouseButton::LEFT);
+    game.bind(alt, ice::MouseButton::LEFT, ice::KeyMod::SHIFT);
+    map.push_context("game");
+
+    map.handle_key_down(ice::KeyMod::SHIFT, ice::Key::LSHIFT);
+    map.handle_button_down(ice::MouseButton::LEFT);
+    map.handle_button_up(ice::MouseButton::LEFT);
+    EXPECT_TRUE(map.was_triggered(alt));
+
+    // a key event with stale modifiers does not decide the button
+    map.handle_key_up(ice::KeyMod::NONE, ice::Key::LSHIFT);
+    map.handle_key_down(ice::KeyMod::SHIFT, ice::Key::W);
+    map.begin_frame();
+    map.handle_button_down(ice::MouseButton::LEFT);
+    EXPECT_TRUE(map.was_triggered(fire));
+    EXPECT_FALSE(map.was_triggered(alt));
+}
+
+TEST(InputMap, axes) {
+    auto map    = ice::InputMap{};
+    auto move_x = map.get_action_id("move_x");
+    auto& game  = map.get_context("game");
+    game.bind_axis(move_x, ice::Key::A, ice::Key::D);
+    game.bind_axis(move_x, ice::Key::LEFT, ice::Key::RIGHT);
+    game.bind_axis(move_x, ice::MouseAxis::X, 0.5f);
+    map.push_context("game");
+
+    EXPECT_FLOAT_EQ(0.0f, map.get_axis(move_x));
+
+    map.handle_key_down(ice::KeyMod::NONE, ice::Key::D);
+    EXPECT_FLOAT_EQ(1.0f, map.get_axis(move_x));
+
+    map.handle_key_down(ice::KeyMod::NONE, ice::Key::RIGHT);
+    EXPECT_FLOAT_EQ(1.0f, map.get_axis(move_x));
+
+    map.handle_key_down(ice::KeyMod::NONE, ice::Key::A);
+    map.handle_key_up(ice::KeyMod::NONE, ice::Key::RIGHT);
+    EXPECT_FLOAT_EQ(0.0f, map.get_axis(move_x));
+
+    map.handle_motion({4, 0});
+    EXPECT_FLOAT_EQ(2.0f, map.get_axis(move_x));
+
+    map.begin_frame();
+    EXPECT_FLOAT_EQ(0.0f, map.get_axis(move_x));
+}
+
+TEST(InputMap, load) {
+    auto input = std::istringstream{R"(
+        # test bindings
+        context game
+        bind jump   SPACE
+        bind save   ctrl+S
+        bind fire   MOUSE_LEFT
+        axis move_x A D
+        axis look_x MOUSE_X 0.25
+
+        context menu
+        bind ok     Return
+    )"};
+
+    auto map = ice::InputMap{};
+    map.load(input);
+    map.push_context("game");
+
+    EXPECT_EQ(map.find_action_id("jump"), map.lookup(ice::Key::SPACE));
+    EXPECT_EQ(map.find_action_id("save"), map.lookup(ice::Key::S, ice::KeyMod::CTRL));
+    EXPECT_EQ(ice::NO_ACTION, map.lookup(ice::Key::S));
+    EXPECT_EQ(map.find_action_id("fire"), map.lookup(ice::MouseButton::LEFT));
+    EXPECT_EQ(ice::NO_ACTION, map.lookup(ice::Key::RETURN));
+
+    map.handle_motion({8, 0});
+    EXPECT_FLOAT_EQ(2.0f, map.get_axis(map.find_action_id("look_x")));
+
+    map.push_context("menu");
+    EXPECT_EQ(map.find_action_id("ok"), map.lookup(ice::Key::RETURN));
+}
+
+TEST(InputMap, load_errors) {
+    auto load = [] (const char* text) {
+        auto input = std::istringstream{text};
+        auto map   = ice::InputMap{};
+        map.load(input);
+    };
+
+    EXPECT_THROW(load("bind jump SPACE"), std::runtime_error);
+    EXPECT_THROW(load("context game\nbind jump SPAEC"), std::runtime_error);
+    EXPECT_THROW(load("context game\nbind jump HYPER+SPACE"), std::runtime_error);
+    EXPECT_THROW(load("context game\naxis move_x A"), std::runtime_error);
+    EXPECT_THROW(load("context game\naxis look MOUSE_X fast"), std::runtime_error);
+    EXPECT_THROW(load("context game\nunbind jump"), std::runtime_error);
+}
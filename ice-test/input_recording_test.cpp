@@ -0,0 +1,286 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/Engine.h>
+#include <ice/InputRecording.h>
+
+#include <cstring>
+#include <filesystem>
+
+#include <SDL2/SDL.h>
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    struct ManualClock
+    {
+        std::chrono::steady_clock::time_point now = {};
+
+        ice::Clock get() noexcept
+        {
+            return [this] () { return now; };
+        }
+    };
+
+    std::filesystem::path temp_file(const char* name)
+    {
+        return std::filesystem::temp_directory_path() / name;
+    }
+
+    SDL_Event make_key(Uint32 type, SDL_Scancode scancode)
+    {
+        auto event = SDL_Event{};
+        event.type                = type;
+        event.key.keysym.scancode = scancode;
+        event.key.keysym.mod      = KMOD_LSHIFT;
+        return event;
+    }
+}
+
+TEST(InputRecording, round_trip)
+{
+    const auto file = temp_file("ice_input_round_trip.bin");
+
+    {
+        auto clock    = ManualClock{};
+        auto recorder = ice::InputRecorder{file, clock.get()};
+
+        recorder.record(make_key(SDL_KEYDOWN, SDL_SCANCODE_A));
+        recorder.end_frame();
+
+        clock.now += 16ms;
+        auto motion = SDL_Event{};
+        motion.type        = SDL_MOUSEMOTION;
+        motion.motion.x    = 100;
+        motion.motion.y    = 200;
+        motion.motion.xrel = -3;
+        motion.motion.yrel = 4;
+        recorder.record(motion);
+
+        auto text = SDL_Event{};
+        text.type = SDL_TEXTINPUT;
+        std::strcpy(text.text.text, "a");
+        recorder.record(text);
+
+        // not recorded
+        auto user = SDL_Event{};
+        user.type = SDL_USEREVENT;
+        recorder.record(user);
+
+        recorder.end_frame();
+        recorder.end_frame();
+
+        clock.now += 32ms;
+        recorder.record(make_key(SDL_KEYUP, SDL_SCANCODE_A));
+        recorder.end_frame();
+        recorder.end_frame();
+
+        EXPECT_EQ(4u, recorder.get_event_count());
+    }
+
+    auto player = ice::InputPlayer{file};
+    EXPECT_EQ(4u, player.get_event_count());
+    EXPECT_EQ(5u, player.get_frame_count());
+
+    auto events = player.get_events();
+    ASSERT_EQ(1u, events.size());
+    EXPECT_EQ(SDL_KEYDOWN, events[0].type);
+    EXPECT_EQ(SDL_SCANCODE_A, events[0].key.keysym.scancode);
+    EXPECT_EQ(KMOD_LSHIFT, events[0].key.keysym.mod);
+    player.end_frame();
+
+    events = player.get_events();
+    ASSERT_EQ(2u, events.size());
+    EXPECT_EQ(SDL_MOUSEMOTION, events[0].type);
+    EXPECT_EQ(100, events[0].motion.x);
+    EXPECT_EQ(200, events[0].motion.y);
+    EXPECT_EQ(-3, events[0].motion.xrel);
+    EXPECT_EQ(4, events[0].motion.yrel);
+    EXPECT_EQ(SDL_TEXTINPUT, events[1].type);
+    EXPECT_STREQ("a", events[1].text.text);
+    EXPECT_EQ(16ms, player.get_time(1));
+    player.end_frame();
+
+    EXPECT_TRUE(player.get_events().empty());
+    player.end_frame();
+
+    events = player.get_events();
+    ASSERT_EQ(1u, events.size());
+    EXPECT_EQ(SDL_KEYUP, events[0].type);
+    EXPECT_EQ(48ms, player.get_time(3));
+    player.end_frame();
+
+    EXPECT_FALSE(player.is_done());
+    EXPECT_TRUE(player.get_events().empty());
+    player.end_frame();
+    EXPECT_TRUE(player.is_done());
+
+    std::filesystem::remove(file);
+}
+
+TEST(InputRecording, elapsed_round_trip)
+{
+    const auto file = temp_file("ice_input_elapsed.bin");
+
+    {
+        auto recorder = ice::InputRecorder{file};
+        recorder.record_elapsed(16ms);
+        recorder.end_frame();
+        recorder.end_frame();
+        recorder.record(make_key(SDL_KEYDOWN, SDL_SCANCODE_A));
+        recorder.record_elapsed(33ms);
+        recorder.end_frame();
+        EXPECT_EQ(1u, recorder.get_event_count());
+    }
+
+    auto player = ice::InputPlayer{file};
+    EXPECT_EQ(1u, player.get_event_count());
+    EXPECT_EQ(3u, player.get_frame_count());
+
+    EXPECT_EQ(16ms, player.get_elapsed());
+    EXPECT_TRUE(player.get_events().empty());
+    player.end_frame();
+    EXPECT_EQ(0ms, player.get_elapsed());
+    player.end_frame();
+    EXPECT_EQ(33ms, player.get_elapsed());
+    EXPECT_EQ(1u, player.get_events().size());
+    player.end_frame();
+    EXPECT_TRUE(player.is_done());
+
+    std::filesystem::remove(file);
+}
+
+TEST(InputRecording, rejects_other_files)
+{
+    const auto file = temp_file("ice_input_invalid.bin");
+    {
+        auto output = std::ofstream(file, std::ios::binary);
+        output << "not a recording";
+    }
+
+    EXPECT_THROW(ice::InputPlayer{file}, std::runtime_error);
+    EXPECT_THROW(ice::InputPlayer{temp_file("ice_input_missing.bin")}, std::runtime_error);
+
+    std::filesystem::remove(file);
+}
+
+TEST(InputRecording, rejects_corrupt_frame_count)
+{
+    const auto file = temp_file("ice_input_corrupt.bin");
+    {
+        auto output = std::ofstream(file, std::ios::binary);
+        output << "ICEINPUT" << '\x02';
+        // an elapsed record 2^56 frames in
+        output << "\x80\x80\x80\x80\x80\x80\x80\x80\x01" << '\x00' << '\x0A' << '\x10';
+    }
+
+    EXPECT_THROW(ice::InputPlayer{file}, std::runtime_error);
+
+    std::filesystem::remove(file);
+}
+
+TEST(InputRecording, engine_replay)
+{
+    const auto file = temp_file("ice_input_replay.bin");
+
+    {
+        auto recorder = ice::InputRecorder{file};
+        recorder.end_frame();
+        recorder.record(make_key(SDL_KEYDOWN, SDL_SCANCODE_SPACE));
+        recorder.end_frame();
+        recorder.record(make_key(SDL_KEYUP, SDL_SCANCODE_SPACE));
+        recorder.end_frame();
+        recorder.end_frame();
+    }
+
+    auto engine    = ice::Engine{ice::EngineMode::HEADLESS};
+    auto& keyboard = engine.get_keyboard();
+    auto frame     = 0u;
+    auto down      = 0u;
+    auto up        = 0u;
+
+    engine.on_update([&] (float) {
+        if (keyboard.was_pressed_this_frame(ice::Key::SPACE))
+        {
+            down = frame;
+        }
+        if (keyboard.was_released_this_frame(ice::Key::SPACE))
+        {
+            up = frame;
+        }
+        frame++;
+    });
+
+    engine.start_replay(file);
+    EXPECT_TRUE(engine.is_replaying());
+    engine.run();
+
+    EXPECT_FALSE(engine.is_replaying());
+    EXPECT_EQ(4u, frame);
+    EXPECT_EQ(1u, down);
+    EXPECT_EQ(2u, up);
+
+    std::filesystem::remove(file);
+}
+
+TEST(InputRecording, engine_replay_recorded_steps)
+{
+    const auto file = temp_file("ice_input_replay_steps.bin");
+
+    // at 60 Hz these are 0, 2, 0 and 3 steps
+    {
+        auto recorder = ice::InputRecorder{file};
+        recorder.record_elapsed(10ms);
+        recorder.end_frame();
+        recorder.record_elapsed(30ms);
+        recorder.end_frame();
+        recorder.record_elapsed(0ms);
+        recorder.end_frame();
+        recorder.record(make_key(SDL_KEYDOWN, SDL_SCANCODE_SPACE));
+        recorder.record_elapsed(50ms);
+        recorder.end_frame();
+    }
+
+    auto engine    = ice::Engine{ice::EngineMode::HEADLESS};
+    auto& keyboard = engine.get_keyboard();
+    auto steps     = 0u;
+    auto down      = 0u;
+    engine.set_update_rate(60u);
+
+    engine.on_update([&] (float) {
+        if (down == 0u && keyboard.is_pressed(ice::Key::SPACE))
+        {
+            down = steps + 1u;
+        }
+        steps++;
+    });
+
+    // the wall clock has nothing to do with the replayed steps
+    engine.start_replay(file);
+    engine.run();
+
+    EXPECT_EQ(5u, steps);
+    EXPECT_EQ(3u, down);
+
+    std::filesystem::remove(file);
+}
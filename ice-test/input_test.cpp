@@ -0,0 +1,151 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/Engine.h>
+
+#include <SDL2/SDL.h>
+#include <gtest/gtest.h>
+
+namespace
+{
+    void push_key(Uint32 type, SDL_Scancode scancode)
+    {
+        auto event = SDL_Event{};
+        event.type                = type;
+        event.key.keysym.scancode = scancode;
+        SDL_PushEvent(&event);
+    }
+
+    void push_button(Uint32 type, Uint8 button)
+    {
+        auto event = SDL_Event{};
+        event.type          = type;
+        event.button.button = button;
+        SDL_PushEvent(&event);
+    }
+}
+
+TEST(Input, key_mask) {
+    auto mask = ice::make_key_mask({ice::Key::W, ice::Key::A});
+    EXPECT_EQ(2u, mask.count());
+    EXPECT_TRUE(mask.test(static_cast<size_t>(ice::Key::W)));
+    EXPECT_TRUE(mask.test(static_cast<size_t>(ice::Key::A)));
+}
+
+TEST(Input, keyboard_edges) {
+    auto engine    = ice::Engine{ice::EngineMode::HEADLESS};
+    auto& keyboard = engine.get_keyboard();
+    auto frame     = 0u;
+    auto results   = std::vector<bool>{};
+
+    push_key(SDL_KEYDOWN, SDL_SCANCODE_A);
+
+    engine.on_update([&] (float) {
+        switch (frame++)
+        {
+        case 0:
+            results.push_back(keyboard.is_pressed(ice::Key::A));
+            results.push_back(keyboard.was_pressed_this_frame(ice::Key::A));
+            results.push_back(!keyboard.was_released_this_frame(ice::Key::A));
+            push_key(SDL_KEYDOWN, SDL_SCANCODE_LSHIFT);
+            break;
+        case 1:
+            results.push_back(keyboard.is_pressed(ice::Key::A));
+            results.push_back(!keyboard.was_pressed_this_frame(ice::Key::A));
+            results.push_back(keyboard.all_pressed(ice::make_key_mask({ice::Key::A, ice::Key::LSHIFT})));
+            results.push_back(!keyboard.any_pressed(ice::make_key_mask({ice::Key::W, ice::Key::S})));
+            push_key(SDL_KEYUP, SDL_SCANCODE_A);
+            break;
+        case 2:
+            results.push_back(!keyboard.is_pressed(ice::Key::A));
+            results.push_back(keyboard.was_released_this_frame(ice::Key::A));
+            results.push_back(keyboard.is_pressed(ice::Key::LSHIFT));
+            engine.stop();
+            break;
+        }
+    });
+
+    engine.run();
+
+    EXPECT_EQ(10u, results.size());
+    for (auto i = 0u; i < results.size(); i++)
+    {
+        EXPECT_TRUE(results[i]) << "check " << i;
+    }
+}
+
+TEST(Input, key_tap_within_one_frame) {
+    auto engine    = ice::Engine{ice::EngineMode::HEADLESS};
+    auto& keyboard = engine.get_keyboard();
+    auto down      = false;
+    auto up        = false;
+    auto pressed   = true;
+
+    push_key(SDL_KEYDOWN, SDL_SCANCODE_SPACE);
+    push_key(SDL_KEYUP, SDL_SCANCODE_SPACE);
+
+    engine.on_update([&] (float) {
+        down    = keyboard.was_pressed_this_frame(ice::Key::SPACE);
+        up      = keyboard.was_released_this_frame(ice::Key::SPACE);
+        pressed = keyboard.is_pressed(ice::Key::SPACE);
+        engine.stop();
+    });
+
+    engine.run();
+
+    EXPECT_TRUE(down);
+    EXPECT_TRUE(up);
+    EXPECT_FALSE(pressed);
+}
+
+TEST(Input, mouse_edges) {
+    auto engine = ice::Engine{ice::EngineMode::HEADLESS};
+    auto& mouse = engine.get_mouse();
+    auto frame  = 0u;
+    auto down   = false;
+    auto held   = false;
+    auto up     = false;
+
+    push_button(SDL_MOUSEBUTTONDOWN, SDL_BUTTON_LEFT);
+
+    engine.on_update([&] (float) {
+        switch (frame++)
+        {
+        case 0:
+            down = mouse.is_pressed(ice::MouseButton::LEFT) && mouse.was_pressed_this_frame(ice::MouseButton::LEFT);
+            break;
+        case 1:
+            held = mouse.is_pressed(ice::MouseButton::LEFT) && !mouse.was_pressed_this_frame(ice::MouseButton::LEFT);
+            push_button(SDL_MOUSEBUTTONUP, SDL_BUTTON_LEFT);
+            break;
+        case 2:
+            up = !mouse.is_pressed(ice::MouseButton::LEFT) && mouse.was_released_this_frame(ice::MouseButton::LEFT);
+            engine.stop();
+            break;
+        }
+    });
+
+    engine.run();
+
+    EXPECT_TRUE(down);
+    EXPECT_TRUE(held);
+    EXPECT_TRUE(up);
+}
@@ -0,0 +1,183 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/JobSystem.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+TEST(JobSystem, runs_jobs)
+{
+    auto jobs    = ice::JobSystem{4u};
+    auto counter = ice::JobCounter{};
+    auto count   = std::atomic<unsigned int>{0u};
+
+    for (auto i = 0u; i < 1000u; i++)
+    {
+        jobs.schedule(counter, [&] () {
+            count++;
+        });
+    }
+
+    jobs.wait(counter);
+    EXPECT_TRUE(counter.is_done());
+    EXPECT_EQ(1000u, count);
+}
+
+TEST(JobSystem, runs_inline_without_threads)
+{
+    auto jobs    = ice::JobSystem{0u};
+    auto counter = ice::JobCounter{};
+    auto count   = 0u;
+
+    jobs.schedule(counter, [&] () {
+        count++;
+    });
+
+    EXPECT_TRUE(counter.is_done());
+    EXPECT_EQ(1u, count);
+}
+
+TEST(JobSystem, parallel_for)
+{
+    auto jobs    = ice::JobSystem{4u};
+    auto counter = ice::JobCounter{};
+    auto values  = std::vector<unsigned int>(10000u, 0u);
+
+    jobs.parallel_for(counter, 0u, values.size(), 0u, [&] (size_t first, size_t last) {
+        for (auto i = first; i < last; i++)
+        {
+            values[i] += static_cast<unsigned int>(i);
+        }
+    });
+
+    jobs.wait(counter);
+    for (auto i = 0u; i < values.size(); i++)
+    {
+        EXPECT_EQ(i, values[i]);
+    }
+}
+
+TEST(JobSystem, nested_jobs)
+{
+    auto jobs    = ice::JobSystem{4u};
+    auto outer   = ice::JobCounter{};
+    auto inner   = ice::JobCounter{};
+    auto count   = std::atomic<unsigned int>{0u};
+
+    for (auto i = 0u; i < 10u; i++)
+    {
+        jobs.schedule(outer, [&] () {
+            for (auto j = 0u; j < 10u; j++)
+            {
+                jobs.schedule(inner, [&] () {
+                    count++;
+                });
+            }
+        });
+    }
+
+    jobs.wait(outer);
+    jobs.wait(inner);
+    EXPECT_EQ(100u, count);
+}
+
+TEST(JobSystem, counter_dependency)
+{
+    auto jobs   = ice::JobSystem{4u};
+    auto first  = ice::JobCounter{};
+    auto second = ice::JobCounter{};
+    auto values = std::vector<unsigned int>(1000u, 0u);
+    auto sum    = 0u;
+
+    jobs.parallel_for(first, 0u, values.size(), 10u, [&] (size_t b, size_t e) {
+        for (auto i = b; i < e; i++)
+        {
+            values[i] = 1u;
+        }
+    });
+
+    jobs.schedule(second, [&] () {
+        jobs.wait(first);
+        sum = std::accumulate(begin(values), end(values), 0u);
+    });
+
+    jobs.wait(second);
+    EXPECT_EQ(1000u, sum);
+}
+
+TEST(JobSystem, wait_does_not_block)
+{
+    auto jobs    = ice::JobSystem{1u};
+    auto counter = ice::JobCounter{};
+    auto release = std::atomic<bool>{false};
+
+    jobs.schedule(counter, [&] () {
+        while (!release)
+        {
+            std::this_thread::yield();
+        }
+    });
+
+    EXPECT_FALSE(counter.is_done());
+    EXPECT_EQ(1u, counter.get_pending());
+    release = true;
+    jobs.wait(counter);
+    EXPECT_TRUE(counter.is_done());
+}
+
+TEST(JobSystem, benchmark_scaling)
+{
+    constexpr auto item_count = size_t{1u << 22u};
+    auto values = std::vector<float>(item_count, 1.0f);
+
+    const auto max_threads = std::max(1u, std::thread::hardware_concurrency());
+    auto baseline = 0.0;
+    for (auto cores = 1u; cores <= max_threads; cores++)
+    {
+        // the waiting thread helps, so n cores means n - 1 workers
+        auto jobs    = ice::JobSystem{cores - 1u};
+        auto counter = ice::JobCounter{};
+
+        const auto start = std::chrono::steady_clock::now();
+        jobs.parallel_for(counter, 0u, item_count, 4096u, [&] (size_t first, size_t last) {
+            for (auto i = first; i < last; i++)
+            {
+                values[i] = std::sqrt(values[i] * 1.0001f + 0.5f);
+            }
+        });
+        jobs.wait(counter);
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const auto throughput = static_cast<double>(item_count) / elapsed / 1e6;
+        if (cores == 1u)
+        {
+            baseline = throughput;
+        }
+        std::cout << cores << " cores: " << throughput << " Mitems/s (" << throughput / baseline << "x)\n";
+    }
+}
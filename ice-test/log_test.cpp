@@ -0,0 +1,283 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/Log.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    class NullSink : public ice::LogSink
+    {
+    public:
+        void write(const ice::LogMessage&) override {}
+    };
+
+    class LogTest : public testing::Test
+    {
+    protected:
+        std::shared_ptr<ice::MemorySink> sink = std::make_shared<ice::MemorySink>();
+
+        void SetUp() override
+        {
+            auto& logger = ice::Logger::get();
+            logger.flush();
+            logger.clear_sinks();
+            logger.add_sink(sink);
+        }
+
+        void TearDown() override
+        {
+            auto& logger = ice::Logger::get();
+            logger.flush();
+            logger.clear_sinks();
+            logger.add_sink(std::make_shared<ice::DebugSink>());
+            logger.set_buffer_size(64u << 10u);
+            logger.set_overflow(ice::LogOverflow::DROP);
+        }
+    };
+}
+
+TEST_F(LogTest, trace_goes_to_sinks) {
+    ice::trace("Hello");
+    ice::Logger::get().flush();
+
+    const auto lines = sink->get_lines();
+    ASSERT_EQ(1u, lines.size());
+    EXPECT_TRUE(lines[0].starts_with("log_test.cpp("));
+    EXPECT_NE(std::string::npos, lines[0].find("TestBody"));
+    EXPECT_TRUE(lines[0].ends_with(": Hello\n"));
+}
+
+TEST_F(LogTest, log_with_category) {
+    ICE_WARNING(ice::LOG_RENDER, "{} draws", 42);
+    ice::Logger::get().flush();
+
+    const auto lines = sink->get_lines();
+    ASSERT_EQ(1u, lines.size());
+    EXPECT_TRUE(lines[0].ends_with(": [render] warning: 42 draws\n"));
+}
+
+TEST_F(LogTest, disabled_levels_are_not_evaluated) {
+    constexpr auto quiet = ice::LogCategory{"quiet", ice::LogLevel::CRITICAL};
+    static_assert(!ice::is_log_enabled(quiet, ice::LogLevel::WARNING));
+    static_assert(ice::is_log_enabled(quiet, ice::LogLevel::CRITICAL));
+    static_assert(!ice::is_log_enabled(ice::LOG_GENERAL, ice::LogLevel::NONE));
+
+    auto calls = 0u;
+    const auto expensive = [&] () {
+        calls++;
+        return 0;
+    };
+    ICE_WARNING(quiet, "{}", expensive());
+    ICE_CRITICAL(quiet, "{}", expensive());
+    ice::Logger::get().flush();
+
+    EXPECT_EQ(1u, calls);
+    EXPECT_EQ(1u, sink->get_lines().size());
+}
+
+TEST_F(LogTest, check_tiers) {
+    auto calls = 0u;
+    ICE_CHECK(++calls > 0u);
+    ICE_CHECK_DEBUG(++calls > 0u);
+    ICE_CHECK_PARANOID(++calls > 0u);
+
+    auto expected = 1u;
+    if constexpr (ice::CHECK_LEVEL >= ice::CheckLevel::DEBUG)
+    {
+        expected++;
+    }
+    if constexpr (ice::CHECK_LEVEL >= ice::CheckLevel::PARANOID)
+    {
+        expected++;
+    }
+    EXPECT_EQ(expected, calls);
+
+    EXPECT_DEATH(ICE_CHECK(calls == 0u), "");
+}
+
+TEST_F(LogTest, forked_child_exits) {
+    ice::trace("parent");
+    // with the fast death test style the child is forked and exits through the logger
+    EXPECT_EXIT({
+        ice::trace("child");
+        ice::Logger::get().flush();
+        std::exit(0);
+    }, testing::ExitedWithCode(0), "");
+    ice::Logger::get().flush();
+
+    const auto lines = sink->get_lines();
+    ASSERT_EQ(1u, lines.size());
+    EXPECT_TRUE(lines[0].ends_with(": parent\n"));
+}
+
+TEST_F(LogTest, keeps_order_per_thread) {
+    auto threads = std::vector<std::thread>{};
+    for (auto t = 0u; t < 4u; t++)
+    {
+        threads.emplace_back([t] () {
+            for (auto i = 0u; i < 100u; i++)
+            {
+                ice::trace(std::to_string(t * 1000u + i));
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    ice::Logger::get().flush();
+
+    const auto lines = sink->get_lines();
+    ASSERT_EQ(400u, lines.size());
+
+    auto last = std::vector<int>(4u, -1);
+    for (const auto& line : lines)
+    {
+        const auto value = std::stoi(line.substr(line.rfind(' ') + 1u));
+        EXPECT_LT(last[value / 1000], value % 1000);
+        last[value / 1000] = value % 1000;
+    }
+}
+
+TEST_F(LogTest, drops_on_overflow) {
+    auto& logger = ice::Logger::get();
+    logger.set_buffer_size(1024u);
+    logger.set_overflow(ice::LogOverflow::DROP);
+    const auto before = logger.get_stats();
+
+    auto thread = std::thread([] () {
+        for (auto i = 0u; i < 1000u; i++)
+        {
+            ice::trace("This message is long enough to fill a small buffer in no time.");
+        }
+    });
+    thread.join();
+    logger.flush();
+
+    const auto after = logger.get_stats();
+    EXPECT_LT(0u, after.dropped - before.dropped);
+    EXPECT_EQ(1000u, (after.dropped - before.dropped) + sink->get_lines().size());
+}
+
+TEST_F(LogTest, blocks_on_overflow) {
+    auto& logger = ice::Logger::get();
+    logger.set_buffer_size(1024u);
+    logger.set_overflow(ice::LogOverflow::BLOCK);
+    const auto before = logger.get_stats();
+
+    auto thread = std::thread([] () {
+        for (auto i = 0u; i < 1000u; i++)
+        {
+            ice::trace("This message is long enough to fill a small buffer in no time.");
+        }
+    });
+    thread.join();
+    logger.flush();
+
+    EXPECT_EQ(before.dropped, logger.get_stats().dropped);
+    EXPECT_EQ(1000u, sink->get_lines().size());
+}
+
+TEST_F(LogTest, cuts_long_messages) {
+    auto& logger = ice::Logger::get();
+    logger.set_buffer_size(1024u);
+
+    auto thread = std::thread([] () {
+        ice::trace(std::string(10000u, 'x'));
+    });
+    thread.join();
+    logger.flush();
+
+    const auto lines = sink->get_lines();
+    ASSERT_EQ(1u, lines.size());
+    EXPECT_GT(1024u, lines[0].size());
+}
+
+TEST_F(LogTest, rotates_files) {
+    const auto file = std::filesystem::temp_directory_path() / "ice_log_test.log";
+    const auto backup = std::filesystem::temp_directory_path() / "ice_log_test.1.log";
+    std::filesystem::remove(file);
+    std::filesystem::remove(backup);
+
+    {
+        auto file_sink = std::make_shared<ice::RotatingFileSink>(file, 200u, 1u);
+        ice::Logger::get().add_sink(file_sink);
+        for (auto i = 0u; i < 10u; i++)
+        {
+            ice::trace("Some text to fill the log file.");
+        }
+        ice::Logger::get().flush();
+        ice::Logger::get().remove_sink(file_sink);
+    }
+
+    EXPECT_TRUE(std::filesystem::exists(backup));
+    EXPECT_GE(200u, std::filesystem::file_size(file));
+    EXPECT_GE(200u, std::filesystem::file_size(backup));
+
+    std::filesystem::remove(file);
+    std::filesystem::remove(backup);
+}
+
+TEST_F(LogTest, benchmark_trace) {
+    auto& logger = ice::Logger::get();
+    logger.clear_sinks();
+    logger.add_sink(std::make_shared<NullSink>());
+    logger.set_overflow(ice::LogOverflow::BLOCK);
+
+    const auto count = 100000u;
+    const auto to_ns = [&] (auto d) { return std::chrono::duration<double, std::nano>(d).count() / count; };
+
+    // what trace used to do on the calling thread, without the actual output
+    auto output = std::ostringstream{};
+    const auto sync_start = std::chrono::steady_clock::now();
+    for (auto i = 0u; i < count; i++)
+    {
+        auto message = ice::LogMessage{};
+        message.file     = __FILE__;
+        message.function = "TestBody";
+        message.line     = __LINE__;
+        message.text     = "Something happened.";
+        output << ice::format_log_line(message);
+    }
+    const auto sync_time = std::chrono::steady_clock::now() - sync_start;
+
+    const auto async_start = std::chrono::steady_clock::now();
+    for (auto i = 0u; i < count; i++)
+    {
+        ice::trace("Something happened.");
+    }
+    const auto async_time = std::chrono::steady_clock::now() - async_start;
+    logger.flush();
+
+    std::cout << "format:  " << to_ns(sync_time) << " ns/call" << std::endl;
+    std::cout << "trace:   " << to_ns(async_time) << " ns/call" << std::endl;
+}
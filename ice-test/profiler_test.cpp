@@ -0,0 +1,192 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/Profiler.h>
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    class ProfilerTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            ice::Profiler::get().stop();
+            ice::Profiler::get().collect();
+            ice::Profiler::get().clear();
+        }
+
+        void TearDown() override
+        {
+            ice::Profiler::get().stop();
+        }
+    };
+
+    void inner()
+    {
+        ICE_PROFILE_ZONE();
+    }
+
+    void outer()
+    {
+        ICE_PROFILE_ZONE();
+        inner();
+        inner();
+    }
+}
+
+TEST_F(ProfilerTest, ignores_zones_when_stopped) {
+    outer();
+
+    auto& profiler = ice::Profiler::get();
+    profiler.collect();
+    EXPECT_TRUE(profiler.get_events().empty());
+}
+
+TEST_F(ProfilerTest, records_nested_zones) {
+    auto& profiler = ice::Profiler::get();
+    profiler.start();
+    outer();
+    profiler.stop();
+    profiler.collect();
+
+    const auto& events = profiler.get_events();
+    ASSERT_EQ(3u, events.size());
+    // zones are written when they end
+    EXPECT_NE(std::string::npos, std::string(events[0].name).find("inner"));
+    EXPECT_EQ(1u, events[0].depth);
+    EXPECT_EQ(1u, events[1].depth);
+    EXPECT_NE(std::string::npos, std::string(events[2].name).find("outer"));
+    EXPECT_EQ(0u, events[2].depth);
+    EXPECT_LE(events[2].begin, events[0].begin);
+    EXPECT_GE(events[2].end, events[1].end);
+}
+
+TEST_F(ProfilerTest, stops_after_frames) {
+    auto& profiler = ice::Profiler::get();
+    profiler.start(2u);
+    for (auto i = 0u; i < 4u; i++)
+    {
+        profiler.begin_frame();
+        ICE_PROFILE_ZONE_NAMED("frame");
+    }
+    EXPECT_FALSE(profiler.is_recording());
+
+    profiler.collect();
+    EXPECT_EQ(2u, profiler.get_events().size());
+}
+
+TEST_F(ProfilerTest, records_each_thread) {
+    auto& profiler = ice::Profiler::get();
+    profiler.start();
+
+    auto thread = std::thread([] () {
+        ice::Profiler::get().set_thread_name("worker");
+        ICE_PROFILE_ZONE_NAMED("work");
+    });
+    thread.join();
+    {
+        ICE_PROFILE_ZONE_NAMED("main");
+    }
+    profiler.stop();
+    profiler.collect();
+
+    const auto& events = profiler.get_events();
+    ASSERT_EQ(2u, events.size());
+    EXPECT_NE(events[0].thread, events[1].thread);
+}
+
+TEST_F(ProfilerTest, frees_rings_of_finished_threads) {
+    auto& profiler = ice::Profiler::get();
+    const auto threads = profiler.get_stats().threads;
+
+    // naming a thread that records nothing costs no ring
+    auto idle = std::thread([] () {
+        ice::Profiler::get().set_thread_name("idle");
+    });
+    idle.join();
+    EXPECT_EQ(threads, profiler.get_stats().threads);
+
+    profiler.start();
+    auto worker = std::thread([] () {
+        ice::Profiler::get().set_thread_name("worker");
+        ICE_PROFILE_ZONE_NAMED("work");
+    });
+    worker.join();
+    profiler.stop();
+    EXPECT_EQ(threads + 1u, profiler.get_stats().threads);
+
+    // the ring is gone after the collect, the name stays for the trace
+    auto output = std::stringstream{};
+    profiler.write_trace(output);
+    EXPECT_NE(std::string::npos, output.str().find("\"name\":\"worker\""));
+    EXPECT_EQ(std::string::npos, output.str().find("\"name\":\"idle\""));
+}
+
+TEST_F(ProfilerTest, writes_chrome_trace) {
+    auto& profiler = ice::Profiler::get();
+    profiler.start();
+    {
+        ICE_PROFILE_ZONE_NAMED("quote\"zone");
+    }
+    profiler.stop();
+
+    auto output = std::stringstream{};
+    profiler.write_trace(output);
+    const auto trace = output.str();
+
+    EXPECT_EQ(0u, trace.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+    EXPECT_NE(std::string::npos, trace.find("\"ph\":\"X\""));
+    EXPECT_NE(std::string::npos, trace.find("\"name\":\"quote\\\"zone\""));
+    EXPECT_NE(std::string::npos, trace.find("profiler_test.cpp"));
+    EXPECT_EQ("]}\n", trace.substr(trace.size() - 3u));
+}
+
+TEST_F(ProfilerTest, benchmark_zone) {
+    auto& profiler = ice::Profiler::get();
+    const auto count = 10000u;
+
+    const auto measure = [&] () {
+        const auto start = std::chrono::steady_clock::now();
+        for (auto i = 0u; i < count; i++)
+        {
+            ICE_PROFILE_ZONE_NAMED("bench");
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+    };
+
+    const auto disabled = measure();
+    profiler.start();
+    const auto enabled = measure();
+    profiler.stop();
+    profiler.collect();
+
+    std::cout << "disabled: " << disabled << " ns/zone" << std::endl;
+    std::cout << "enabled:  " << enabled << " ns/zone" << std::endl;
+    EXPECT_EQ(count, profiler.get_stats().events);
+}
@@ -0,0 +1,170 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/RenderQueue.h>
+#include <ice/JobSystem.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include <gtest/gtest.h>
+
+static_assert(ice::get_sort_layer(ice::make_sort_key(1u, 2u, 3u, 4u)) == 1u);
+static_assert(ice::get_sort_shader(ice::make_sort_key(1u, 2u, 3u, 4u)) == 2u);
+static_assert(ice::get_sort_material(ice::make_sort_key(1u, 2u, 3u, 4u)) == 3u);
+static_assert(ice::get_sort_depth(ice::make_sort_key(1u, 2u, 3u, 4u)) == 4u);
+
+TEST(RenderQueue, sorts_by_key) {
+    auto queue  = ice::RenderQueue{};
+    auto order  = std::vector<uint64_t>{};
+    auto record = [&] (uint64_t key, uint64_t) { order.push_back(key); };
+
+    auto& buffer = queue.get_buffer();
+    EXPECT_EQ(&buffer, &queue.get_buffer());
+
+    const auto keys = std::vector<uint64_t>{
+        ice::make_sort_key(1u, 1u, 1u, 0u),
+        ice::make_sort_key(0u, 2u, 1u, 5u),
+        ice::make_sort_key(0u, 1u, 2u, 0u),
+        ice::make_sort_key(0u, 2u, 1u, 3u),
+        ice::make_sort_key(0u, 1u, 1u, 0u)
+    };
+    for (auto key : keys)
+    {
+        buffer.add(key, record);
+    }
+    EXPECT_EQ(5u, queue.get_command_count());
+
+    queue.execute();
+
+    auto expected = keys;
+    std::sort(begin(expected), end(expected));
+    EXPECT_EQ(expected, order);
+}
+
+TEST(RenderQueue, equal_keys_keep_order) {
+    auto queue = ice::RenderQueue{};
+    auto order = std::vector<int>{};
+
+    auto& buffer = queue.get_buffer();
+    for (auto i = 0; i < 10; i++)
+    {
+        buffer.add(ice::make_sort_key(0u, 1u, 1u, 0u), [&order, i] (uint64_t, uint64_t) { order.push_back(i); });
+    }
+    queue.execute();
+
+    EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), order);
+}
+
+TEST(RenderQueue, passes_previous_key) {
+    auto queue    = ice::RenderQueue{};
+    auto previous = std::vector<uint64_t>{};
+    auto record   = [&] (uint64_t, uint64_t p) { previous.push_back(p); };
+
+    auto& buffer = queue.get_buffer();
+    buffer.add(ice::make_sort_key(0u, 2u, 0u, 0u), record);
+    buffer.add(ice::make_sort_key(0u, 1u, 0u, 0u), record);
+    queue.execute();
+
+    ASSERT_EQ(2u, previous.size());
+    EXPECT_EQ(~uint64_t{0}, previous[0]);
+    EXPECT_EQ(ice::make_sort_key(0u, 1u, 0u, 0u), previous[1]);
+}
+
+TEST(RenderQueue, counts_saved_state_changes) {
+    auto queue = ice::RenderQueue{};
+
+    auto& buffer = queue.get_buffer();
+    for (auto i = 0u; i < 8u; i++)
+    {
+        // alternate between two shaders
+        buffer.add(ice::make_sort_key(0u, i % 2u, 0u, i), [] (uint64_t, uint64_t) {});
+    }
+    queue.execute();
+
+    const auto& stats = queue.get_stats();
+    EXPECT_EQ(8u, stats.commands);
+    EXPECT_EQ(7u, stats.unsorted_state_changes);
+    EXPECT_EQ(1u, stats.state_changes);
+    EXPECT_EQ(6u, stats.saved_state_changes);
+}
+
+TEST(RenderQueue, records_from_many_threads) {
+    auto jobs    = ice::JobSystem{4u};
+    auto counter = ice::JobCounter{};
+    auto queue   = ice::RenderQueue{};
+    auto count   = 0u;
+
+    jobs.parallel_for(counter, 0u, 1000u, 10u, [&] (size_t begin, size_t end) {
+        auto& buffer = queue.get_buffer();
+        for (auto i = begin; i < end; i++)
+        {
+            buffer.add(ice::make_sort_key(0u, 0u, 0u, static_cast<unsigned int>(i)), [&count] (uint64_t, uint64_t) { count++; });
+        }
+    });
+    jobs.wait(counter);
+
+    auto last  = uint64_t{0};
+    auto order = true;
+    queue.get_buffer().add(0u, [&] (uint64_t key, uint64_t) { order = order && key >= last; last = key; });
+    queue.execute();
+
+    EXPECT_EQ(1000u, count);
+    EXPECT_TRUE(order);
+
+    queue.clear();
+    EXPECT_EQ(0u, queue.get_command_count());
+}
+
+TEST(RenderQueue, benchmark_sort) {
+    const auto count = 100000u;
+
+    auto rng  = std::mt19937{42u};
+    auto dist = std::uniform_int_distribution<unsigned int>{0u, 0xFFFFFFu};
+
+    auto queue   = ice::RenderQueue{};
+    auto& buffer = queue.get_buffer();
+    auto keys    = std::vector<uint64_t>{};
+    for (auto i = 0u; i < count; i++)
+    {
+        const auto key = ice::make_sort_key(dist(rng) % 4u, dist(rng) % 32u, dist(rng) % 256u, dist(rng));
+        keys.push_back(key);
+        buffer.add(key, [] (uint64_t, uint64_t) {});
+    }
+
+    const auto radix_start = std::chrono::steady_clock::now();
+    queue.execute();
+    const auto radix_time = std::chrono::steady_clock::now() - radix_start;
+
+    const auto std_start = std::chrono::steady_clock::now();
+    std::stable_sort(begin(keys), end(keys));
+    const auto std_time = std::chrono::steady_clock::now() - std_start;
+
+    const auto& stats = queue.get_stats();
+    std::cout << "commands:               " << stats.commands << std::endl;
+    std::cout << "state changes:          " << stats.state_changes << std::endl;
+    std::cout << "unsorted state changes: " << stats.unsorted_state_changes << std::endl;
+    std::cout << "radix sort + replay:    " << std::chrono::duration<double, std::milli>(radix_time).count() << " ms" << std::endl;
+    std::cout << "std::stable_sort keys:  " << std::chrono::duration<double, std::milli>(std_time).count() << " ms" << std::endl;
+    EXPECT_LT(stats.state_changes, stats.unsorted_state_changes);
+}
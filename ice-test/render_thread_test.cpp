@@ -0,0 +1,142 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/RenderThread.h>
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+TEST(FramePacket, executes_in_order) {
+    auto packet = ice::FramePacket{};
+    auto order  = std::vector<int>{};
+
+    packet.add([&] () { order.push_back(1); });
+    packet.add([&] () { order.push_back(2); });
+    EXPECT_EQ(2u, packet.get_command_count());
+
+    packet.execute();
+    EXPECT_EQ(std::vector<int>({1, 2}), order);
+
+    packet.clear();
+    EXPECT_EQ(0u, packet.get_command_count());
+}
+
+TEST(RenderThread, draws_on_own_thread) {
+    const auto main_id  = std::this_thread::get_id();
+    auto attach_id      = std::thread::id{};
+    auto draw_ids       = std::vector<std::thread::id>{};
+    auto detached       = false;
+    auto frames         = std::vector<uint64_t>{};
+
+    {
+        auto renderer = ice::RenderThread{
+            [&] (ice::FramePacket& packet) {
+                draw_ids.push_back(std::this_thread::get_id());
+                frames.push_back(packet.get_frame());
+                packet.execute();
+            },
+            [&] () { attach_id = std::this_thread::get_id(); },
+            [&] () { detached = true; }
+        };
+
+        auto packet   = ice::FramePacket{};
+        auto executed = 0u;
+        for (auto i = 0u; i < 10u; i++)
+        {
+            packet.set_frame(i);
+            packet.add([&] () { executed++; });
+            renderer.submit(packet);
+            EXPECT_EQ(0u, packet.get_command_count());
+        }
+
+        renderer.wait();
+        EXPECT_EQ(10u, renderer.get_frame_count());
+        EXPECT_EQ(10u, executed);
+    }
+
+    EXPECT_NE(main_id, attach_id);
+    ASSERT_EQ(10u, draw_ids.size());
+    for (auto id : draw_ids)
+    {
+        EXPECT_EQ(attach_id, id);
+    }
+    EXPECT_TRUE(detached);
+    for (auto i = 0u; i < frames.size(); i++)
+    {
+        EXPECT_EQ(i, frames[i]);
+    }
+}
+
+TEST(RenderThread, draws_frame_in_flight_on_destruction) {
+    auto drawn = 0u;
+    {
+        auto renderer = ice::RenderThread{[&] (ice::FramePacket&) {
+            std::this_thread::sleep_for(10ms);
+            drawn++;
+        }};
+
+        auto packet = ice::FramePacket{};
+        renderer.submit(packet);
+        renderer.submit(packet);
+    }
+    EXPECT_EQ(2u, drawn);
+}
+
+TEST(RenderThread, benchmark_overlap) {
+    // simulate a tick and a draw that each block for a few milliseconds
+    const auto frames = 50u;
+    const auto update = [] () { std::this_thread::sleep_for(4ms); };
+    const auto draw   = [] (ice::FramePacket&) { std::this_thread::sleep_for(4ms); };
+
+    auto packet = ice::FramePacket{};
+
+    const auto inline_start = std::chrono::steady_clock::now();
+    for (auto i = 0u; i < frames; i++)
+    {
+        update();
+        draw(packet);
+    }
+    const auto inline_time = std::chrono::steady_clock::now() - inline_start;
+
+    auto threaded_time = std::chrono::steady_clock::duration{};
+    {
+        auto renderer = ice::RenderThread{draw};
+        const auto threaded_start = std::chrono::steady_clock::now();
+        for (auto i = 0u; i < frames; i++)
+        {
+            update();
+            renderer.submit(packet);
+        }
+        renderer.wait();
+        threaded_time = std::chrono::steady_clock::now() - threaded_start;
+    }
+
+    const auto to_ms = [&] (auto d) { return std::chrono::duration<double, std::milli>(d).count() / frames; };
+    std::cout << "inline:   " << to_ms(inline_time) << " ms/frame" << std::endl;
+    std::cout << "threaded: " << to_ms(threaded_time) << " ms/frame" << std::endl;
+    EXPECT_LT(threaded_time, inline_time);
+}
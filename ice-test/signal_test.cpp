@@ -0,0 +1,205 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/Signal.h>
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <rsig/rsig.h>
+#include <gtest/gtest.h>
+
+TEST(Delegate, calls_callables)
+{
+    auto a = ice::Delegate<int (int)>{[] (int v) { return v + 1; }};
+    EXPECT_EQ(2, a(1));
+
+    auto offset = 10;
+    auto b = ice::Delegate<int (int)>{[offset] (int v) { return v + offset; }};
+    EXPECT_EQ(11, b(1));
+
+    auto fun = std::function<int (int)>{[] (int v) { return v * 2; }};
+    auto c = ice::Delegate<int (int)>{fun};
+    EXPECT_EQ(4, c(2));
+
+    auto empty = ice::Delegate<int (int)>{std::function<int (int)>{}};
+    EXPECT_FALSE(empty);
+}
+
+TEST(Delegate, copies_and_moves)
+{
+    auto text  = std::string{"a fairly long string that does not fit into the small string buffer"};
+    auto large = std::array<char, 64>{};
+    large[0] = 'x';
+
+    auto a = ice::Delegate<std::string ()>{[text] () { return text; }};
+    auto b = a;
+    auto c = std::move(a);
+    EXPECT_FALSE(a);
+    EXPECT_EQ(text, b());
+    EXPECT_EQ(text, c());
+
+    auto d = ice::Delegate<char ()>{[large] () { return large[0]; }};
+    auto e = d;
+    auto f = std::move(d);
+    EXPECT_EQ('x', e());
+    EXPECT_EQ('x', f());
+}
+
+TEST(Signal, emits_in_order)
+{
+    auto signal = ice::Signal<int>{};
+    auto values = std::vector<int>{};
+
+    signal.connect([&] (int v) { values.push_back(v); });
+    signal.connect([&] (int v) { values.push_back(v * 10); });
+    signal.emit(2);
+
+    EXPECT_EQ((std::vector<int>{2, 20}), values);
+}
+
+TEST(Signal, disconnect)
+{
+    auto signal = ice::Signal<>{};
+    auto count  = 0u;
+
+    auto con = signal.connect([&] () { count++; });
+    EXPECT_TRUE(con.is_connected());
+    signal.emit();
+    con.disconnect();
+    EXPECT_FALSE(con.is_connected());
+    signal.emit();
+
+    EXPECT_EQ(1u, count);
+    EXPECT_EQ(0u, signal.get_slot_count());
+}
+
+TEST(Signal, disconnect_through_signal)
+{
+    auto signal = ice::Signal<>{};
+    auto other  = ice::Signal<>{};
+    auto count  = 0u;
+
+    auto con = signal.connect([&] () { count++; });
+    other.disconnect(con);
+    EXPECT_TRUE(con.is_connected());
+    signal.disconnect(con);
+    EXPECT_FALSE(con.is_connected());
+    signal.emit();
+
+    EXPECT_EQ(0u, count);
+}
+
+TEST(Signal, connection_outlives_signal)
+{
+    auto con = ice::Connection{};
+    {
+        auto signal = ice::Signal<>{};
+        con = signal.connect([] () {});
+        EXPECT_TRUE(con.is_connected());
+    }
+    EXPECT_FALSE(con.is_connected());
+    con.disconnect();
+}
+
+TEST(Signal, connect_and_disconnect_during_emit)
+{
+    auto signal = ice::Signal<>{};
+    auto order  = std::string{};
+
+    auto self = ice::Connection{};
+    self = signal.connect([&] () {
+        order += 'a';
+        self.disconnect();
+    });
+
+    auto other = ice::Connection{};
+    signal.connect([&] () {
+        order += 'b';
+        other.disconnect();
+        signal.connect([&] () {
+            order += 'd';
+        });
+    });
+    other = signal.connect([&] () {
+        order += 'c';
+    });
+
+    signal.emit();
+    EXPECT_EQ("ab", order);
+
+    order.clear();
+    signal.emit();
+    EXPECT_EQ("bd", order);
+}
+
+TEST(Signal, rejects_empty_slot)
+{
+    auto signal = ice::Signal<>{};
+    auto slot   = ice::Delegate<void ()>{[] () {}};
+    auto moved  = std::move(slot);
+    EXPECT_DEATH(signal.connect(slot), "");
+    EXPECT_DEATH(signal.connect(ice::Delegate<void ()>{}), "");
+    EXPECT_EQ(0u, signal.get_slot_count());
+}
+
+namespace
+{
+    template <typename Fun>
+    double measure(Fun fun)
+    {
+        constexpr auto iterations = 100000u;
+        const auto start = std::chrono::steady_clock::now();
+        for (auto i = 0u; i < iterations; i++)
+        {
+            fun(i);
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+    }
+}
+
+TEST(Signal, benchmark_emit)
+{
+    for (auto slot_count : {1u, 8u, 64u})
+    {
+        auto sum = 0ull;
+
+        auto rsig_signal = rsig::signal<int, int>{};
+        auto ice_signal  = ice::Signal<int, int>{};
+        for (auto i = 0u; i < slot_count; i++)
+        {
+            rsig_signal.connect([&sum] (int x, int y) { sum += x + y; });
+            ice_signal.connect([&sum] (int x, int y) { sum += x + y; });
+        }
+
+        const auto rsig_time = measure([&] (unsigned int i) {
+            rsig_signal.emit(static_cast<int>(i), 1);
+        });
+        const auto ice_time = measure([&] (unsigned int i) {
+            ice_signal.emit(static_cast<int>(i), 1);
+        });
+
+        std::cout << slot_count << " slots: rsig " << rsig_time << " ns, ice " << ice_time << " ns per emit\n";
+        EXPECT_NE(0u, sum);
+    }
+}
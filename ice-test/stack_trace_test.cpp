@@ -0,0 +1,176 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/StackTrace.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    ICE_NOINLINE unsigned int capture_here(ice::RawStackTrace& trace)
+    {
+        trace = ice::RawStackTrace::capture(); const auto line = static_cast<unsigned int>(__LINE__);
+        return line;
+    }
+
+    ICE_NOINLINE unsigned int capture_outer(ice::RawStackTrace& trace, unsigned int& inner_line)
+    {
+        inner_line = capture_here(trace); const auto line = static_cast<unsigned int>(__LINE__);
+        return line;
+    }
+
+    ICE_NOINLINE size_t capture_skipping(ice::RawStackTrace& trace, size_t skip)
+    {
+        trace = ice::RawStackTrace::capture(skip);
+        return trace.size();
+    }
+
+    bool ends_with_file(const std::string& file, const std::string& name)
+    {
+        return file.size() > name.size() && file.ends_with(name) && (file[file.size() - name.size() - 1u] == '/' || file[file.size() - name.size() - 1u] == '\\');
+    }
+}
+
+TEST(StackTrace, capture_starts_at_caller)
+{
+    auto trace = ice::RawStackTrace{};
+    const auto line = capture_here(trace);
+    ASSERT_FALSE(trace.empty());
+
+    auto symbolizer = ice::Symbolizer{};
+    const auto frame = symbolizer.resolve(trace.get_addresses()[0]);
+    EXPECT_EQ(trace.get_addresses()[0], frame.address);
+    EXPECT_NE(std::string::npos, frame.name.find("capture_here"));
+    EXPECT_TRUE(ends_with_file(frame.file, "stack_trace_test.cpp")) << frame.file;
+    EXPECT_EQ(line, frame.line);
+}
+
+TEST(StackTrace, resolves_callers)
+{
+    auto trace      = ice::RawStackTrace{};
+    auto inner_line = 0u;
+    const auto outer_line = capture_outer(trace, inner_line);
+    ASSERT_LE(3u, trace.size());
+
+    auto symbolizer = ice::Symbolizer{};
+    const auto frames = symbolizer.resolve(trace);
+    ASSERT_EQ(trace.size(), frames.size());
+    EXPECT_NE(std::string::npos, frames[0].name.find("capture_here"));
+    EXPECT_EQ(inner_line, frames[0].line);
+    EXPECT_NE(std::string::npos, frames[1].name.find("capture_outer"));
+    EXPECT_EQ(outer_line, frames[1].line);
+    EXPECT_NE(std::string::npos, frames[2].name.find("TestBody"));
+    EXPECT_NE("Unknown Module", frames[2].module);
+}
+
+TEST(StackTrace, skip_frames)
+{
+    auto full    = ice::RawStackTrace{};
+    auto skipped = ice::RawStackTrace{};
+    capture_skipping(full, 0u);
+    capture_skipping(skipped, 1u);
+    ASSERT_LE(2u, full.size());
+    ASSERT_EQ(full.size() - 1u, skipped.size());
+
+    // the frames above the test body are the same
+    EXPECT_EQ(full.get_addresses()[full.size() - 1u], skipped.get_addresses()[skipped.size() - 1u]);
+
+    auto symbolizer = ice::Symbolizer{};
+    EXPECT_NE(std::string::npos, symbolizer.resolve(skipped.get_addresses()[0]).name.find("TestBody"));
+}
+
+TEST(StackTrace, capture_into_small_buffer)
+{
+    auto addresses = std::array<uintptr_t, 2u>{};
+    EXPECT_EQ(2u, ice::capture_stack(addresses));
+    EXPECT_NE(0u, addresses[0]);
+    EXPECT_NE(0u, addresses[1]);
+}
+
+TEST(StackTrace, caches_lookups)
+{
+    auto trace = ice::RawStackTrace{};
+    capture_here(trace);
+
+    auto symbolizer = ice::Symbolizer{};
+    const auto first  = symbolizer.resolve(trace);
+    const auto second = symbolizer.resolve(trace);
+
+    const auto stats = symbolizer.get_stats();
+    EXPECT_EQ(2u * trace.size(), stats.lookups);
+    EXPECT_EQ(trace.size(), stats.hits);
+    EXPECT_LE(1u, stats.modules);
+    ASSERT_EQ(first.size(), second.size());
+    for (auto i = 0u; i < first.size(); i++)
+    {
+        EXPECT_EQ(first[i].name, second[i].name);
+        EXPECT_EQ(first[i].line, second[i].line);
+    }
+
+    symbolizer.clear();
+    EXPECT_EQ(0u, symbolizer.get_stats().lookups);
+}
+
+TEST(StackTrace, get_stack_trace)
+{
+    const auto frames = ice::get_stack_trace();
+    ASSERT_FALSE(frames.empty());
+    EXPECT_NE(std::string::npos, frames[0].name.find("TestBody"));
+}
+
+TEST(StackTrace, benchmark_capture)
+{
+    const auto count = 10000u;
+    const auto to_ns = [] (auto d, auto n) { return std::chrono::duration<double, std::nano>(d).count() / n; };
+
+    auto trace = ice::RawStackTrace{};
+    const auto capture_start = std::chrono::steady_clock::now();
+    for (auto i = 0u; i < count; i++)
+    {
+        capture_here(trace);
+    }
+    const auto capture_time = to_ns(std::chrono::steady_clock::now() - capture_start, count);
+
+    auto symbolizer = ice::Symbolizer{};
+    const auto cold_start = std::chrono::steady_clock::now();
+    const auto frames = symbolizer.resolve(trace);
+    const auto cold_time = to_ns(std::chrono::steady_clock::now() - cold_start, 1u);
+
+    const auto warm_start = std::chrono::steady_clock::now();
+    for (auto i = 0u; i < count; i++)
+    {
+        static_cast<void>(symbolizer.resolve(trace));
+    }
+    const auto warm_time = to_ns(std::chrono::steady_clock::now() - warm_start, count);
+
+    std::cout << "capture:          " << capture_time << " ns (" << trace.size() << " frames)" << std::endl;
+    std::cout << "symbolize cold:   " << cold_time << " ns" << std::endl;
+    std::cout << "symbolize cached: " << warm_time << " ns" << std::endl;
+
+    // capturing must be cheap enough for every allocation, resolving is paid once
+    EXPECT_LT(capture_time, cold_time);
+    EXPECT_LT(warm_time, cold_time);
+    EXPECT_EQ(trace.size(), frames.size());
+}
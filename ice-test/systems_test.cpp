@@ -0,0 +1,193 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/SystemScheduler.h>
+
+#include <mutex>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    struct Position
+    {
+        float x = 0.0f;
+    };
+
+    struct Velocity
+    {
+        float x = 0.0f;
+    };
+
+    struct Health
+    {
+        int value = 100;
+    };
+}
+
+TEST(SystemScheduler, orders_conflicting_systems)
+{
+    auto world     = ice::World{};
+    auto scheduler = ice::SystemScheduler{};
+
+    scheduler.add("velocity", {{}, world.get_mask<Velocity>()}, [] (ice::World&, float) {});
+    scheduler.add("movement", {world.get_mask<Velocity>(), world.get_mask<Position>()}, [] (ice::World&, float) {});
+    scheduler.add("health",   {{}, world.get_mask<Health>()}, [] (ice::World&, float) {});
+    scheduler.add("render",   {world.get_mask<Position, Health>(), {}}, [] (ice::World&, float) {});
+    scheduler.add("culling",  {world.get_mask<Position>(), {}}, [] (ice::World&, float) {});
+
+    EXPECT_EQ(std::vector<size_t>{}, scheduler.get_dependencies(0u));
+    EXPECT_EQ(std::vector<size_t>{0u}, scheduler.get_dependencies(1u));
+    EXPECT_EQ(std::vector<size_t>{}, scheduler.get_dependencies(2u));
+    EXPECT_EQ((std::vector<size_t>{1u, 2u}), scheduler.get_dependencies(3u));
+    EXPECT_EQ(std::vector<size_t>{1u}, scheduler.get_dependencies(4u));
+}
+
+TEST(SystemScheduler, runs_systems)
+{
+    auto jobs      = ice::JobSystem{4u};
+    auto world     = ice::World{};
+    auto scheduler = ice::SystemScheduler{};
+
+    for (auto i = 0u; i < 1000u; i++)
+    {
+        auto e = world.create();
+        world.add<Position>(e);
+        world.add<Velocity>(e);
+        world.add<Health>(e);
+    }
+
+    auto mutex = std::mutex{};
+    auto order = std::string{};
+    auto log = [&] (char c) {
+        auto lock = std::unique_lock{mutex};
+        order += c;
+    };
+
+    auto accelerate = world.query<Velocity>();
+    scheduler.add("accelerate", {{}, world.get_mask<Velocity>()}, [&] (ice::World&, float dt) {
+        accelerate.each([&] (Velocity& v) {
+            v.x += dt;
+        });
+        log('a');
+    });
+
+    auto move = world.query<const Velocity, Position>();
+    scheduler.add("move", {world.get_mask<Velocity>(), world.get_mask<Position>()}, [&] (ice::World&, float dt) {
+        move.each([&] (const Velocity& v, Position& p) {
+            p.x += v.x * dt;
+        });
+        log('m');
+    });
+
+    auto heal = world.query<Health>();
+    scheduler.add("heal", {{}, world.get_mask<Health>()}, [&] (ice::World&, float) {
+        heal.each([&] (Health& h) {
+            h.value++;
+        });
+        log('h');
+    });
+
+    for (auto i = 0u; i < 10u; i++)
+    {
+        scheduler.run(jobs, world, 1.0f);
+    }
+
+    EXPECT_EQ(30u, order.size());
+    for (auto i = 0u; i < order.size(); i += 3u)
+    {
+        const auto frame = order.substr(i, 3u);
+        EXPECT_LT(frame.find('a'), frame.find('m'));
+    }
+
+    world.query<const Position, const Velocity, const Health>().each([] (const Position& p, const Velocity& v, const Health& h) {
+        EXPECT_FLOAT_EQ(10.0f, v.x);
+        EXPECT_FLOAT_EQ(55.0f, p.x);
+        EXPECT_EQ(110, h.value);
+    });
+}
+
+TEST(SystemScheduler, fails_on_unregistered_component)
+{
+    auto jobs      = ice::JobSystem{0u};
+    auto world     = ice::World{};
+    auto scheduler = ice::SystemScheduler{};
+
+    auto e = world.create();
+
+    scheduler.add("lookup", {world.get_mask<Position>(), {}}, [e] (ice::World& w, float) {
+        [[maybe_unused]] auto h = w.has<Health>(e);
+    });
+
+    EXPECT_DEATH(scheduler.run(jobs, world, 1.0f), "");
+}
+
+#ifndef NDEBUG
+TEST(SystemScheduler, fails_on_undeclared_access)
+{
+    auto jobs      = ice::JobSystem{0u};
+    auto world     = ice::World{};
+    auto scheduler = ice::SystemScheduler{};
+
+    auto e = world.create();
+    world.add<Position>(e);
+
+    scheduler.add("sneaky", {world.get_mask<Position>(), {}}, [e] (ice::World& w, float) {
+        w.get<Position>(e)->x = 1.0f;
+    });
+
+    EXPECT_DEATH(scheduler.run(jobs, world, 1.0f), "");
+}
+
+TEST(SystemScheduler, fails_on_undeclared_access_in_spawned_job)
+{
+    auto jobs      = ice::JobSystem{2u};
+    auto world     = ice::World{};
+    auto scheduler = ice::SystemScheduler{};
+
+    auto e = world.create();
+    world.add<Position>(e);
+
+    scheduler.add("spawner", {world.get_mask<Position>(), {}}, [&jobs, e] (ice::World& w, float) {
+        auto counter = ice::JobCounter{};
+        jobs.schedule(counter, [&w, e] () {
+            w.get<Position>(e)->x = 1.0f;
+        });
+        jobs.wait(counter);
+    });
+
+    EXPECT_DEATH(scheduler.run(jobs, world, 1.0f), "");
+}
+
+TEST(SystemScheduler, fails_on_structural_change)
+{
+    auto jobs      = ice::JobSystem{0u};
+    auto world     = ice::World{};
+    auto scheduler = ice::SystemScheduler{};
+
+    scheduler.add("spawner", {}, [] (ice::World& w, float) {
+        [[maybe_unused]] auto e = w.create();
+    });
+
+    EXPECT_DEATH(scheduler.run(jobs, world, 1.0f), "");
+}
+#endif
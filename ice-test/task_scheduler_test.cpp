@@ -0,0 +1,165 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/TaskScheduler.h>
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    struct ManualClock
+    {
+        std::chrono::steady_clock::time_point now = {};
+
+        ice::Clock get() noexcept
+        {
+            return [this] () { return now; };
+        }
+    };
+}
+
+TEST(TaskScheduler, runs_within_budget)
+{
+    auto clock     = ManualClock{};
+    auto scheduler = ice::TaskScheduler{4ms, clock.get()};
+
+    auto count = 0u;
+    for (auto i = 0u; i < 10u; i++)
+    {
+        scheduler.enqueue(ice::TaskPriority::NORMAL, [&] () {
+            clock.now += 1ms;
+            count++;
+            return true;
+        });
+    }
+
+    scheduler.run();
+    EXPECT_EQ(4u, count);
+    EXPECT_EQ(6u, scheduler.get_pending());
+
+    const auto& stats = scheduler.get_stats();
+    EXPECT_EQ(4ms, stats.budget);
+    EXPECT_EQ(4ms, stats.used);
+    EXPECT_EQ(4u, stats.slices);
+    EXPECT_EQ(4u, stats.finished);
+    EXPECT_EQ(6u, stats.pending);
+    EXPECT_EQ(1u, stats.max_wait);
+}
+
+TEST(TaskScheduler, runs_at_least_one_slice)
+{
+    auto clock     = ManualClock{};
+    auto scheduler = ice::TaskScheduler{1ms, clock.get()};
+
+    auto count = 0u;
+    for (auto i = 0u; i < 2u; i++)
+    {
+        scheduler.enqueue(ice::TaskPriority::NORMAL, [&] () {
+            clock.now += 10ms;
+            count++;
+            return true;
+        });
+    }
+
+    scheduler.run();
+    EXPECT_EQ(1u, count);
+    EXPECT_EQ(10ms, scheduler.get_stats().used);
+}
+
+TEST(TaskScheduler, resumes_tasks)
+{
+    auto clock     = ManualClock{};
+    auto scheduler = ice::TaskScheduler{2ms, clock.get()};
+
+    auto steps = 0u;
+    scheduler.enqueue(ice::TaskPriority::NORMAL, [&] () {
+        clock.now += 1ms;
+        steps++;
+        return steps == 5u;
+    });
+
+    scheduler.run();
+    EXPECT_EQ(2u, steps);
+    EXPECT_EQ(1u, scheduler.get_pending());
+    scheduler.run();
+    scheduler.run();
+    EXPECT_EQ(5u, steps);
+    EXPECT_EQ(0u, scheduler.get_pending());
+    EXPECT_EQ(1u, scheduler.get_stats().finished);
+}
+
+TEST(TaskScheduler, honors_priority)
+{
+    auto clock     = ManualClock{};
+    auto scheduler = ice::TaskScheduler{1ms, clock.get()};
+
+    auto order = std::string{};
+    auto make_task = [&] (char id) {
+        return [&, id] () {
+            clock.now += 1ms;
+            order += id;
+            return true;
+        };
+    };
+
+    scheduler.enqueue(ice::TaskPriority::LOW,    make_task('l'));
+    scheduler.enqueue(ice::TaskPriority::NORMAL, make_task('n'));
+    scheduler.enqueue(ice::TaskPriority::HIGH,   make_task('h'));
+
+    scheduler.run();
+    scheduler.run();
+    scheduler.run();
+    EXPECT_EQ("hnl", order);
+}
+
+TEST(TaskScheduler, prevents_starvation)
+{
+    auto clock     = ManualClock{};
+    auto scheduler = ice::TaskScheduler{1ms, clock.get()};
+    scheduler.set_max_age(3u);
+
+    auto low_ran = false;
+    scheduler.enqueue(ice::TaskPriority::LOW, [&] () {
+        clock.now += 1ms;
+        low_ran = true;
+        return true;
+    });
+
+    // a high priority task that never finishes
+    scheduler.enqueue(ice::TaskPriority::HIGH, [&] () {
+        clock.now += 1ms;
+        return false;
+    });
+
+    for (auto i = 0u; i < 3u; i++)
+    {
+        scheduler.run();
+        EXPECT_FALSE(low_ran);
+    }
+    EXPECT_EQ(3u, scheduler.get_stats().max_wait);
+
+    scheduler.run();
+    EXPECT_TRUE(low_ran);
+}
@@ -0,0 +1,119 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/FixedTimestep.h>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    struct ManualClock
+    {
+        std::chrono::steady_clock::time_point now = {};
+
+        ice::Clock get() noexcept
+        {
+            return [this] () { return now; };
+        }
+    };
+}
+
+TEST(FixedTimestep, no_step_before_rate)
+{
+    auto clock    = ManualClock{};
+    auto timestep = ice::FixedTimestep{100u, clock.get()};
+
+    clock.now += 5ms;
+    EXPECT_EQ(0u, timestep.advance());
+    EXPECT_NEAR(0.5f, timestep.get_alpha(), 0.001f);
+}
+
+TEST(FixedTimestep, steps_at_rate)
+{
+    auto clock    = ManualClock{};
+    auto timestep = ice::FixedTimestep{100u, clock.get()};
+
+    EXPECT_EQ(10ms, timestep.get_step());
+    EXPECT_FLOAT_EQ(0.01f, timestep.get_step_seconds());
+
+    clock.now += 10ms;
+    EXPECT_EQ(1u, timestep.advance());
+    EXPECT_NEAR(0.0f, timestep.get_alpha(), 0.001f);
+
+    clock.now += 25ms;
+    EXPECT_EQ(2u, timestep.advance());
+    EXPECT_NEAR(0.5f, timestep.get_alpha(), 0.001f);
+
+    clock.now += 5ms;
+    EXPECT_EQ(1u, timestep.advance());
+    EXPECT_NEAR(0.0f, timestep.get_alpha(), 0.001f);
+}
+
+TEST(FixedTimestep, caps_catch_up)
+{
+    auto clock    = ManualClock{};
+    auto timestep = ice::FixedTimestep{100u, clock.get()};
+    timestep.set_max_steps(4u);
+
+    clock.now += 1005ms;
+    EXPECT_EQ(4u, timestep.advance());
+    EXPECT_NEAR(0.5f, timestep.get_alpha(), 0.001f);
+    EXPECT_EQ(960ms, timestep.get_dropped());
+
+    clock.now += 5ms;
+    EXPECT_EQ(1u, timestep.advance());
+}
+
+TEST(FixedTimestep, variable)
+{
+    auto clock    = ManualClock{};
+    auto timestep = ice::FixedTimestep{0u, clock.get()};
+
+    clock.now += 7ms;
+    EXPECT_EQ(1u, timestep.advance());
+    EXPECT_EQ(7ms, timestep.get_step());
+    EXPECT_FLOAT_EQ(1.0f, timestep.get_alpha());
+
+    clock.now += 100ms;
+    EXPECT_EQ(1u, timestep.advance());
+    EXPECT_EQ(100ms, timestep.get_step());
+}
+
+TEST(FixedTimestep, reset_discards_time)
+{
+    auto clock    = ManualClock{};
+    auto timestep = ice::FixedTimestep{100u, clock.get()};
+
+    clock.now += 500ms;
+    timestep.reset();
+    EXPECT_EQ(0ms, timestep.get_elapsed());
+    clock.now += 10ms;
+    EXPECT_EQ(1u, timestep.advance());
+    EXPECT_EQ(10ms, timestep.get_elapsed());
+}
+
+TEST(FixedTimestep, fails_on_rate_beyond_clock)
+{
+    auto timestep = ice::FixedTimestep{100u};
+    EXPECT_DEATH(timestep.set_rate(2000000000u), "");
+}
@@ -0,0 +1,275 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/World.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    struct Position
+    {
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+    };
+
+    struct Velocity
+    {
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+    };
+
+    struct Name
+    {
+        std::string value;
+    };
+
+    struct Health
+    {
+        int value = 100;
+    };
+}
+
+TEST(World, create_and_destroy)
+{
+    auto world = ice::World{};
+
+    auto a = world.create();
+    auto b = world.create();
+    EXPECT_TRUE(world.is_alive(a));
+    EXPECT_TRUE(world.is_alive(b));
+    EXPECT_EQ(2u, world.get_entity_count());
+
+    world.destroy(a);
+    EXPECT_FALSE(world.is_alive(a));
+    EXPECT_TRUE(world.is_alive(b));
+    EXPECT_EQ(1u, world.get_entity_count());
+
+    auto c = world.create();
+    EXPECT_EQ(a.index, c.index);
+    EXPECT_NE(a.generation, c.generation);
+    EXPECT_FALSE(world.is_alive(a));
+}
+
+TEST(World, add_get_remove)
+{
+    auto world = ice::World{};
+
+    auto e = world.create();
+    world.add<Position>(e, 1.0f, 2.0f, 3.0f);
+    world.add<Name>(e, "bob");
+
+    ASSERT_TRUE(world.has<Position>(e));
+    ASSERT_TRUE(world.has<Name>(e));
+    EXPECT_FALSE(world.has<Velocity>(e));
+    EXPECT_EQ(nullptr, world.get<Velocity>(e));
+    EXPECT_EQ(2.0f, world.get<Position>(e)->y);
+    EXPECT_EQ("bob", world.get<Name>(e)->value);
+
+    world.remove<Position>(e);
+    EXPECT_FALSE(world.has<Position>(e));
+    EXPECT_EQ("bob", world.get<Name>(e)->value);
+
+    world.add<Name>(e, "alice");
+    EXPECT_EQ("alice", world.get<Name>(e)->value);
+}
+
+TEST(World, transitions_are_cached)
+{
+    auto world = ice::World{};
+
+    for (auto i = 0u; i < 100u; i++)
+    {
+        auto e = world.create();
+        world.add<Position>(e);
+        world.add<Velocity>(e);
+        world.remove<Position>(e);
+    }
+
+    // empty, P, PV, V
+    EXPECT_EQ(4u, world.get_archetype_count());
+}
+
+TEST(World, keeps_components_on_swap_remove)
+{
+    auto world = ice::World{};
+
+    auto entities = std::vector<ice::Entity>{};
+    for (auto i = 0u; i < 5000u; i++)
+    {
+        auto e = world.create();
+        world.add<Health>(e, static_cast<int>(i));
+        world.add<Name>(e, std::to_string(i));
+        entities.push_back(e);
+    }
+
+    for (auto i = 0u; i < 5000u; i += 3u)
+    {
+        world.destroy(entities[i]);
+    }
+    for (auto i = 1u; i < 5000u; i += 3u)
+    {
+        world.remove<Health>(entities[i]);
+    }
+
+    for (auto i = 0u; i < 5000u; i++)
+    {
+        if (i % 3u == 0u)
+        {
+            EXPECT_FALSE(world.is_alive(entities[i]));
+            continue;
+        }
+
+        EXPECT_EQ(std::to_string(i), world.get<Name>(entities[i])->value);
+        if (i % 3u == 2u)
+        {
+            EXPECT_EQ(static_cast<int>(i), world.get<Health>(entities[i])->value);
+        }
+        else
+        {
+            EXPECT_FALSE(world.has<Health>(entities[i]));
+        }
+    }
+}
+
+TEST(World, chunks_are_16k)
+{
+    auto world = ice::World{};
+
+    for (auto i = 0u; i < 10000u; i++)
+    {
+        auto e = world.create();
+        world.add<Position>(e);
+    }
+
+    const auto& archetype = world.get_archetype(1u);
+    EXPECT_EQ(ice::CHUNK_SIZE / (sizeof(ice::Entity) + sizeof(Position)), archetype.get_capacity());
+    EXPECT_EQ(10000u, archetype.get_size());
+    EXPECT_EQ((10000u + archetype.get_capacity() - 1u) / archetype.get_capacity(), archetype.get_chunk_count());
+}
+
+TEST(World, query)
+{
+    auto world = ice::World{};
+
+    for (auto i = 0u; i < 100u; i++)
+    {
+        auto e = world.create();
+        world.add<Position>(e);
+        if (i % 2u == 0u)
+        {
+            world.add<Velocity>(e, 1.0f, 0.0f, 0.0f);
+        }
+    }
+
+    auto query = world.query<Position, Velocity>();
+    EXPECT_EQ(50u, query.count());
+
+    query.each([] (Position& p, Velocity& v) {
+        p.x += v.x;
+    });
+
+    auto moved = 0u;
+    world.query<Position>().each([&] (Position& p) {
+        if (p.x == 1.0f)
+        {
+            moved++;
+        }
+    });
+    EXPECT_EQ(50u, moved);
+
+    // new archetypes are picked up by the cached query
+    auto e = world.create();
+    world.add<Velocity>(e);
+    world.add<Health>(e);
+    world.add<Position>(e);
+    EXPECT_EQ(51u, query.count());
+}
+
+TEST(World, benchmark_iteration)
+{
+    constexpr auto entity_count = 1000000u;
+    constexpr auto dt           = 0.016f;
+
+    // Array of structs baseline, with some cold data that a typical game
+    // object drags along.
+    struct GameObject
+    {
+        Position position;
+        Velocity velocity;
+        Health   health;
+        char     cold[64];
+    };
+
+    auto objects = std::vector<GameObject>(entity_count);
+    for (auto& o : objects)
+    {
+        o.velocity = {1.0f, 2.0f, 3.0f};
+    }
+
+    auto world = ice::World{};
+    for (auto i = 0u; i < entity_count; i++)
+    {
+        auto e = world.create();
+        world.add<Position>(e);
+        world.add<Velocity>(e, 1.0f, 2.0f, 3.0f);
+        world.add<Health>(e);
+    }
+    auto query = world.query<Position, Velocity>();
+
+    constexpr auto iterations = 10u;
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto n = 0u; n < iterations; n++)
+    {
+        for (auto& o : objects)
+        {
+            o.position.x += o.velocity.x * dt;
+            o.position.y += o.velocity.y * dt;
+            o.position.z += o.velocity.z * dt;
+        }
+    }
+    const auto aos = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+    start = std::chrono::steady_clock::now();
+    for (auto n = 0u; n < iterations; n++)
+    {
+        query.each_chunk([] (size_t count, const ice::Entity*, Position* p, Velocity* v) {
+            for (auto i = size_t{0u}; i < count; i++)
+            {
+                p[i].x += v[i].x * dt;
+                p[i].y += v[i].y * dt;
+                p[i].z += v[i].z * dt;
+            }
+        });
+    }
+    const auto ecs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+    std::cout << "1M entities: array of structs " << aos << " ms, ecs " << ecs << " ms\n";
+
+    EXPECT_FLOAT_EQ(objects.back().position.x, world.get<Position>(ice::Entity{entity_count - 1u, 1u})->x);
+}
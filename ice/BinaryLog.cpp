@@ -0,0 +1,655 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "BinaryLog.h"
+
+#include <bit>
+#include <chrono>
+#include <format>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <unordered_map>
+#include <variant>
+
+#include "ByteRing.h"
+#include "Log.h"
+
+namespace ice
+{
+    constexpr char     BINARY_LOG_MAGIC[8]  = {'I', 'C', 'E', 'B', 'L', 'O', 'G', '\0'};
+    constexpr uint32_t BINARY_LOG_VERSION   = 1u;
+    constexpr char     BINARY_LOG_FORMAT    = 'F';
+    constexpr char     BINARY_LOG_RECORD    = 'R';
+
+    //! Header of a record in a ring, the arguments follow directly.
+    struct BinaryRecord
+    {
+        uint32_t id;
+        uint32_t padding;
+        int64_t  time;
+    };
+
+    //! The records of one thread.
+    struct BinaryLogRing
+    {
+        ByteRing            buffer;
+        uint32_t            thread  = 0u;
+        std::atomic<bool>   closed  = false;
+        std::atomic<size_t> dropped = 0u;
+
+        BinaryLogRing(size_t capacity)
+        : buffer(capacity)
+        {}
+    };
+
+    namespace
+    {
+        //! Marks the ring as closed when the thread exits.
+        struct BinaryLogRingHandle
+        {
+            std::shared_ptr<BinaryLogRing> ring;
+
+            ~BinaryLogRingHandle()
+            {
+                if (ring)
+                {
+                    ring->closed = true;
+                }
+            }
+        };
+
+        thread_local BinaryLogRingHandle thread_ring;
+        std::atomic<uint32_t>            next_thread = 0u;
+
+        template <typename T>
+        void write_value(std::ostream& output, const T& value)
+        {
+            output.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        void write_string(std::ostream& output, const std::string_view value)
+        {
+            write_value(output, static_cast<uint32_t>(value.size()));
+            output.write(value.data(), static_cast<std::streamsize>(value.size()));
+        }
+
+        template <typename T>
+        bool read_value(std::istream& input, T& value)
+        {
+            return static_cast<bool>(input.read(reinterpret_cast<char*>(&value), sizeof(T)));
+        }
+
+        bool read_string(std::istream& input, std::string& value)
+        {
+            auto length = uint32_t{0u};
+            if (!read_value(input, length))
+            {
+                return false;
+            }
+            value.resize(length);
+            return static_cast<bool>(input.read(value.data(), length));
+        }
+    }
+
+    BinaryLog& BinaryLog::get() noexcept
+    {
+        static auto log = BinaryLog{};
+        return log;
+    }
+
+    BinaryLog::BinaryLog()
+    : wakeup(std::make_unique<LogWakeup>()), process(get_process_id())
+    {
+        thread = std::thread([this] () {
+            run();
+        });
+    }
+
+    BinaryLog::~BinaryLog()
+    {
+        if (is_forked())
+        {
+            // the writer thread was not copied into the child and the file is the parent's
+            thread.detach();
+            static_cast<void>(wakeup.release());
+            return;
+        }
+
+        {
+            auto lock = std::unique_lock<std::mutex>{wakeup->mutex};
+            wakeup->running = false;
+        }
+        wakeup->cond.notify_all();
+        thread.join();
+        close();
+    }
+
+    bool BinaryLog::is_forked() const noexcept
+    {
+        return get_process_id() != process;
+    }
+
+    void BinaryLog::open(const std::filesystem::path& file)
+    {
+        close();
+
+        auto lock = std::unique_lock<std::mutex>{drain_mutex};
+        output.clear();
+        output.open(file, std::ios::binary | std::ios::trunc);
+        if (!output)
+        {
+            throw std::runtime_error(std::format("Failed to open binary log {}.", file.string()));
+        }
+        output.write(BINARY_LOG_MAGIC, sizeof(BINARY_LOG_MAGIC));
+        write_value(output, BINARY_LOG_VERSION);
+        formats_written = 0u;
+        opened = true;
+    }
+
+    void BinaryLog::close() noexcept
+    {
+        opened = false;
+        drain();
+
+        auto lock = std::unique_lock<std::mutex>{drain_mutex};
+        if (output.is_open())
+        {
+            output.close();
+        }
+    }
+
+    void BinaryLog::set_buffer_size(size_t value) noexcept
+    {
+        buffer_size = value;
+    }
+
+    size_t BinaryLog::get_buffer_size() const noexcept
+    {
+        return buffer_size;
+    }
+
+    uint32_t BinaryLog::register_format(const char* format, const char* types, const LogCategory& category, LogLevel level, const std::source_location& location) noexcept
+    {
+        try
+        {
+            auto lock = std::unique_lock<std::mutex>{mutex};
+            formats.push_back({format, types, category.name, level, location});
+            return static_cast<uint32_t>(formats.size() - 1u);
+        }
+        catch (...)
+        {
+            return INVALID_ID;
+        }
+    }
+
+    std::byte* BinaryLog::reserve(uint32_t id, size_t size) noexcept
+    {
+        auto ring = get_ring();
+        if (ring == nullptr)
+        {
+            return nullptr;
+        }
+
+        const auto need = sizeof(BinaryRecord) + size;
+        auto dst = need <= ring->buffer.get_max_record() ? ring->buffer.reserve(need) : nullptr;
+        if (dst == nullptr)
+        {
+            ring->dropped.fetch_add(1u, std::memory_order_relaxed);
+            wake();
+            return nullptr;
+        }
+
+        auto record = BinaryRecord{};
+        record.id   = id;
+        record.time = std::chrono::system_clock::now().time_since_epoch().count();
+        std::memcpy(dst, &record, sizeof(BinaryRecord));
+        return dst + sizeof(BinaryRecord);
+    }
+
+    void BinaryLog::commit() noexcept
+    {
+        thread_ring.ring->buffer.commit();
+    }
+
+    void BinaryLog::flush() noexcept
+    {
+        drain();
+    }
+
+    BinaryLogStats BinaryLog::get_stats() const noexcept
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+
+        auto result = BinaryLogStats{};
+        result.written = written;
+        result.dropped = dropped;
+        result.formats = formats.size();
+        for (const auto& ring : rings)
+        {
+            result.dropped += ring->dropped.load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    BinaryLogRing* BinaryLog::get_ring() noexcept
+    {
+        if (thread_ring.ring)
+        {
+            return thread_ring.ring.get();
+        }
+
+        try
+        {
+            auto ring = std::make_shared<BinaryLogRing>(std::max(buffer_size.load(), size_t{1024u}));
+            ring->thread = next_thread++;
+
+            auto lock = std::unique_lock<std::mutex>{mutex};
+            rings.push_back(ring);
+            thread_ring.ring = ring;
+            return ring.get();
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+
+    void BinaryLog::write_formats(size_t count)
+    {
+        auto pending = std::vector<Format>{};
+        {
+            auto lock = std::unique_lock<std::mutex>{mutex};
+            pending.assign(formats.begin() + static_cast<ptrdiff_t>(formats_written), formats.begin() + static_cast<ptrdiff_t>(count));
+        }
+
+        for (const auto& format : pending)
+        {
+            output.put(BINARY_LOG_FORMAT);
+            write_value(output, static_cast<uint32_t>(formats_written));
+            write_value(output, static_cast<uint32_t>(format.location.line()));
+            write_value(output, static_cast<uint8_t>(format.level));
+            write_string(output, format.category != nullptr ? format.category : "");
+            write_string(output, format.location.file_name());
+            write_string(output, format.location.function_name());
+            write_string(output, format.format);
+            write_string(output, format.types);
+            formats_written++;
+        }
+    }
+
+    void BinaryLog::wake() noexcept
+    {
+        if (!wake_requested.exchange(true, std::memory_order_relaxed))
+        {
+            wakeup->cond.notify_one();
+        }
+    }
+
+    void BinaryLog::drain() noexcept
+    {
+        auto lock = std::unique_lock<std::mutex>{drain_mutex};
+
+        auto current = std::vector<std::shared_ptr<BinaryLogRing>>{};
+        {
+            auto rings_lock = std::unique_lock<std::mutex>{mutex};
+            current = rings;
+        }
+
+        auto count = size_t{0u};
+        try
+        {
+            for (auto& ring : current)
+            {
+                // only drain what is there now, a busy thread could keep us here
+                auto pending = ring->buffer.get_capacity();
+                auto data    = ring->buffer.peek();
+                while (!data.empty() && pending >= data.size())
+                {
+                    pending -= data.size();
+
+                    auto record = BinaryRecord{};
+                    std::memcpy(&record, data.data(), sizeof(BinaryRecord));
+
+                    // records of a closed file are discarded
+                    if (output.is_open())
+                    {
+                        // the format is registered before the first record that uses it
+                        if (record.id >= formats_written)
+                        {
+                            write_formats(record.id + 1u);
+                        }
+
+                        const auto time = std::chrono::system_clock::duration{record.time};
+                        const auto size = data.size() - sizeof(BinaryRecord);
+                        output.put(BINARY_LOG_RECORD);
+                        write_value(output, record.id);
+                        write_value(output, ring->thread);
+                        write_value(output, static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time).count()));
+                        write_value(output, static_cast<uint32_t>(size));
+                        output.write(reinterpret_cast<const char*>(data.data() + sizeof(BinaryRecord)), static_cast<std::streamsize>(size));
+                        count++;
+                    }
+
+                    ring->buffer.pop();
+                    data = ring->buffer.peek();
+                }
+            }
+
+            if (output.is_open())
+            {
+                output.flush();
+            }
+        }
+        catch (...) {}
+        written += count;
+
+        // forget the rings of threads that are gone
+        auto rings_lock = std::unique_lock<std::mutex>{mutex};
+        std::erase_if(rings, [this] (const auto& ring) {
+            if (ring->closed && ring->buffer.is_empty())
+            {
+                dropped += ring->dropped.load(std::memory_order_relaxed);
+                return true;
+            }
+            return false;
+        });
+    }
+
+    void BinaryLog::run() noexcept
+    {
+        while (true)
+        {
+            {
+                auto lock = std::unique_lock<std::mutex>{wakeup->mutex};
+                wakeup->cond.wait_for(lock, std::chrono::milliseconds(10), [this] () {
+                    return !wakeup->running || wake_requested.load(std::memory_order_relaxed);
+                });
+                if (!wakeup->running)
+                {
+                    return;
+                }
+            }
+            wake_requested.store(false, std::memory_order_relaxed);
+            drain();
+        }
+    }
+
+    //! A format read from a binary log.
+    struct DecodedFormat
+    {
+        uint32_t    line  = 0u;
+        LogLevel    level = LogLevel::INFO;
+        std::string category;
+        std::string file;
+        std::string function;
+        std::string format;
+        std::string types;
+    };
+
+    using BinaryValue = std::variant<int64_t, uint64_t, double, bool, char, const void*, std::string_view>;
+
+    //! Read the arguments of a record.
+    //!
+    //! @returns nothing if the payload doesn't match the types
+    std::optional<std::vector<BinaryValue>> read_arguments(const std::string_view types, std::string_view payload)
+    {
+        auto values = std::vector<BinaryValue>{};
+        auto take = [&payload] (size_t size) -> std::optional<std::string_view> {
+            if (payload.size() < size)
+            {
+                return std::nullopt;
+            }
+            auto result = payload.substr(0u, size);
+            payload.remove_prefix(size);
+            return result;
+        };
+
+        for (const auto type : types)
+        {
+            switch (static_cast<BinaryType>(type))
+            {
+                case BinaryType::BOOL:
+                case BinaryType::CHAR:
+                {
+                    auto bytes = take(1u);
+                    if (!bytes)
+                    {
+                        return std::nullopt;
+                    }
+                    if (static_cast<BinaryType>(type) == BinaryType::BOOL)
+                    {
+                        values.emplace_back((*bytes)[0] != 0);
+                    }
+                    else
+                    {
+                        values.emplace_back((*bytes)[0]);
+                    }
+                    break;
+                }
+                case BinaryType::INT:
+                case BinaryType::UINT:
+                case BinaryType::FLOAT:
+                case BinaryType::POINTER:
+                {
+                    auto bytes = take(8u);
+                    if (!bytes)
+                    {
+                        return std::nullopt;
+                    }
+                    auto value = uint64_t{0u};
+                    std::memcpy(&value, bytes->data(), 8u);
+                    switch (static_cast<BinaryType>(type))
+                    {
+                        case BinaryType::INT:
+                            values.emplace_back(static_cast<int64_t>(value));
+                            break;
+                        case BinaryType::UINT:
+                            values.emplace_back(value);
+                            break;
+                        case BinaryType::FLOAT:
+                            values.emplace_back(std::bit_cast<double>(value));
+                            break;
+                        default:
+                            values.emplace_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(value)));
+                            break;
+                    }
+                    break;
+                }
+                case BinaryType::STRING:
+                {
+                    auto bytes = take(sizeof(uint32_t));
+                    if (!bytes)
+                    {
+                        return std::nullopt;
+                    }
+                    auto length = uint32_t{0u};
+                    std::memcpy(&length, bytes->data(), sizeof(length));
+                    auto text = take(length);
+                    if (!text)
+                    {
+                        return std::nullopt;
+                    }
+                    values.emplace_back(*text);
+                    break;
+                }
+                default:
+                    return std::nullopt;
+            }
+        }
+        return values;
+    }
+
+    //! Format one argument with the spec of its placeholder.
+    std::string format_argument(const std::string_view spec, const BinaryValue& value)
+    {
+        const auto field = "{" + std::string{spec} + "}";
+        try
+        {
+            return std::visit([&field] (const auto& v) {
+                return std::vformat(field, std::make_format_args(v));
+            }, value);
+        }
+        catch (const std::format_error&)
+        {
+            return field;
+        }
+    }
+
+    //! Substitute the arguments into a format string.
+    //!
+    //! This supports the std::format syntax with automatic and manual indexing.
+    std::string format_record(const std::string_view format, const std::vector<BinaryValue>& values)
+    {
+        auto result = std::string{};
+        auto next   = size_t{0u};
+        auto i      = size_t{0u};
+        while (i < format.size())
+        {
+            const auto c = format[i];
+            if ((c == '{' || c == '}') && i + 1u < format.size() && format[i + 1u] == c)
+            {
+                result += c;
+                i += 2u;
+                continue;
+            }
+            if (c != '{')
+            {
+                result += c;
+                i++;
+                continue;
+            }
+
+            const auto end = format.find('}', i);
+            if (end == std::string_view::npos)
+            {
+                result += format.substr(i);
+                break;
+            }
+
+            // split "{index:spec}" into the index and ":spec"
+            auto field = format.substr(i + 1u, end - i - 1u);
+            auto colon = field.find(':');
+            auto index = field.substr(0u, colon);
+            auto spec  = colon == std::string_view::npos ? std::string_view{} : field.substr(colon);
+
+            auto argument = next++;
+            if (!index.empty())
+            {
+                argument = 0u;
+                for (const auto digit : index)
+                {
+                    argument = argument * 10u + static_cast<size_t>(digit - '0');
+                }
+            }
+
+            if (argument < values.size())
+            {
+                result += format_argument(spec, values[argument]);
+            }
+            else
+            {
+                result += format.substr(i, end - i + 1u);
+            }
+            i = end + 1u;
+        }
+        return result;
+    }
+
+    size_t decode_binary_log(std::istream& input, std::ostream& output)
+    {
+        char magic[sizeof(BINARY_LOG_MAGIC)] = {};
+        auto version = uint32_t{0u};
+        if (!input.read(magic, sizeof(magic)) || std::memcmp(magic, BINARY_LOG_MAGIC, sizeof(magic)) != 0 || !read_value(input, version))
+        {
+            throw std::runtime_error("Not a binary log.");
+        }
+        if (version != BINARY_LOG_VERSION)
+        {
+            throw std::runtime_error(std::format("Unsupported binary log version {}.", version));
+        }
+
+        auto formats = std::unordered_map<uint32_t, DecodedFormat>{};
+        auto payload = std::string{};
+        auto count   = size_t{0u};
+        auto kind    = char{0};
+        while (input.get(kind))
+        {
+            if (kind == BINARY_LOG_FORMAT)
+            {
+                auto id     = uint32_t{0u};
+                auto level  = uint8_t{0u};
+                auto format = DecodedFormat{};
+                if (!read_value(input, id) || !read_value(input, format.line) || !read_value(input, level) ||
+                    !read_string(input, format.category) || !read_string(input, format.file) || !read_string(input, format.function) ||
+                    !read_string(input, format.format) || !read_string(input, format.types))
+                {
+                    break;
+                }
+                format.level = static_cast<LogLevel>(level);
+                formats[id] = std::move(format);
+            }
+            else if (kind == BINARY_LOG_RECORD)
+            {
+                auto id     = uint32_t{0u};
+                auto thread = uint32_t{0u};
+                auto time   = int64_t{0};
+                if (!read_value(input, id) || !read_value(input, thread) || !read_value(input, time) || !read_string(input, payload))
+                {
+                    break;
+                }
+
+                auto message = LogMessage{};
+                message.time   = std::chrono::system_clock::time_point{std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds{time})};
+                message.thread = thread;
+
+                auto text = std::string{};
+                auto i    = formats.find(id);
+                if (i == formats.end())
+                {
+                    text = std::format("<unknown format {}>", id);
+                }
+                else
+                {
+                    const auto& format = i->second;
+                    message.file     = format.file;
+                    message.function = format.function;
+                    message.line     = format.line;
+                    message.category = format.category;
+                    message.level    = format.level;
+
+                    auto values = read_arguments(format.types, payload);
+                    text = values ? format_record(format.format, *values) : std::format("<bad arguments for \"{}\">", format.format);
+                }
+                message.text = text;
+
+                output << std::format("{} [{}] ", std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds{time}).count(), thread) << format_log_line(message);
+                count++;
+            }
+            else
+            {
+                throw std::runtime_error("Corrupt binary log.");
+            }
+        }
+        return count;
+    }
+}
@@ -0,0 +1,357 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <source_location>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "defines.h"
+#include "debug.h"
+#include "utils.h"
+
+namespace ice
+{
+    //! Binary Log Argument Type
+    //!
+    //! The values are the characters stored in the type string of a format.
+    enum class BinaryType : char
+    {
+        //! int64_t
+        INT     = 'i',
+        //! uint64_t
+        UINT    = 'u',
+        //! double
+        FLOAT   = 'd',
+        //! one byte, 0 or 1
+        BOOL    = 'b',
+        //! one byte
+        CHAR    = 'c',
+        //! uint64_t, printed in hex
+        POINTER = 'p',
+        //! uint32_t length followed by the bytes
+        STRING  = 's'
+    };
+
+    //! Get the binary type of an argument type.
+    template <typename T>
+    constexpr BinaryType get_binary_type() noexcept
+    {
+        using U = std::decay_t<T>;
+        if constexpr (std::is_same_v<U, bool>)
+        {
+            return BinaryType::BOOL;
+        }
+        else if constexpr (std::is_same_v<U, char>)
+        {
+            return BinaryType::CHAR;
+        }
+        else if constexpr (std::is_enum_v<U>)
+        {
+            return std::is_signed_v<std::underlying_type_t<U>> ? BinaryType::INT : BinaryType::UINT;
+        }
+        else if constexpr (std::is_integral_v<U>)
+        {
+            return std::is_signed_v<U> ? BinaryType::INT : BinaryType::UINT;
+        }
+        else if constexpr (std::is_floating_point_v<U>)
+        {
+            return BinaryType::FLOAT;
+        }
+        else if constexpr (std::is_convertible_v<U, std::string_view>)
+        {
+            return BinaryType::STRING;
+        }
+        else if constexpr (std::is_pointer_v<U>)
+        {
+            return BinaryType::POINTER;
+        }
+        else
+        {
+            static_assert(sizeof(U) == 0u, "type can't be written to the binary log");
+        }
+    }
+
+    //! The type string of an argument list.
+    template <typename... Args>
+    constexpr char binary_types[] = {static_cast<char>(get_binary_type<Args>())..., '\0'};
+
+    //! Get the text of a string argument, a null pointer is empty.
+    template <typename T>
+    std::string_view get_binary_string(const T& value) noexcept
+    {
+        if constexpr (std::is_pointer_v<T>)
+        {
+            if (value == nullptr)
+            {
+                return {};
+            }
+        }
+        return std::string_view{value};
+    }
+
+    //! Get the encoded size of an argument.
+    template <typename T>
+    size_t get_binary_size(const T& value) noexcept
+    {
+        constexpr auto type = get_binary_type<T>();
+        if constexpr (type == BinaryType::STRING)
+        {
+            return sizeof(uint32_t) + get_binary_string(value).size();
+        }
+        else if constexpr (type == BinaryType::BOOL || type == BinaryType::CHAR)
+        {
+            return 1u;
+        }
+        else
+        {
+            return 8u;
+        }
+    }
+
+    //! Encode an argument and advance the pointer.
+    template <typename T>
+    void write_binary(std::byte*& dst, const T& value) noexcept
+    {
+        constexpr auto type = get_binary_type<T>();
+        if constexpr (type == BinaryType::STRING)
+        {
+            const auto text   = get_binary_string(value);
+            const auto length = static_cast<uint32_t>(text.size());
+            std::memcpy(dst, &length, sizeof(length));
+            // a null string has no data to copy from
+            if (!text.empty())
+            {
+                std::memcpy(dst + sizeof(length), text.data(), text.size());
+            }
+            dst += sizeof(length) + text.size();
+        }
+        else if constexpr (type == BinaryType::BOOL || type == BinaryType::CHAR)
+        {
+            *dst = static_cast<std::byte>(value);
+            dst += 1u;
+        }
+        else
+        {
+            if constexpr (type == BinaryType::INT)
+            {
+                const auto encoded = static_cast<int64_t>(value);
+                std::memcpy(dst, &encoded, 8u);
+            }
+            else if constexpr (type == BinaryType::UINT)
+            {
+                const auto encoded = static_cast<uint64_t>(value);
+                std::memcpy(dst, &encoded, 8u);
+            }
+            else if constexpr (type == BinaryType::FLOAT)
+            {
+                const auto encoded = static_cast<double>(value);
+                std::memcpy(dst, &encoded, 8u);
+            }
+            else
+            {
+                const auto encoded = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+                std::memcpy(dst, &encoded, 8u);
+            }
+            dst += 8u;
+        }
+    }
+
+    //! Binary Log Statistics
+    struct BinaryLogStats
+    {
+        //! The number of records written to the file.
+        size_t written = 0u;
+        //! The number of records dropped because a buffer was full.
+        size_t dropped = 0u;
+        //! The number of formats registered.
+        size_t formats = 0u;
+    };
+
+    struct BinaryLogRing;
+    struct LogWakeup;
+
+    //! Binary Log
+    //!
+    //! The binary log defers formatting to after the program ran. A call
+    //! site registers its format string once and gets an id; each call then
+    //! only copies the id, a timestamp and the raw argument bytes into the
+    //! thread's ring buffer. A writer thread appends the records to the file
+    //! and decode_binary_log turns the file into text.
+    //!
+    //! The file is written in the byte order of the machine.
+    //!
+    //! A child created with fork has no writer thread; it does not close
+    //! the file when it exits, the parent owns it.
+    class ICE_EXPORT BinaryLog : private non_copyable
+    {
+    public:
+        //! An id that is never handed out.
+        static constexpr uint32_t INVALID_ID = ~uint32_t{0};
+
+        //! Get the binary log.
+        [[nodiscard]] static BinaryLog& get() noexcept;
+
+        ~BinaryLog();
+
+        //! Start writing to a file.
+        //!
+        //! Records are only kept while a file is open.
+        //!
+        //! @throws std::runtime_error if the file can't be written
+        void open(const std::filesystem::path& file);
+
+        //! Write the remaining records and close the file.
+        void close() noexcept;
+
+        //! Check if a file is open.
+        [[nodiscard]] bool is_open() const noexcept
+        {
+            return opened.load(std::memory_order_relaxed);
+        }
+
+        //! Set the buffer size in bytes of threads that log for the first time.
+        void set_buffer_size(size_t value) noexcept;
+        //! Get the buffer size in bytes of new threads.
+        [[nodiscard]] size_t get_buffer_size() const noexcept;
+
+        //! Register the format of a call site.
+        //!
+        //! @param format a string that outlives the log, usually a literal
+        //! @param types the types of the arguments, see BinaryType
+        //! @returns the id or INVALID_ID if out of memory
+        [[nodiscard]] uint32_t register_format(const char* format, const char* types, const LogCategory& category, LogLevel level, const std::source_location& location) noexcept;
+
+        //! Reserve a record.
+        //!
+        //! @returns where the arguments go or nullptr if the record was dropped
+        [[nodiscard]] std::byte* reserve(uint32_t id, size_t size) noexcept;
+
+        //! Publish the reserved record.
+        void commit() noexcept;
+
+        //! Write all queued records to the file.
+        void flush() noexcept;
+
+        //! Get the statistics.
+        [[nodiscard]] BinaryLogStats get_stats() const noexcept;
+
+    private:
+        //! A registered format.
+        struct Format
+        {
+            const char*          format;
+            const char*          types;
+            const char*          category;
+            LogLevel             level;
+            std::source_location location;
+        };
+
+        std::atomic<bool>                           opened = false;
+        mutable std::mutex                          mutex;
+        std::vector<Format>                         formats;
+        std::vector<std::shared_ptr<BinaryLogRing>> rings;
+        std::atomic<size_t>                         buffer_size = 64u << 10u;
+        size_t                                      dropped     = 0u;
+
+        std::mutex          drain_mutex;
+        std::ofstream       output;
+        size_t              formats_written = 0u;
+        std::atomic<size_t> written         = 0u;
+
+        std::unique_ptr<LogWakeup> wakeup;
+        std::atomic<bool>          wake_requested = false;
+        std::thread                thread;
+        int                        process = 0;
+
+        BinaryLog();
+        bool is_forked() const noexcept;
+        BinaryLogRing* get_ring() noexcept;
+        void write_formats(size_t count);
+        void wake() noexcept;
+        void drain() noexcept;
+        void run() noexcept;
+    };
+
+    //! Write a record to the binary log.
+    //!
+    //! Use ICE_BLOG, the tag is what gives each call site its own id.
+    template <typename Tag, typename... Args>
+    void write_binary_log(Tag tag, const LogCategory& category, LogLevel level, const std::source_location& location, const Args&... args) noexcept
+    {
+        auto& log = BinaryLog::get();
+        if (!log.is_open())
+        {
+            return;
+        }
+
+        static const auto id = log.register_format(tag(), binary_types<Args...>, category, level, location);
+        if (id == BinaryLog::INVALID_ID)
+        {
+            return;
+        }
+
+        const auto size = (get_binary_size(args) + ... + size_t{0u});
+        auto dst = log.reserve(id, size);
+        if (dst == nullptr)
+        {
+            return;
+        }
+        (write_binary(dst, args), ...);
+        log.commit();
+    }
+
+    //! Turn a binary log into text.
+    //!
+    //! Each record becomes one line formatted like the text log. A file
+    //! that ends in the middle of a record, for example after a crash, is
+    //! decoded up to the last complete record.
+    //!
+    //! @returns the number of records decoded
+    //! @throws std::runtime_error if the input is not a binary log
+    ICE_EXPORT size_t decode_binary_log(std::istream& input, std::ostream& output);
+}
+
+//! Write to the binary log.
+//!
+//! The format uses std::format syntax and must be a string literal; the
+//! arguments are formatted when the log is decoded.
+#define ICE_BLOG(CATEGORY, LEVEL, FORMAT, ...) \
+    do { \
+        if constexpr (::ice::is_log_enabled(CATEGORY, ::ice::LogLevel::LEVEL)) \
+        { \
+            ::ice::write_binary_log([] () -> const char* { return FORMAT; }, CATEGORY, ::ice::LogLevel::LEVEL, std::source_location::current() __VA_OPT__(,) __VA_ARGS__); \
+        } \
+    } while (false)
@@ -0,0 +1,134 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "ByteRing.h"
+
+#include <cstring>
+
+namespace ice
+{
+    //! Header in front of each record.
+    struct RecordHeader
+    {
+        //! The bytes taken by the record including header and padding.
+        uint32_t size;
+        //! The bytes of the payload, SKIP for the unused end of the buffer.
+        uint32_t length;
+    };
+
+    constexpr uint32_t SKIP = ~uint32_t{0};
+
+    static_assert(sizeof(RecordHeader) == 8u);
+
+    constexpr size_t align_record(size_t size) noexcept
+    {
+        return (size + 7u) & ~size_t{7u};
+    }
+
+    ByteRing::ByteRing(size_t c)
+    {
+        capacity = 64u;
+        while (capacity < c)
+        {
+            capacity *= 2u;
+        }
+        data = std::make_unique<std::byte[]>(capacity);
+    }
+
+    size_t ByteRing::get_capacity() const noexcept
+    {
+        return capacity;
+    }
+
+    size_t ByteRing::get_max_record() const noexcept
+    {
+        // a record may need to skip up to its own size at the end of the buffer
+        return capacity / 2u - sizeof(RecordHeader);
+    }
+
+    std::byte* ByteRing::reserve(size_t size) noexcept
+    {
+        check(size <= get_max_record());
+
+        const auto need       = align_record(sizeof(RecordHeader) + size);
+        const auto h          = head.load(std::memory_order_relaxed);
+        const auto t          = tail.load(std::memory_order_acquire);
+        const auto offset     = h & (capacity - 1u);
+        const auto contiguous = capacity - offset;
+        const auto skip       = need > contiguous ? contiguous : 0u;
+
+        if (capacity - (h - t) < skip + need)
+        {
+            return nullptr;
+        }
+
+        if (skip != 0u)
+        {
+            const auto header = RecordHeader{static_cast<uint32_t>(skip), SKIP};
+            std::memcpy(data.get() + offset, &header, sizeof(RecordHeader));
+        }
+
+        auto record = data.get() + ((h + skip) & (capacity - 1u));
+        const auto header = RecordHeader{static_cast<uint32_t>(need), static_cast<uint32_t>(size)};
+        std::memcpy(record, &header, sizeof(RecordHeader));
+
+        reserved = skip + need;
+        return record + sizeof(RecordHeader);
+    }
+
+    void ByteRing::commit() noexcept
+    {
+        head.store(head.load(std::memory_order_relaxed) + reserved, std::memory_order_release);
+        reserved = 0u;
+    }
+
+    std::span<const std::byte> ByteRing::peek() noexcept
+    {
+        const auto h = head.load(std::memory_order_acquire);
+        auto       t = tail.load(std::memory_order_relaxed);
+        while (t != h)
+        {
+            auto record = data.get() + (t & (capacity - 1u));
+            auto header = RecordHeader{};
+            std::memcpy(&header, record, sizeof(RecordHeader));
+            if (header.length != SKIP)
+            {
+                return {record + sizeof(RecordHeader), header.length};
+            }
+            t += header.size;
+            tail.store(t, std::memory_order_release);
+        }
+        return {};
+    }
+
+    void ByteRing::pop() noexcept
+    {
+        const auto t = tail.load(std::memory_order_relaxed);
+        auto header = RecordHeader{};
+        std::memcpy(&header, data.get() + (t & (capacity - 1u)), sizeof(RecordHeader));
+        tail.store(t + header.size, std::memory_order_release);
+    }
+
+    bool ByteRing::is_empty() const noexcept
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+}
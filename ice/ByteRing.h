@@ -0,0 +1,86 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include "defines.h"
+#include "utils.h"
+
+namespace ice
+{
+    //! Byte Ring
+    //!
+    //! A ring buffer of variable sized records for one producer and one
+    //! consumer thread. Records never wrap around the end of the buffer,
+    //! the rest is skipped instead, so each record is contiguous and 8 byte
+    //! aligned.
+    class ICE_EXPORT ByteRing : private non_copyable
+    {
+    public:
+        //! Construct Byte Ring
+        //!
+        //! @param capacity the size in bytes, rounded up to a power of two
+        ByteRing(size_t capacity);
+
+        //! Get the size in bytes.
+        [[nodiscard]] size_t get_capacity() const noexcept;
+
+        //! Get the largest record that fits.
+        [[nodiscard]] size_t get_max_record() const noexcept;
+
+        //! Reserve room for a record.
+        //!
+        //! Producer only. The record is visible to the consumer after commit.
+        //!
+        //! @returns nullptr if the ring is full
+        [[nodiscard]] std::byte* reserve(size_t size) noexcept;
+
+        //! Publish the reserved record.
+        void commit() noexcept;
+
+        //! Get the next record.
+        //!
+        //! Consumer only.
+        //!
+        //! @returns an empty span if there is no record
+        [[nodiscard]] std::span<const std::byte> peek() noexcept;
+
+        //! Release the record returned by peek.
+        void pop() noexcept;
+
+        //! Check if all records were consumed.
+        [[nodiscard]] bool is_empty() const noexcept;
+
+    private:
+        std::unique_ptr<std::byte[]> data;
+        size_t                       capacity = 0u;
+        size_t                       reserved = 0u;
+
+        alignas(64) std::atomic<size_t> head = 0u;
+        alignas(64) std::atomic<size_t> tail = 0u;
+    };
+}
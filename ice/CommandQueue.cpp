@@ -0,0 +1,124 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "CommandQueue.h"
+
+#include <bit>
+
+#include "debug.h"
+
+namespace ice
+{
+    CommandQueue::CommandQueue(size_t capacity)
+    {
+        check(capacity > 0u);
+        capacity = std::bit_ceil(capacity);
+
+        cells = std::make_unique<Cell[]>(capacity);
+        mask  = capacity - 1u;
+        for (auto i = size_t{0u}; i < capacity; i++)
+        {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    CommandQueue::~CommandQueue()
+    {
+        while (true)
+        {
+            auto& cell = cells[head & mask];
+            if (cell.sequence.load(std::memory_order_acquire) != head + 1u)
+            {
+                break;
+            }
+            cell.op(cell.storage, false);
+            head++;
+        }
+    }
+
+    size_t CommandQueue::get_capacity() const noexcept
+    {
+        return mask + 1u;
+    }
+
+    size_t CommandQueue::run() noexcept
+    {
+        // only what is queued now, producers or a command pushing itself could keep us here
+        const auto end = tail.load(std::memory_order_acquire);
+
+        auto count = size_t{0u};
+        while (head != end && run_one())
+        {
+            count++;
+        }
+        return count;
+    }
+
+    bool CommandQueue::run_one() noexcept
+    {
+        auto& cell = cells[head & mask];
+        if (cell.sequence.load(std::memory_order_acquire) != head + 1u)
+        {
+            return false;
+        }
+
+        cell.op(cell.storage, true);
+
+        // hand the cell back to the producers for the next lap
+        cell.sequence.store(head + mask + 1u, std::memory_order_release);
+        head++;
+        return true;
+    }
+
+    CommandQueue::Cell* CommandQueue::acquire() noexcept
+    {
+        auto pos = tail.load(std::memory_order_relaxed);
+        while (true)
+        {
+            auto& cell = cells[pos & mask];
+            const auto seq  = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0)
+            {
+                if (tail.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed))
+                {
+                    return &cell;
+                }
+            }
+            else if (diff < 0)
+            {
+                // the consumer has not yet freed this cell; the queue is full
+                return nullptr;
+            }
+            else
+            {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void CommandQueue::publish(Cell* cell) noexcept
+    {
+        // The cell was claimed at position sequence, mark it as filled.
+        const auto pos = cell->sequence.load(std::memory_order_relaxed);
+        cell->sequence.store(pos + 1u, std::memory_order_release);
+    }
+}
@@ -0,0 +1,131 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "defines.h"
+#include "utils.h"
+
+namespace ice
+{
+    //! Command Queue
+    //!
+    //! The CommandQueue is a bounded lock-free multi-producer single-consumer
+    //! queue of commands. Any thread may push commands and one thread, usually
+    //! the main thread, runs them.
+    //!
+    //! Commands are callables that are stored inline in preallocated slots;
+    //! pushing a command never allocates. A command must fit into
+    //! COMMAND_STORAGE bytes, which is plenty for a lambda capturing a few
+    //! pointers or values.
+    class ICE_EXPORT CommandQueue : private non_copyable
+    {
+    public:
+        //! The bytes available to store a command.
+        static constexpr size_t COMMAND_STORAGE = 48u;
+
+        //! Construct Command Queue
+        //!
+        //! @param capacity the number of slots, rounded up to a power of two
+        CommandQueue(size_t capacity = 1024u);
+
+        //! Destroy Command Queue
+        //!
+        //! Commands that were not run are discarded.
+        ~CommandQueue();
+
+        //! Get the number of slots.
+        [[nodiscard]] size_t get_capacity() const noexcept;
+
+        //! Push a command.
+        //!
+        //! This function may be called from any thread.
+        //!
+        //! @returns false if the queue is full
+        template <typename Fun>
+        bool push(Fun&& fun) noexcept;
+
+        //! Run the commands queued when the call starts.
+        //!
+        //! Only one thread may call this function at a time. Commands pushed
+        //! while running are left for the next call.
+        //!
+        //! @returns the number of commands run
+        size_t run() noexcept;
+
+        //! Run one queued command.
+        //!
+        //! @returns true if a command was run
+        bool run_one() noexcept;
+
+    private:
+        struct alignas(64) Cell
+        {
+            std::atomic<size_t> sequence = 0u;
+            void (*op)(void* storage, bool invoke) noexcept = nullptr;
+            alignas(std::max_align_t) std::byte storage[COMMAND_STORAGE];
+        };
+
+        std::unique_ptr<Cell[]> cells;
+        size_t                  mask = 0u;
+
+        alignas(64) std::atomic<size_t> tail = 0u;
+        alignas(64) size_t              head = 0u;
+
+        Cell* acquire() noexcept;
+        void publish(Cell* cell) noexcept;
+    };
+
+    template <typename Fun>
+    bool CommandQueue::push(Fun&& fun) noexcept
+    {
+        using F = std::decay_t<Fun>;
+        static_assert(sizeof(F) <= COMMAND_STORAGE, "Command too large; capture less or capture by pointer.");
+        static_assert(alignof(F) <= alignof(std::max_align_t), "Command over aligned.");
+        static_assert(std::is_nothrow_constructible_v<F, Fun&&>, "Command must be nothrow constructible.");
+
+        auto cell = acquire();
+        if (cell == nullptr)
+        {
+            return false;
+        }
+
+        new (cell->storage) F(std::forward<Fun>(fun));
+        cell->op = [] (void* storage, bool invoke) noexcept {
+            auto f = std::launder(static_cast<F*>(storage));
+            if (invoke)
+            {
+                (*f)();
+            }
+            f->~F();
+        };
+
+        publish(cell);
+        return true;
+    }
+}
@@ -0,0 +1,634 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "CrashReporter.h"
+
+#ifdef __linux__
+
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include "Log.h"
+
+namespace ice
+{
+    //! Keeps the last lines of the log for the crash report.
+    //!
+    //! The log thread writes, the signal handler reads without locking. A
+    //! line written during the crash may come out garbled.
+    class CrashLogSink : public LogSink
+    {
+    public:
+        CrashLogSink(size_t c)
+        : data(std::make_unique<char[]>(c)), capacity(c)
+        {}
+
+        void write(const LogMessage& message) override
+        {
+            const auto line = format_log_line(message);
+            auto text = std::string_view{line};
+            if (text.size() > capacity)
+            {
+                text = text.substr(text.size() - capacity);
+            }
+
+            auto position = head.load(std::memory_order_relaxed);
+            for (const auto c : text)
+            {
+                data[position % capacity] = c;
+                position++;
+            }
+            head.store(position, std::memory_order_release);
+        }
+
+        //! Get the tail as up to two pieces, oldest first.
+        std::array<std::string_view, 2u> get_tail() const noexcept
+        {
+            const auto position = head.load(std::memory_order_acquire);
+            if (position <= capacity)
+            {
+                return {std::string_view{data.get(), position}, std::string_view{}};
+            }
+            const auto offset = position % capacity;
+            return {std::string_view{data.get() + offset, capacity - offset}, std::string_view{data.get(), offset}};
+        }
+
+    private:
+        std::unique_ptr<char[]> data;
+        size_t                  capacity;
+        std::atomic<size_t>     head = 0u;
+    };
+
+    namespace
+    {
+        constexpr size_t REPORT_BUFFER_SIZE  = 16u << 10u;
+        constexpr size_t SCRATCH_BUFFER_SIZE = 8u << 10u;
+        constexpr int    CRASH_SIGNALS[]     = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+
+        std::atomic<CrashReporter*> active          = nullptr;
+        //! The thread that writes the report, 0 until something crashes.
+        std::atomic<pid_t>          crashing_thread = 0;
+
+        //! Frees the alternate signal stack of a thread when it exits.
+        struct AltStack
+        {
+            std::unique_ptr<std::byte[]> memory;
+
+            ~AltStack()
+            {
+                if (memory)
+                {
+                    auto stack = stack_t{};
+                    stack.ss_flags = SS_DISABLE;
+                    sigaltstack(&stack, nullptr);
+                }
+            }
+        };
+
+        thread_local AltStack alt_stack;
+
+        //! Buffered output that only uses async signal safe calls.
+        class ReportWriter
+        {
+        public:
+            ReportWriter(int f, std::span<char> b) noexcept
+            : fd(f), buffer(b)
+            {}
+
+            ~ReportWriter()
+            {
+                flush();
+            }
+
+            void text(std::string_view value) noexcept
+            {
+                while (!value.empty())
+                {
+                    if (size == buffer.size())
+                    {
+                        flush();
+                    }
+                    const auto n = std::min(value.size(), buffer.size() - size);
+                    std::memcpy(buffer.data() + size, value.data(), n);
+                    size += n;
+                    value.remove_prefix(n);
+                }
+            }
+
+            void hex(uint64_t value) noexcept
+            {
+                char digits[18] = {'0', 'x'};
+                for (auto i = 0u; i < 16u; i++)
+                {
+                    digits[17u - i] = "0123456789abcdef"[(value >> (i * 4u)) & 0xfu];
+                }
+                text({digits, sizeof(digits)});
+            }
+
+            void dec(int64_t value) noexcept
+            {
+                char digits[21];
+                auto i        = sizeof(digits);
+                auto negative = value < 0;
+                auto rest     = negative ? 0u - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+                do
+                {
+                    digits[--i] = static_cast<char>('0' + rest % 10u);
+                    rest /= 10u;
+                }
+                while (rest != 0u);
+                if (negative)
+                {
+                    digits[--i] = '-';
+                }
+                text({digits + i, sizeof(digits) - i});
+            }
+
+            void flush() noexcept
+            {
+                auto data = buffer.data();
+                while (size > 0u)
+                {
+                    const auto n = ::write(fd, data, size);
+                    if (n < 0 && errno == EINTR)
+                    {
+                        continue;
+                    }
+                    if (n <= 0)
+                    {
+                        break;
+                    }
+                    data += n;
+                    size -= static_cast<size_t>(n);
+                }
+                size = 0u;
+            }
+
+        private:
+            int             fd;
+            std::span<char> buffer;
+            size_t          size = 0u;
+        };
+
+        const char* get_signal_name(int signal) noexcept
+        {
+            switch (signal)
+            {
+                case SIGSEGV: return "SIGSEGV";
+                case SIGBUS:  return "SIGBUS";
+                case SIGFPE:  return "SIGFPE";
+                case SIGILL:  return "SIGILL";
+                case SIGABRT: return "SIGABRT";
+                default:      return "none";
+            }
+        }
+
+        //! Write the registers of a signal context, returns the program counter.
+        uintptr_t write_registers(ReportWriter& out, const void* context) noexcept
+        {
+            const auto& mcontext = static_cast<const ucontext_t*>(context)->uc_mcontext;
+            out.text("registers:\n");
+
+            #if defined(__x86_64__)
+            constexpr std::pair<const char*, int> registers[] = {
+                {"rax", REG_RAX}, {"rbx", REG_RBX}, {"rcx", REG_RCX}, {"rdx", REG_RDX},
+                {"rsi", REG_RSI}, {"rdi", REG_RDI}, {"rbp", REG_RBP}, {"rsp", REG_RSP},
+                {"r8",  REG_R8},  {"r9",  REG_R9},  {"r10", REG_R10}, {"r11", REG_R11},
+                {"r12", REG_R12}, {"r13", REG_R13}, {"r14", REG_R14}, {"r15", REG_R15},
+                {"rip", REG_RIP}, {"efl", REG_EFL}
+            };
+            for (const auto& [name, index] : registers)
+            {
+                out.text("  ");
+                out.text(name);
+                out.text(" ");
+                out.hex(static_cast<uint64_t>(mcontext.gregs[index]));
+                out.text("\n");
+            }
+            return static_cast<uintptr_t>(mcontext.gregs[REG_RIP]);
+            #elif defined(__aarch64__)
+            for (auto i = 0u; i < 31u; i++)
+            {
+                out.text("  x");
+                out.dec(i);
+                out.text(" ");
+                out.hex(mcontext.regs[i]);
+                out.text("\n");
+            }
+            out.text("  sp ");
+            out.hex(mcontext.sp);
+            out.text("\n  pc ");
+            out.hex(mcontext.pc);
+            out.text("\n  pstate ");
+            out.hex(mcontext.pstate);
+            out.text("\n");
+            return static_cast<uintptr_t>(mcontext.pc);
+            #else
+            static_cast<void>(mcontext);
+            out.text("  not supported\n");
+            return 0u;
+            #endif
+        }
+
+        //! Write the stack, starting at the program counter if there is one.
+        void write_stack(ReportWriter& out, std::span<uintptr_t> addresses, uintptr_t pc) noexcept
+        {
+            auto count = capture_stack(addresses);
+
+            // leave out the frames of the handler, the faulting frame follows the signal trampoline
+            auto first = size_t{0u};
+            if (pc != 0u)
+            {
+                for (auto i = size_t{0u}; i < count; i++)
+                {
+                    if (addresses[i] == pc)
+                    {
+                        first = i;
+                        break;
+                    }
+                }
+            }
+
+            out.text("stack:\n");
+            for (auto i = first; i < count; i++)
+            {
+                out.text("  ");
+                out.hex(addresses[i]);
+                out.text("\n");
+            }
+        }
+
+        //! Copy the executable mappings, they are needed to resolve the stack.
+        void write_mappings(ReportWriter& out, std::span<char> scratch) noexcept
+        {
+            out.text("mappings:\n");
+            const auto fd = ::open("/proc/self/maps", O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+            {
+                return;
+            }
+
+            // the second half of the scratch buffer collects a line
+            auto chunk = scratch.first(scratch.size() / 2u);
+            auto line  = scratch.last(scratch.size() / 2u);
+            auto used  = size_t{0u};
+            while (true)
+            {
+                const auto n = ::read(fd, chunk.data(), chunk.size());
+                if (n < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (n <= 0)
+                {
+                    break;
+                }
+                for (auto i = 0; i < n; i++)
+                {
+                    if (chunk[i] != '\n')
+                    {
+                        if (used < line.size())
+                        {
+                            line[used++] = chunk[i];
+                        }
+                        continue;
+                    }
+                    const auto text = std::string_view{line.data(), used};
+                    if (text.find(" r-xp ") != std::string_view::npos)
+                    {
+                        out.text("  ");
+                        out.text(text);
+                        out.text("\n");
+                    }
+                    used = 0u;
+                }
+            }
+            ::close(fd);
+        }
+
+        //! Format a number into a buffer, returns the end.
+        char* format_number(char* dst, uint64_t value) noexcept
+        {
+            char digits[20];
+            auto i = sizeof(digits);
+            do
+            {
+                digits[--i] = static_cast<char>('0' + value % 10u);
+                value /= 10u;
+            }
+            while (value != 0u);
+            std::memcpy(dst, digits + i, sizeof(digits) - i);
+            return dst + sizeof(digits) - i;
+        }
+
+        //! The layout of the entries returned by getdents64.
+        struct DirectoryEntry
+        {
+            uint64_t       inode;
+            int64_t        offset;
+            unsigned short length;
+            unsigned char  type;
+            char           name[1];
+        };
+
+        //! List the threads with their names.
+        void write_threads(ReportWriter& out, std::span<char> scratch, pid_t crashed) noexcept
+        {
+            out.text("threads:\n");
+            const auto dir = ::open("/proc/self/task", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (dir < 0)
+            {
+                return;
+            }
+
+            while (true)
+            {
+                const auto n = syscall(SYS_getdents64, dir, scratch.data(), scratch.size());
+                if (n <= 0)
+                {
+                    break;
+                }
+                for (auto offset = 0l; offset < n;)
+                {
+                    const auto entry = reinterpret_cast<const DirectoryEntry*>(scratch.data() + offset);
+                    offset += entry->length;
+
+                    const auto name = std::string_view{entry->name};
+                    if (name.empty() || name[0] < '0' || name[0] > '9')
+                    {
+                        continue;
+                    }
+
+                    auto tid = uint64_t{0u};
+                    for (const auto c : name)
+                    {
+                        tid = tid * 10u + static_cast<uint64_t>(c - '0');
+                    }
+
+                    char path[64] = "/proc/self/task/";
+                    auto end = format_number(path + 16, tid);
+                    std::memcpy(end, "/comm", 6u);
+
+                    char comm[32] = {};
+                    auto length = ssize_t{0};
+                    const auto fd = ::open(path, O_RDONLY | O_CLOEXEC);
+                    if (fd >= 0)
+                    {
+                        length = ::read(fd, comm, sizeof(comm) - 1u);
+                        ::close(fd);
+                    }
+                    while (length > 0 && comm[length - 1] == '\n')
+                    {
+                        length--;
+                    }
+
+                    out.text("  ");
+                    out.dec(static_cast<int64_t>(tid));
+                    out.text(" ");
+                    out.text({comm, static_cast<size_t>(std::max(length, ssize_t{0}))});
+                    out.text(static_cast<pid_t>(tid) == crashed ? " (crashed)\n" : "\n");
+                }
+            }
+            ::close(dir);
+        }
+
+        void write_log_tail(ReportWriter& out, const CrashLogSink* sink) noexcept
+        {
+            out.text("log:\n");
+            if (sink != nullptr)
+            {
+                for (const auto piece : sink->get_tail())
+                {
+                    out.text(piece);
+                }
+            }
+        }
+
+        //! Write a full report.
+        //!
+        //! @param context the signal context or nullptr
+        void write_crash_report(int fd, std::span<char> buffer, std::span<char> scratch, std::span<uintptr_t> addresses,
+                                int signal, const siginfo_t* info, const void* context, const CrashLogSink* sink) noexcept
+        {
+            auto out = ReportWriter{fd, buffer};
+            const auto tid = static_cast<pid_t>(syscall(SYS_gettid));
+
+            auto now = timespec{};
+            clock_gettime(CLOCK_REALTIME, &now);
+
+            out.text("ice crash report\n");
+            out.text("signal: ");
+            out.text(get_signal_name(signal));
+            if (info != nullptr)
+            {
+                out.text(" code: ");
+                out.dec(info->si_code);
+                out.text(" address: ");
+                out.hex(reinterpret_cast<uintptr_t>(info->si_addr));
+            }
+            out.text("\npid: ");
+            out.dec(getpid());
+            out.text(" tid: ");
+            out.dec(tid);
+            out.text("\ntime: ");
+            out.dec(now.tv_sec);
+            out.text("\n");
+
+            auto pc = uintptr_t{0u};
+            if (context != nullptr)
+            {
+                pc = write_registers(out, context);
+            }
+            write_stack(out, addresses, pc);
+            write_mappings(out, scratch);
+            write_threads(out, scratch, tid);
+            write_log_tail(out, sink);
+        }
+    }
+
+    CrashReporter::CrashReporter(const std::filesystem::path& f, size_t log_tail)
+    : file(f), file_name(f.string())
+    {
+        fd = ::open(file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            throw std::runtime_error(std::format("Failed to open crash report {}.", file_name));
+        }
+
+        auto expected = static_cast<CrashReporter*>(nullptr);
+        if (!active.compare_exchange_strong(expected, this))
+        {
+            ::close(fd);
+            ::unlink(file_name.c_str());
+            throw std::runtime_error("A crash reporter is already installed.");
+        }
+
+        buffer   = std::make_unique<char[]>(REPORT_BUFFER_SIZE);
+        scratch  = std::make_unique<char[]>(SCRATCH_BUFFER_SIZE);
+        log_sink = std::make_shared<CrashLogSink>(std::max(log_tail, size_t{1u}));
+        Logger::get().add_sink(log_sink);
+
+        // the unwinder loads and sets itself up on first use, not in the handler
+        capture_stack(addresses);
+
+        prepare_thread();
+
+        struct sigaction action = {};
+        action.sa_sigaction = handle_signal;
+        action.sa_flags     = SA_SIGINFO | SA_ONSTACK;
+        // a crash while writing the report must not enter the handler again
+        sigemptyset(&action.sa_mask);
+        for (const auto signal : CRASH_SIGNALS)
+        {
+            sigaddset(&action.sa_mask, signal);
+        }
+        for (const auto signal : CRASH_SIGNALS)
+        {
+            sigaction(signal, &action, &old_actions[signal]);
+        }
+    }
+
+    CrashReporter::~CrashReporter()
+    {
+        for (const auto signal : CRASH_SIGNALS)
+        {
+            sigaction(signal, &old_actions[signal], nullptr);
+        }
+        active = nullptr;
+
+        if (auto logger = Logger::try_get())
+        {
+            logger->remove_sink(log_sink);
+        }
+        ::close(fd);
+        if (!written)
+        {
+            ::unlink(file_name.c_str());
+        }
+    }
+
+    const std::filesystem::path& CrashReporter::get_file() const noexcept
+    {
+        return file;
+    }
+
+    void CrashReporter::prepare_thread() noexcept
+    {
+        if (alt_stack.memory)
+        {
+            return;
+        }
+
+        try
+        {
+            const auto size = std::max<size_t>(SIGSTKSZ, 64u << 10u);
+            alt_stack.memory = std::make_unique<std::byte[]>(size);
+
+            auto stack = stack_t{};
+            stack.ss_sp    = alt_stack.memory.get();
+            stack.ss_size  = size;
+            stack.ss_flags = 0;
+            if (sigaltstack(&stack, nullptr) != 0)
+            {
+                alt_stack.memory.reset();
+            }
+        }
+        catch (...) {}
+    }
+
+    void CrashReporter::write_report(const std::filesystem::path& target) noexcept
+    {
+        const auto fd = ::open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            return;
+        }
+
+        auto buffer    = std::array<char, REPORT_BUFFER_SIZE>{};
+        auto scratch   = std::array<char, SCRATCH_BUFFER_SIZE>{};
+        auto addresses = std::array<uintptr_t, MAX_STACK_DEPTH>{};
+        auto reporter  = active.load();
+        write_crash_report(fd, buffer, scratch, addresses, 0, nullptr, nullptr, reporter != nullptr ? reporter->log_sink.get() : nullptr);
+        ::close(fd);
+    }
+
+    void CrashReporter::handle_signal(int signal, siginfo_t* info, void* context) noexcept
+    {
+        const auto tid = static_cast<pid_t>(syscall(SYS_gettid));
+        auto first = pid_t{0};
+        if (!crashing_thread.compare_exchange_strong(first, tid))
+        {
+            // a second thread crashing waits for the first report, the process ends with it
+            if (first != tid)
+            {
+                while (true)
+                {
+                    pause();
+                }
+            }
+
+            // the report itself crashed, nobody else would end the process
+            struct sigaction action = {};
+            action.sa_handler = SIG_DFL;
+            sigaction(signal, &action, nullptr);
+
+            auto mask = sigset_t{};
+            sigemptyset(&mask);
+            sigaddset(&mask, signal);
+            pthread_sigmask(SIG_UNBLOCK, &mask, nullptr);
+            raise(signal);
+            _exit(128 + signal);
+        }
+
+        auto reporter = active.load();
+        if (reporter != nullptr)
+        {
+            write_crash_report(reporter->fd, {reporter->buffer.get(), REPORT_BUFFER_SIZE}, {reporter->scratch.get(), SCRATCH_BUFFER_SIZE},
+                               reporter->addresses, signal, info, context, reporter->log_sink.get());
+            fsync(reporter->fd);
+            reporter->written = true;
+
+            // hand the signal to whoever was there before, usually the default action
+            sigaction(signal, &reporter->old_actions[signal], nullptr);
+        }
+        else
+        {
+            struct sigaction action = {};
+            action.sa_handler = SIG_DFL;
+            sigaction(signal, &action, nullptr);
+        }
+
+        // faults happen again on return, signals sent with kill do not
+        raise(signal);
+    }
+}
+
+#endif
@@ -0,0 +1,103 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#ifdef __linux__
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include <signal.h>
+
+#include "defines.h"
+#include "utils.h"
+#include "StackTrace.h"
+
+namespace ice
+{
+    class CrashLogSink;
+
+    //! Crash Reporter
+    //!
+    //! Writes a compact text report when the process dies from SIGSEGV,
+    //! SIGBUS, SIGFPE, SIGILL or SIGABRT. The report holds the signal, the
+    //! registers, the raw stack addresses, the executable mappings to
+    //! resolve them offline, the thread list and the tail of the log. For
+    //! addr2line, an address maps to address - start + offset of the mapping
+    //! that contains it.
+    //!
+    //! Everything the handler needs, the file, the buffers and an alternate
+    //! signal stack, is reserved up front; the handler only makes async
+    //! signal safe calls and allocates nothing. After the report is written
+    //! the previous handler is restored and the signal raised again.
+    //!
+    //! Only one crash reporter can be installed at a time. The file is
+    //! removed again if the process ends without a crash.
+    class ICE_EXPORT CrashReporter : private non_copyable
+    {
+    public:
+        //! Install Crash Reporter
+        //!
+        //! @param file where the report goes
+        //! @param log_tail the number of bytes of recent log kept for the report
+        //!
+        //! @throws std::runtime_error if the file can't be opened or a
+        //! reporter is already installed
+        CrashReporter(const std::filesystem::path& file, size_t log_tail = 16u << 10u);
+        ~CrashReporter();
+
+        //! Get the report file.
+        [[nodiscard]] const std::filesystem::path& get_file() const noexcept;
+
+        //! Give the calling thread an alternate signal stack.
+        //!
+        //! Without one a stack overflow can't be reported. The thread that
+        //! installs the reporter gets one automatically; other threads call
+        //! this when they start, the stack is freed when they exit.
+        static void prepare_thread() noexcept;
+
+        //! Write a report of the calling thread without a crash.
+        //!
+        //! Includes the log tail of the installed reporter, if there is one.
+        static void write_report(const std::filesystem::path& file) noexcept;
+
+    private:
+        std::filesystem::path                  file;
+        std::string                            file_name;
+        int                                    fd = -1;
+        std::shared_ptr<CrashLogSink>          log_sink;
+        std::unique_ptr<char[]>                buffer;
+        std::unique_ptr<char[]>                scratch;
+        std::array<uintptr_t, MAX_STACK_DEPTH> addresses = {};
+        std::array<struct sigaction, NSIG>     old_actions = {};
+        std::atomic<bool>                      written = false;
+
+        static void handle_signal(int signal, siginfo_t* info, void* context) noexcept;
+    };
+}
+
+#endif
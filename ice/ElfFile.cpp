@@ -0,0 +1,700 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "ElfFile.h"
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <limits>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <link.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ice
+{
+    namespace
+    {
+        constexpr uint32_t NO_FILE = std::numeric_limits<uint32_t>::max();
+
+        // the DWARF constants used to read the line table
+        constexpr uint8_t DW_LNS_copy               = 1u;
+        constexpr uint8_t DW_LNS_advance_pc         = 2u;
+        constexpr uint8_t DW_LNS_advance_line       = 3u;
+        constexpr uint8_t DW_LNS_set_file           = 4u;
+        constexpr uint8_t DW_LNS_const_add_pc       = 8u;
+        constexpr uint8_t DW_LNS_fixed_advance_pc   = 9u;
+        constexpr uint8_t DW_LNE_end_sequence       = 1u;
+        constexpr uint8_t DW_LNE_set_address        = 2u;
+        constexpr uint8_t DW_LNE_define_file        = 3u;
+        constexpr uint64_t DW_LNCT_path             = 1u;
+        constexpr uint64_t DW_LNCT_directory_index  = 2u;
+        constexpr uint64_t DW_FORM_block            = 0x09u;
+        constexpr uint64_t DW_FORM_block1           = 0x0au;
+        constexpr uint64_t DW_FORM_data1            = 0x0bu;
+        constexpr uint64_t DW_FORM_data2            = 0x05u;
+        constexpr uint64_t DW_FORM_data4            = 0x06u;
+        constexpr uint64_t DW_FORM_data8            = 0x07u;
+        constexpr uint64_t DW_FORM_data16           = 0x1eu;
+        constexpr uint64_t DW_FORM_string           = 0x08u;
+        constexpr uint64_t DW_FORM_strp             = 0x0eu;
+        constexpr uint64_t DW_FORM_udata            = 0x0fu;
+        constexpr uint64_t DW_FORM_line_strp        = 0x1fu;
+
+        //! Bounds checked reading of DWARF data.
+        //!
+        //! Reading past the end sets the reader to failed and returns zeros.
+        class DwarfReader
+        {
+        public:
+            DwarfReader(std::string_view d)
+            : data(d)
+            {}
+
+            bool good() const noexcept
+            {
+                return ok;
+            }
+
+            size_t tell() const noexcept
+            {
+                return pos;
+            }
+
+            size_t remaining() const noexcept
+            {
+                return data.size() - pos;
+            }
+
+            void seek(size_t offset) noexcept
+            {
+                if (offset > data.size())
+                {
+                    ok     = false;
+                    offset = data.size();
+                }
+                pos = offset;
+            }
+
+            void skip(uint64_t count) noexcept
+            {
+                if (count > remaining())
+                {
+                    ok = false;
+                    pos = data.size();
+                    return;
+                }
+                pos += count;
+            }
+
+            template <typename T>
+            T read() noexcept
+            {
+                auto value = T{};
+                if (sizeof(T) > remaining())
+                {
+                    ok  = false;
+                    pos = data.size();
+                    return value;
+                }
+                std::memcpy(&value, data.data() + pos, sizeof(T));
+                pos += sizeof(T);
+                return value;
+            }
+
+            uint64_t read_uleb() noexcept
+            {
+                auto value = uint64_t{0u};
+                auto shift = 0u;
+                while (true)
+                {
+                    const auto byte = read<uint8_t>();
+                    if (shift < 64u)
+                    {
+                        value |= uint64_t{byte & 0x7fu} << shift;
+                    }
+                    shift += 7u;
+                    if ((byte & 0x80u) == 0u || !ok)
+                    {
+                        return value;
+                    }
+                }
+            }
+
+            int64_t read_sleb() noexcept
+            {
+                auto value = int64_t{0};
+                auto shift = 0u;
+                auto byte  = uint8_t{0u};
+                do
+                {
+                    byte = read<uint8_t>();
+                    if (shift < 64u)
+                    {
+                        value |= static_cast<int64_t>(uint64_t{byte & 0x7fu} << shift);
+                    }
+                    shift += 7u;
+                }
+                while ((byte & 0x80u) != 0u && ok);
+
+                if (shift < 64u && (byte & 0x40u) != 0u)
+                {
+                    value |= -(int64_t{1} << shift);
+                }
+                return value;
+            }
+
+            uint64_t read_offset(bool dwarf64) noexcept
+            {
+                return dwarf64 ? read<uint64_t>() : read<uint32_t>();
+            }
+
+            uint64_t read_address(uint8_t size) noexcept
+            {
+                return size == 4u ? read<uint32_t>() : read<uint64_t>();
+            }
+
+            std::string_view read_string() noexcept
+            {
+                const auto end = data.find('\0', pos);
+                if (end == std::string_view::npos)
+                {
+                    ok  = false;
+                    pos = data.size();
+                    return {};
+                }
+                auto result = data.substr(pos, end - pos);
+                pos = end + 1u;
+                return result;
+            }
+
+        private:
+            std::string_view data;
+            size_t           pos = 0u;
+            bool             ok  = true;
+        };
+
+        std::string_view get_string(std::string_view table, uint64_t offset) noexcept
+        {
+            if (offset >= table.size())
+            {
+                return {};
+            }
+            const auto rest = table.substr(offset);
+            return rest.substr(0u, rest.find('\0'));
+        }
+
+        //! Strings of the line table header.
+        struct DwarfStrings
+        {
+            std::string_view debug_str;
+            std::string_view debug_line_str;
+            bool             dwarf64 = false;
+        };
+
+        //! Read an attribute of a DWARF 5 directory or file entry.
+        //!
+        //! @returns false if the form is not known
+        bool read_form(DwarfReader& reader, uint64_t form, const DwarfStrings& strings, std::string_view& text, uint64_t& value) noexcept
+        {
+            switch (form)
+            {
+                case DW_FORM_string:
+                    text = reader.read_string();
+                    return true;
+                case DW_FORM_strp:
+                    text = get_string(strings.debug_str, reader.read_offset(strings.dwarf64));
+                    return true;
+                case DW_FORM_line_strp:
+                    text = get_string(strings.debug_line_str, reader.read_offset(strings.dwarf64));
+                    return true;
+                case DW_FORM_udata:
+                    value = reader.read_uleb();
+                    return true;
+                case DW_FORM_data1:
+                    value = reader.read<uint8_t>();
+                    return true;
+                case DW_FORM_data2:
+                    value = reader.read<uint16_t>();
+                    return true;
+                case DW_FORM_data4:
+                    value = reader.read<uint32_t>();
+                    return true;
+                case DW_FORM_data8:
+                    value = reader.read<uint64_t>();
+                    return true;
+                case DW_FORM_data16:
+                    reader.skip(16u);
+                    return true;
+                case DW_FORM_block:
+                    reader.skip(reader.read_uleb());
+                    return true;
+                case DW_FORM_block1:
+                    reader.skip(reader.read<uint8_t>());
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        //! Read the directory or file entries of a DWARF 5 line table header.
+        //!
+        //! @returns false if the entries use an unknown form
+        bool read_entries(DwarfReader& reader, const DwarfStrings& strings, std::vector<std::pair<std::string_view, uint64_t>>& entries) noexcept
+        {
+            auto formats = std::vector<std::pair<uint64_t, uint64_t>>{};
+            const auto format_count = reader.read<uint8_t>();
+            for (auto i = 0u; i < format_count; i++)
+            {
+                const auto content = reader.read_uleb();
+                const auto form    = reader.read_uleb();
+                formats.emplace_back(content, form);
+            }
+
+            const auto count = reader.read_uleb();
+            for (auto i = uint64_t{0u}; i < count && reader.good(); i++)
+            {
+                auto path      = std::string_view{};
+                auto directory = uint64_t{0u};
+                for (const auto& [content, form] : formats)
+                {
+                    auto text  = std::string_view{};
+                    auto value = uint64_t{0u};
+                    if (!read_form(reader, form, strings, text, value))
+                    {
+                        return false;
+                    }
+                    if (content == DW_LNCT_path)
+                    {
+                        path = text;
+                    }
+                    else if (content == DW_LNCT_directory_index)
+                    {
+                        directory = value;
+                    }
+                }
+                entries.emplace_back(path, directory);
+            }
+            return reader.good();
+        }
+
+        std::string join_path(std::string_view directory, std::string_view name)
+        {
+            if (name.starts_with('/') || directory.empty())
+            {
+                return std::string{name};
+            }
+            auto result = std::string{directory};
+            if (!result.ends_with('/'))
+            {
+                result += '/';
+            }
+            result += name;
+            return result;
+        }
+    }
+
+    ElfFile::ElfFile(const std::filesystem::path& file)
+    {
+        const auto fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            throw std::runtime_error(std::format("Failed to open {}.", file.string()));
+        }
+
+        struct stat info = {};
+        if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(ElfW(Ehdr))))
+        {
+            ::close(fd);
+            throw std::runtime_error(std::format("{} is not an ELF file.", file.string()));
+        }
+
+        size = static_cast<size_t>(info.st_size);
+        auto mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            throw std::runtime_error(std::format("Failed to map {}.", file.string()));
+        }
+        data = static_cast<const std::byte*>(mapping);
+
+        auto header = ElfW(Ehdr){};
+        std::memcpy(&header, data, sizeof(header));
+
+        #if __LP64__
+        constexpr auto elf_class = ELFCLASS64;
+        #else
+        constexpr auto elf_class = ELFCLASS32;
+        #endif
+
+        const auto valid = std::memcmp(header.e_ident, ELFMAG, SELFMAG) == 0 &&
+                           header.e_ident[EI_CLASS] == elf_class &&
+                           header.e_shentsize == sizeof(ElfW(Shdr)) &&
+                           header.e_shoff + uint64_t{header.e_shnum} * sizeof(ElfW(Shdr)) <= size &&
+                           header.e_shstrndx < header.e_shnum;
+        if (!valid)
+        {
+            munmap(const_cast<std::byte*>(data), size);
+            throw std::runtime_error(std::format("{} is not an ELF file of this machine.", file.string()));
+        }
+
+        auto sections = std::vector<ElfW(Shdr)>(header.e_shnum);
+        std::memcpy(sections.data(), data + header.e_shoff, sections.size() * sizeof(ElfW(Shdr)));
+
+        auto get_data = [this] (const ElfW(Shdr)& section) -> std::string_view {
+            if (section.sh_type == SHT_NOBITS || (section.sh_flags & SHF_COMPRESSED) != 0u || section.sh_offset + section.sh_size > size)
+            {
+                return {};
+            }
+            return {reinterpret_cast<const char*>(data + section.sh_offset), section.sh_size};
+        };
+
+        const auto names = get_data(sections[header.e_shstrndx]);
+
+        auto symtab         = std::string_view{};
+        auto strtab         = std::string_view{};
+        auto dynsym         = std::string_view{};
+        auto dynstr         = std::string_view{};
+        auto debug_line     = std::string_view{};
+        auto debug_str      = std::string_view{};
+        auto debug_line_str = std::string_view{};
+        for (const auto& section : sections)
+        {
+            const auto name = get_string(names, section.sh_name);
+            if (section.sh_type == SHT_SYMTAB && section.sh_link < sections.size())
+            {
+                symtab = get_data(section);
+                strtab = get_data(sections[section.sh_link]);
+            }
+            else if (section.sh_type == SHT_DYNSYM && section.sh_link < sections.size())
+            {
+                dynsym = get_data(section);
+                dynstr = get_data(sections[section.sh_link]);
+            }
+            else if (name == ".debug_line")
+            {
+                debug_line = get_data(section);
+            }
+            else if (name == ".debug_str")
+            {
+                debug_str = get_data(section);
+            }
+            else if (name == ".debug_line_str")
+            {
+                debug_line_str = get_data(section);
+            }
+        }
+
+        // stripped files only have the exported symbols
+        if (!symtab.empty())
+        {
+            load_symbols(symtab, strtab);
+        }
+        else
+        {
+            load_symbols(dynsym, dynstr);
+        }
+        load_lines(debug_line, debug_str, debug_line_str);
+    }
+
+    ElfFile::~ElfFile()
+    {
+        munmap(const_cast<std::byte*>(data), size);
+    }
+
+    const char* ElfFile::find_symbol(uint64_t address) const noexcept
+    {
+        auto i = std::upper_bound(symbols.begin(), symbols.end(), address, [] (uint64_t a, const Symbol& s) {
+            return a < s.address;
+        });
+        if (i == symbols.begin())
+        {
+            return nullptr;
+        }
+        --i;
+        if (i->size != 0u && address >= i->address + i->size)
+        {
+            return nullptr;
+        }
+        return i->name;
+    }
+
+    SourceLine ElfFile::find_line(uint64_t address) const noexcept
+    {
+        auto i = std::upper_bound(lines.begin(), lines.end(), address, [] (uint64_t a, const LineRow& r) {
+            return a < r.address;
+        });
+        if (i == lines.begin())
+        {
+            return {};
+        }
+        --i;
+        // a line of 0 marks the end of a sequence
+        if (i->line == 0u || i->file == NO_FILE)
+        {
+            return {};
+        }
+        return {files[i->file], i->line};
+    }
+
+    size_t ElfFile::get_symbol_count() const noexcept
+    {
+        return symbols.size();
+    }
+
+    bool ElfFile::has_lines() const noexcept
+    {
+        return !lines.empty();
+    }
+
+    void ElfFile::load_symbols(std::string_view symtab, std::string_view strtab)
+    {
+        const auto count = symtab.size() / sizeof(ElfW(Sym));
+        for (auto i = size_t{0u}; i < count; i++)
+        {
+            auto symbol = ElfW(Sym){};
+            std::memcpy(&symbol, symtab.data() + i * sizeof(ElfW(Sym)), sizeof(symbol));
+
+            const auto type = symbol.st_info & 0xfu;
+            if ((type != STT_FUNC && type != STT_GNU_IFUNC) || symbol.st_shndx == SHN_UNDEF || symbol.st_value == 0u || symbol.st_name >= strtab.size())
+            {
+                continue;
+            }
+            symbols.push_back({symbol.st_value, symbol.st_size, strtab.data() + symbol.st_name});
+        }
+
+        std::sort(symbols.begin(), symbols.end(), [] (const Symbol& a, const Symbol& b) {
+            return a.address < b.address;
+        });
+    }
+
+    void ElfFile::load_lines(std::string_view debug_line, std::string_view debug_str, std::string_view debug_line_str)
+    {
+        auto reader   = DwarfReader{debug_line};
+        auto sequence = std::vector<LineRow>{};
+        while (reader.remaining() > 0u && reader.good())
+        {
+            auto strings = DwarfStrings{debug_str, debug_line_str, false};
+
+            auto length = uint64_t{reader.read<uint32_t>()};
+            if (length == 0xffffffffu)
+            {
+                length          = reader.read<uint64_t>();
+                strings.dwarf64 = true;
+            }
+            if (!reader.good() || length > reader.remaining())
+            {
+                break;
+            }
+            const auto unit_end = reader.tell() + length;
+
+            const auto version = reader.read<uint16_t>();
+            if (version < 2u || version > 5u)
+            {
+                reader.seek(unit_end);
+                continue;
+            }
+
+            auto address_size = static_cast<uint8_t>(sizeof(void*));
+            if (version >= 5u)
+            {
+                address_size = reader.read<uint8_t>();
+                reader.read<uint8_t>(); // segment selector size
+            }
+
+            const auto header_length   = reader.read_offset(strings.dwarf64);
+            const auto program_start   = reader.tell() + header_length;
+            const auto min_instruction = reader.read<uint8_t>();
+            if (version >= 4u)
+            {
+                reader.read<uint8_t>(); // maximum operations per instruction, only for VLIW
+            }
+            const auto default_is_stmt = reader.read<uint8_t>();
+            const auto line_base       = reader.read<int8_t>();
+            const auto line_range      = reader.read<uint8_t>();
+            const auto opcode_base     = reader.read<uint8_t>();
+            static_cast<void>(default_is_stmt);
+
+            auto opcode_lengths = std::vector<uint8_t>{};
+            for (auto i = 1u; i < opcode_base; i++)
+            {
+                opcode_lengths.push_back(reader.read<uint8_t>());
+            }
+
+            // the file register indexes this, it maps to the files of the object
+            auto unit_files = std::vector<uint32_t>{};
+            auto add_file = [&] (std::string_view directory, std::string_view name) {
+                unit_files.push_back(static_cast<uint32_t>(files.size()));
+                files.push_back(join_path(directory, name));
+            };
+
+            auto directories = std::vector<std::string_view>{};
+            if (version < 5u)
+            {
+                // directory 0 is the compilation directory, it is only known to .debug_info
+                directories.emplace_back();
+                for (auto dir = reader.read_string(); !dir.empty(); dir = reader.read_string())
+                {
+                    directories.push_back(dir);
+                }
+
+                // files count from 1
+                unit_files.push_back(NO_FILE);
+                for (auto name = reader.read_string(); !name.empty(); name = reader.read_string())
+                {
+                    const auto dir = reader.read_uleb();
+                    reader.read_uleb(); // modification time
+                    reader.read_uleb(); // size
+                    add_file(dir < directories.size() ? directories[dir] : std::string_view{}, name);
+                }
+            }
+            else
+            {
+                auto entries = std::vector<std::pair<std::string_view, uint64_t>>{};
+                if (!read_entries(reader, strings, entries))
+                {
+                    reader.seek(unit_end);
+                    continue;
+                }
+                for (const auto& entry : entries)
+                {
+                    directories.push_back(entry.first);
+                }
+
+                entries.clear();
+                if (!read_entries(reader, strings, entries))
+                {
+                    reader.seek(unit_end);
+                    continue;
+                }
+                for (const auto& [name, dir] : entries)
+                {
+                    add_file(dir < directories.size() ? directories[dir] : std::string_view{}, name);
+                }
+            }
+
+            if (!reader.good() || line_range == 0u)
+            {
+                reader.seek(unit_end);
+                continue;
+            }
+            reader.seek(program_start);
+
+            auto address = uint64_t{0u};
+            auto file    = uint64_t{1u};
+            auto line    = int64_t{1};
+
+            auto emit = [&] () {
+                const auto index = file < unit_files.size() ? unit_files[file] : NO_FILE;
+                sequence.push_back({address, index, static_cast<uint32_t>(std::max(line, int64_t{0}))});
+            };
+
+            sequence.clear();
+            while (reader.tell() < unit_end && reader.good())
+            {
+                const auto opcode = reader.read<uint8_t>();
+                if (opcode >= opcode_base)
+                {
+                    const auto adjusted = static_cast<uint8_t>(opcode - opcode_base);
+                    address += static_cast<uint64_t>(adjusted / line_range) * min_instruction;
+                    line    += line_base + adjusted % line_range;
+                    emit();
+                }
+                else if (opcode == 0u)
+                {
+                    const auto length = reader.read_uleb();
+                    const auto start  = reader.tell();
+                    const auto sub    = reader.read<uint8_t>();
+                    if (sub == DW_LNE_end_sequence)
+                    {
+                        // code of functions the linker dropped ends up at 0
+                        if (!sequence.empty() && sequence.front().address != 0u)
+                        {
+                            lines.insert(lines.end(), sequence.begin(), sequence.end());
+                            lines.push_back({address, NO_FILE, 0u});
+                        }
+                        sequence.clear();
+                        address = 0u;
+                        file    = 1u;
+                        line    = 1;
+                    }
+                    else if (sub == DW_LNE_set_address)
+                    {
+                        address = reader.read_address(address_size);
+                    }
+                    else if (sub == DW_LNE_define_file)
+                    {
+                        const auto name = reader.read_string();
+                        const auto dir  = reader.read_uleb();
+                        add_file(dir < directories.size() ? directories[dir] : std::string_view{}, name);
+                    }
+                    reader.seek(start + length);
+                }
+                else if (opcode == DW_LNS_copy)
+                {
+                    emit();
+                }
+                else if (opcode == DW_LNS_advance_pc)
+                {
+                    address += reader.read_uleb() * min_instruction;
+                }
+                else if (opcode == DW_LNS_advance_line)
+                {
+                    line += reader.read_sleb();
+                }
+                else if (opcode == DW_LNS_set_file)
+                {
+                    file = reader.read_uleb();
+                }
+                else if (opcode == DW_LNS_const_add_pc)
+                {
+                    address += static_cast<uint64_t>((255u - opcode_base) / line_range) * min_instruction;
+                }
+                else if (opcode == DW_LNS_fixed_advance_pc)
+                {
+                    address += reader.read<uint16_t>();
+                }
+                else
+                {
+                    // other standard opcodes only change registers we don't track
+                    for (auto i = 0u; i < opcode_lengths[opcode - 1u]; i++)
+                    {
+                        reader.read_uleb();
+                    }
+                }
+            }
+            reader.seek(unit_end);
+        }
+
+        // at equal addresses the end of a sequence goes before the start of the next
+        std::stable_sort(lines.begin(), lines.end(), [] (const LineRow& a, const LineRow& b) {
+            return a.address != b.address ? a.address < b.address : a.line < b.line;
+        });
+    }
+}
+
+#endif
@@ -0,0 +1,105 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#ifdef __linux__
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "defines.h"
+#include "utils.h"
+
+namespace ice
+{
+    //! Source Line
+    struct SourceLine
+    {
+        std::string_view file;
+        unsigned int     line = 0u;
+    };
+
+    //! ELF File
+    //!
+    //! The symbols and DWARF line table of an ELF file, used to resolve
+    //! stack traces on Linux. The file is mapped into memory for the
+    //! lifetime of the object and names point into the mapping.
+    //!
+    //! Addresses are file addresses, subtract the load bias of the module
+    //! from runtime addresses. Compressed debug sections are not supported.
+    class ICE_EXPORT ElfFile : private non_copyable
+    {
+    public:
+        //! Load ELF File
+        //!
+        //! @throws std::runtime_error if the file can't be read or is not an
+        //! ELF file of this machine
+        ElfFile(const std::filesystem::path& file);
+        ~ElfFile();
+
+        //! Find the function that contains an address.
+        //!
+        //! @returns the mangled name or nullptr
+        [[nodiscard]] const char* find_symbol(uint64_t address) const noexcept;
+
+        //! Find the source line of an address.
+        //!
+        //! @returns a line of 0 if the address is not covered
+        [[nodiscard]] SourceLine find_line(uint64_t address) const noexcept;
+
+        //! Get the number of function symbols.
+        [[nodiscard]] size_t get_symbol_count() const noexcept;
+
+        //! Check if the file has line information.
+        [[nodiscard]] bool has_lines() const noexcept;
+
+    private:
+        struct Symbol
+        {
+            uint64_t    address;
+            uint64_t    size;
+            const char* name;
+        };
+
+        struct LineRow
+        {
+            uint64_t address;
+            uint32_t file;
+            uint32_t line;
+        };
+
+        const std::byte*         data = nullptr;
+        size_t                   size = 0u;
+        std::vector<Symbol>      symbols;
+        std::vector<LineRow>     lines;
+        std::vector<std::string> files;
+
+        void load_symbols(std::string_view symtab, std::string_view strtab);
+        void load_lines(std::string_view debug_line, std::string_view debug_str, std::string_view debug_line_str);
+    };
+}
+
+#endif
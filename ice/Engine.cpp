@@ -21,24 +21,80 @@
 
 #include "Engine.h"
 
+#include <array>
+#include <sstream>
+
 #include <SDL2/SDL.h>
 
 namespace ice
 {
-    Engine::Engine()
+    // Nothing in the engine handles these, don't let SDL queue them.
+    constexpr auto unused_events = std::array<Uint32, 18>{
+        SDL_JOYAXISMOTION, SDL_JOYBALLMOTION, SDL_JOYHATMOTION, SDL_JOYBUTTONDOWN, SDL_JOYBUTTONUP,
+        SDL_CONTROLLERAXISMOTION, SDL_CONTROLLERBUTTONDOWN, SDL_CONTROLLERBUTTONUP, SDL_CONTROLLERTOUCHPADMOTION, SDL_CONTROLLERSENSORUPDATE,
+        SDL_FINGERDOWN, SDL_FINGERUP, SDL_FINGERMOTION,
+        SDL_DOLLARGESTURE, SDL_DOLLARRECORD, SDL_MULTIGESTURE,
+        SDL_SENSORUPDATE, SDL_TEXTEDITING
+    };
+
+    bool is_input_event(Uint32 type) noexcept
+    {
+        switch (type)
+        {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+        case SDL_TEXTINPUT:
+        case SDL_MOUSEMOTION:
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+        case SDL_MOUSEWHEEL:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    Engine::Engine(EngineMode mode)
     {
-        auto r = SDL_Init(SDL_INIT_VIDEO|SDL_INIT_EVENTS);
+        const auto flags = mode == EngineMode::HEADLESS ? SDL_INIT_EVENTS : SDL_INIT_VIDEO|SDL_INIT_EVENTS;
+        auto r = SDL_Init(flags);
         if (r < 0) {
             throw std::runtime_error("Failed to init SDL.");
         }
 
-        window = std::make_unique<Window>(glm::uvec2(800, 600), WindowMode::STATIC, "Ice Engine");
+        for (auto type : unused_events)
+        {
+            events.set_enabled(type, false);
+        }
+
+        wake_event = SDL_RegisterEvents(1);
+        if (wake_event == static_cast<Uint32>(-1))
+        {
+            throw std::runtime_error("Failed to register SDL event.");
+        }
+
+        if (mode == EngineMode::WINDOWED)
+        {
+            window = std::make_unique<Window>(glm::uvec2(800, 600), WindowMode::STATIC, "Ice Engine");
+        }
+        keyboard = std::make_unique<Keyboard>();
+        mouse    = std::make_unique<Mouse>();
+
+        input.attach(*keyboard, *mouse);
 
+        Profiler::get().set_thread_name("main");
     }
 
     Engine::~Engine()
     {
-        window = nullptr;
+        // jobs in flight use the counter, the world and the window, which go before the job system
+        jobs.wait(update_jobs);
+
+        renderer = nullptr;
+        input.detach();
+        mouse    = nullptr;
+        keyboard = nullptr;
+        window   = nullptr;
 
         SDL_Quit();
     }
@@ -51,72 +107,486 @@ namespace ice
     void Engine::run()
     {
         running = true;
+        timestep.reset();
+        limiter.reset();
+
+        if (render_thread && window)
+        {
+            window->release_current();
+            renderer = std::make_unique<RenderThread>(
+                [this] (FramePacket& packet) { window->draw(packet); },
+                [this] () { window->make_current(); },
+                [this] () { window->release_current(); });
+        }
+        auto stop_renderer = cleanup([this] () {
+            if (renderer)
+            {
+                renderer = nullptr;
+                window->make_current();
+            }
+        });
+
         while (running)
         {
             tick();
         }
+
+        if (dump_frame_stats)
+        {
+            auto output = std::stringstream{};
+            output << frame_stats;
+            ICE_INFO(LOG_ENGINE, "{}", output.str());
+        }
     }
 
     void Engine::stop()
     {
         running = false;
+        wake();
+    }
+
+    void Engine::set_update_rate(unsigned int value) noexcept
+    {
+        timestep.set_rate(value);
+    }
+
+    unsigned int Engine::get_update_rate() const noexcept
+    {
+        return timestep.get_rate();
+    }
+
+    void Engine::set_max_updates(unsigned int value) noexcept
+    {
+        timestep.set_max_steps(value);
+    }
+
+    unsigned int Engine::get_max_updates() const noexcept
+    {
+        return timestep.get_max_steps();
+    }
+
+    void Engine::set_clock(const Clock& value) noexcept
+    {
+        clock = value;
+        if (!player)
+        {
+            timestep.set_clock(value);
+        }
+        tasks.set_clock(value);
+    }
+
+    void Engine::set_frame_rate_limit(unsigned int value) noexcept
+    {
+        limiter.set_rate(value);
+    }
+
+    unsigned int Engine::get_frame_rate_limit() const noexcept
+    {
+        return limiter.get_rate();
+    }
+
+    void Engine::set_idle_mode(bool value) noexcept
+    {
+        idle_mode = value;
+        redraw    = true;
+    }
+
+    bool Engine::get_idle_mode() const noexcept
+    {
+        return idle_mode;
+    }
+
+    void Engine::set_idle_timeout(std::chrono::milliseconds value) noexcept
+    {
+        idle_timeout = value;
+    }
+
+    std::chrono::milliseconds Engine::get_idle_timeout() const noexcept
+    {
+        return idle_timeout;
+    }
+
+    void Engine::request_redraw() noexcept
+    {
+        if (!redraw.exchange(true))
+        {
+            wake();
+        }
+    }
+
+    void Engine::set_render_thread(bool value) noexcept
+    {
+        render_thread = value;
+    }
+
+    bool Engine::get_render_thread() const noexcept
+    {
+        return render_thread;
+    }
+
+    FramePacket& Engine::get_frame_packet() noexcept
+    {
+        return frame_packet;
+    }
+
+    uint64_t Engine::get_frame() const noexcept
+    {
+        return frame;
+    }
+
+    float Engine::get_alpha() const noexcept
+    {
+        return timestep.get_alpha();
+    }
+
+    bool Engine::is_headless() const noexcept
+    {
+        return window == nullptr;
+    }
+
+    Window& Engine::get_window() noexcept
+    {
+        check(window != nullptr);
+        return *window;
+    }
+
+    Keyboard& Engine::get_keyboard() noexcept
+    {
+        check(keyboard != nullptr);
+        return *keyboard;
+    }
+
+    Mouse& Engine::get_mouse() noexcept
+    {
+        check(mouse != nullptr);
+        return *mouse;
+    }
+
+    InputMap& Engine::get_input_map() noexcept
+    {
+        return input;
+    }
+
+    void Engine::start_recording(const std::filesystem::path& file)
+    {
+        recorder = std::make_unique<InputRecorder>(file);
+        // the replay starts with an empty accumulator
+        timestep.reset();
+    }
+
+    void Engine::stop_recording() noexcept
+    {
+        recorder = nullptr;
+    }
+
+    bool Engine::is_recording() const noexcept
+    {
+        return recorder != nullptr;
+    }
+
+    void Engine::start_replay(const std::filesystem::path& file, bool stop_at_end)
+    {
+        player            = std::make_unique<InputPlayer>(file);
+        stop_after_replay = stop_at_end;
+
+        replay_time = FixedTimestep::time_point{};
+        timestep.set_clock([this] () { return replay_time; });
+    }
+
+    void Engine::stop_replay() noexcept
+    {
+        if (player)
+        {
+            player = nullptr;
+            timestep.set_clock(clock);
+        }
+    }
+
+    bool Engine::is_replaying() const noexcept
+    {
+        return player != nullptr;
+    }
+
+    std::shared_ptr<FrameCapture> Engine::start_capture(const std::filesystem::path& file, const CaptureSettings& settings)
+    {
+        auto capture = std::make_shared<FrameCapture>(file, settings);
+        get_window().set_capture(capture);
+        return capture;
+    }
+
+    void Engine::stop_capture() noexcept
+    {
+        if (window)
+        {
+            window->set_capture(nullptr);
+        }
+    }
+
+    bool Engine::is_capturing() const noexcept
+    {
+        return window && window->get_capture() != nullptr;
+    }
+
+    FrameStats& Engine::get_frame_stats() noexcept
+    {
+        return frame_stats;
+    }
+
+    void Engine::set_dump_frame_stats(bool value) noexcept
+    {
+        dump_frame_stats = value;
+    }
+
+    bool Engine::get_dump_frame_stats() const noexcept
+    {
+        return dump_frame_stats;
+    }
+
+    EventPump& Engine::get_event_pump() noexcept
+    {
+        return events;
+    }
+
+    World& Engine::get_world() noexcept
+    {
+        return world;
+    }
+
+    SystemScheduler& Engine::get_systems() noexcept
+    {
+        return systems;
+    }
+
+    JobSystem& Engine::get_job_system() noexcept
+    {
+        return jobs;
+    }
+
+    JobCounter& Engine::get_update_jobs() noexcept
+    {
+        return update_jobs;
+    }
+
+    TaskScheduler& Engine::get_task_scheduler() noexcept
+    {
+        return tasks;
+    }
+
+    Signal<float>& Engine::get_update_signal() noexcept
+    {
+        return update_signal;
+    }
+
+    Connection Engine::on_update(const Delegate<void (float)>& cb) noexcept
+    {
+        return update_signal.connect(cb);
     }
 
     void Engine::tick()
     {
+        Profiler::get().begin_frame();
+        ICE_PROFILE_ZONE();
+        const auto tick_start = std::chrono::steady_clock::now();
+
+        // input edges only last for one frame
+        if (keyboard)
+        {
+            keyboard->begin_frame();
+        }
+        if (mouse)
+        {
+            mouse->begin_frame();
+        }
+        input.begin_frame();
+
+        if (idle_mode)
+        {
+            wait_events();
+        }
+
+        const auto events_start = std::chrono::steady_clock::now();
         route_events();
-        if (window)
+        const auto update_start = std::chrono::steady_clock::now();
+        update();
+        {
+            ICE_PROFILE_ZONE_NAMED("TaskScheduler::run");
+            tasks.run();
+        }
+        const auto update_end = std::chrono::steady_clock::now();
+        frame_stats.add(FramePhase::EVENTS, update_start - events_start);
+        frame_stats.add(FramePhase::UPDATE, update_end - update_start);
+
+        frame_packet.set_frame(frame);
+        frame_packet.set_alpha(timestep.get_alpha());
+
+        const auto draw = !idle_mode || redraw.exchange(false);
+        if (window && draw && renderer)
+        {
+            ICE_PROFILE_ZONE_NAMED("RenderThread::submit");
+            renderer->submit(frame_packet);
+        }
+        else if (window && draw)
+        {
+            window->draw(frame_packet);
+            frame_packet.clear();
+        }
+        else
         {
-            window->draw();
+            frame_packet.clear();
         }
+        if (window && draw)
+        {
+            frame_stats.add(FramePhase::DRAW, window->get_draw_time());
+            frame_stats.add(FramePhase::SWAP, window->get_swap_time());
+        }
+        frame++;
+
+        if (recorder)
+        {
+            recorder->end_frame();
+        }
+        if (player)
+        {
+            player->end_frame();
+            if (player->is_done())
+            {
+                stop_replay();
+                if (stop_after_replay)
+                {
+                    stop();
+                }
+            }
+        }
+
+        {
+            ICE_PROFILE_ZONE_NAMED("FrameLimiter::wait");
+            limiter.wait();
+        }
+
+        frame_stats.add(FramePhase::FRAME, std::chrono::steady_clock::now() - tick_start);
+        frame_stats.end_frame();
     }
 
-    void Engine::route_events()
+    void Engine::update()
     {
+        ICE_PROFILE_ZONE();
+        if (player)
+        {
+            replay_time += player->get_elapsed();
+        }
+        const auto steps = timestep.advance();
+        const auto dt    = timestep.get_step_seconds();
+        if (recorder)
+        {
+            recorder->record_elapsed(timestep.get_elapsed());
+        }
+        for (auto i = 0u; i < steps; i++)
+        {
+            update_signal.emit(dt);
+            // the systems run in parallel by their declared access, update jobs know nothing of it
+            jobs.wait(update_jobs);
+            systems.run(jobs, world, dt);
+        }
+    }
+
+    void Engine::wait_events()
+    {
+        ICE_PROFILE_ZONE();
+        if (redraw || !running || player)
+        {
+            return;
+        }
+
         SDL_Event event;
+        if (SDL_WaitEventTimeout(&event, static_cast<int>(idle_timeout.count())))
+        {
+            route_event(event);
+        }
+    }
 
-        while (SDL_PollEvent(&event))
+    void Engine::route_events()
+    {
+        ICE_PROFILE_ZONE();
+        commands.run();
+
+        for (auto& event : events.pump())
         {
-            switch (event.type)
+            // during a replay only the recorded input counts
+            if (player && is_input_event(event.type))
             {
-                case SDL_QUIT:
-                    stop();
-                    break;
-
-                case SDL_WINDOWEVENT_RESIZED:
-                case SDL_WINDOWEVENT_SIZE_CHANGED:
-                case SDL_WINDOWEVENT_CLOSE:
-                    if (window)
-                    {
-                        window->handle_event(event);
-                    }
-
-                    break;
-
-                case SDL_KEYDOWN:
-                case SDL_KEYUP:
-                case SDL_TEXTINPUT:
-                case SDL_TEXTEDITING:
-                    if (keyboard)
-                    {
-                        keyboard->handle_event(event);
-                    }
-                    break;
-
-                case SDL_MOUSEBUTTONDOWN:
-                case SDL_MOUSEBUTTONUP:
-                case SDL_MOUSEMOTION:
-                    if (mouse)
-                    {
-                        mouse->handle_event(event);
-                    }
-
-                    break;
-
-                default:
-                    /* stfu */
-                    break;
+                continue;
             }
+            route_event(event);
+        }
+
+        if (player)
+        {
+            for (auto& event : player->get_events())
+            {
+                route_event(event);
+            }
+        }
+    }
+
+    void Engine::route_event(SDL_Event& event)
+    {
+        if (event.type == wake_event)
+        {
+            return;
+        }
+
+        // any input may change what is on screen
+        redraw = true;
+
+        if (recorder)
+        {
+            recorder->record(event);
         }
+
+        switch (event.type)
+        {
+            case SDL_QUIT:
+                stop();
+                break;
+
+            case SDL_WINDOWEVENT:
+                if (window)
+                {
+                    window->handle_event(event);
+                }
+
+                break;
+
+            case SDL_KEYDOWN:
+            case SDL_KEYUP:
+            case SDL_TEXTINPUT:
+                if (keyboard)
+                {
+                    keyboard->handle_event(event);
+                }
+                break;
+
+            case SDL_MOUSEBUTTONDOWN:
+            case SDL_MOUSEBUTTONUP:
+            case SDL_MOUSEMOTION:
+            case SDL_MOUSEWHEEL:
+                if (mouse)
+                {
+                    mouse->handle_event(event);
+                }
+
+                break;
+
+            default:
+                /* stfu */
+                break;
+        }
+    }
+
+    void Engine::wake() noexcept
+    {
+        SDL_Event event = {};
+        event.type = wake_event;
+        SDL_PushEvent(&event);
     }
 }
@@ -25,12 +25,38 @@
 
 #include "defines.h"
 #include "debug.h"
+#include "Signal.h"
 #include "Window.h"
 #include "Keyboard.h"
 #include "Mouse.h"
+#include "InputMap.h"
+#include "InputRecording.h"
+#include "FramePacket.h"
+#include "RenderThread.h"
+#include "FixedTimestep.h"
+#include "FrameLimiter.h"
+#include "JobSystem.h"
+#include "TaskScheduler.h"
+#include "World.h"
+#include "SystemScheduler.h"
+#include "CommandQueue.h"
+#include "EventPump.h"
+#include "Profiler.h"
+#include "FrameStats.h"
+
+union SDL_Event;
 
 namespace ice
 {
+    //! Engine Mode
+    enum class EngineMode
+    {
+        //! Open a window with an OpenGL context.
+        WINDOWED,
+        //! Run without window, OpenGL context and SDL video.
+        HEADLESS
+    };
+
     //! Engine
     //!
     //! The Engine class ties all bits of the ice engine together.
@@ -38,7 +64,12 @@ namespace ice
     {
     public:
         //! Construct Engine
-        Engine();
+        //!
+        //! In headless mode only the SDL event subsystem is initialized. The
+        //! tick loop, timing, input and events pushed with SDL_PushEvent work
+        //! as usual, but nothing is drawn. This is meant for servers and
+        //! tests on machines without a GPU.
+        Engine(EngineMode mode = EngineMode::WINDOWED);
 
         //! Destreuct Engine
         ~Engine();
@@ -54,18 +85,271 @@ namespace ice
         //! Stop engine execution.
         void stop();
 
+        //! Post a command to run on the engine thread.
+        //!
+        //! This function may be called from any thread. The command is run
+        //! at the start of the next tick, before the events are routed. The
+        //! command is stored without allocating and must therefore be small.
+        //!
+        //! @returns false if the command queue is full
+        template <typename Fun>
+        bool post(Fun&& fun) noexcept;
+
+        //! Set the simulation update rate in Hz.
+        //!
+        //! When the rate is not 0, the update signal is emitted at a fixed rate
+        //! independent of the frame rate. With a rate of 0 the update signal
+        //! is emitted once per frame with the elapsed time.
+        void set_update_rate(unsigned int value) noexcept;
+        //! Get the simulation update rate in Hz.
+        [[nodiscard]] unsigned int get_update_rate() const noexcept;
+
+        //! Set the maximum number of updates run per frame.
+        //!
+        //! When a frame takes too long the simulation will only catch up to
+        //! this number of steps and drop the remaining time.
+        void set_max_updates(unsigned int value) noexcept;
+        //! Get the maximum number of updates run per frame.
+        [[nodiscard]] unsigned int get_max_updates() const noexcept;
+
+        //! Replace the clock that drives the engine timing.
+        void set_clock(const Clock& value) noexcept;
+
+        //! Set the frame rate limit in Hz.
+        //!
+        //! A limit of 0 lets the engine run as fast as it can.
+        void set_frame_rate_limit(unsigned int value) noexcept;
+        //! Get the frame rate limit in Hz.
+        [[nodiscard]] unsigned int get_frame_rate_limit() const noexcept;
+
+        //! Enable or disable idle mode.
+        //!
+        //! In idle mode the engine blocks until input arrives or a redraw is
+        //! requested and only draws a frame when something happened.
+        void set_idle_mode(bool value) noexcept;
+        //! Check if idle mode is enabled.
+        [[nodiscard]] bool get_idle_mode() const noexcept;
+
+        //! Set the maximum time the engine blocks in idle mode.
+        //!
+        //! The engine wakes up at least this often to run updates.
+        void set_idle_timeout(std::chrono::milliseconds value) noexcept;
+        //! Get the maximum time the engine blocks in idle mode.
+        [[nodiscard]] std::chrono::milliseconds get_idle_timeout() const noexcept;
+
+        //! Request a redraw.
+        //!
+        //! In idle mode this wakes the engine and draws the next frame. This
+        //! function may be called from any thread.
+        void request_redraw() noexcept;
+
+        //! Enable or disable the render thread.
+        //!
+        //! With the render thread the GL context is moved to its own thread
+        //! and frames are drawn there while the main thread runs the next
+        //! tick. The draw signal and the frame packet commands are then
+        //! called on the render thread. The setting takes effect when the
+        //! engine is run.
+        void set_render_thread(bool value) noexcept;
+        //! Check if the render thread is enabled.
+        [[nodiscard]] bool get_render_thread() const noexcept;
+
+        //! Get the frame packet of the current tick.
+        //!
+        //! The packet's commands are run when the frame is drawn.
+        [[nodiscard]] FramePacket& get_frame_packet() noexcept;
+
+        //! Get the number of the current frame.
+        [[nodiscard]] uint64_t get_frame() const noexcept;
+
+        //! Get the render interpolation factor.
+        //!
+        //! Draw code should use this to blend between the previous and current
+        //! simulation state.
+        [[nodiscard]] float get_alpha() const noexcept;
+
+        //! Check if the engine runs without window.
+        [[nodiscard]] bool is_headless() const noexcept;
+
+        //! Get the window.
+        //!
+        //! @warning A headless engine has no window.
+        [[nodiscard]] Window& get_window() noexcept;
+
+        //! Get the keyboard.
+        [[nodiscard]] Keyboard& get_keyboard() noexcept;
+
+        //! Get the mouse.
+        [[nodiscard]] Mouse& get_mouse() noexcept;
+
+        //! Get the input map.
+        //!
+        //! The input map is fed by the keyboard and mouse.
+        [[nodiscard]] InputMap& get_input_map() noexcept;
+
+        //! Record the routed input to a file.
+        //!
+        //! All quit, window, keyboard and mouse events routed by the engine
+        //! are written with their frame number until stop_recording is
+        //! called. The time the simulation advanced by is written for each
+        //! frame; the timestep is reset when the recording starts.
+        //!
+        //! @throws std::runtime_error if the file can't be written
+        void start_recording(const std::filesystem::path& file);
+        //! Stop recording the input.
+        void stop_recording() noexcept;
+        //! Check if the input is recorded.
+        [[nodiscard]] bool is_recording() const noexcept;
+
+        //! Replay recorded input.
+        //!
+        //! The recorded events are routed in the same frames as they were
+        //! recorded. Live keyboard and mouse input is ignored while a replay
+        //! runs. The timestep is driven by the recorded frame times instead
+        //! of the clock, so with the same update rate every frame runs the
+        //! same simulation steps as when it was recorded. This makes a
+        //! recorded session a repeatable benchmark.
+        //!
+        //! @param file the recording
+        //! @param stop_at_end stop the engine when the replay is done
+        //!
+        //! @throws std::runtime_error if the file can't be read or is corrupt
+        void start_replay(const std::filesystem::path& file, bool stop_at_end = true);
+        //! Stop replaying recorded input.
+        void stop_replay() noexcept;
+        //! Check if recorded input is replayed.
+        [[nodiscard]] bool is_replaying() const noexcept;
+
+        //! Capture the drawn frames to a file.
+        //!
+        //! The frames are read back and written on background threads, the
+        //! engine never waits for the disk. The returned capture holds the
+        //! statistics, which stay valid after stop_capture.
+        //!
+        //! @throws std::runtime_error if the file can't be written
+        std::shared_ptr<FrameCapture> start_capture(const std::filesystem::path& file, const CaptureSettings& settings = {});
+        //! Stop capturing frames.
+        void stop_capture() noexcept;
+        //! Check if frames are captured.
+        [[nodiscard]] bool is_capturing() const noexcept;
+
+        //! Get the frame time statistics.
+        //!
+        //! The engine adds the time of each tick and of its phases. With the
+        //! render thread the draw and swap times are those of the frame that
+        //! was drawn while the tick ran.
+        [[nodiscard]] FrameStats& get_frame_stats() noexcept;
+
+        //! Write the frame time statistics with trace when run returns.
+        void set_dump_frame_stats(bool value) noexcept;
+        //! Check if the frame time statistics are written when run returns.
+        [[nodiscard]] bool get_dump_frame_stats() const noexcept;
+
+        //! Get the event pump.
+        //!
+        //! The pump's statistics hold the events per frame and the time spent
+        //! pumping them.
+        [[nodiscard]] EventPump& get_event_pump() noexcept;
+
+        //! Get the world holding the entities and components.
+        [[nodiscard]] World& get_world() noexcept;
+
+        //! Get the systems run on each update step.
+        //!
+        //! The systems are run on the job system after the update signal was
+        //! emitted.
+        [[nodiscard]] SystemScheduler& get_systems() noexcept;
+
+        //! Get the engine's job system.
+        [[nodiscard]] JobSystem& get_job_system() noexcept;
+
+        //! Get the update job counter.
+        //!
+        //! Jobs scheduled with this counter by the update signal are completed
+        //! before the ECS systems of the step run. While waiting, the main
+        //! thread helps running jobs.
+        [[nodiscard]] JobCounter& get_update_jobs() noexcept;
+
+        //! Get the engine's task scheduler.
+        //!
+        //! Queued tasks are run each frame after the updates within the
+        //! scheduler's time budget.
+        [[nodiscard]] TaskScheduler& get_task_scheduler() noexcept;
+
+        //! Update Signal
+        //!
+        //! The update signal is emitted with the step time in seconds.
+        //!
+        //! @{
+        Signal<float>& get_update_signal() noexcept;
+        Connection on_update(const Delegate<void (float)>& cb) noexcept;
+        //! @}
+
     protected:
         //! Single engine tick.
         void tick();
 
+        //! Run the simulation updates that are due.
+        void update();
+
     private:
-        CrashHandler debug_handler;
+        CrashHandler      debug_handler;
         std::atomic<bool> running = false;
 
+        CommandQueue    commands;
+        EventPump       events;
+        InputMap        input;
+        Clock           clock = std::chrono::steady_clock::now;
+        FixedTimestep   timestep{0u};
+        FrameLimiter    limiter;
+        JobSystem       jobs;
+        JobCounter      update_jobs;
+        TaskScheduler   tasks;
+        World           world;
+        SystemScheduler systems;
+
+        std::atomic<bool>         idle_mode    = false;
+        std::chrono::milliseconds idle_timeout = std::chrono::milliseconds(100);
+        std::atomic<bool>         redraw       = true;
+        unsigned int              wake_event   = 0u;
+
+        FrameStats frame_stats;
+        bool       dump_frame_stats = false;
+
+        bool                          render_thread = false;
+        uint64_t                      frame         = 0u;
+        FramePacket                   frame_packet;
+        std::unique_ptr<RenderThread> renderer;
+
+        std::unique_ptr<InputRecorder> recorder;
+        std::unique_ptr<InputPlayer>   player;
+        FixedTimestep::time_point      replay_time;
+        bool                           stop_after_replay = true;
+
+        Signal<float> update_signal;
+
         std::unique_ptr<Window>   window;
         std::unique_ptr<Mouse>    mouse;
         std::unique_ptr<Keyboard> keyboard;
 
+        void wait_events();
         void route_events();
+        void route_event(SDL_Event& event);
+        void wake() noexcept;
     };
+
+    template <typename Fun>
+    bool Engine::post(Fun&& fun) noexcept
+    {
+        if (!commands.push(std::forward<Fun>(fun)))
+        {
+            return false;
+        }
+
+        if (idle_mode)
+        {
+            wake();
+        }
+        return true;
+    }
 }
@@ -0,0 +1,140 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "EventPump.h"
+
+#include <algorithm>
+
+#include <SDL2/SDL.h>
+
+#include "debug.h"
+
+namespace ice
+{
+    EventPump::EventPump(size_t batch_size)
+    : buffer(std::make_unique<SDL_Event[]>(batch_size)), capacity(batch_size)
+    {
+        check(batch_size > 0u);
+    }
+
+    EventPump::~EventPump() = default;
+
+    void EventPump::set_coalesce_motion(bool value) noexcept
+    {
+        coalesce = value;
+    }
+
+    bool EventPump::get_coalesce_motion() const noexcept
+    {
+        return coalesce;
+    }
+
+    void EventPump::set_enabled(uint32_t type, bool value) noexcept
+    {
+        SDL_EventState(type, value ? SDL_ENABLE : SDL_IGNORE);
+    }
+
+    bool EventPump::is_enabled(uint32_t type) const noexcept
+    {
+        return SDL_EventState(type, SDL_QUERY) == SDL_ENABLE;
+    }
+
+    std::span<SDL_Event> EventPump::pump() noexcept
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        SDL_PumpEvents();
+
+        auto count = size_t{0u};
+        while (true)
+        {
+            if (count == capacity)
+            {
+                // A burst of events; grow the buffer, so that the next
+                // burst fits in one batch.
+                auto bigger = std::make_unique<SDL_Event[]>(capacity * 2u);
+                std::copy(buffer.get(), buffer.get() + count, bigger.get());
+                buffer   = std::move(bigger);
+                capacity = capacity * 2u;
+            }
+
+            const auto n = SDL_PeepEvents(buffer.get() + count, static_cast<int>(capacity - count), SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+            if (n <= 0)
+            {
+                break;
+            }
+
+            count += static_cast<size_t>(n);
+            if (count < capacity)
+            {
+                break;
+            }
+        }
+
+        stats = {};
+        stats.received = count;
+        if (coalesce)
+        {
+            count = coalesce_motion(count);
+        }
+        stats.events    = count;
+        stats.coalesced = stats.received - count;
+        stats.pump_time = std::chrono::steady_clock::now() - start;
+
+        return {buffer.get(), count};
+    }
+
+    const EventStats& EventPump::get_stats() const noexcept
+    {
+        return stats;
+    }
+
+    size_t EventPump::coalesce_motion(size_t count) noexcept
+    {
+        if (count == 0u)
+        {
+            return 0u;
+        }
+
+        auto out = size_t{0u};
+        for (auto i = size_t{1u}; i < count; i++)
+        {
+            auto& last = buffer[out];
+            const auto& event = buffer[i];
+            if (last.type == SDL_MOUSEMOTION && event.type == SDL_MOUSEMOTION &&
+                last.motion.which == event.motion.which && last.motion.windowID == event.motion.windowID)
+            {
+                last.motion.timestamp = event.motion.timestamp;
+                last.motion.state     = event.motion.state;
+                last.motion.x         = event.motion.x;
+                last.motion.y         = event.motion.y;
+                last.motion.xrel     += event.motion.xrel;
+                last.motion.yrel     += event.motion.yrel;
+            }
+            else
+            {
+                out++;
+                buffer[out] = event;
+            }
+        }
+        return out + 1u;
+    }
+}
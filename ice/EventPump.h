@@ -0,0 +1,95 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include "defines.h"
+#include "utils.h"
+
+union SDL_Event;
+
+namespace ice
+{
+    //! Event Pump Statistics
+    struct EventStats
+    {
+        //! The number of events pulled from SDL in the last pump.
+        size_t received = 0u;
+        //! The number of events left after coalescing.
+        size_t events = 0u;
+        //! The number of mouse motion events merged into others.
+        size_t coalesced = 0u;
+        //! The time spent pumping and pulling the events.
+        std::chrono::steady_clock::duration pump_time = {};
+    };
+
+    //! Event Pump
+    //!
+    //! The EventPump pulls all pending SDL events in batches with
+    //! SDL_PeepEvents into a reusable buffer. Optionally consecutive mouse
+    //! motion events are merged into one event with the summed relative
+    //! motion and the last absolute position.
+    //!
+    //! Event types that nobody handles should be disabled, so that SDL does
+    //! not queue them in the first place.
+    class ICE_EXPORT EventPump : private non_copyable
+    {
+    public:
+        //! Construct Event Pump
+        //!
+        //! @param batch_size the initial number of events pulled at once
+        EventPump(size_t batch_size = 128u);
+        ~EventPump();
+
+        //! Enable or disable merging of consecutive mouse motion events.
+        void set_coalesce_motion(bool value) noexcept;
+        //! Check if consecutive mouse motion events are merged.
+        [[nodiscard]] bool get_coalesce_motion() const noexcept;
+
+        //! Enable or disable an SDL event type.
+        //!
+        //! Disabled events are dropped by SDL and never queued.
+        void set_enabled(uint32_t type, bool value) noexcept;
+        //! Check if an SDL event type is enabled.
+        [[nodiscard]] bool is_enabled(uint32_t type) const noexcept;
+
+        //! Pull all pending events.
+        //!
+        //! The returned events stay valid until the next call to pump.
+        std::span<SDL_Event> pump() noexcept;
+
+        //! Get the statistics of the last pump.
+        [[nodiscard]] const EventStats& get_stats() const noexcept;
+
+    private:
+        std::unique_ptr<SDL_Event[]> buffer;
+        size_t                       capacity = 0u;
+        bool                         coalesce = false;
+        EventStats                   stats;
+
+        size_t coalesce_motion(size_t count) noexcept;
+    };
+}
@@ -0,0 +1,140 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "FixedTimestep.h"
+
+#include "debug.h"
+
+namespace ice
+{
+    FixedTimestep::FixedTimestep(unsigned int update_rate, const Clock& clock_func) noexcept
+    : clock(clock_func)
+    {
+        check(static_cast<bool>(clock));
+        set_rate(update_rate);
+        reset();
+    }
+
+    void FixedTimestep::set_rate(unsigned int value) noexcept
+    {
+        rate = value;
+        if (rate != 0u)
+        {
+            step = std::chrono::duration_cast<duration>(std::chrono::nanoseconds(std::chrono::seconds(1)) / rate);
+            // the step is the divisor in advance
+            check(step > duration::zero());
+        }
+        accumulator = duration::zero();
+    }
+
+    unsigned int FixedTimestep::get_rate() const noexcept
+    {
+        return rate;
+    }
+
+    void FixedTimestep::set_max_steps(unsigned int value) noexcept
+    {
+        check(value > 0u);
+        max_steps = value;
+    }
+
+    unsigned int FixedTimestep::get_max_steps() const noexcept
+    {
+        return max_steps;
+    }
+
+    void FixedTimestep::set_clock(const Clock& value) noexcept
+    {
+        check(static_cast<bool>(value));
+        clock = value;
+        reset();
+    }
+
+    void FixedTimestep::reset() noexcept
+    {
+        last        = clock();
+        elapsed     = duration::zero();
+        accumulator = duration::zero();
+        dropped     = duration::zero();
+        if (rate == 0u)
+        {
+            step = duration::zero();
+        }
+    }
+
+    unsigned int FixedTimestep::advance() noexcept
+    {
+        const auto now = clock();
+        elapsed = now - last;
+        last    = now;
+
+        if (rate == 0u)
+        {
+            step = elapsed;
+            return 1u;
+        }
+
+        accumulator += elapsed;
+
+        auto steps = static_cast<unsigned int>(accumulator / step);
+        if (steps > max_steps)
+        {
+            const auto excess = accumulator - step * max_steps;
+            // keep the fraction, so that alpha stays continuous
+            const auto remainder = accumulator % step;
+            dropped     += excess - remainder;
+            accumulator  = step * max_steps + remainder;
+            steps        = max_steps;
+        }
+
+        accumulator -= step * steps;
+        return steps;
+    }
+
+    FixedTimestep::duration FixedTimestep::get_elapsed() const noexcept
+    {
+        return elapsed;
+    }
+
+    FixedTimestep::duration FixedTimestep::get_step() const noexcept
+    {
+        return step;
+    }
+
+    float FixedTimestep::get_step_seconds() const noexcept
+    {
+        return std::chrono::duration<float>(step).count();
+    }
+
+    float FixedTimestep::get_alpha() const noexcept
+    {
+        if (rate == 0u || step == duration::zero())
+        {
+            return 1.0f;
+        }
+        return std::chrono::duration<float>(accumulator) / std::chrono::duration<float>(step);
+    }
+
+    FixedTimestep::duration FixedTimestep::get_dropped() const noexcept
+    {
+        return dropped;
+    }
+}
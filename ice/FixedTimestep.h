@@ -0,0 +1,122 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+
+#include "defines.h"
+
+namespace ice
+{
+    //! Clock used to drive the engine timing.
+    //!
+    //! The clock is a plain function returning the current time point. It can
+    //! be replaced by tests to step time manually.
+    using Clock = std::function<std::chrono::steady_clock::time_point ()>;
+
+    //! Fixed Timestep
+    //!
+    //! The FixedTimestep accumulates the elapsed wall clock time and splits it
+    //! into a number of fixed size simulation steps. The remainder that is not
+    //! yet consumed is exposed as interpolation factor between the previous
+    //! and the current simulation state.
+    //!
+    //! To prevent a slow frame from causing more steps, which in turn cause a
+    //! slower frame, the number of steps per advance is capped. Any time above
+    //! the cap is dropped.
+    //!
+    //! If the rate is 0 the timestep is variable and advance always yields
+    //! exactly one step of the elapsed time.
+    class ICE_EXPORT FixedTimestep
+    {
+    public:
+        using duration   = std::chrono::steady_clock::duration;
+        using time_point = std::chrono::steady_clock::time_point;
+
+        //! Construct Fixed Timestep
+        //!
+        //! @param update_rate the update rate in Hz or 0 for variable timestep
+        //! @param clock_func the clock to sample the time from
+        FixedTimestep(unsigned int update_rate = 60u, const Clock& clock_func = std::chrono::steady_clock::now) noexcept;
+
+        //! Set the update rate in Hz.
+        //!
+        //! A rate of 0 switches to variable timestep. The rate must not exceed
+        //! the resolution of the clock.
+        void set_rate(unsigned int value) noexcept;
+        //! Get the update rate in Hz.
+        [[nodiscard]] unsigned int get_rate() const noexcept;
+
+        //! Set the maximum number of steps per advance.
+        void set_max_steps(unsigned int value) noexcept;
+        //! Get the maximum number of steps per advance.
+        [[nodiscard]] unsigned int get_max_steps() const noexcept;
+
+        //! Replace the clock.
+        //!
+        //! This also resets the timestep.
+        void set_clock(const Clock& value) noexcept;
+
+        //! Restart the time measurement.
+        //!
+        //! Any accumulated time is discarded.
+        void reset() noexcept;
+
+        //! Sample the clock and compute the steps to run.
+        //!
+        //! @returns the number of simulation steps to run
+        [[nodiscard]] unsigned int advance() noexcept;
+
+        //! Get the time elapsed between the last two advances.
+        [[nodiscard]] duration get_elapsed() const noexcept;
+
+        //! Get the duration of one simulation step.
+        //!
+        //! In variable timestep mode this is the elapsed time of the last
+        //! advance.
+        [[nodiscard]] duration get_step() const noexcept;
+
+        //! Get the duration of one simulation step in seconds.
+        [[nodiscard]] float get_step_seconds() const noexcept;
+
+        //! Get the interpolation factor.
+        //!
+        //! The factor is in the range [0, 1) and describes how far the
+        //! rendered frame lies between the last and the next simulation step.
+        //! In variable timestep mode the factor is always 1.
+        [[nodiscard]] float get_alpha() const noexcept;
+
+        //! Get the total time dropped due to the step cap.
+        [[nodiscard]] duration get_dropped() const noexcept;
+
+    private:
+        unsigned int rate      = 60u;
+        unsigned int max_steps = 5u;
+        Clock        clock;
+        time_point   last;
+        duration     elapsed     = duration::zero();
+        duration     step        = duration::zero();
+        duration     accumulator = duration::zero();
+        duration     dropped     = duration::zero();
+    };
+}
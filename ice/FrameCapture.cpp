@@ -0,0 +1,235 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "FrameCapture.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "debug.h"
+
+namespace ice
+{
+    FrameCapture::FrameCapture(const std::filesystem::path& file, const CaptureSettings& s)
+    : settings(s), output(file, std::ios::binary)
+    {
+        check(settings.downscale > 0u);
+        check(settings.interval > 0u);
+        check(settings.queue_size > 0u);
+
+        if (!output)
+        {
+            throw std::runtime_error("Failed to open frame capture.");
+        }
+
+        thread = std::thread([this] () {
+            run();
+        });
+    }
+
+    FrameCapture::~FrameCapture()
+    {
+        {
+            auto lock = std::unique_lock<std::mutex>{mutex};
+            running = false;
+        }
+        cond.notify_all();
+        thread.join();
+    }
+
+    const CaptureSettings& FrameCapture::get_settings() const noexcept
+    {
+        return settings;
+    }
+
+    bool FrameCapture::want_frame(uint64_t frame) noexcept
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        stats.frames++;
+        if (frame % settings.interval != 0u)
+        {
+            stats.skipped++;
+            return false;
+        }
+        return true;
+    }
+
+    void FrameCapture::push(Image&& image) noexcept
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        if (queue.size() >= settings.queue_size)
+        {
+            stats.dropped_queue++;
+            return;
+        }
+        queue.push_back(std::move(image));
+        cond.notify_one();
+    }
+
+    void FrameCapture::drop_readback() noexcept
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        stats.dropped_readback++;
+    }
+
+    CaptureStats FrameCapture::get_stats() const noexcept
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        return stats;
+    }
+
+    void FrameCapture::run()
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        while (true)
+        {
+            cond.wait(lock, [this] () {
+                return !running || !queue.empty();
+            });
+            if (queue.empty())
+            {
+                return;
+            }
+
+            auto image = std::move(queue.front());
+            queue.pop_front();
+            lock.unlock();
+
+            auto result = &CaptureStats::written;
+            try
+            {
+                if (!write(image))
+                {
+                    result = &CaptureStats::dropped_size;
+                }
+            }
+            catch (const std::exception&)
+            {
+                result = &CaptureStats::failed;
+            }
+
+            lock.lock();
+            (stats.*result)++;
+        }
+    }
+
+    uint8_t clamp_byte(int value) noexcept
+    {
+        return static_cast<uint8_t>(std::clamp(value, 0, 255));
+    }
+
+    // JPEG (full range BT.601) coefficients in 8 bit fixed point
+    uint8_t rgb_to_y(int r, int g, int b) noexcept
+    {
+        return clamp_byte((77 * r + 150 * g + 29 * b + 128) >> 8);
+    }
+
+    uint8_t rgb_to_cb(int r, int g, int b) noexcept
+    {
+        return clamp_byte(((-43 * r - 85 * g + 128 * b + 128) >> 8) + 128);
+    }
+
+    uint8_t rgb_to_cr(int r, int g, int b) noexcept
+    {
+        return clamp_byte(((128 * r - 107 * g - 21 * b + 128) >> 8) + 128);
+    }
+
+    void rgba_to_yuv420(const Image& image, const glm::uvec2& size, std::vector<uint8_t>& out)
+    {
+        const auto luma   = static_cast<size_t>(size.x) * size.y;
+        const auto chroma = luma / 4u;
+        out.resize(luma + 2u * chroma);
+
+        auto y_plane  = out.data();
+        auto cb_plane = y_plane + luma;
+        auto cr_plane = cb_plane + chroma;
+
+        for (auto y = 0u; y < size.y; y++)
+        {
+            auto src = image.pixels.data() + static_cast<size_t>(y) * image.size.x * 4u;
+            for (auto x = 0u; x < size.x; x++)
+            {
+                *y_plane++ = rgb_to_y(src[x * 4u], src[x * 4u + 1u], src[x * 4u + 2u]);
+            }
+        }
+
+        for (auto y = 0u; y < size.y; y += 2u)
+        {
+            auto row0 = image.pixels.data() + static_cast<size_t>(y) * image.size.x * 4u;
+            auto row1 = row0 + image.size.x * 4u;
+            for (auto x = 0u; x < size.x; x += 2u)
+            {
+                int rgb[3];
+                for (auto c = 0u; c < 3u; c++)
+                {
+                    rgb[c] = (row0[x * 4u + c] + row0[x * 4u + 4u + c] + row1[x * 4u + c] + row1[x * 4u + 4u + c] + 2) / 4;
+                }
+                *cb_plane++ = rgb_to_cb(rgb[0], rgb[1], rgb[2]);
+                *cr_plane++ = rgb_to_cr(rgb[0], rgb[1], rgb[2]);
+            }
+        }
+    }
+
+    bool FrameCapture::write(Image& image)
+    {
+        // 4:2:0 needs even dimensions, the odd row and column are cut
+        const auto frame_size = settings.format == CaptureFormat::Y4M ? glm::uvec2{image.size.x & ~1u, image.size.y & ~1u} : image.size;
+        if (frame_size.x == 0u || frame_size.y == 0u)
+        {
+            return false;
+        }
+
+        if (size == glm::uvec2{0u, 0u})
+        {
+            size = frame_size;
+            if (settings.format == CaptureFormat::Y4M)
+            {
+                output << "YUV4MPEG2 W" << size.x << " H" << size.y << " F" << settings.frame_rate << ":" << settings.interval << " Ip A1:1 C420jpeg\n";
+            }
+        }
+
+        if (frame_size != size)
+        {
+            return false;
+        }
+
+        switch (settings.format)
+        {
+        case CaptureFormat::Y4M:
+            rgba_to_yuv420(image, size, buffer);
+            output << "FRAME\n";
+            output.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+            break;
+        case CaptureFormat::RAW:
+            output.write(reinterpret_cast<const char*>(image.pixels.data()), static_cast<std::streamsize>(image.pixels.size()));
+            break;
+        default:
+            fail("Unknown capture format.");
+        }
+
+        if (!output)
+        {
+            throw std::runtime_error("Failed to write frame capture.");
+        }
+        return true;
+    }
+}
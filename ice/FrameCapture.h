@@ -0,0 +1,149 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "defines.h"
+#include "utils.h"
+#include "FrameReadback.h"
+
+namespace ice
+{
+    //! Capture Format
+    enum class CaptureFormat
+    {
+        //! YUV4MPEG2 with 4:2:0 full range chroma, readable by most video tools.
+        Y4M,
+        //! Plain 8 bit RGBA frames, top row first, without any header.
+        RAW
+    };
+
+    //! Capture Settings
+    struct CaptureSettings
+    {
+        //! The file format.
+        CaptureFormat format = CaptureFormat::Y4M;
+        //! The rate frames are offered at; the Y4M header gets this divided
+        //! by the interval.
+        unsigned int frame_rate = 60u;
+        //! Divide the width and height by this factor on the GPU, before
+        //! the frame is read back.
+        unsigned int downscale = 1u;
+        //! Only capture every nth frame.
+        //!
+        //! The interval and downscale are fixed for the recording, they do
+        //! not adapt when the writer falls behind; Y4M has a constant frame
+        //! rate. Frames the writer can't keep up with are dropped.
+        unsigned int interval = 1u;
+        //! The number of frames that may wait for the writer.
+        size_t queue_size = 8u;
+    };
+
+    //! Capture Statistics
+    //!
+    //! Each frame the capture was offered ends up in exactly one counter
+    //! besides frames, so a recording can be checked for gaps.
+    struct CaptureStats
+    {
+        //! The number of frames offered to the capture.
+        size_t frames = 0u;
+        //! The number of frames written to the file.
+        size_t written = 0u;
+        //! The number of frames skipped by the capture interval.
+        size_t skipped = 0u;
+        //! The number of frames dropped because the readback was busy or
+        //! failed.
+        size_t dropped_readback = 0u;
+        //! The number of frames dropped because the writer fell behind.
+        size_t dropped_queue = 0u;
+        //! The number of frames dropped because their size changed.
+        size_t dropped_size = 0u;
+        //! The number of frames that could not be written to the file.
+        size_t failed = 0u;
+    };
+
+    //! Frame Capture
+    //!
+    //! The frame capture writes a stream of frames to disk on its own
+    //! thread. Frames are handed over through a bounded queue; when the
+    //! writer falls behind, new frames are dropped and counted instead of
+    //! blocking the caller. The size of the first frame sets the size of the
+    //! recording.
+    //!
+    //! The frames are usually fed by the window, see Window::set_capture.
+    class ICE_EXPORT FrameCapture : private non_copyable
+    {
+    public:
+        //! Start Capture
+        //!
+        //! @throws std::runtime_error if the file can't be written
+        FrameCapture(const std::filesystem::path& file, const CaptureSettings& settings = {});
+
+        //! Stop Capture
+        //!
+        //! Frames still in the queue are written before the file is closed.
+        ~FrameCapture();
+
+        //! Get the settings.
+        [[nodiscard]] const CaptureSettings& get_settings() const noexcept;
+
+        //! Offer a frame to the capture.
+        //!
+        //! @returns false if the frame is skipped by the interval
+        [[nodiscard]] bool want_frame(uint64_t frame) noexcept;
+
+        //! Queue a frame for writing.
+        void push(Image&& image) noexcept;
+
+        //! Count a frame that could not be read back.
+        void drop_readback() noexcept;
+
+        //! Get the statistics.
+        [[nodiscard]] CaptureStats get_stats() const noexcept;
+
+    private:
+        CaptureSettings settings;
+        std::ofstream   output;
+        glm::uvec2      size = {0u, 0u};
+
+        mutable std::mutex      mutex;
+        std::condition_variable cond;
+        std::deque<Image>       queue;
+        bool                    running = true;
+        CaptureStats            stats;
+
+        std::vector<uint8_t> buffer;
+        std::thread          thread;
+
+        void run();
+        //! @returns false if the frame does not fit the recording
+        bool write(Image& image);
+    };
+}
@@ -0,0 +1,100 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "FrameLimiter.h"
+
+#include <thread>
+
+namespace ice
+{
+    FrameLimiter::FrameLimiter(unsigned int target_rate) noexcept
+    {
+        set_rate(target_rate);
+    }
+
+    void FrameLimiter::set_rate(unsigned int value) noexcept
+    {
+        rate = value;
+        if (rate != 0u)
+        {
+            period = std::chrono::duration_cast<duration>(std::chrono::nanoseconds(std::chrono::seconds(1)) / rate);
+        }
+        else
+        {
+            period = duration::zero();
+        }
+        reset();
+    }
+
+    unsigned int FrameLimiter::get_rate() const noexcept
+    {
+        return rate;
+    }
+
+    void FrameLimiter::set_spin_threshold(duration value) noexcept
+    {
+        spin = value;
+    }
+
+    FrameLimiter::duration FrameLimiter::get_spin_threshold() const noexcept
+    {
+        return spin;
+    }
+
+    void FrameLimiter::reset() noexcept
+    {
+        next = std::chrono::steady_clock::now() + period;
+    }
+
+    void FrameLimiter::wait() noexcept
+    {
+        if (rate == 0u)
+        {
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now < next)
+        {
+            const auto remaining = next - now;
+            if (remaining > spin)
+            {
+                std::this_thread::sleep_for(remaining - spin);
+            }
+
+            do
+            {
+                std::this_thread::yield();
+                now = std::chrono::steady_clock::now();
+            }
+            while (now < next);
+        }
+
+        next += period;
+
+        // When we fell behind by more than a frame, don't try to catch up
+        // by rushing the following frames.
+        if (next < now)
+        {
+            next = now + period;
+        }
+    }
+}
@@ -0,0 +1,71 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+
+#include "defines.h"
+
+namespace ice
+{
+    //! Frame Limiter
+    //!
+    //! The FrameLimiter paces the frames to a target rate. Since the sleep
+    //! granularity of most operating systems is in the range of a millisecond
+    //! or worse, the limiter sleeps for most of the remaining frame time and
+    //! then spins for the last short stretch to hit the deadline accurately.
+    class ICE_EXPORT FrameLimiter
+    {
+    public:
+        using duration   = std::chrono::steady_clock::duration;
+        using time_point = std::chrono::steady_clock::time_point;
+
+        //! Construct Frame Limiter
+        //!
+        //! @param target_rate the target frame rate in Hz or 0 for unlimited
+        FrameLimiter(unsigned int target_rate = 0u) noexcept;
+
+        //! Set the target frame rate in Hz.
+        //!
+        //! A rate of 0 disables the limiter.
+        void set_rate(unsigned int value) noexcept;
+        //! Get the target frame rate in Hz.
+        [[nodiscard]] unsigned int get_rate() const noexcept;
+
+        //! Set the time before the deadline the limiter spins instead of sleeps.
+        void set_spin_threshold(duration value) noexcept;
+        //! Get the time before the deadline the limiter spins instead of sleeps.
+        [[nodiscard]] duration get_spin_threshold() const noexcept;
+
+        //! Restart the pacing from now.
+        void reset() noexcept;
+
+        //! Wait until the next frame is due.
+        void wait() noexcept;
+
+    private:
+        unsigned int rate   = 0u;
+        duration     period = duration::zero();
+        duration     spin   = std::chrono::milliseconds(2);
+        time_point   next;
+    };
+}
@@ -0,0 +1,85 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "FramePacket.h"
+
+#include <utility>
+
+namespace ice
+{
+    void FramePacket::add(const Delegate<void ()>& command)
+    {
+        commands.push_back(command);
+    }
+
+    RenderQueue& FramePacket::get_render_queue() noexcept
+    {
+        return queue;
+    }
+
+    size_t FramePacket::get_command_count() const noexcept
+    {
+        return commands.size();
+    }
+
+    void FramePacket::set_frame(uint64_t value) noexcept
+    {
+        frame = value;
+    }
+
+    uint64_t FramePacket::get_frame() const noexcept
+    {
+        return frame;
+    }
+
+    void FramePacket::set_alpha(float value) noexcept
+    {
+        alpha = value;
+    }
+
+    float FramePacket::get_alpha() const noexcept
+    {
+        return alpha;
+    }
+
+    void FramePacket::execute()
+    {
+        for (const auto& command : commands)
+        {
+            command();
+        }
+        queue.execute();
+    }
+
+    void FramePacket::clear() noexcept
+    {
+        commands.clear();
+        queue.clear();
+    }
+
+    void FramePacket::swap(FramePacket& other) noexcept
+    {
+        std::swap(commands, other.commands);
+        std::swap(frame, other.frame);
+        std::swap(alpha, other.alpha);
+        queue.swap(other.queue);
+    }
+}
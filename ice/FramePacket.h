@@ -0,0 +1,82 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "defines.h"
+#include "Signal.h"
+#include "RenderQueue.h"
+
+namespace ice
+{
+    //! Frame Packet
+    //!
+    //! The frame packet holds the render commands of one frame. The commands
+    //! are recorded during the tick and run when the frame is drawn, either
+    //! on the main thread or on the render thread. Commands must therefore
+    //! capture the data they draw by value instead of reading the simulation
+    //! state.
+    //!
+    //! Draw commands that should be sorted are recorded into the packet's
+    //! render queue, which is run after the plain commands.
+    class ICE_EXPORT FramePacket
+    {
+    public:
+        //! Add a render command.
+        void add(const Delegate<void ()>& command);
+
+        //! Get the render queue.
+        [[nodiscard]] RenderQueue& get_render_queue() noexcept;
+
+        //! Get the number of render commands.
+        [[nodiscard]] size_t get_command_count() const noexcept;
+
+        //! Set the frame number.
+        void set_frame(uint64_t value) noexcept;
+        //! Get the frame number.
+        [[nodiscard]] uint64_t get_frame() const noexcept;
+
+        //! Set the render interpolation factor.
+        void set_alpha(float value) noexcept;
+        //! Get the render interpolation factor.
+        [[nodiscard]] float get_alpha() const noexcept;
+
+        //! Run all render commands in order, then the render queue.
+        void execute();
+
+        //! Remove all render commands.
+        //!
+        //! The memory is kept for the next frame.
+        void clear() noexcept;
+
+        //! Swap the contents with another packet.
+        void swap(FramePacket& other) noexcept;
+
+    private:
+        std::vector<Delegate<void ()>> commands;
+        uint64_t                       frame = 0u;
+        float                          alpha = 1.0f;
+        RenderQueue                    queue;
+    };
+}
@@ -0,0 +1,365 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "FrameReadback.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengl.h>
+
+#include "debug.h"
+
+namespace ice
+{
+    template <typename Fun>
+    void load_readback_function(Fun& fun, const char* name)
+    {
+        fun = reinterpret_cast<Fun>(SDL_GL_GetProcAddress(name));
+        if (fun == nullptr)
+        {
+            throw std::runtime_error(std::string("Failed to load ") + name + ".");
+        }
+    }
+
+    ReadbackFunctions load_readback_functions()
+    {
+        auto result = ReadbackFunctions{};
+        load_readback_function(result.gen_buffers,              "glGenBuffers");
+        load_readback_function(result.delete_buffers,           "glDeleteBuffers");
+        load_readback_function(result.bind_buffer,              "glBindBuffer");
+        load_readback_function(result.buffer_data,              "glBufferData");
+        load_readback_function(result.read_pixels,              "glReadPixels");
+        load_readback_function(result.map_buffer_range,         "glMapBufferRange");
+        load_readback_function(result.unmap_buffer,             "glUnmapBuffer");
+        load_readback_function(result.fence_sync,               "glFenceSync");
+        load_readback_function(result.client_wait_sync,         "glClientWaitSync");
+        load_readback_function(result.delete_sync,              "glDeleteSync");
+        load_readback_function(result.gen_framebuffers,         "glGenFramebuffers");
+        load_readback_function(result.delete_framebuffers,      "glDeleteFramebuffers");
+        load_readback_function(result.bind_framebuffer,         "glBindFramebuffer");
+        load_readback_function(result.gen_renderbuffers,        "glGenRenderbuffers");
+        load_readback_function(result.delete_renderbuffers,     "glDeleteRenderbuffers");
+        load_readback_function(result.bind_renderbuffer,        "glBindRenderbuffer");
+        load_readback_function(result.renderbuffer_storage,     "glRenderbufferStorage");
+        load_readback_function(result.framebuffer_renderbuffer, "glFramebufferRenderbuffer");
+        load_readback_function(result.blit_framebuffer,         "glBlitFramebuffer");
+        return result;
+    }
+
+    FrameReadback::FrameReadback(const ReadbackFunctions& functions, size_t ring_size)
+    : gl(functions), slots(ring_size)
+    {
+        check(ring_size > 0u);
+
+        auto buffers = std::vector<unsigned int>(ring_size, 0u);
+        gl.gen_buffers(static_cast<int>(ring_size), buffers.data());
+        for (auto i = 0u; i < ring_size; i++)
+        {
+            slots[i].buffer = buffers[i];
+        }
+        // recycle must not allocate
+        pool.reserve(ring_size);
+
+        thread = std::thread([this] () {
+            run();
+        });
+    }
+
+    FrameReadback::~FrameReadback()
+    {
+        {
+            auto lock = std::unique_lock<std::mutex>{mutex};
+            running = false;
+        }
+        cond.notify_all();
+        thread.join();
+
+        // the readbacks the GPU did not finish yet are lost
+        for (auto i = mapped; i < pending; i++)
+        {
+            auto& slot = slots[(head + i) % slots.size()];
+            stats.dropped++;
+            if (slot.failure)
+            {
+                slot.failure();
+            }
+        }
+
+        auto buffers = std::vector<unsigned int>{};
+        for (auto& slot : slots)
+        {
+            if (slot.data != nullptr)
+            {
+                gl.bind_buffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+                gl.unmap_buffer(GL_PIXEL_PACK_BUFFER);
+            }
+            if (slot.fence != nullptr)
+            {
+                gl.delete_sync(slot.fence);
+            }
+            buffers.push_back(slot.buffer);
+        }
+        gl.bind_buffer(GL_PIXEL_PACK_BUFFER, 0u);
+        gl.delete_buffers(static_cast<int>(buffers.size()), buffers.data());
+
+        if (framebuffer != 0u)
+        {
+            gl.delete_framebuffers(1, &framebuffer);
+            gl.delete_renderbuffers(1, &renderbuffer);
+        }
+    }
+
+    bool FrameReadback::read(const glm::uvec2& size, uint64_t frame, const ReadbackCallback& callback, const ReadbackFailure& failure, unsigned int downscale)
+    {
+        check(downscale > 0u);
+        const auto target = glm::uvec2{size.x / downscale, size.y / downscale};
+
+        {
+            auto lock = std::unique_lock<std::mutex>{mutex};
+            stats.requested++;
+            if (pending == slots.size() || target.x == 0u || target.y == 0u)
+            {
+                stats.dropped++;
+                return false;
+            }
+        }
+
+        if (downscale > 1u)
+        {
+            blit_scaled(size, target);
+        }
+
+        auto& slot = slots[(head + pending) % slots.size()];
+        auto bytes = static_cast<size_t>(target.x) * target.y * 4u;
+
+        gl.bind_buffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        if (slot.capacity < bytes)
+        {
+            gl.buffer_data(GL_PIXEL_PACK_BUFFER, static_cast<ptrdiff_t>(bytes), nullptr, GL_STREAM_READ);
+            slot.capacity = bytes;
+        }
+        // with a pack buffer bound, the last argument is an offset and the call returns immediately
+        gl.read_pixels(0, 0, static_cast<int>(target.x), static_cast<int>(target.y), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        gl.bind_buffer(GL_PIXEL_PACK_BUFFER, 0u);
+
+        if (downscale > 1u)
+        {
+            gl.bind_framebuffer(GL_READ_FRAMEBUFFER, 0u);
+        }
+
+        slot.fence    = gl.fence_sync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0u);
+        slot.size     = target;
+        slot.frame    = frame;
+        slot.callback = callback;
+        slot.failure  = failure;
+
+        pending++;
+        return true;
+    }
+
+    void FrameReadback::blit_scaled(const glm::uvec2& size, const glm::uvec2& target)
+    {
+        if (framebuffer == 0u)
+        {
+            gl.gen_framebuffers(1, &framebuffer);
+            gl.gen_renderbuffers(1, &renderbuffer);
+        }
+        if (scaled_size != target)
+        {
+            gl.bind_renderbuffer(GL_RENDERBUFFER, renderbuffer);
+            gl.renderbuffer_storage(GL_RENDERBUFFER, GL_RGBA8, static_cast<int>(target.x), static_cast<int>(target.y));
+            gl.bind_renderbuffer(GL_RENDERBUFFER, 0u);
+            gl.bind_framebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+            gl.framebuffer_renderbuffer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+            scaled_size = target;
+        }
+        else
+        {
+            gl.bind_framebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+        }
+
+        // linear filtering averages 2x2 pixels, larger factors skip pixels
+        gl.blit_framebuffer(0, 0, static_cast<int>(size.x), static_cast<int>(size.y),
+                            0, 0, static_cast<int>(target.x), static_cast<int>(target.y),
+                            GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        gl.bind_framebuffer(GL_DRAW_FRAMEBUFFER, 0u);
+        gl.bind_framebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    }
+
+    void FrameReadback::update()
+    {
+        unmap_done();
+        map_finished();
+    }
+
+    void FrameReadback::unmap_done()
+    {
+        // the readback thread works in order, so the done slots are at the head
+        auto count = size_t{0u};
+        {
+            auto lock = std::unique_lock<std::mutex>{mutex};
+            while (count < mapped && slots[(head + count) % slots.size()].done)
+            {
+                count++;
+            }
+        }
+
+        for (auto i = size_t{0u}; i < count; i++)
+        {
+            auto& slot = slots[head];
+            if (slot.data != nullptr)
+            {
+                gl.bind_buffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+                gl.unmap_buffer(GL_PIXEL_PACK_BUFFER);
+                gl.bind_buffer(GL_PIXEL_PACK_BUFFER, 0u);
+                slot.data = nullptr;
+            }
+            slot.done = false;
+
+            head = (head + 1u) % slots.size();
+            pending--;
+            mapped--;
+        }
+    }
+
+    void FrameReadback::map_finished()
+    {
+        while (mapped < pending)
+        {
+            const auto index = (head + mapped) % slots.size();
+            auto& slot = slots[index];
+
+            auto status = gl.client_wait_sync(slot.fence, 0u, 0u);
+            if (status == GL_TIMEOUT_EXPIRED)
+            {
+                // the copies finish in order, so the younger ones are not done either
+                return;
+            }
+            gl.delete_sync(slot.fence);
+            slot.fence = nullptr;
+
+            if (status != GL_WAIT_FAILED)
+            {
+                auto bytes = static_cast<size_t>(slot.size.x) * slot.size.y * 4u;
+                gl.bind_buffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+                slot.data = static_cast<const uint8_t*>(gl.map_buffer_range(GL_PIXEL_PACK_BUFFER, 0, static_cast<ptrdiff_t>(bytes), GL_MAP_READ_BIT));
+                gl.bind_buffer(GL_PIXEL_PACK_BUFFER, 0u);
+            }
+            mapped++;
+
+            // failed slots go through the thread too, so that slots are released in order
+            auto lock = std::unique_lock<std::mutex>{mutex};
+            jobs.push_back(index);
+            cond.notify_one();
+        }
+    }
+
+    size_t FrameReadback::get_pending() const noexcept
+    {
+        return pending;
+    }
+
+    void FrameReadback::recycle(Image&& image) noexcept
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        if (image.pixels.capacity() > 0u && pool.size() < slots.size())
+        {
+            pool.push_back(std::move(image.pixels));
+        }
+    }
+
+    ReadbackStats FrameReadback::get_stats() const noexcept
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        return stats;
+    }
+
+    void FrameReadback::run()
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        while (true)
+        {
+            cond.wait(lock, [this] () {
+                return !running || !jobs.empty();
+            });
+            if (jobs.empty())
+            {
+                return;
+            }
+
+            auto& slot = slots[jobs.front()];
+            jobs.pop_front();
+
+            auto image = Image{};
+            image.size  = slot.size;
+            image.frame = slot.frame;
+            if (!pool.empty())
+            {
+                image.pixels = std::move(pool.back());
+                pool.pop_back();
+            }
+            auto callback = std::move(slot.callback);
+            auto failure  = std::move(slot.failure);
+            auto data     = slot.data;
+            lock.unlock();
+
+            if (data != nullptr)
+            {
+                // GL reads bottom up, copy the rows in reverse
+                const auto stride = static_cast<size_t>(image.size.x) * 4u;
+                image.pixels.resize(stride * image.size.y);
+                for (auto y = size_t{0u}; y < image.size.y; y++)
+                {
+                    std::memcpy(image.pixels.data() + y * stride, data + (image.size.y - 1u - y) * stride, stride);
+                }
+            }
+
+            lock.lock();
+            slot.done = true;
+            if (data == nullptr)
+            {
+                stats.dropped++;
+                if (image.pixels.capacity() > 0u)
+                {
+                    pool.push_back(std::move(image.pixels));
+                }
+                lock.unlock();
+                if (failure)
+                {
+                    failure();
+                }
+                lock.lock();
+                continue;
+            }
+            lock.unlock();
+
+            callback(std::move(image));
+            // an image the callback did not keep goes back to the pool
+            recycle(std::move(image));
+
+            lock.lock();
+            stats.completed++;
+        }
+    }
+}
@@ -0,0 +1,199 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "defines.h"
+#include "utils.h"
+
+namespace ice
+{
+    //! Image
+    //!
+    //! The pixels are 8 bit RGBA, rows from top to bottom.
+    struct Image
+    {
+        glm::uvec2           size  = {0u, 0u};
+        uint64_t             frame = 0u;
+        std::vector<uint8_t> pixels;
+    };
+
+    using ReadbackCallback = std::function<void (Image&&)>;
+    using ReadbackFailure  = std::function<void ()>;
+
+    //! OpenGL Readback Functions
+    //!
+    //! The GL entry points used by the FrameReadback. GLsync is passed as
+    //! void pointer and GLuint64 as uint64_t.
+    struct ReadbackFunctions
+    {
+        void          (ICE_APIENTRY* gen_buffers)(int n, unsigned int* buffers)                                                                                           = nullptr;
+        void          (ICE_APIENTRY* delete_buffers)(int n, const unsigned int* buffers)                                                                                  = nullptr;
+        void          (ICE_APIENTRY* bind_buffer)(unsigned int target, unsigned int buffer)                                                                               = nullptr;
+        void          (ICE_APIENTRY* buffer_data)(unsigned int target, ptrdiff_t size, const void* data, unsigned int usage)                                              = nullptr;
+        void          (ICE_APIENTRY* read_pixels)(int x, int y, int width, int height, unsigned int format, unsigned int type, void* data)                                = nullptr;
+        void*         (ICE_APIENTRY* map_buffer_range)(unsigned int target, ptrdiff_t offset, ptrdiff_t length, unsigned int access)                                      = nullptr;
+        unsigned char (ICE_APIENTRY* unmap_buffer)(unsigned int target)                                                                                                   = nullptr;
+        void*         (ICE_APIENTRY* fence_sync)(unsigned int condition, unsigned int flags)                                                                              = nullptr;
+        unsigned int  (ICE_APIENTRY* client_wait_sync)(void* sync, unsigned int flags, uint64_t timeout)                                                                  = nullptr;
+        void          (ICE_APIENTRY* delete_sync)(void* sync)                                                                                                             = nullptr;
+        void          (ICE_APIENTRY* gen_framebuffers)(int n, unsigned int* framebuffers)                                                                                 = nullptr;
+        void          (ICE_APIENTRY* delete_framebuffers)(int n, const unsigned int* framebuffers)                                                                        = nullptr;
+        void          (ICE_APIENTRY* bind_framebuffer)(unsigned int target, unsigned int framebuffer)                                                                     = nullptr;
+        void          (ICE_APIENTRY* gen_renderbuffers)(int n, unsigned int* renderbuffers)                                                                               = nullptr;
+        void          (ICE_APIENTRY* delete_renderbuffers)(int n, const unsigned int* renderbuffers)                                                                      = nullptr;
+        void          (ICE_APIENTRY* bind_renderbuffer)(unsigned int target, unsigned int renderbuffer)                                                                   = nullptr;
+        void          (ICE_APIENTRY* renderbuffer_storage)(unsigned int target, unsigned int format, int width, int height)                                               = nullptr;
+        void          (ICE_APIENTRY* framebuffer_renderbuffer)(unsigned int target, unsigned int attachment, unsigned int renderbuffer_target, unsigned int renderbuffer) = nullptr;
+        void          (ICE_APIENTRY* blit_framebuffer)(int x0, int y0, int x1, int y1, int dx0, int dy0, int dx1, int dy1, unsigned int mask, unsigned int filter)        = nullptr;
+    };
+
+    //! Load the readback functions of the current context.
+    ICE_EXPORT ReadbackFunctions load_readback_functions();
+
+    //! Readback Statistics
+    struct ReadbackStats
+    {
+        //! The number of readbacks requested.
+        size_t requested = 0u;
+        //! The number of images handed to callbacks.
+        size_t completed = 0u;
+        //! The number of requests dropped because all buffers were in use or
+        //! the readback failed.
+        size_t dropped = 0u;
+    };
+
+    //! Frame Readback
+    //!
+    //! The frame readback copies the frame buffer into a ring of pixel
+    //! buffer objects without waiting for the GPU. Each update checks with
+    //! fences which copies are done and maps only those, so the GL thread
+    //! never stalls. The readback thread copies the mapped memory into an
+    //! image and hands it to the callback; the buffer is unmapped by a later
+    //! update. The GL thread never touches the pixels.
+    //!
+    //! The pixel memory of images is taken from a small pool. Images the
+    //! callback leaves alone are returned to the pool, callbacks that keep
+    //! the image may return it with recycle.
+    //!
+    //! When all buffers are in use a request is dropped instead of waiting.
+    //! All functions but get_stats and recycle must be called on the GL
+    //! thread.
+    class ICE_EXPORT FrameReadback : private non_copyable
+    {
+    public:
+        //! Construct Frame Readback
+        //!
+        //! @param functions the GL functions
+        //! @param ring_size the number of pixel buffers
+        FrameReadback(const ReadbackFunctions& functions, size_t ring_size = 3u);
+
+        //! Destroy Frame Readback
+        //!
+        //! Pending readbacks are dropped and reported to their failure
+        //! callbacks, images handed to the thread are still passed to their
+        //! callbacks.
+        ~FrameReadback();
+
+        //! Start reading the current read buffer.
+        //!
+        //! With a downscale factor above 1 the frame is first blitted into a
+        //! smaller frame buffer, so only the reduced image is transferred.
+        //! The default frame buffer is bound for reading afterwards.
+        //!
+        //! A request that was accepted ends up either in the callback or, if
+        //! the readback fails or is still pending when the readback is
+        //! destroyed, in the failure callback.
+        //!
+        //! @param size the size of the read buffer
+        //! @param frame the frame number passed on with the image
+        //! @param callback called with the image on the readback thread
+        //! @param failure called when an accepted request is lost
+        //! @param downscale divide the width and height by this factor
+        //! @returns false if the request was dropped
+        bool read(const glm::uvec2& size, uint64_t frame, const ReadbackCallback& callback, const ReadbackFailure& failure = {}, unsigned int downscale = 1u);
+
+        //! Collect the finished readbacks.
+        //!
+        //! This should be called once per frame, after the buffers were swapped.
+        void update();
+
+        //! Get the number of readbacks in flight.
+        //!
+        //! This includes buffers that are still mapped.
+        [[nodiscard]] size_t get_pending() const noexcept;
+
+        //! Return the pixel memory of an image to the pool.
+        void recycle(Image&& image) noexcept;
+
+        //! Get the statistics.
+        [[nodiscard]] ReadbackStats get_stats() const noexcept;
+
+    private:
+        struct Slot
+        {
+            unsigned int     buffer   = 0u;
+            size_t           capacity = 0u;
+            void*            fence    = nullptr;
+            glm::uvec2       size     = {0u, 0u};
+            uint64_t         frame    = 0u;
+            ReadbackCallback callback;
+            ReadbackFailure  failure;
+            //! The mapped memory, read by the readback thread.
+            const uint8_t*   data     = nullptr;
+            //! Set by the readback thread once it no longer needs the slot.
+            bool             done     = false;
+        };
+
+        ReadbackFunctions gl;
+        std::vector<Slot> slots;
+        size_t            head    = 0u;
+        size_t            pending = 0u;
+        size_t            mapped  = 0u;
+
+        unsigned int framebuffer  = 0u;
+        unsigned int renderbuffer = 0u;
+        glm::uvec2   scaled_size  = {0u, 0u};
+
+        mutable std::mutex                mutex;
+        std::condition_variable           cond;
+        std::deque<size_t>                jobs;
+        std::vector<std::vector<uint8_t>> pool;
+        bool                              running = true;
+        ReadbackStats                     stats;
+        std::thread                       thread;
+
+        void blit_scaled(const glm::uvec2& size, const glm::uvec2& target);
+        void unmap_done();
+        void map_finished();
+        void run();
+    };
+}
@@ -0,0 +1,132 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <numeric>
+#include <ostream>
+
+namespace ice
+{
+    std::string_view get_phase_name(FramePhase phase) noexcept
+    {
+        switch (phase)
+        {
+        case FramePhase::FRAME:  return "frame";
+        case FramePhase::EVENTS: return "events";
+        case FramePhase::UPDATE: return "update";
+        case FramePhase::DRAW:   return "draw";
+        case FramePhase::SWAP:   return "swap";
+        default:                 return "unknown";
+        }
+    }
+
+    FrameStats::FrameStats(size_t window)
+    {
+        check(window > 0u);
+        for (auto& phase : samples)
+        {
+            phase.resize(window, 0);
+        }
+    }
+
+    size_t FrameStats::get_window() const noexcept
+    {
+        return samples[0].size();
+    }
+
+    size_t FrameStats::get_frame_count() const noexcept
+    {
+        return count;
+    }
+
+    void FrameStats::add(FramePhase phase, std::chrono::steady_clock::duration time) noexcept
+    {
+        const auto index = static_cast<size_t>(phase);
+        ICE_CHECK_DEBUG(index < FRAME_PHASE_COUNT);
+        current[index] += std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+    }
+
+    void FrameStats::end_frame() noexcept
+    {
+        for (auto i = 0u; i < FRAME_PHASE_COUNT; i++)
+        {
+            samples[i][next] = current[i];
+            current[i]       = 0;
+        }
+        next  = (next + 1u) % get_window();
+        count = std::min(count + 1u, get_window());
+    }
+
+    // nearest rank on sorted samples
+    double get_percentile(const std::vector<int64_t>& sorted, double percent) noexcept
+    {
+        const auto rank = static_cast<size_t>(std::ceil(percent / 100.0 * static_cast<double>(sorted.size())));
+        return static_cast<double>(sorted[std::clamp<size_t>(rank, 1u, sorted.size()) - 1u]) / 1e6;
+    }
+
+    PhaseStats FrameStats::get(FramePhase phase) const
+    {
+        const auto index = static_cast<size_t>(phase);
+        ICE_CHECK_DEBUG(index < FRAME_PHASE_COUNT);
+
+        if (count == 0u)
+        {
+            return {};
+        }
+
+        // the window is only partly filled at the start, the oldest frames are at the front then
+        auto sorted = std::vector<int64_t>(samples[index].begin(), samples[index].begin() + count);
+        std::sort(sorted.begin(), sorted.end());
+
+        auto result = PhaseStats{};
+        result.min = static_cast<double>(sorted.front()) / 1e6;
+        result.max = static_cast<double>(sorted.back()) / 1e6;
+        result.avg = static_cast<double>(std::accumulate(sorted.begin(), sorted.end(), int64_t{0})) / static_cast<double>(count) / 1e6;
+        result.p50 = get_percentile(sorted, 50.0);
+        result.p95 = get_percentile(sorted, 95.0);
+        result.p99 = get_percentile(sorted, 99.0);
+        return result;
+    }
+
+    void FrameStats::clear() noexcept
+    {
+        current.fill(0);
+        next  = 0u;
+        count = 0u;
+    }
+
+    std::ostream& operator << (std::ostream& os, const FrameStats& stats)
+    {
+        os << std::format("frame times of the last {} frames in ms\n", stats.get_frame_count());
+        os << std::format("{:<8} {:>8} {:>8} {:>8} {:>8} {:>8} {:>8}\n", "phase", "min", "avg", "p50", "p95", "p99", "max");
+        for (auto i = 0u; i < FRAME_PHASE_COUNT; i++)
+        {
+            const auto phase = static_cast<FramePhase>(i);
+            const auto s     = stats.get(phase);
+            os << std::format("{:<8} {:>8.3f} {:>8.3f} {:>8.3f} {:>8.3f} {:>8.3f} {:>8.3f}\n", get_phase_name(phase), s.min, s.avg, s.p50, s.p95, s.p99, s.max);
+        }
+        return os;
+    }
+}
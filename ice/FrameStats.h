@@ -0,0 +1,112 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+#include <vector>
+
+#include "defines.h"
+#include "utils.h"
+
+namespace ice
+{
+    //! Frame Phase
+    enum class FramePhase
+    {
+        //! The whole tick, including the frame limiter.
+        FRAME,
+        //! Routing the input and window events.
+        EVENTS,
+        //! The simulation updates and the tasks.
+        UPDATE,
+        //! Drawing the frame, without the swap.
+        DRAW,
+        //! Swapping the buffers.
+        SWAP
+    };
+
+    //! The number of frame phases.
+    constexpr size_t FRAME_PHASE_COUNT = 5u;
+
+    //! Get the name of a frame phase.
+    ICE_EXPORT std::string_view get_phase_name(FramePhase phase) noexcept;
+
+    //! Phase Statistics
+    //!
+    //! All times are in milliseconds.
+    struct PhaseStats
+    {
+        double min = 0.0;
+        double avg = 0.0;
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    //! Frame Statistics
+    //!
+    //! The frame statistics keep the phase times of the last frames in a
+    //! rolling window. Each frame every phase gets one sample; a phase
+    //! that did not run in a frame counts as 0.
+    class ICE_EXPORT FrameStats
+    {
+    public:
+        //! Construct Frame Statistics
+        //!
+        //! @param window the number of frames kept
+        FrameStats(size_t window = 600u);
+
+        //! Get the number of frames kept.
+        [[nodiscard]] size_t get_window() const noexcept;
+
+        //! Get the number of frames in the window.
+        [[nodiscard]] size_t get_frame_count() const noexcept;
+
+        //! Add time to a phase of the current frame.
+        void add(FramePhase phase, std::chrono::steady_clock::duration time) noexcept;
+
+        //! Move on to the next frame.
+        void end_frame() noexcept;
+
+        //! Compute the statistics of a phase over the window.
+        [[nodiscard]] PhaseStats get(FramePhase phase) const;
+
+        //! Discard all frames.
+        void clear() noexcept;
+
+    private:
+        using Samples = std::vector<int64_t>;
+
+        std::array<Samples, FRAME_PHASE_COUNT> samples;
+        std::array<int64_t, FRAME_PHASE_COUNT> current = {};
+        size_t                                 next    = 0u;
+        size_t                                 count   = 0u;
+    };
+
+    //! Write the statistics of all phases as table.
+    ICE_EXPORT std::ostream& operator << (std::ostream& os, const FrameStats& stats);
+}
@@ -0,0 +1,218 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "GLState.h"
+
+#include <stdexcept>
+#include <string>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengl.h>
+
+namespace ice
+{
+    template <typename Fun>
+    void load_gl_function(Fun& fun, const char* name)
+    {
+        fun = reinterpret_cast<Fun>(SDL_GL_GetProcAddress(name));
+        if (fun == nullptr)
+        {
+            throw std::runtime_error(std::string("Failed to load ") + name + ".");
+        }
+    }
+
+    GLFunctions load_gl_functions()
+    {
+        auto result = GLFunctions{};
+        load_gl_function(result.viewport,    "glViewport");
+        load_gl_function(result.clear_color, "glClearColor");
+        load_gl_function(result.use_program, "glUseProgram");
+        load_gl_function(result.bind_buffer, "glBindBuffer");
+        load_gl_function(result.enable,      "glEnable");
+        load_gl_function(result.disable,     "glDisable");
+        load_gl_function(result.blend_func,  "glBlendFunc");
+        return result;
+    }
+
+    int get_buffer_index(unsigned int target) noexcept
+    {
+        switch (target)
+        {
+        case GL_ARRAY_BUFFER:         return 0;
+        case GL_ELEMENT_ARRAY_BUFFER: return 1;
+        case GL_UNIFORM_BUFFER:       return 2;
+        default:                      return -1;
+        }
+    }
+
+    int get_cap_index(unsigned int cap) noexcept
+    {
+        switch (cap)
+        {
+        case GL_BLEND:        return 0;
+        case GL_DEPTH_TEST:   return 1;
+        case GL_CULL_FACE:    return 2;
+        case GL_SCISSOR_TEST: return 3;
+        default:              return -1;
+        }
+    }
+
+    GLState::GLState(const GLFunctions& functions) noexcept
+    : gl(functions) {}
+
+    void GLState::set_functions(const GLFunctions& value) noexcept
+    {
+        gl = value;
+        invalidate();
+    }
+
+    void GLState::invalidate() noexcept
+    {
+        viewport_valid = false;
+        clear_valid    = false;
+        program_valid  = false;
+        buffer_valid   = {};
+        cap_valid      = {};
+        blend_valid    = false;
+    }
+
+    void GLState::viewport(const glm::ivec4& value) noexcept
+    {
+        if (viewport_valid && viewport_value == value)
+        {
+            stats.skipped++;
+            return;
+        }
+
+        ICE_CHECK_DEBUG(gl.viewport != nullptr);
+        gl.viewport(value.x, value.y, value.z, value.w);
+        viewport_valid = true;
+        viewport_value = value;
+        stats.issued++;
+    }
+
+    void GLState::clear_color(const glm::vec4& value) noexcept
+    {
+        if (clear_valid && clear_value == value)
+        {
+            stats.skipped++;
+            return;
+        }
+
+        ICE_CHECK_DEBUG(gl.clear_color != nullptr);
+        gl.clear_color(value.x, value.y, value.z, value.w);
+        clear_valid = true;
+        clear_value = value;
+        stats.issued++;
+    }
+
+    void GLState::use_program(unsigned int program) noexcept
+    {
+        if (program_valid && program_value == program)
+        {
+            stats.skipped++;
+            return;
+        }
+
+        ICE_CHECK_DEBUG(gl.use_program != nullptr);
+        gl.use_program(program);
+        program_valid = true;
+        program_value = program;
+        stats.issued++;
+    }
+
+    void GLState::bind_buffer(unsigned int target, unsigned int buffer) noexcept
+    {
+        const auto index = get_buffer_index(target);
+        if (index >= 0 && buffer_valid[index] && buffer_value[index] == buffer)
+        {
+            stats.skipped++;
+            return;
+        }
+
+        ICE_CHECK_DEBUG(gl.bind_buffer != nullptr);
+        gl.bind_buffer(target, buffer);
+        if (index >= 0)
+        {
+            buffer_valid[index] = true;
+            buffer_value[index] = buffer;
+        }
+        stats.issued++;
+    }
+
+    void GLState::set_enabled(unsigned int cap, bool value) noexcept
+    {
+        const auto index = get_cap_index(cap);
+        if (index >= 0 && cap_valid[index] && cap_value[index] == value)
+        {
+            stats.skipped++;
+            return;
+        }
+
+        ICE_CHECK_DEBUG(gl.enable != nullptr && gl.disable != nullptr);
+        if (value)
+        {
+            gl.enable(cap);
+        }
+        else
+        {
+            gl.disable(cap);
+        }
+        if (index >= 0)
+        {
+            cap_valid[index] = true;
+            cap_value[index] = value;
+        }
+        stats.issued++;
+    }
+
+    void GLState::blend_func(unsigned int sfactor, unsigned int dfactor) noexcept
+    {
+        if (blend_valid && blend_src == sfactor && blend_dst == dfactor)
+        {
+            stats.skipped++;
+            return;
+        }
+
+        ICE_CHECK_DEBUG(gl.blend_func != nullptr);
+        gl.blend_func(sfactor, dfactor);
+        blend_valid = true;
+        blend_src   = sfactor;
+        blend_dst   = dfactor;
+        stats.issued++;
+    }
+
+    void GLState::end_frame() noexcept
+    {
+        frame_stats = stats;
+        stats       = {};
+    }
+
+    const GLStats& GLState::get_frame_stats() const noexcept
+    {
+        return frame_stats;
+    }
+
+    const GLStats& GLState::get_stats() const noexcept
+    {
+        return stats;
+    }
+}
@@ -0,0 +1,138 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <glm/glm.hpp>
+
+#include "defines.h"
+#include "utils.h"
+
+namespace ice
+{
+    //! OpenGL Functions
+    //!
+    //! The GL entry points used by the GLState. The types match GLenum,
+    //! GLint, GLsizei, GLuint and GLfloat.
+    struct GLFunctions
+    {
+        void (ICE_APIENTRY* viewport)(int x, int y, int width, int height)                = nullptr;
+        void (ICE_APIENTRY* clear_color)(float red, float green, float blue, float alpha) = nullptr;
+        void (ICE_APIENTRY* use_program)(unsigned int program)                              = nullptr;
+        void (ICE_APIENTRY* bind_buffer)(unsigned int target, unsigned int buffer)          = nullptr;
+        void (ICE_APIENTRY* enable)(unsigned int cap)                                       = nullptr;
+        void (ICE_APIENTRY* disable)(unsigned int cap)                                      = nullptr;
+        void (ICE_APIENTRY* blend_func)(unsigned int sfactor, unsigned int dfactor)         = nullptr;
+    };
+
+    //! Load the GL functions of the current context.
+    ICE_EXPORT GLFunctions load_gl_functions();
+
+    //! GL Call Statistics
+    struct GLStats
+    {
+        //! The number of calls passed to the driver.
+        size_t issued = 0u;
+        //! The number of calls skipped because the state was already set.
+        size_t skipped = 0u;
+    };
+
+    //! GL State Cache
+    //!
+    //! The GLState shadows the GL state it sets and skips calls that would
+    //! not change anything. All GL state changes of the covered kinds must go
+    //! through the cache; after calling GL directly, invalidate the cache.
+    //!
+    //! The state is only valid on the thread that owns the context.
+    class ICE_EXPORT GLState : private non_copyable
+    {
+    public:
+        //! Construct GL State Cache
+        GLState(const GLFunctions& functions = {}) noexcept;
+
+        //! Set the GL functions.
+        //!
+        //! This also invalidates the cache.
+        void set_functions(const GLFunctions& value) noexcept;
+
+        //! Forget the cached state.
+        void invalidate() noexcept;
+
+        //! Set the viewport.
+        void viewport(const glm::ivec4& value) noexcept;
+
+        //! Set the clear color.
+        void clear_color(const glm::vec4& value) noexcept;
+
+        //! Use a shader program.
+        void use_program(unsigned int program) noexcept;
+
+        //! Bind a buffer.
+        //!
+        //! Bindings of the array, element array and uniform buffer targets
+        //! are cached, other targets are always passed to the driver.
+        void bind_buffer(unsigned int target, unsigned int buffer) noexcept;
+
+        //! Enable or disable a capability.
+        //!
+        //! Blending, depth test, cull face and scissor test are cached,
+        //! other capabilities are always passed to the driver.
+        void set_enabled(unsigned int cap, bool value) noexcept;
+
+        //! Set the blend function.
+        void blend_func(unsigned int sfactor, unsigned int dfactor) noexcept;
+
+        //! End the frame.
+        //!
+        //! The counts of this frame become the frame statistics.
+        void end_frame() noexcept;
+
+        //! Get the statistics of the last frame.
+        [[nodiscard]] const GLStats& get_frame_stats() const noexcept;
+
+        //! Get the statistics of the current frame.
+        [[nodiscard]] const GLStats& get_stats() const noexcept;
+
+    private:
+        static constexpr size_t BUFFER_TARGETS = 3u;
+        static constexpr size_t CAPABILITIES   = 4u;
+
+        GLFunctions gl;
+
+        bool                                     viewport_valid = false;
+        glm::ivec4                               viewport_value;
+        bool                                     clear_valid    = false;
+        glm::vec4                                clear_value;
+        bool                                     program_valid  = false;
+        unsigned int                             program_value  = 0u;
+        std::array<bool, BUFFER_TARGETS>         buffer_valid   = {};
+        std::array<unsigned int, BUFFER_TARGETS> buffer_value   = {};
+        std::array<bool, CAPABILITIES>           cap_valid      = {};
+        std::array<bool, CAPABILITIES>           cap_value      = {};
+        bool                                     blend_valid    = false;
+        unsigned int                             blend_src      = 0u;
+        unsigned int                             blend_dst      = 0u;
+
+        GLStats stats;
+        GLStats frame_stats;
+    };
+}
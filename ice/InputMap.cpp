@@ -0,0 +1,699 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "InputMap.h"
+
+#include <algorithm>
+#include <bit>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "debug.h"
+#include "KeyNames.h"
+
+namespace ice
+{
+    constexpr auto INPUT_COUNT = KEY_COUNT + MOUSE_BUTTON_COUNT;
+
+    unsigned int mod_index(KeyMod mod) noexcept
+    {
+        // KeyMod starts at bit 1
+        return (static_cast<unsigned int>(mod) >> 1u) & (KEY_MOD_COUNT - 1u);
+    }
+
+    unsigned int key_input(Key key) noexcept
+    {
+        return static_cast<unsigned int>(key);
+    }
+
+    unsigned int button_input(MouseButton button) noexcept
+    {
+        return static_cast<unsigned int>(KEY_COUNT) + static_cast<unsigned int>(button);
+    }
+
+    const std::string& InputContext::get_name() const noexcept
+    {
+        return name;
+    }
+
+    void InputContext::bind(ActionId action, Key key, KeyMod mod)
+    {
+        check(key_input(key) < KEY_COUNT);
+        bindings.push_back({action, key_input(key), mod});
+        map.dirty = true;
+    }
+
+    void InputContext::bind(ActionId action, MouseButton button, KeyMod mod)
+    {
+        check(button_input(button) < INPUT_COUNT);
+        bindings.push_back({action, button_input(button), mod});
+        map.dirty = true;
+    }
+
+    void InputContext::bind_axis(ActionId axis, Key negative, Key positive, float scale)
+    {
+        check(key_input(negative) < KEY_COUNT && key_input(positive) < KEY_COUNT);
+        axis_bindings.push_back({axis, key_input(negative), key_input(positive), MouseAxis::X, false, scale});
+        map.dirty = true;
+    }
+
+    void InputContext::bind_axis(ActionId axis, MouseAxis source, float scale)
+    {
+        axis_bindings.push_back({axis, 0u, 0u, source, true, scale});
+        map.dirty = true;
+    }
+
+    void InputContext::clear() noexcept
+    {
+        bindings.clear();
+        axis_bindings.clear();
+        map.dirty = true;
+    }
+
+    InputContext::InputContext(InputMap& m, std::string_view n)
+    : map(m), name(n) {}
+
+    InputMap::InputMap()
+    {
+        // id 0 is NO_ACTION
+        action_names.emplace_back();
+        states.emplace_back();
+        down_actions.resize(INPUT_COUNT, NO_ACTION);
+    }
+
+    InputMap::~InputMap()
+    {
+        detach();
+    }
+
+    ActionId InputMap::get_action_id(std::string_view name)
+    {
+        auto i = action_ids.find(name);
+        if (i != end(action_ids))
+        {
+            return i->second;
+        }
+
+        const auto id = static_cast<ActionId>(action_names.size());
+        action_names.emplace_back(name);
+        action_ids.emplace(name, id);
+        states.emplace_back();
+        dirty = true;
+        return id;
+    }
+
+    ActionId InputMap::find_action_id(std::string_view name) const noexcept
+    {
+        auto i = action_ids.find(name);
+        return i != end(action_ids) ? i->second : NO_ACTION;
+    }
+
+    const std::string& InputMap::get_action_name(ActionId action) const noexcept
+    {
+        check(action < action_names.size());
+        return action_names[action];
+    }
+
+    InputContext& InputMap::get_context(std::string_view name)
+    {
+        for (const auto& context : contexts)
+        {
+            if (context->name == name)
+            {
+                return *context;
+            }
+        }
+
+        contexts.push_back(std::unique_ptr<InputContext>(new InputContext(*this, name)));
+        return *contexts.back();
+    }
+
+    void InputMap::push_context(std::string_view name)
+    {
+        stack.push_back(&get_context(name));
+        dirty = true;
+    }
+
+    void InputMap::pop_context() noexcept
+    {
+        check(!stack.empty());
+        stack.pop_back();
+        dirty = true;
+    }
+
+    size_t InputMap::get_context_depth() const noexcept
+    {
+        return stack.size();
+    }
+
+    std::vector<std::string_view> split(std::string_view text, char delimiter)
+    {
+        auto result = std::vector<std::string_view>{};
+        auto start  = size_t{0};
+        while (start < text.size())
+        {
+            auto end = text.find(delimiter, start);
+            if (end == std::string_view::npos)
+            {
+                end = text.size();
+            }
+            result.push_back(text.substr(start, end - start));
+            start = end + 1u;
+        }
+        return result;
+    }
+
+    std::vector<std::string_view> tokenize(std::string_view line)
+    {
+        auto result = std::vector<std::string_view>{};
+        auto i      = size_t{0};
+        while (i < line.size())
+        {
+            while (i < line.size() && std::isspace(static_cast<unsigned char>(line[i])))
+            {
+                i++;
+            }
+            const auto start = i;
+            while (i < line.size() && !std::isspace(static_cast<unsigned char>(line[i])))
+            {
+                i++;
+            }
+            if (i > start)
+            {
+                result.push_back(line.substr(start, i - start));
+            }
+        }
+        return result;
+    }
+
+    KeyMod parse_mod(std::string_view name) noexcept
+    {
+        if (detail::iequals(name, "SHIFT")) return KeyMod::SHIFT;
+        if (detail::iequals(name, "CTRL"))  return KeyMod::CTRL;
+        if (detail::iequals(name, "ALT"))   return KeyMod::ALT;
+        if (detail::iequals(name, "META"))  return KeyMod::META;
+        return KeyMod::NONE;
+    }
+
+    MouseButton parse_button(std::string_view name) noexcept
+    {
+        if (detail::iequals(name, "MOUSE_LEFT"))    return MouseButton::LEFT;
+        if (detail::iequals(name, "MOUSE_MIDDLE"))  return MouseButton::MIDDLE;
+        if (detail::iequals(name, "MOUSE_RIGHT"))   return MouseButton::RIGHT;
+        if (detail::iequals(name, "MOUSE_BUTTON4")) return MouseButton::BUTTON4;
+        if (detail::iequals(name, "MOUSE_BUTTON5")) return MouseButton::BUTTON5;
+        return MouseButton::NONE;
+    }
+
+    bool parse_mouse_axis(std::string_view name, MouseAxis& axis) noexcept
+    {
+        if (detail::iequals(name, "MOUSE_X")) { axis = MouseAxis::X;       return true; }
+        if (detail::iequals(name, "MOUSE_Y")) { axis = MouseAxis::Y;       return true; }
+        if (detail::iequals(name, "WHEEL_X")) { axis = MouseAxis::WHEEL_X; return true; }
+        if (detail::iequals(name, "WHEEL_Y")) { axis = MouseAxis::WHEEL_Y; return true; }
+        return false;
+    }
+
+    Key parse_key_checked(std::string_view name, unsigned int line)
+    {
+        const auto key = parse_key(name);
+        if (key == Key::UNDEFINED)
+        {
+            throw std::runtime_error(std::format("line {}: unknown key '{}'", line, name));
+        }
+        return key;
+    }
+
+    float parse_scale(const std::vector<std::string_view>& tokens, size_t index, unsigned int line)
+    {
+        if (tokens.size() <= index)
+        {
+            return 1.0f;
+        }
+        if (tokens.size() > index + 1u)
+        {
+            throw std::runtime_error(std::format("line {}: unexpected '{}'", line, tokens[index + 1u]));
+        }
+
+        try
+        {
+            return std::stof(std::string(tokens[index]));
+        }
+        catch (const std::exception&)
+        {
+            throw std::runtime_error(std::format("line {}: invalid scale '{}'", line, tokens[index]));
+        }
+    }
+
+    void InputMap::load(std::istream& input)
+    {
+        InputContext* context = nullptr;
+        auto number           = 0u;
+        auto line             = std::string{};
+        while (std::getline(input, line))
+        {
+            number++;
+
+            auto text = std::string_view(line);
+            text = text.substr(0u, text.find('#'));
+
+            const auto tokens = tokenize(text);
+            if (tokens.empty())
+            {
+                continue;
+            }
+
+            if (tokens[0] == "context")
+            {
+                if (tokens.size() != 2u)
+                {
+                    throw std::runtime_error(std::format("line {}: expected 'context <name>'", number));
+                }
+                context = &get_context(tokens[1]);
+                continue;
+            }
+
+            if (context == nullptr)
+            {
+                throw std::runtime_error(std::format("line {}: binding outside of a context", number));
+            }
+
+            if (tokens[0] == "bind")
+            {
+                if (tokens.size() != 3u)
+                {
+                    throw std::runtime_error(std::format("line {}: expected 'bind <action> <input>'", number));
+                }
+
+                const auto parts  = split(tokens[2], '+');
+                auto       mod    = KeyMod::NONE;
+                for (auto i = 0u; i + 1u < parts.size(); i++)
+                {
+                    const auto m = parse_mod(parts[i]);
+                    if (m == KeyMod::NONE)
+                    {
+                        throw std::runtime_error(std::format("line {}: unknown modifier '{}'", number, parts[i]));
+                    }
+                    mod |= m;
+                }
+
+                const auto action = get_action_id(tokens[1]);
+                const auto button = parse_button(parts.back());
+                if (button != MouseButton::NONE)
+                {
+                    context->bind(action, button, mod);
+                }
+                else
+                {
+                    context->bind(action, parse_key_checked(parts.back(), number), mod);
+                }
+            }
+            else if (tokens[0] == "axis")
+            {
+                if (tokens.size() < 3u)
+                {
+                    throw std::runtime_error(std::format("line {}: expected 'axis <axis> <input> [scale]'", number));
+                }
+
+                const auto axis   = get_action_id(tokens[1]);
+                auto       source = MouseAxis::X;
+                if (parse_mouse_axis(tokens[2], source))
+                {
+                    context->bind_axis(axis, source, parse_scale(tokens, 3u, number));
+                }
+                else
+                {
+                    if (tokens.size() < 4u)
+                    {
+                        throw std::runtime_error(std::format("line {}: expected 'axis <axis> <negative> <positive> [scale]'", number));
+                    }
+                    const auto negative = parse_key_checked(tokens[2], number);
+                    const auto positive = parse_key_checked(tokens[3], number);
+                    context->bind_axis(axis, negative, positive, parse_scale(tokens, 4u, number));
+                }
+            }
+            else
+            {
+                throw std::runtime_error(std::format("line {}: unknown directive '{}'", number, tokens[0]));
+            }
+        }
+    }
+
+    void InputMap::load(const std::filesystem::path& file)
+    {
+        auto input = std::ifstream(file);
+        if (!input.is_open())
+        {
+            throw std::runtime_error(std::format("Failed to open {}.", file.string()));
+        }
+        load(input);
+    }
+
+    ActionId InputMap::lookup(Key key, KeyMod mod) noexcept
+    {
+        if (dirty)
+        {
+            compile();
+        }
+        check(key_input(key) < KEY_COUNT);
+        return table[key_input(key) * KEY_MOD_COUNT + mod_index(mod)];
+    }
+
+    ActionId InputMap::lookup(MouseButton button, KeyMod mod) noexcept
+    {
+        if (dirty)
+        {
+            compile();
+        }
+        check(button_input(button) < INPUT_COUNT);
+        return table[button_input(button) * KEY_MOD_COUNT + mod_index(mod)];
+    }
+
+    bool InputMap::is_active(ActionId action) const noexcept
+    {
+        ICE_CHECK_DEBUG(action < states.size());
+        return states[action].held > 0u;
+    }
+
+    bool InputMap::was_triggered(ActionId action) const noexcept
+    {
+        ICE_CHECK_DEBUG(action < states.size());
+        return states[action].pressed;
+    }
+
+    bool InputMap::was_released(ActionId action) const noexcept
+    {
+        ICE_CHECK_DEBUG(action < states.size());
+        return states[action].released;
+    }
+
+    float InputMap::get_axis(ActionId axis) noexcept
+    {
+        if (dirty)
+        {
+            compile();
+        }
+
+        if (axis >= axes.size())
+        {
+            return 0.0f;
+        }
+
+        auto digital = 0.0f;
+        auto analog  = 0.0f;
+        for (const auto& binding : axes[axis])
+        {
+            if (binding.analog)
+            {
+                switch (binding.source)
+                {
+                case MouseAxis::X:
+                    analog += motion.x * binding.scale;
+                    break;
+                case MouseAxis::Y:
+                    analog += motion.y * binding.scale;
+                    break;
+                case MouseAxis::WHEEL_X:
+                    analog += wheel.x * binding.scale;
+                    break;
+                case MouseAxis::WHEEL_Y:
+                    analog += wheel.y * binding.scale;
+                    break;
+                }
+            }
+            else
+            {
+                if (down_inputs.test(binding.negative))
+                {
+                    digital -= binding.scale;
+                }
+                if (down_inputs.test(binding.positive))
+                {
+                    digital += binding.scale;
+                }
+            }
+        }
+
+        return std::clamp(digital, -1.0f, 1.0f) + analog;
+    }
+
+    Signal<ActionId>& InputMap::get_action_down_signal() noexcept
+    {
+        return action_down_signal;
+    }
+
+    Connection InputMap::on_action_down(const Delegate<void (ActionId)>& cb) noexcept
+    {
+        return action_down_signal.connect(cb);
+    }
+
+    Signal<ActionId>& InputMap::get_action_up_signal() noexcept
+    {
+        return action_up_signal;
+    }
+
+    Connection InputMap::on_action_up(const Delegate<void (ActionId)>& cb) noexcept
+    {
+        return action_up_signal.connect(cb);
+    }
+
+    void InputMap::attach(Keyboard& keyboard, Mouse& mouse)
+    {
+        detach();
+
+        connections.push_back(keyboard.on_key_down([this] (KeyMod mod, Key key) {
+            handle_key_down(mod, key);
+        }));
+        connections.push_back(keyboard.on_key_up([this] (KeyMod mod, Key key) {
+            handle_key_up(mod, key);
+        }));
+        connections.push_back(mouse.on_button_down([this] (MouseButton button, glm::ivec2) {
+            handle_button_down(button);
+        }));
+        connections.push_back(mouse.on_button_up([this] (MouseButton button, glm::ivec2) {
+            handle_button_up(button);
+        }));
+        connections.push_back(mouse.on_move([this] (glm::ivec2, glm::ivec2 rel) {
+            handle_motion(rel);
+        }));
+        connections.push_back(mouse.on_wheel([this] (glm::ivec2 delta) {
+            handle_wheel(delta);
+        }));
+    }
+
+    void InputMap::detach() noexcept
+    {
+        for (auto& connection : connections)
+        {
+            connection.disconnect();
+        }
+        connections.clear();
+    }
+
+    void InputMap::begin_frame() noexcept
+    {
+        for (auto& state : states)
+        {
+            state.pressed  = false;
+            state.released = false;
+        }
+        motion = glm::vec2(0.0f);
+        wheel  = glm::vec2(0.0f);
+    }
+
+    void InputMap::handle_key_down(KeyMod mod, Key key)
+    {
+        mods = mod;
+        if (key_input(key) < KEY_COUNT)
+        {
+            input_down(key_input(key));
+        }
+    }
+
+    void InputMap::handle_key_up(KeyMod mod, Key key)
+    {
+        mods = mod;
+        if (key_input(key) < KEY_COUNT)
+        {
+            input_up(key_input(key));
+        }
+    }
+
+    void InputMap::handle_button_down(MouseButton button)
+    {
+        // the modifiers of the last key event may be long released
+        mods = get_held_mods();
+        if (button_input(button) < INPUT_COUNT)
+        {
+            input_down(button_input(button));
+        }
+    }
+
+    void InputMap::handle_button_up(MouseButton button)
+    {
+        if (button_input(button) < INPUT_COUNT)
+        {
+            input_up(button_input(button));
+        }
+    }
+
+    KeyMod InputMap::get_held_mods() const noexcept
+    {
+        const auto held = [this] (Key left, Key right) {
+            return down_inputs.test(key_input(left)) || down_inputs.test(key_input(right));
+        };
+
+        auto result = KeyMod::NONE;
+        if (held(Key::LSHIFT, Key::RSHIFT))
+        {
+            result |= KeyMod::SHIFT;
+        }
+        if (held(Key::LCTRL, Key::RCTRL))
+        {
+            result |= KeyMod::CTRL;
+        }
+        if (held(Key::LALT, Key::RALT))
+        {
+            result |= KeyMod::ALT;
+        }
+        if (held(Key::LGUI, Key::RGUI))
+        {
+            result |= KeyMod::META;
+        }
+        return result;
+    }
+
+    void InputMap::handle_motion(glm::ivec2 rel) noexcept
+    {
+        motion += glm::vec2(rel);
+    }
+
+    void InputMap::handle_wheel(glm::ivec2 delta) noexcept
+    {
+        wheel += glm::vec2(delta);
+    }
+
+    void InputMap::compile()
+    {
+        table.assign(INPUT_COUNT * KEY_MOD_COUNT, NO_ACTION);
+        axes.assign(action_names.size(), {});
+
+        // Bottom to top, so that higher contexts overwrite lower ones. Within
+        // a context bindings with fewer modifiers are written first, so that
+        // the binding with the most matching modifiers wins.
+        auto bindings = std::vector<InputContext::Binding>{};
+        for (const auto context : stack)
+        {
+            bindings = context->bindings;
+            std::stable_sort(begin(bindings), end(bindings), [] (const auto& a, const auto& b) {
+                return std::popcount(mod_index(a.mod)) < std::popcount(mod_index(b.mod));
+            });
+
+            for (const auto& binding : bindings)
+            {
+                const auto mask = mod_index(binding.mod);
+                for (auto m = 0u; m < KEY_MOD_COUNT; m++)
+                {
+                    if ((m & mask) == mask)
+                    {
+                        table[binding.input * KEY_MOD_COUNT + m] = binding.action;
+                    }
+                }
+            }
+        }
+
+        // An axis is defined by the top most context binding it.
+        auto taken = std::vector<bool>(action_names.size(), false);
+        for (auto i = stack.rbegin(); i != stack.rend(); ++i)
+        {
+            for (const auto& binding : (*i)->axis_bindings)
+            {
+                if (!taken[binding.axis])
+                {
+                    axes[binding.axis].push_back(binding);
+                }
+            }
+            for (const auto& binding : (*i)->axis_bindings)
+            {
+                taken[binding.axis] = true;
+            }
+        }
+
+        dirty = false;
+    }
+
+    void InputMap::input_down(unsigned int input)
+    {
+        // key repeat
+        if (down_inputs.test(input))
+        {
+            return;
+        }
+        down_inputs.set(input);
+
+        if (dirty)
+        {
+            compile();
+        }
+
+        // the action is remembered, so that releasing a modifier first
+        // still releases the same action
+        const auto action = table[input * KEY_MOD_COUNT + mod_index(mods)];
+        down_actions[input] = action;
+        if (action == NO_ACTION)
+        {
+            return;
+        }
+
+        auto& state = states[action];
+        if (state.held++ == 0u)
+        {
+            state.pressed = true;
+            action_down_signal.emit(action);
+        }
+    }
+
+    void InputMap::input_up(unsigned int input)
+    {
+        if (!down_inputs.test(input))
+        {
+            return;
+        }
+        down_inputs.reset(input);
+
+        const auto action = down_actions[input];
+        down_actions[input] = NO_ACTION;
+        if (action == NO_ACTION)
+        {
+            return;
+        }
+
+        auto& state = states[action];
+        check(state.held > 0u);
+        if (--state.held == 0u)
+        {
+            state.released = true;
+            action_up_signal.emit(action);
+        }
+    }
+}
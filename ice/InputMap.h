@@ -0,0 +1,273 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <filesystem>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "defines.h"
+#include "utils.h"
+#include "Signal.h"
+#include "Keyboard.h"
+#include "Mouse.h"
+
+namespace ice
+{
+    //! Input Action or Axis Identifier
+    using ActionId = unsigned int;
+
+    //! The id of no action.
+    constexpr ActionId NO_ACTION = 0u;
+
+    //! The number of distinct modifier combinations.
+    constexpr size_t KEY_MOD_COUNT = 16u;
+
+    //! Mouse Axes
+    enum class MouseAxis
+    {
+        X,
+        Y,
+        WHEEL_X,
+        WHEEL_Y
+    };
+
+    class InputMap;
+
+    //! Input Context
+    //!
+    //! An input context is a named set of bindings from keys and mouse
+    //! buttons to actions and from keys and mouse motion to axes. A context
+    //! is only used when it is pushed onto the InputMap's context stack.
+    class ICE_EXPORT InputContext : private non_copyable
+    {
+    public:
+        //! Get the context name.
+        [[nodiscard]] const std::string& get_name() const noexcept;
+
+        //! Bind a key to an action.
+        //!
+        //! The binding matches when at least the given modifiers are held.
+        //! When several bindings match, the one with most modifiers wins.
+        void bind(ActionId action, Key key, KeyMod mod = KeyMod::NONE);
+
+        //! Bind a mouse button to an action.
+        void bind(ActionId action, MouseButton button, KeyMod mod = KeyMod::NONE);
+
+        //! Bind two keys to an axis.
+        //!
+        //! The axis is -scale while the negative key is held and +scale
+        //! while the positive key is held.
+        void bind_axis(ActionId axis, Key negative, Key positive, float scale = 1.0f);
+
+        //! Bind a mouse axis to an axis.
+        //!
+        //! The axis is the motion of the frame multiplied with scale.
+        void bind_axis(ActionId axis, MouseAxis source, float scale = 1.0f);
+
+        //! Remove all bindings.
+        void clear() noexcept;
+
+    private:
+        struct Binding
+        {
+            ActionId     action;
+            unsigned int input;
+            KeyMod       mod;
+        };
+
+        struct AxisBinding
+        {
+            ActionId     axis;
+            unsigned int negative;
+            unsigned int positive;
+            MouseAxis    source;
+            bool         analog;
+            float        scale;
+        };
+
+        InputMap&                map;
+        std::string              name;
+        std::vector<Binding>     bindings;
+        std::vector<AxisBinding> axis_bindings;
+
+        InputContext(InputMap& map, std::string_view name);
+
+        friend class InputMap;
+    };
+
+    //! Input Map
+    //!
+    //! The input map translates key and mouse input into named actions and
+    //! axes. The bindings of the active contexts are compiled into one flat
+    //! table indexed by input and modifier mask; the table is rebuilt when the
+    //! context stack or a binding changes. Resolving the action of a key
+    //! press is therefore a single table lookup.
+    //!
+    //! Contexts higher on the stack override the bindings of lower contexts.
+    //!
+    //! Binding files are line based; `#` starts a comment:
+    //!
+    //!     context <name>
+    //!     bind <action> [MOD+...]<key or button>
+    //!     axis <axis> <negative key> <positive key> [scale]
+    //!     axis <axis> <MOUSE_X|MOUSE_Y|WHEEL_X|WHEEL_Y> [scale]
+    //!
+    //! Keys are named as the Key enumerators, modifiers are SHIFT, CTRL, ALT
+    //! and META and buttons are MOUSE_LEFT, MOUSE_MIDDLE, MOUSE_RIGHT,
+    //! MOUSE_BUTTON4 and MOUSE_BUTTON5. All names are case insensitive.
+    class ICE_EXPORT InputMap : private non_copyable
+    {
+    public:
+        //! Construct Input Map
+        InputMap();
+        ~InputMap();
+
+        //! Get the id of an action or axis, registering the name if needed.
+        ActionId get_action_id(std::string_view name);
+        //! Find the id of an action or axis.
+        //!
+        //! @returns the id or NO_ACTION if the name is unknown
+        [[nodiscard]] ActionId find_action_id(std::string_view name) const noexcept;
+        //! Get the name of an action or axis.
+        [[nodiscard]] const std::string& get_action_name(ActionId action) const noexcept;
+
+        //! Get a context, creating it if needed.
+        InputContext& get_context(std::string_view name);
+
+        //! Push a context onto the stack.
+        void push_context(std::string_view name);
+        //! Pop the top most context from the stack.
+        void pop_context() noexcept;
+        //! Get the number of contexts on the stack.
+        [[nodiscard]] size_t get_context_depth() const noexcept;
+
+        //! Load bindings from a stream.
+        //!
+        //! @throws std::runtime_error on syntax errors
+        void load(std::istream& input);
+        //! Load bindings from a file.
+        //!
+        //! @throws std::runtime_error if the file can't be read or on syntax errors
+        void load(const std::filesystem::path& file);
+
+        //! Get the action bound to a key.
+        [[nodiscard]] ActionId lookup(Key key, KeyMod mod = KeyMod::NONE) noexcept;
+        //! Get the action bound to a mouse button.
+        [[nodiscard]] ActionId lookup(MouseButton button, KeyMod mod = KeyMod::NONE) noexcept;
+
+        //! Check if an action is held.
+        [[nodiscard]] bool is_active(ActionId action) const noexcept;
+        //! Check if an action was triggered this frame.
+        [[nodiscard]] bool was_triggered(ActionId action) const noexcept;
+        //! Check if an action was released this frame.
+        [[nodiscard]] bool was_released(ActionId action) const noexcept;
+
+        //! Get the value of an axis.
+        //!
+        //! The key bindings of an axis are summed and clamped to the range
+        //! -1 to 1 before the mouse motion is added.
+        [[nodiscard]] float get_axis(ActionId axis) noexcept;
+
+        //! Action Down Signal
+        //!
+        //! @{
+        Signal<ActionId>& get_action_down_signal() noexcept;
+        Connection on_action_down(const Delegate<void (ActionId)>& cb) noexcept;
+        //! @}
+
+        //! Action Up Signal
+        //!
+        //! @{
+        Signal<ActionId>& get_action_up_signal() noexcept;
+        Connection on_action_up(const Delegate<void (ActionId)>& cb) noexcept;
+        //! @}
+
+        //! Feed the input of a keyboard and mouse into the map.
+        void attach(Keyboard& keyboard, Mouse& mouse);
+        //! Stop feeding input into the map.
+        void detach() noexcept;
+
+        //! Clear the actions triggered and released and the mouse motion.
+        //!
+        //! This is called by the Engine at the start of each frame.
+        void begin_frame() noexcept;
+
+        //! Handle a key going down.
+        void handle_key_down(KeyMod mod, Key key);
+        //! Handle a key going up.
+        void handle_key_up(KeyMod mod, Key key);
+        //! Handle a mouse button going down.
+        void handle_button_down(MouseButton button);
+        //! Handle a mouse button going up.
+        void handle_button_up(MouseButton button);
+        //! Handle mouse motion.
+        void handle_motion(glm::ivec2 rel) noexcept;
+        //! Handle mouse wheel motion.
+        void handle_wheel(glm::ivec2 delta) noexcept;
+
+    private:
+        struct ActionState
+        {
+            unsigned short held     = 0u;
+            bool           pressed  = false;
+            bool           released = false;
+        };
+
+        using Axis = std::vector<InputContext::AxisBinding>;
+
+        std::vector<std::string>                     action_names;
+        std::map<std::string, ActionId, std::less<>> action_ids;
+        std::vector<std::unique_ptr<InputContext>>   contexts;
+        std::vector<InputContext*>                   stack;
+
+        bool                  dirty = true;
+        std::vector<ActionId> table;
+        std::vector<Axis>     axes;
+
+        std::vector<ActionState>                    states;
+        std::vector<ActionId>                       down_actions;
+        std::bitset<KEY_COUNT + MOUSE_BUTTON_COUNT> down_inputs;
+        KeyMod                                      mods   = KeyMod::NONE;
+        glm::vec2                                   motion = glm::vec2(0.0f);
+        glm::vec2                                   wheel  = glm::vec2(0.0f);
+
+        Signal<ActionId> action_down_signal;
+        Signal<ActionId> action_up_signal;
+
+        std::vector<Connection> connections;
+
+        void compile();
+        KeyMod get_held_mods() const noexcept;
+        void input_down(unsigned int input);
+        void input_up(unsigned int input);
+
+        friend class InputContext;
+    };
+}
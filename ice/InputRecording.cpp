@@ -0,0 +1,436 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "InputRecording.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include <SDL2/SDL.h>
+
+#include "debug.h"
+
+namespace ice
+{
+    constexpr auto     RECORDING_MAGIC   = std::string_view{"ICEINPUT"};
+    constexpr uint8_t  RECORDING_VERSION = 2u;
+
+    enum class RecordType : uint8_t
+    {
+        END,
+        QUIT,
+        WINDOW,
+        KEY_DOWN,
+        KEY_UP,
+        TEXT,
+        MOTION,
+        BUTTON_DOWN,
+        BUTTON_UP,
+        WHEEL,
+        ELAPSED
+    };
+
+    bool get_record_type(Uint32 type, RecordType& result) noexcept
+    {
+        switch (type)
+        {
+        case SDL_QUIT:            result = RecordType::QUIT;        return true;
+        case SDL_WINDOWEVENT:     result = RecordType::WINDOW;      return true;
+        case SDL_KEYDOWN:         result = RecordType::KEY_DOWN;    return true;
+        case SDL_KEYUP:           result = RecordType::KEY_UP;      return true;
+        case SDL_TEXTINPUT:       result = RecordType::TEXT;        return true;
+        case SDL_MOUSEMOTION:     result = RecordType::MOTION;      return true;
+        case SDL_MOUSEBUTTONDOWN: result = RecordType::BUTTON_DOWN; return true;
+        case SDL_MOUSEBUTTONUP:   result = RecordType::BUTTON_UP;   return true;
+        case SDL_MOUSEWHEEL:      result = RecordType::WHEEL;       return true;
+        default:                  return false;
+        }
+    }
+
+    void write_uint(std::string& buffer, uint64_t value)
+    {
+        while (value >= 0x80u)
+        {
+            buffer.push_back(static_cast<char>((value & 0x7Fu) | 0x80u));
+            value >>= 7u;
+        }
+        buffer.push_back(static_cast<char>(value));
+    }
+
+    void write_int(std::string& buffer, int64_t value)
+    {
+        write_uint(buffer, (static_cast<uint64_t>(value) << 1u) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    class RecordReader
+    {
+    public:
+        RecordReader(const std::string& d)
+        : data(d) {}
+
+        bool at_end() const noexcept
+        {
+            return offset >= data.size();
+        }
+
+        uint8_t read_byte()
+        {
+            if (at_end())
+            {
+                throw std::runtime_error("Truncated input recording.");
+            }
+            return static_cast<uint8_t>(data[offset++]);
+        }
+
+        uint64_t read_uint()
+        {
+            auto value = uint64_t{0};
+            for (auto shift = 0u; shift < 64u; shift += 7u)
+            {
+                const auto byte = read_byte();
+                value |= static_cast<uint64_t>(byte & 0x7Fu) << shift;
+                if ((byte & 0x80u) == 0u)
+                {
+                    return value;
+                }
+            }
+            throw std::runtime_error("Corrupt input recording.");
+        }
+
+        int64_t read_int()
+        {
+            const auto value = read_uint();
+            return static_cast<int64_t>(value >> 1u) ^ -static_cast<int64_t>(value & 1u);
+        }
+
+        std::string_view read_bytes(size_t count)
+        {
+            if (data.size() - offset < count)
+            {
+                throw std::runtime_error("Truncated input recording.");
+            }
+            auto result = std::string_view(data).substr(offset, count);
+            offset += count;
+            return result;
+        }
+
+    private:
+        const std::string& data;
+        size_t             offset = 0u;
+    };
+
+    InputRecorder::InputRecorder(const std::filesystem::path& file, const Clock& c)
+    : output(file, std::ios::binary), clock(c), start(c())
+    {
+        if (!output.is_open())
+        {
+            throw std::runtime_error("Failed to open input recording.");
+        }
+
+        output.write(RECORDING_MAGIC.data(), RECORDING_MAGIC.size());
+        output.put(static_cast<char>(RECORDING_VERSION));
+    }
+
+    InputRecorder::~InputRecorder()
+    {
+        // the end marker keeps the trailing frames without input
+        auto buffer = std::string{};
+        write_uint(buffer, frame - last_frame);
+        write_uint(buffer, 0u);
+        buffer.push_back(static_cast<char>(RecordType::END));
+        output.write(buffer.data(), buffer.size());
+    }
+
+    void InputRecorder::record(const SDL_Event& event)
+    {
+        auto type = RecordType::END;
+        if (!get_record_type(event.type, type))
+        {
+            return;
+        }
+
+        auto buffer = std::string{};
+        write_header(buffer, type);
+
+        switch (type)
+        {
+        case RecordType::WINDOW:
+            write_uint(buffer, event.window.event);
+            write_int(buffer, event.window.data1);
+            write_int(buffer, event.window.data2);
+            break;
+        case RecordType::KEY_DOWN:
+        case RecordType::KEY_UP:
+            write_uint(buffer, static_cast<uint64_t>(event.key.keysym.scancode));
+            write_uint(buffer, event.key.keysym.mod);
+            write_uint(buffer, event.key.repeat);
+            break;
+        case RecordType::TEXT:
+        {
+            const auto length = strnlen(event.text.text, sizeof(event.text.text) - 1u);
+            write_uint(buffer, length);
+            buffer.append(event.text.text, length);
+            break;
+        }
+        case RecordType::MOTION:
+            write_uint(buffer, event.motion.state);
+            write_int(buffer, event.motion.x);
+            write_int(buffer, event.motion.y);
+            write_int(buffer, event.motion.xrel);
+            write_int(buffer, event.motion.yrel);
+            break;
+        case RecordType::BUTTON_DOWN:
+        case RecordType::BUTTON_UP:
+            write_uint(buffer, event.button.button);
+            write_uint(buffer, event.button.clicks);
+            write_int(buffer, event.button.x);
+            write_int(buffer, event.button.y);
+            break;
+        case RecordType::WHEEL:
+            write_int(buffer, event.wheel.x);
+            write_int(buffer, event.wheel.y);
+            write_uint(buffer, event.wheel.direction);
+            break;
+        default:
+            break;
+        }
+
+        output.write(buffer.data(), buffer.size());
+        count++;
+    }
+
+    void InputRecorder::record_elapsed(FixedTimestep::duration elapsed)
+    {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+        auto buffer = std::string{};
+        write_header(buffer, RecordType::ELAPSED);
+        write_uint(buffer, static_cast<uint64_t>(std::max(ns, decltype(ns){0})));
+        output.write(buffer.data(), buffer.size());
+    }
+
+    void InputRecorder::write_header(std::string& buffer, RecordType type)
+    {
+        const auto time = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(clock() - start).count());
+
+        write_uint(buffer, frame - last_frame);
+        write_uint(buffer, time >= last_time ? time - last_time : 0u);
+        buffer.push_back(static_cast<char>(type));
+        last_frame = frame;
+        last_time  = std::max(time, last_time);
+    }
+
+    void InputRecorder::end_frame() noexcept
+    {
+        frame++;
+    }
+
+    uint64_t InputRecorder::get_frame() const noexcept
+    {
+        return frame;
+    }
+
+    size_t InputRecorder::get_event_count() const noexcept
+    {
+        return count;
+    }
+
+    void InputRecorder::flush()
+    {
+        output.flush();
+        if (!output)
+        {
+            throw std::runtime_error("Failed to write input recording.");
+        }
+    }
+
+    Uint32 get_sdl_type(RecordType type)
+    {
+        switch (type)
+        {
+        case RecordType::QUIT:        return SDL_QUIT;
+        case RecordType::WINDOW:      return SDL_WINDOWEVENT;
+        case RecordType::KEY_DOWN:    return SDL_KEYDOWN;
+        case RecordType::KEY_UP:      return SDL_KEYUP;
+        case RecordType::TEXT:        return SDL_TEXTINPUT;
+        case RecordType::MOTION:      return SDL_MOUSEMOTION;
+        case RecordType::BUTTON_DOWN: return SDL_MOUSEBUTTONDOWN;
+        case RecordType::BUTTON_UP:   return SDL_MOUSEBUTTONUP;
+        case RecordType::WHEEL:       return SDL_MOUSEWHEEL;
+        default:
+            throw std::runtime_error("Corrupt input recording.");
+        }
+    }
+
+    InputPlayer::InputPlayer(const std::filesystem::path& file)
+    {
+        auto input = std::ifstream(file, std::ios::binary);
+        if (!input.is_open())
+        {
+            throw std::runtime_error("Failed to open input recording.");
+        }
+        const auto data = std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+
+        auto reader = RecordReader(data);
+        if (reader.read_bytes(RECORDING_MAGIC.size()) != RECORDING_MAGIC || reader.read_byte() != RECORDING_VERSION)
+        {
+            throw std::runtime_error("Not an input recording.");
+        }
+
+        auto frame_count = uint64_t{0};
+        auto time        = uint64_t{0};
+        while (!reader.at_end())
+        {
+            frame_count += reader.read_uint();
+            time        += reader.read_uint();
+
+            const auto type = static_cast<RecordType>(reader.read_byte());
+            if (type == RecordType::END)
+            {
+                end_frame_count = frame_count;
+                break;
+            }
+            if (type == RecordType::ELAPSED)
+            {
+                // the engine records the elapsed time of every frame, so there are fewer frames than bytes
+                if (frame_count > data.size())
+                {
+                    throw std::runtime_error("Corrupt input recording.");
+                }
+                if (elapsed.size() <= frame_count)
+                {
+                    elapsed.resize(frame_count + 1u, FixedTimestep::duration::zero());
+                }
+                elapsed[frame_count] = std::chrono::duration_cast<FixedTimestep::duration>(std::chrono::nanoseconds(reader.read_uint()));
+                end_frame_count = frame_count + 1u;
+                continue;
+            }
+
+            auto event = SDL_Event{};
+            event.type = get_sdl_type(type);
+
+            switch (type)
+            {
+            case RecordType::WINDOW:
+                event.window.event = static_cast<Uint8>(reader.read_uint());
+                event.window.data1 = static_cast<Sint32>(reader.read_int());
+                event.window.data2 = static_cast<Sint32>(reader.read_int());
+                break;
+            case RecordType::KEY_DOWN:
+            case RecordType::KEY_UP:
+                event.key.state           = type == RecordType::KEY_DOWN ? SDL_PRESSED : SDL_RELEASED;
+                event.key.keysym.scancode = static_cast<SDL_Scancode>(reader.read_uint());
+                event.key.keysym.mod      = static_cast<Uint16>(reader.read_uint());
+                event.key.repeat          = static_cast<Uint8>(reader.read_uint());
+                break;
+            case RecordType::TEXT:
+            {
+                const auto length = reader.read_uint();
+                if (length >= sizeof(event.text.text))
+                {
+                    throw std::runtime_error("Corrupt input recording.");
+                }
+                const auto text = reader.read_bytes(length);
+                std::memcpy(event.text.text, text.data(), text.size());
+                break;
+            }
+            case RecordType::MOTION:
+                event.motion.state = static_cast<Uint32>(reader.read_uint());
+                event.motion.x     = static_cast<Sint32>(reader.read_int());
+                event.motion.y     = static_cast<Sint32>(reader.read_int());
+                event.motion.xrel  = static_cast<Sint32>(reader.read_int());
+                event.motion.yrel  = static_cast<Sint32>(reader.read_int());
+                break;
+            case RecordType::BUTTON_DOWN:
+            case RecordType::BUTTON_UP:
+                event.button.state  = type == RecordType::BUTTON_DOWN ? SDL_PRESSED : SDL_RELEASED;
+                event.button.button = static_cast<Uint8>(reader.read_uint());
+                event.button.clicks = static_cast<Uint8>(reader.read_uint());
+                event.button.x      = static_cast<Sint32>(reader.read_int());
+                event.button.y      = static_cast<Sint32>(reader.read_int());
+                break;
+            case RecordType::WHEEL:
+                event.wheel.x         = static_cast<Sint32>(reader.read_int());
+                event.wheel.y         = static_cast<Sint32>(reader.read_int());
+                event.wheel.direction = static_cast<Uint32>(reader.read_uint());
+                break;
+            default:
+                break;
+            }
+
+            events.push_back(event);
+            frames.push_back(frame_count);
+            times.push_back(std::chrono::microseconds(time));
+            end_frame_count = frame_count + 1u;
+        }
+    }
+
+    InputPlayer::~InputPlayer() = default;
+
+    std::span<SDL_Event> InputPlayer::get_events() noexcept
+    {
+        const auto first = next;
+        while (next < events.size() && frames[next] <= frame)
+        {
+            next++;
+        }
+        return std::span<SDL_Event>(events.data() + first, next - first);
+    }
+
+    FixedTimestep::duration InputPlayer::get_elapsed() const noexcept
+    {
+        return frame < elapsed.size() ? elapsed[frame] : FixedTimestep::duration::zero();
+    }
+
+    void InputPlayer::end_frame() noexcept
+    {
+        frame++;
+    }
+
+    uint64_t InputPlayer::get_frame() const noexcept
+    {
+        return frame;
+    }
+
+    uint64_t InputPlayer::get_frame_count() const noexcept
+    {
+        return end_frame_count;
+    }
+
+    size_t InputPlayer::get_event_count() const noexcept
+    {
+        return events.size();
+    }
+
+    std::chrono::microseconds InputPlayer::get_time(size_t index) const noexcept
+    {
+        check(index < times.size());
+        return times[index];
+    }
+
+    bool InputPlayer::is_done() const noexcept
+    {
+        return next == events.size() && frame >= end_frame_count;
+    }
+}
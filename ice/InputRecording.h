@@ -0,0 +1,141 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "defines.h"
+#include "utils.h"
+#include "FixedTimestep.h"
+
+union SDL_Event;
+
+namespace ice
+{
+    enum class RecordType : uint8_t;
+
+    //! Input Recorder
+    //!
+    //! The InputRecorder writes input events to a compact binary file. Each
+    //! event is stored with the frame it was routed in and the time since
+    //! the recording started. Only the fields the engine's handlers use are
+    //! stored; frame and time are delta encoded as variable length integers.
+    //!
+    //! Each frame also stores the time the simulation advanced by, so that
+    //! a replay runs the same number of fixed steps in every frame.
+    //!
+    //! Events of other types than quit, window, keyboard and mouse events
+    //! are ignored.
+    class ICE_EXPORT InputRecorder : private non_copyable
+    {
+    public:
+        //! Start Recording
+        //!
+        //! @throws std::runtime_error if the file can't be written
+        InputRecorder(const std::filesystem::path& file, const Clock& clock = std::chrono::steady_clock::now);
+        ~InputRecorder();
+
+        //! Record an event in the current frame.
+        void record(const SDL_Event& event);
+
+        //! Record the time the simulation advanced by in the current frame.
+        void record_elapsed(FixedTimestep::duration elapsed);
+
+        //! Advance to the next frame.
+        void end_frame() noexcept;
+
+        //! Get the current frame.
+        [[nodiscard]] uint64_t get_frame() const noexcept;
+
+        //! Get the number of recorded events.
+        [[nodiscard]] size_t get_event_count() const noexcept;
+
+        //! Write buffered events to the file.
+        void flush();
+
+    private:
+        std::ofstream                         output;
+        Clock                                 clock;
+        std::chrono::steady_clock::time_point start;
+        uint64_t                              frame      = 0u;
+        uint64_t                              last_frame = 0u;
+        uint64_t                              last_time  = 0u;
+        size_t                                count      = 0u;
+
+        void write_header(std::string& buffer, RecordType type);
+    };
+
+    //! Input Player
+    //!
+    //! The InputPlayer reads a file written by the InputRecorder and hands
+    //! out the events frame by frame.
+    class ICE_EXPORT InputPlayer : private non_copyable
+    {
+    public:
+        //! Load Recording
+        //!
+        //! @throws std::runtime_error if the file can't be read or is corrupt
+        InputPlayer(const std::filesystem::path& file);
+        ~InputPlayer();
+
+        //! Get the events of the current frame.
+        //!
+        //! The returned events stay valid as long as the player.
+        std::span<SDL_Event> get_events() noexcept;
+
+        //! Get the time the simulation advanced by in the current frame.
+        [[nodiscard]] FixedTimestep::duration get_elapsed() const noexcept;
+
+        //! Advance to the next frame.
+        void end_frame() noexcept;
+
+        //! Get the current frame.
+        [[nodiscard]] uint64_t get_frame() const noexcept;
+
+        //! Get the number of frames in the recording.
+        [[nodiscard]] uint64_t get_frame_count() const noexcept;
+
+        //! Get the number of events in the recording.
+        [[nodiscard]] size_t get_event_count() const noexcept;
+
+        //! Get the time since the recording started of an event.
+        [[nodiscard]] std::chrono::microseconds get_time(size_t index) const noexcept;
+
+        //! Check if all events were played.
+        [[nodiscard]] bool is_done() const noexcept;
+
+    private:
+        std::vector<SDL_Event>                 events;
+        std::vector<uint64_t>                  frames;
+        std::vector<std::chrono::microseconds> times;
+        std::vector<FixedTimestep::duration>   elapsed;
+        uint64_t                               frame           = 0u;
+        uint64_t                               end_frame_count = 0u;
+        size_t                                 next            = 0u;
+    };
+}
@@ -0,0 +1,262 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "JobSystem.h"
+
+#include <algorithm>
+
+#include "debug.h"
+#include "World.h"
+
+namespace ice
+{
+    namespace
+    {
+        thread_local JobSystem* current_system = nullptr;
+        thread_local size_t     current_index  = 0u;
+    }
+
+    bool JobCounter::is_done() const noexcept
+    {
+        return pending.load(std::memory_order_acquire) == 0u;
+    }
+
+    unsigned int JobCounter::get_pending() const noexcept
+    {
+        return pending.load(std::memory_order_acquire);
+    }
+
+    JobSystem::JobSystem(unsigned int thread_count)
+    {
+        queues.reserve(thread_count);
+        for (auto i = 0u; i < thread_count; i++)
+        {
+            queues.push_back(std::make_unique<Queue>());
+        }
+
+        threads.reserve(thread_count);
+        for (auto i = 0u; i < thread_count; i++)
+        {
+            threads.emplace_back([this, i] (std::stop_token stoken) {
+                work(stoken, i);
+            });
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            auto lock = std::unique_lock{sleep_mutex};
+            for (auto& thread : threads)
+            {
+                thread.request_stop();
+            }
+        }
+        sleep_cond.notify_all();
+        threads.clear();
+    }
+
+    unsigned int JobSystem::get_thread_count() const noexcept
+    {
+        return static_cast<unsigned int>(threads.size());
+    }
+
+    void JobSystem::schedule(JobCounter& counter, const std::function<void ()>& job)
+    {
+        check(static_cast<bool>(job));
+
+        counter.pending.fetch_add(1u, std::memory_order_relaxed);
+
+        // the job inherits the access of the system scheduling it
+        auto j = Job{job, &counter, World::get_thread_access()};
+        if (queues.empty())
+        {
+            execute(j);
+            return;
+        }
+
+        push(std::move(j));
+    }
+
+    void JobSystem::parallel_for(JobCounter& counter, size_t begin, size_t end, size_t grain, const std::function<void (size_t, size_t)>& body)
+    {
+        check(begin <= end);
+        check(static_cast<bool>(body));
+
+        const auto count = end - begin;
+        if (count == 0u)
+        {
+            return;
+        }
+
+        if (grain == 0u)
+        {
+            const auto parts = static_cast<size_t>(get_thread_count()) + 1u;
+            grain = (count + parts - 1u) / parts;
+        }
+
+        for (auto first = begin; first < end; first += grain)
+        {
+            const auto last = std::min(first + grain, end);
+            schedule(counter, [body, first, last] () {
+                body(first, last);
+            });
+        }
+    }
+
+    void JobSystem::wait(const JobCounter& counter) noexcept
+    {
+        while (!counter.is_done())
+        {
+            if (!run_pending())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    bool JobSystem::run_pending() noexcept
+    {
+        auto job = Job{};
+
+        if (current_system == this)
+        {
+            if (pop(current_index, job) || steal(current_index + 1u, job))
+            {
+                execute(job);
+                return true;
+            }
+            return false;
+        }
+
+        if (steal(0u, job))
+        {
+            execute(job);
+            return true;
+        }
+        return false;
+    }
+
+    unsigned int JobSystem::default_thread_count() noexcept
+    {
+        const auto n = std::thread::hardware_concurrency();
+        return n > 1u ? n - 1u : 1u;
+    }
+
+    void JobSystem::push(Job&& job)
+    {
+        // Workers push onto their own queue, everybody else distributes
+        // the jobs round robin.
+        auto index = size_t{0u};
+        if (current_system == this)
+        {
+            index = current_index;
+        }
+        else
+        {
+            index = next_queue.fetch_add(1u, std::memory_order_relaxed) % queues.size();
+        }
+
+        auto& queue = *queues[index];
+        {
+            auto lock = std::unique_lock{queue.mutex};
+            queued.fetch_add(1u);
+            queue.jobs.push_back(std::move(job));
+        }
+
+        if (sleeping.load() > 0u)
+        {
+            auto lock = std::unique_lock{sleep_mutex};
+            sleep_cond.notify_one();
+        }
+    }
+
+    bool JobSystem::pop(size_t index, Job& job) noexcept
+    {
+        auto& queue = *queues[index];
+        auto lock = std::unique_lock{queue.mutex};
+        if (queue.jobs.empty())
+        {
+            return false;
+        }
+        job = std::move(queue.jobs.back());
+        queue.jobs.pop_back();
+        queued.fetch_sub(1u);
+        return true;
+    }
+
+    bool JobSystem::steal(size_t start, Job& job) noexcept
+    {
+        const auto count = queues.size();
+        for (auto i = size_t{0u}; i < count; i++)
+        {
+            auto& queue = *queues[(start + i) % count];
+            auto lock = std::unique_lock{queue.mutex, std::try_to_lock};
+            if (lock.owns_lock() && !queue.jobs.empty())
+            {
+                job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+                queued.fetch_sub(1u);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void JobSystem::execute(Job& job) noexcept
+    {
+        // a thread waiting in a system runs jobs of others, they must not see its access
+        const auto previous = World::set_thread_access(job.access);
+        job.fun();
+        World::set_thread_access(previous);
+        job.counter->pending.fetch_sub(1u, std::memory_order_release);
+    }
+
+    void JobSystem::work(std::stop_token stoken, size_t index) noexcept
+    {
+        current_system = this;
+        current_index  = index;
+
+        auto job = Job{};
+        while (true)
+        {
+            if (pop(index, job) || steal(index + 1u, job))
+            {
+                execute(job);
+                continue;
+            }
+
+            auto lock = std::unique_lock{sleep_mutex};
+            if (stoken.stop_requested() && queued.load() == 0u)
+            {
+                break;
+            }
+
+            sleeping.fetch_add(1u);
+            sleep_cond.wait(lock, [&] () {
+                return queued.load() > 0u || stoken.stop_requested();
+            });
+            sleeping.fetch_sub(1u);
+        }
+
+        current_system = nullptr;
+    }
+}
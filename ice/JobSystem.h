@@ -0,0 +1,143 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "defines.h"
+#include "utils.h"
+
+namespace ice
+{
+    struct SystemAccess;
+
+    //! Job Counter
+    //!
+    //! The job counter tracks the number of outstanding jobs. It is passed to
+    //! the JobSystem when scheduling and is done once all jobs scheduled with
+    //! it have completed.
+    class ICE_EXPORT JobCounter : private non_copyable
+    {
+    public:
+        //! Check if all jobs are completed.
+        [[nodiscard]] bool is_done() const noexcept;
+
+        //! Get the number of pending jobs.
+        [[nodiscard]] unsigned int get_pending() const noexcept;
+
+    private:
+        std::atomic<unsigned int> pending = 0u;
+
+        friend class JobSystem;
+    };
+
+    //! Job System
+    //!
+    //! The JobSystem runs jobs on a set of worker threads. Each worker owns a
+    //! deque of jobs; the worker takes work from the back of its own deque and
+    //! when it runs dry steals from the front of the other workers' deques.
+    //!
+    //! Threads that are not workers, such as the main thread, should wait on
+    //! jobs with wait, which runs pending jobs instead of blocking, or poll
+    //! the counter with JobCounter::is_done.
+    //!
+    //! A job runs with the declared component access of the system that
+    //! scheduled it, see World::set_thread_access.
+    class ICE_EXPORT JobSystem : private non_copyable
+    {
+    public:
+        //! Construct Job System
+        //!
+        //! @param thread_count the number of worker threads
+        JobSystem(unsigned int thread_count = default_thread_count());
+
+        //! Destroy Job System
+        //!
+        //! Pending jobs are completed before the workers are stopped.
+        ~JobSystem();
+
+        //! Get the number of worker threads.
+        [[nodiscard]] unsigned int get_thread_count() const noexcept;
+
+        //! Schedule a job.
+        void schedule(JobCounter& counter, const std::function<void ()>& job);
+
+        //! Schedule a job over an index range.
+        //!
+        //! The range [begin, end) is split into chunks of at most grain
+        //! indices and the body is called with each chunk. If grain is 0, the
+        //! range is split evenly across the workers.
+        void parallel_for(JobCounter& counter, size_t begin, size_t end, size_t grain, const std::function<void (size_t, size_t)>& body);
+
+        //! Wait for the jobs of a counter to complete.
+        //!
+        //! The calling thread runs pending jobs until the counter is done.
+        void wait(const JobCounter& counter) noexcept;
+
+        //! Run a single pending job on the calling thread.
+        //!
+        //! @returns true if a job was run
+        bool run_pending() noexcept;
+
+        //! Get the default number of worker threads.
+        //!
+        //! This is one thread less than the hardware concurrency, leaving a
+        //! core to the main thread.
+        [[nodiscard]] static unsigned int default_thread_count() noexcept;
+
+    private:
+        struct Job
+        {
+            std::function<void ()> fun;
+            JobCounter*            counter = nullptr;
+            const SystemAccess*    access  = nullptr;
+        };
+
+        struct Queue
+        {
+            std::mutex      mutex;
+            std::deque<Job> jobs;
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::jthread>           threads;
+
+        std::atomic<size_t>       queued     = 0u;
+        std::atomic<unsigned int> sleeping   = 0u;
+        std::atomic<unsigned int> next_queue = 0u;
+        std::mutex                sleep_mutex;
+        std::condition_variable   sleep_cond;
+
+        void push(Job&& job);
+        bool pop(size_t index, Job& job) noexcept;
+        bool steal(size_t start, Job& job) noexcept;
+        void execute(Job& job) noexcept;
+        void work(std::stop_token stoken, size_t index) noexcept;
+    };
+}
@@ -0,0 +1,344 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+#include "Keyboard.h"
+
+namespace ice
+{
+    //! A key and its name.
+    struct KeyName
+    {
+        std::string_view name;
+        Key              key;
+
+        // takes the length from the literal, a strlen per name is costly at compile time
+        template <size_t N>
+        constexpr KeyName(const char (&n)[N], Key k) noexcept
+        : name(n, N - 1u), key(k) {}
+    };
+
+    //! The names of all keys.
+    //!
+    //! The names are the Key enumerator names.
+    constexpr auto key_names = std::array<KeyName, 239>{{
+        {"A", Key::A}, {"B", Key::B}, {"C", Key::C}, {"D", Key::D}, {"E", Key::E}, {"F", Key::F},
+        {"G", Key::G}, {"H", Key::H}, {"I", Key::I}, {"J", Key::J}, {"K", Key::K}, {"L", Key::L},
+        {"M", Key::M}, {"N", Key::N}, {"O", Key::O}, {"P", Key::P}, {"Q", Key::Q}, {"R", Key::R},
+        {"S", Key::S}, {"T", Key::T}, {"U", Key::U}, {"V", Key::V}, {"W", Key::W}, {"X", Key::X},
+        {"Y", Key::Y}, {"Z", Key::Z}, {"ONE", Key::ONE}, {"TWO", Key::TWO}, {"THREE", Key::THREE},
+        {"FOUR", Key::FOUR}, {"FIVE", Key::FIVE}, {"SIX", Key::SIX}, {"SEVEN", Key::SEVEN},
+        {"EIGHT", Key::EIGHT}, {"NINE", Key::NINE}, {"ZERO", Key::ZERO}, {"RETURN", Key::RETURN},
+        {"ESCAPE", Key::ESCAPE}, {"BACKSPACE", Key::BACKSPACE}, {"TAB", Key::TAB}, {"SPACE", Key::SPACE},
+        {"MINUS", Key::MINUS}, {"EQUALS", Key::EQUALS}, {"LEFTBRACKET", Key::LEFTBRACKET},
+        {"RIGHTBRACKET", Key::RIGHTBRACKET}, {"BACKSLASH", Key::BACKSLASH}, {"NONUSHASH", Key::NONUSHASH},
+        {"SEMICOLON", Key::SEMICOLON}, {"APOSTROPHE", Key::APOSTROPHE}, {"GRAVE", Key::GRAVE},
+        {"PERIOD", Key::PERIOD}, {"SLASH", Key::SLASH}, {"CAPSLOCK", Key::CAPSLOCK}, {"F1", Key::F1},
+        {"F2", Key::F2}, {"F3", Key::F3}, {"F4", Key::F4}, {"F5", Key::F5}, {"F6", Key::F6}, {"F7", Key::F7},
+        {"F8", Key::F8}, {"F9", Key::F9}, {"F10", Key::F10}, {"F11", Key::F11}, {"F12", Key::F12},
+        {"PRINTSCREEN", Key::PRINTSCREEN}, {"SCROLLLOCK", Key::SCROLLLOCK}, {"PAUSE", Key::PAUSE},
+        {"INSERT", Key::INSERT}, {"HOME", Key::HOME}, {"PAGEUP", Key::PAGEUP}, {"DELETE", Key::DELETE},
+        {"END", Key::END}, {"PAGEDOWN", Key::PAGEDOWN}, {"RIGHT", Key::RIGHT}, {"LEFT", Key::LEFT},
+        {"DOWN", Key::DOWN}, {"UP", Key::UP}, {"NUMLOCKCLEAR", Key::NUMLOCKCLEAR},
+        {"KPDIVIDE", Key::KPDIVIDE}, {"KPMULTIPLY", Key::KPMULTIPLY}, {"KPMINUS", Key::KPMINUS},
+        {"KPPLUS", Key::KPPLUS}, {"KPENTER", Key::KPENTER}, {"KP1", Key::KP1}, {"KP2", Key::KP2},
+        {"KP3", Key::KP3}, {"KP4", Key::KP4}, {"KP5", Key::KP5}, {"KP6", Key::KP6}, {"KP7", Key::KP7},
+        {"KP8", Key::KP8}, {"KP9", Key::KP9}, {"KP0", Key::KP0}, {"KPPERIOD", Key::KPPERIOD},
+        {"NONUSBACKSLASH", Key::NONUSBACKSLASH}, {"APPLICATION", Key::APPLICATION}, {"POWER", Key::POWER},
+        {"KPEQUALS", Key::KPEQUALS}, {"F13", Key::F13}, {"F14", Key::F14}, {"F15", Key::F15},
+        {"F16", Key::F16}, {"F17", Key::F17}, {"F18", Key::F18}, {"F19", Key::F19}, {"F20", Key::F20},
+        {"F21", Key::F21}, {"F22", Key::F22}, {"F23", Key::F23}, {"F24", Key::F24},
+        {"EXECUTE", Key::EXECUTE}, {"HELP", Key::HELP}, {"MENU", Key::MENU}, {"SELECT", Key::SELECT},
+        {"STOP", Key::STOP}, {"AGAIN", Key::AGAIN}, {"UNDO", Key::UNDO}, {"CUT", Key::CUT},
+        {"COPY", Key::COPY}, {"PASTE", Key::PASTE}, {"FIND", Key::FIND}, {"MUTE", Key::MUTE},
+        {"VOLUMEUP", Key::VOLUMEUP}, {"VOLUMEDOWN", Key::VOLUMEDOWN}, {"KPCOMMA", Key::KPCOMMA},
+        {"KPEQUALSAS400", Key::KPEQUALSAS400}, {"INTERNATIONAL1", Key::INTERNATIONAL1},
+        {"INTERNATIONAL2", Key::INTERNATIONAL2}, {"INTERNATIONAL3", Key::INTERNATIONAL3},
+        {"INTERNATIONAL4", Key::INTERNATIONAL4}, {"INTERNATIONAL5", Key::INTERNATIONAL5},
+        {"INTERNATIONAL6", Key::INTERNATIONAL6}, {"INTERNATIONAL7", Key::INTERNATIONAL7},
+        {"INTERNATIONAL8", Key::INTERNATIONAL8}, {"INTERNATIONAL9", Key::INTERNATIONAL9},
+        {"LANG1", Key::LANG1}, {"LANG2", Key::LANG2}, {"LANG3", Key::LANG3}, {"LANG4", Key::LANG4},
+        {"LANG5", Key::LANG5}, {"LANG6", Key::LANG6}, {"LANG7", Key::LANG7}, {"LANG8", Key::LANG8},
+        {"LANG9", Key::LANG9}, {"ALTERASE", Key::ALTERASE}, {"SYSREQ", Key::SYSREQ}, {"CANCEL", Key::CANCEL},
+        {"CLEAR", Key::CLEAR}, {"PRIOR", Key::PRIOR}, {"RETURN2", Key::RETURN2},
+        {"SEPARATOR", Key::SEPARATOR}, {"OUT", Key::OUT}, {"OPER", Key::OPER},
+        {"CLEARAGAIN", Key::CLEARAGAIN}, {"CRSEL", Key::CRSEL}, {"EXSEL", Key::EXSEL}, {"KP00", Key::KP00},
+        {"KP000", Key::KP000}, {"THOUSANDSSEPARATOR", Key::THOUSANDSSEPARATOR},
+        {"DECIMALSEPARATOR", Key::DECIMALSEPARATOR}, {"CURRENCYUNIT", Key::CURRENCYUNIT},
+        {"CURRENCYSUBUNIT", Key::CURRENCYSUBUNIT}, {"KPLEFTPAREN", Key::KPLEFTPAREN},
+        {"KPRIGHTPAREN", Key::KPRIGHTPAREN}, {"KPLEFTBRACE", Key::KPLEFTBRACE},
+        {"KPRIGHTBRACE", Key::KPRIGHTBRACE}, {"KPTAB", Key::KPTAB}, {"KPBACKSPACE", Key::KPBACKSPACE},
+        {"KPA", Key::KPA}, {"KPB", Key::KPB}, {"KPC", Key::KPC}, {"KPD", Key::KPD}, {"KPE", Key::KPE},
+        {"KPF", Key::KPF}, {"KPXOR", Key::KPXOR}, {"KPPOWER", Key::KPPOWER}, {"KPPERCENT", Key::KPPERCENT},
+        {"KPLESS", Key::KPLESS}, {"KPGREATER", Key::KPGREATER}, {"KPAMPERSAND", Key::KPAMPERSAND},
+        {"KPDBLAMPERSAND", Key::KPDBLAMPERSAND}, {"KPVERTICALBAR", Key::KPVERTICALBAR},
+        {"KPDBLVERTICALBAR", Key::KPDBLVERTICALBAR}, {"KPCOLON", Key::KPCOLON}, {"KPHASH", Key::KPHASH},
+        {"KPSPACE", Key::KPSPACE}, {"KPAT", Key::KPAT}, {"KPEXCLAM", Key::KPEXCLAM},
+        {"KPMEMSTORE", Key::KPMEMSTORE}, {"KPMEMRECALL", Key::KPMEMRECALL}, {"KPMEMCLEAR", Key::KPMEMCLEAR},
+        {"KPMEMADD", Key::KPMEMADD}, {"KPMEMSUBTRACT", Key::KPMEMSUBTRACT},
+        {"KPMEMMULTIPLY", Key::KPMEMMULTIPLY}, {"KPMEMDIVIDE", Key::KPMEMDIVIDE},
+        {"KPPLUSMINUS", Key::KPPLUSMINUS}, {"KPCLEAR", Key::KPCLEAR}, {"KPCLEARENTRY", Key::KPCLEARENTRY},
+        {"KPBINARY", Key::KPBINARY}, {"KPOCTAL", Key::KPOCTAL}, {"KPDECIMAL", Key::KPDECIMAL},
+        {"KPHEXADECIMAL", Key::KPHEXADECIMAL}, {"LCTRL", Key::LCTRL}, {"LSHIFT", Key::LSHIFT},
+        {"LALT", Key::LALT}, {"LGUI", Key::LGUI}, {"RCTRL", Key::RCTRL}, {"RSHIFT", Key::RSHIFT},
+        {"RALT", Key::RALT}, {"RGUI", Key::RGUI}, {"MODE", Key::MODE}, {"AUDIONEXT", Key::AUDIONEXT},
+        {"AUDIOPREV", Key::AUDIOPREV}, {"AUDIOSTOP", Key::AUDIOSTOP}, {"AUDIOPLAY", Key::AUDIOPLAY},
+        {"AUDIOMUTE", Key::AUDIOMUTE}, {"MEDIASELECT", Key::MEDIASELECT}, {"WWW", Key::WWW},
+        {"MAIL", Key::MAIL}, {"CALCULATOR", Key::CALCULATOR}, {"COMPUTER", Key::COMPUTER},
+        {"ACSEARCH", Key::ACSEARCH}, {"ACHOME", Key::ACHOME}, {"ACBACK", Key::ACBACK},
+        {"ACFORWARD", Key::ACFORWARD}, {"ACSTOP", Key::ACSTOP}, {"ACREFRESH", Key::ACREFRESH},
+        {"ACBOOKMARKS", Key::ACBOOKMARKS}, {"BRIGHTNESSDOWN", Key::BRIGHTNESSDOWN},
+        {"BRIGHTNESSUP", Key::BRIGHTNESSUP}, {"DISPLAYSWITCH", Key::DISPLAYSWITCH},
+        {"KBDILLUMTOGGLE", Key::KBDILLUMTOGGLE}, {"KBDILLUMDOWN", Key::KBDILLUMDOWN},
+        {"KBDILLUMUP", Key::KBDILLUMUP}, {"EJECT", Key::EJECT}, {"SLEEP", Key::SLEEP}, {"APP1", Key::APP1},
+        {"APP2", Key::APP2}
+    }};
+
+    namespace detail
+    {
+        constexpr char to_upper(char c) noexcept
+        {
+            return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+        }
+
+        constexpr bool iequals(std::string_view a, std::string_view b) noexcept
+        {
+            if (a.size() != b.size())
+            {
+                return false;
+            }
+            for (auto i = 0u; i < a.size(); i++)
+            {
+                if (to_upper(a[i]) != to_upper(b[i]))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        constexpr uint32_t key_name_hash(std::string_view name) noexcept
+        {
+            auto h = 2166136261u;
+            for (auto c : name)
+            {
+                h = (h ^ static_cast<unsigned char>(to_upper(c))) * 16777619u;
+            }
+            return h;
+        }
+
+        constexpr uint32_t key_name_mix(uint32_t hash, uint32_t seed) noexcept
+        {
+            auto h = hash ^ (seed * 0x9e3779b9u);
+            h ^= h >> 15u;
+            h *= 0x2c1b3c6du;
+            h ^= h >> 12u;
+            return h;
+        }
+
+        constexpr size_t KEY_HASH_BUCKETS = 128u;
+        constexpr size_t KEY_HASH_SLOTS   = 512u;
+
+        //! Hash and displace table over key_names.
+        //!
+        //! The name's hash first selects a bucket, the hash mixed with the
+        //! bucket's seed then selects a slot that no other name uses. Slots hold the name index
+        //! plus one, 0 marks an empty slot.
+        struct KeyHashTable
+        {
+            std::array<uint16_t, KEY_HASH_BUCKETS> seeds = {};
+            std::array<uint8_t, KEY_HASH_SLOTS>    slots = {};
+
+            constexpr bool operator == (const KeyHashTable&) const noexcept = default;
+        };
+        static_assert(key_names.size() < 256u, "Slots hold the name index in a byte.");
+
+        //! Search the seeds for a collision free hash table.
+        constexpr KeyHashTable make_key_hash_table()
+        {
+            constexpr auto MAX_BUCKET_SIZE = 16u;
+
+            auto table = KeyHashTable{};
+
+            // sort the names by bucket
+            auto hashes = std::array<uint32_t, key_names.size()>{};
+            auto starts = std::array<uint16_t, KEY_HASH_BUCKETS + 1u>{};
+            for (auto i = 0u; i < key_names.size(); i++)
+            {
+                hashes[i] = key_name_hash(key_names[i].name);
+                starts[hashes[i] % KEY_HASH_BUCKETS + 1u]++;
+            }
+            for (auto b = 0u; b < KEY_HASH_BUCKETS; b++)
+            {
+                if (starts[b + 1u] > MAX_BUCKET_SIZE)
+                {
+                    throw std::logic_error("Key name bucket too large.");
+                }
+                starts[b + 1u] += starts[b];
+            }
+            auto order = std::array<uint16_t, key_names.size()>{};
+            auto next  = starts;
+            for (auto i = 0u; i < key_names.size(); i++)
+            {
+                order[next[hashes[i] % KEY_HASH_BUCKETS]++] = static_cast<uint16_t>(i);
+            }
+
+            // place the largest buckets first, while most slots are free
+            for (auto size = MAX_BUCKET_SIZE; size > 0u; size--)
+            {
+                for (auto b = 0u; b < KEY_HASH_BUCKETS; b++)
+                {
+                    if (static_cast<unsigned int>(starts[b + 1u] - starts[b]) != size)
+                    {
+                        continue;
+                    }
+
+                    auto placed = std::array<uint16_t, MAX_BUCKET_SIZE>{};
+                    for (auto seed = 1u; ; seed++)
+                    {
+                        if (seed > 0xFFFFu)
+                        {
+                            throw std::logic_error("No perfect hash for key names.");
+                        }
+
+                        auto ok = true;
+                        for (auto j = 0u; j < size && ok; j++)
+                        {
+                            const auto slot = key_name_mix(hashes[order[starts[b] + j]], seed) % KEY_HASH_SLOTS;
+                            ok = table.slots[slot] == 0u;
+                            for (auto k = 0u; k < j && ok; k++)
+                            {
+                                ok = placed[k] != slot;
+                            }
+                            placed[j] = static_cast<uint16_t>(slot);
+                        }
+
+                        if (ok)
+                        {
+                            table.seeds[b] = static_cast<uint16_t>(seed);
+                            for (auto j = 0u; j < size; j++)
+                            {
+                                table.slots[placed[j]] = static_cast<uint8_t>(order[starts[b] + j] + 1u);
+                            }
+                            break;
+                        }
+                    }
+                }
+            }
+
+            return table;
+        }
+
+        //! The result of make_key_hash_table.
+        //!
+        //! Searching the seeds is too costly for the compiler's constexpr
+        //! step limits, so the table is kept here and the tests check that it
+        //! matches key_names. Paste the table the failing test prints after
+        //! changing key_names.
+        constexpr auto key_hash_table = KeyHashTable{
+            {
+                1, 1, 0, 6, 1, 1, 0, 1, 2, 0, 1, 2, 1, 1, 3, 1,
+                3, 0, 1, 1, 2, 2, 1, 1, 1, 1, 1, 1, 0, 1, 2, 0,
+                1, 0, 1, 2, 2, 2, 1, 1, 4, 0, 1, 1, 3, 3, 2, 1,
+                1, 2, 1, 2, 0, 1, 1, 1, 1, 1, 2, 0, 2, 2, 1, 1,
+                0, 1, 3, 2, 2, 0, 4, 2, 7, 4, 1, 2, 4, 1, 1, 1,
+                0, 1, 0, 1, 0, 1, 1, 3, 3, 3, 2, 1, 2, 2, 1, 0,
+                4, 3, 5, 1, 1, 1, 1, 0, 1, 2, 3, 0, 4, 3, 9, 2,
+                1, 3, 1, 3, 0, 3, 1, 1, 2, 1, 3, 0, 1, 1, 1, 5
+            },
+            {
+                0, 224, 0, 155, 0, 157, 142, 0, 215, 0, 130, 154, 0, 144, 0, 0,
+                0, 0, 0, 0, 0, 0, 0, 0, 0, 39, 2, 33, 152, 52, 192, 0,
+                126, 221, 0, 175, 0, 0, 0, 0, 0, 23, 35, 0, 10, 0, 0, 163,
+                235, 71, 0, 80, 0, 0, 29, 98, 0, 0, 94, 0, 0, 0, 0, 43,
+                68, 0, 179, 210, 61, 0, 0, 0, 0, 0, 105, 0, 0, 148, 110, 0,
+                182, 93, 0, 149, 212, 0, 124, 18, 37, 42, 160, 7, 0, 161, 31, 0,
+                63, 0, 0, 25, 0, 0, 140, 0, 0, 3, 0, 143, 202, 0, 0, 0,
+                0, 0, 122, 0, 189, 0, 0, 201, 13, 0, 84, 45, 0, 0, 112, 0,
+                0, 0, 197, 0, 0, 75, 0, 0, 0, 6, 153, 97, 0, 0, 0, 8,
+                0, 0, 145, 162, 223, 176, 0, 0, 0, 129, 47, 0, 137, 187, 0, 0,
+                232, 193, 115, 0, 0, 49, 0, 0, 228, 133, 128, 170, 0, 59, 48, 74,
+                0, 0, 0, 44, 109, 178, 0, 208, 0, 0, 0, 0, 0, 58, 0, 0,
+                238, 0, 4, 219, 0, 0, 0, 0, 0, 222, 0, 50, 0, 188, 0, 107,
+                147, 14, 0, 158, 0, 0, 32, 56, 0, 1, 86, 36, 200, 34, 132, 0,
+                15, 0, 237, 85, 171, 0, 0, 0, 0, 167, 78, 191, 88, 0, 0, 0,
+                196, 0, 0, 0, 0, 125, 89, 106, 46, 0, 195, 135, 117, 0, 0, 151,
+                53, 0, 22, 159, 0, 0, 0, 0, 67, 0, 81, 239, 0, 204, 146, 0,
+                0, 134, 0, 0, 227, 165, 150, 70, 0, 0, 172, 0, 0, 119, 0, 0,
+                199, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 123, 0, 0, 0,
+                0, 0, 40, 0, 12, 0, 0, 72, 0, 0, 0, 120, 0, 0, 164, 203,
+                62, 0, 139, 0, 51, 0, 0, 177, 226, 0, 190, 0, 0, 138, 0, 0,
+                24, 90, 211, 173, 198, 0, 0, 169, 116, 0, 184, 66, 0, 0, 95, 82,
+                0, 0, 0, 236, 16, 194, 0, 233, 0, 0, 30, 0, 220, 0, 0, 19,
+                0, 101, 0, 0, 21, 180, 0, 0, 0, 0, 0, 206, 0, 0, 229, 0,
+                0, 0, 214, 0, 181, 0, 0, 77, 0, 166, 0, 73, 217, 0, 0, 0,
+                60, 207, 0, 0, 79, 87, 213, 0, 0, 231, 5, 0, 0, 0, 0, 0,
+                0, 9, 0, 76, 209, 183, 141, 92, 0, 168, 156, 55, 111, 104, 0, 38,
+                205, 0, 103, 0, 64, 216, 100, 0, 54, 136, 0, 102, 83, 0, 0, 108,
+                57, 0, 0, 0, 0, 0, 113, 186, 0, 234, 0, 91, 118, 131, 0, 127,
+                0, 218, 26, 230, 0, 20, 0, 96, 0, 41, 99, 121, 225, 0, 69, 65,
+                0, 0, 0, 114, 0, 0, 0, 0, 0, 0, 0, 0, 27, 0, 0, 0,
+                0, 28, 11, 17, 0, 174, 0, 185, 0, 0, 0, 0, 0, 0, 0, 0
+            }
+        };
+    }
+
+    //! Get the key for a name.
+    //!
+    //! The name is compared case insensitive and resolved with a precomputed
+    //! perfect hash, so a lookup is one hash and one
+    //! string compare.
+    //!
+    //! @returns the key or Key::UNDEFINED for unknown names
+    constexpr Key parse_key(std::string_view name) noexcept
+    {
+        const auto hash   = detail::key_name_hash(name);
+        const auto seed   = detail::key_hash_table.seeds[hash % detail::KEY_HASH_BUCKETS];
+        const auto slot   = detail::key_name_mix(hash, seed) % detail::KEY_HASH_SLOTS;
+        const auto index  = detail::key_hash_table.slots[slot];
+        if (index == 0u || !detail::iequals(key_names[index - 1u].name, name))
+        {
+            return Key::UNDEFINED;
+        }
+        return key_names[index - 1u].key;
+    }
+
+    //! Get the name of a key.
+    //!
+    //! @returns the name or an empty string for unknown keys
+    constexpr std::string_view get_key_name(Key key) noexcept
+    {
+        for (const auto& [name, value] : key_names)
+        {
+            if (value == key)
+            {
+                return name;
+            }
+        }
+        return {};
+    }
+}
@@ -32,6 +32,22 @@ namespace ice
         return static_cast<Key>(sc);
     }
 
+    void set_key(KeyMask& mask, SDL_Scancode sc) noexcept
+    {
+        if (static_cast<size_t>(sc) < KEY_COUNT)
+        {
+            mask.set(static_cast<size_t>(sc));
+        }
+    }
+
+    void clear_key(KeyMask& mask, SDL_Scancode sc) noexcept
+    {
+        if (static_cast<size_t>(sc) < KEY_COUNT)
+        {
+            mask.reset(static_cast<size_t>(sc));
+        }
+    }
+
     KeyMod sdl2mod(Uint16 mod)
     {
         auto result = KeyMod::NONE;
@@ -56,53 +72,97 @@ namespace ice
         return result;
     }
 
+    KeyMask make_key_mask(std::initializer_list<Key> keys) noexcept
+    {
+        auto mask = KeyMask{};
+        for (auto key : keys)
+        {
+            mask.set(static_cast<size_t>(key));
+        }
+        return mask;
+    }
+
     bool Keyboard::is_pressed(Key key) const noexcept
     {
-        int numkeys = 0;
-        auto keys = SDL_GetKeyboardState(&numkeys);
-        check(keys != nullptr);
-        check(numkeys < static_cast<int>(key));
-        return keys[static_cast<int>(key)] == SDL_TRUE;
+        return pressed.test(static_cast<size_t>(key));
     }
 
-    rsig::signal<KeyMod, Key>& Keyboard::get_key_down_signal() noexcept
+    bool Keyboard::was_pressed_this_frame(Key key) const noexcept
+    {
+        return went_down.test(static_cast<size_t>(key));
+    }
+
+    bool Keyboard::was_released_this_frame(Key key) const noexcept
+    {
+        return went_up.test(static_cast<size_t>(key));
+    }
+
+    bool Keyboard::all_pressed(const KeyMask& mask) const noexcept
+    {
+        return (pressed & mask) == mask;
+    }
+
+    bool Keyboard::any_pressed(const KeyMask& mask) const noexcept
+    {
+        return (pressed & mask).any();
+    }
+
+    const KeyMask& Keyboard::get_pressed() const noexcept
+    {
+        return pressed;
+    }
+
+    Signal<KeyMod, Key>& Keyboard::get_key_down_signal() noexcept
     {
         return key_down_signal;
     }
 
-    rsig::connection Keyboard::on_key_down(const std::function<void(KeyMod, Key)>& cb) noexcept
+    Connection Keyboard::on_key_down(const Delegate<void (KeyMod, Key)>& cb) noexcept
     {
         return key_down_signal.connect(cb);
     }
 
-    rsig::signal<KeyMod, Key>& Keyboard::get_key_up_signal() noexcept
+    Signal<KeyMod, Key>& Keyboard::get_key_up_signal() noexcept
     {
         return key_up_signal;
     }
 
-    rsig::connection Keyboard::on_key_up(const std::function<void(KeyMod, Key)>& cb) noexcept
+    Connection Keyboard::on_key_up(const Delegate<void (KeyMod, Key)>& cb) noexcept
     {
         return key_up_signal.connect(cb);
     }
 
-    rsig::signal<const std::string_view>& Keyboard::get_text_signal() noexcept
+    Signal<const std::string_view>& Keyboard::get_text_signal() noexcept
     {
         return text_signal;
     }
 
-    rsig::connection Keyboard::on_text(const std::function<void(const std::string_view)>& cb) noexcept
+    Connection Keyboard::on_text(const Delegate<void (const std::string_view)>& cb) noexcept
     {
         return text_signal.connect(cb);
     }
 
+    void Keyboard::begin_frame() noexcept
+    {
+        went_down.reset();
+        went_up.reset();
+    }
+
     void Keyboard::handle_event(SDL_Event& event)
     {
         switch (event.type)
         {
         case SDL_KEYDOWN:
+            if (event.key.repeat == 0)
+            {
+                set_key(went_down, event.key.keysym.scancode);
+                set_key(pressed, event.key.keysym.scancode);
+            }
             key_down_signal.emit(sdl2mod(event.key.keysym.mod), sdl2key(event.key.keysym.scancode));
             break;
         case SDL_KEYUP:
+            set_key(went_up, event.key.keysym.scancode);
+            clear_key(pressed, event.key.keysym.scancode);
             key_up_signal.emit(sdl2mod(event.key.keysym.mod), sdl2key(event.key.keysym.scancode));
             break;
         case SDL_TEXTINPUT:
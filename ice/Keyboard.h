@@ -21,12 +21,14 @@
 
 #pragma once
 
+#include <bitset>
 #include <functional>
+#include <initializer_list>
 #include <glm/glm.hpp>
-#include <rsig/rsig.h>
 
 #include "defines.h"
 #include "utils.h"
+#include "Signal.h"
 
 #ifdef DELETE
 #undef DELETE
@@ -295,39 +297,72 @@ namespace ice
     };
     ICE_ENUM_BIT_OPERATORS(KeyMod);
 
+    //! The number of distinct keys.
+    constexpr size_t KEY_COUNT = 512u;
+
+    //! Set of Keys
+    using KeyMask = std::bitset<KEY_COUNT>;
+
+    //! Create a set of keys.
+    ICE_EXPORT KeyMask make_key_mask(std::initializer_list<Key> keys) noexcept;
+
     //! Keyboard
+    //!
+    //! The keyboard state is tracked from the key events of each frame. The
+    //! queries only look at this snapshot and never call into SDL. A key
+    //! that is pressed and released within one frame reports both edges.
     class ICE_EXPORT Keyboard : private non_copyable
     {
     public:
         //! Check if a key is pressed.
-        bool is_pressed(Key key) const noexcept;
+        [[nodiscard]] bool is_pressed(Key key) const noexcept;
+
+        //! Check if a key went down this frame.
+        [[nodiscard]] bool was_pressed_this_frame(Key key) const noexcept;
+
+        //! Check if a key went up this frame.
+        [[nodiscard]] bool was_released_this_frame(Key key) const noexcept;
+
+        //! Check if all keys in the mask are pressed.
+        [[nodiscard]] bool all_pressed(const KeyMask& mask) const noexcept;
+
+        //! Check if any key in the mask is pressed.
+        [[nodiscard]] bool any_pressed(const KeyMask& mask) const noexcept;
+
+        //! Get the keys that are pressed.
+        [[nodiscard]] const KeyMask& get_pressed() const noexcept;
 
         //! Key Down Signal
         //!
         //! @{
-        rsig::signal<KeyMod, Key>& get_key_down_signal() noexcept;
-        rsig::connection on_key_down(const std::function<void (KeyMod, Key)>& cb) noexcept;
+        Signal<KeyMod, Key>& get_key_down_signal() noexcept;
+        Connection on_key_down(const Delegate<void (KeyMod, Key)>& cb) noexcept;
         //! @}
 
         //! Key Up Signal
         //!
         //! @{
-        rsig::signal<KeyMod, Key>& get_key_up_signal() noexcept;
-        rsig::connection on_key_up(const std::function<void (KeyMod, Key)>& cb) noexcept;
+        Signal<KeyMod, Key>& get_key_up_signal() noexcept;
+        Connection on_key_up(const Delegate<void (KeyMod, Key)>& cb) noexcept;
         //! @}
 
         //! Text Signal
         //!
         //! @{
-        rsig::signal<const std::string_view>& get_text_signal() noexcept;
-        rsig::connection on_text(const std::function<void (const std::string_view)>& cb) noexcept;
+        Signal<const std::string_view>& get_text_signal() noexcept;
+        Connection on_text(const Delegate<void (const std::string_view)>& cb) noexcept;
         //! @}
 
     private:
-        rsig::signal<KeyMod, Key>            key_down_signal;
-        rsig::signal<KeyMod, Key>            key_up_signal;
-        rsig::signal<const std::string_view> text_signal;
+        Signal<KeyMod, Key>            key_down_signal;
+        Signal<KeyMod, Key>            key_up_signal;
+        Signal<const std::string_view> text_signal;
+
+        KeyMask pressed;
+        KeyMask went_down;
+        KeyMask went_up;
 
+        void begin_frame() noexcept;
         void handle_event(SDL_Event& event);
 
         friend class Engine;
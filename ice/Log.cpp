@@ -0,0 +1,493 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Log.h"
+
+#include "ByteRing.h"
+
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+#if _WIN32
+#include <windows.h>
+#endif
+
+namespace ice
+{
+    //! Header of a message in a ring, the text follows directly.
+    struct LogEntry
+    {
+        uint32_t    line;
+        uint32_t    length;
+        const char* file;
+        const char* function;
+        const char* category;
+        int64_t     time;
+        LogLevel    level;
+    };
+
+    //! The messages of one thread.
+    struct LogRing
+    {
+        ByteRing            buffer;
+        uint32_t            thread  = 0u;
+        std::atomic<bool>   closed  = false;
+        std::atomic<size_t> dropped = 0u;
+
+        LogRing(size_t capacity)
+        : buffer(capacity)
+        {}
+    };
+
+    namespace
+    {
+        //! Marks the ring as closed when the thread exits.
+        struct LogRingHandle
+        {
+            std::shared_ptr<LogRing> ring;
+
+            ~LogRingHandle()
+            {
+                if (ring)
+                {
+                    ring->closed = true;
+                }
+            }
+        };
+
+        thread_local LogRingHandle thread_ring;
+        std::atomic<uint32_t>      next_thread = 0u;
+        //! Constant initialized, so it can be read after the logger is destroyed.
+        std::atomic<bool>          logger_destroyed = false;
+
+        //! Lock, or only try to if the owner of the lock may be gone.
+        bool acquire(std::unique_lock<std::mutex>& lock, bool try_only) noexcept
+        {
+            if (try_only)
+            {
+                return lock.try_lock();
+            }
+            lock.lock();
+            return true;
+        }
+    }
+
+    std::string_view get_file_name(std::string_view path) noexcept
+    {
+        auto i = path.find_last_of("\\/");
+        return i == std::string_view::npos ? path : path.substr(i + 1u);
+    }
+
+    std::string format_log_line(const LogMessage& message)
+    {
+        if (message.category.empty())
+        {
+            return std::format("{}({}): {}: {}\n", get_file_name(message.file), message.line, message.function, message.text);
+        }
+        return std::format("{}({}): {}: [{}] {}: {}\n", get_file_name(message.file), message.line, message.function, message.category, get_level_name(message.level), message.text);
+    }
+
+    void DebugSink::write(const LogMessage& message)
+    {
+        const auto line = format_log_line(message);
+        #ifdef _WIN32
+        OutputDebugStringA(line.c_str());
+        #else
+        std::clog << line;
+        #endif
+    }
+
+    void DebugSink::flush()
+    {
+        std::clog.flush();
+    }
+
+    void StderrSink::write(const LogMessage& message)
+    {
+        std::cerr << format_log_line(message);
+    }
+
+    void StderrSink::flush()
+    {
+        std::cerr.flush();
+    }
+
+    RotatingFileSink::RotatingFileSink(const std::filesystem::path& f, size_t ms, unsigned int mf)
+    : file(f), max_size(ms), max_files(mf)
+    {
+        output.open(file, std::ios::app);
+        if (!output)
+        {
+            throw std::runtime_error("Failed to open log file.");
+        }
+
+        auto ec = std::error_code{};
+        size = static_cast<size_t>(std::filesystem::file_size(file, ec));
+    }
+
+    void RotatingFileSink::write(const LogMessage& message)
+    {
+        const auto line = format_log_line(message);
+        if (size > 0u && size + line.size() > max_size)
+        {
+            rotate();
+        }
+        output << line;
+        size += line.size();
+    }
+
+    void RotatingFileSink::flush()
+    {
+        output.flush();
+    }
+
+    std::filesystem::path RotatingFileSink::get_backup(unsigned int index) const
+    {
+        auto result = file;
+        result.replace_extension(std::to_string(index) + file.extension().string());
+        return result;
+    }
+
+    void RotatingFileSink::rotate()
+    {
+        output.close();
+
+        auto ec = std::error_code{};
+        if (max_files == 0u)
+        {
+            std::filesystem::remove(file, ec);
+        }
+        else
+        {
+            std::filesystem::remove(get_backup(max_files), ec);
+            for (auto i = max_files; i > 1u; i--)
+            {
+                std::filesystem::rename(get_backup(i - 1u), get_backup(i), ec);
+            }
+            std::filesystem::rename(file, get_backup(1u), ec);
+        }
+
+        output.open(file, std::ios::trunc);
+        size = 0u;
+    }
+
+    void MemorySink::write(const LogMessage& message)
+    {
+        auto line = format_log_line(message);
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        lines.push_back(std::move(line));
+    }
+
+    std::vector<std::string> MemorySink::get_lines() const
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        return lines;
+    }
+
+    void MemorySink::clear() noexcept
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        lines.clear();
+    }
+
+    Logger& Logger::get() noexcept
+    {
+        static auto logger = Logger{};
+        return logger;
+    }
+
+    Logger* Logger::try_get() noexcept
+    {
+        if (logger_destroyed.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+        return &get();
+    }
+
+    Logger::Logger()
+    : wakeup(std::make_unique<LogWakeup>()), process(get_process_id())
+    {
+        sinks.push_back(std::make_shared<DebugSink>());
+        thread = std::thread([this] () {
+            run();
+        });
+    }
+
+    Logger::~Logger()
+    {
+        logger_destroyed.store(true, std::memory_order_release);
+
+        if (is_forked())
+        {
+            // only the forking thread was copied into the child, there is nothing to join
+            thread.detach();
+            drain();
+            static_cast<void>(wakeup.release());
+            return;
+        }
+
+        {
+            auto lock = std::unique_lock<std::mutex>{wakeup->mutex};
+            wakeup->running = false;
+        }
+        wakeup->cond.notify_all();
+        thread.join();
+        drain();
+    }
+
+    bool Logger::is_forked() const noexcept
+    {
+        return get_process_id() != process;
+    }
+
+    void Logger::add_sink(const std::shared_ptr<LogSink>& sink)
+    {
+        check(sink != nullptr);
+        auto lock = std::unique_lock<std::mutex>{drain_mutex};
+        sinks.push_back(sink);
+    }
+
+    void Logger::remove_sink(const std::shared_ptr<LogSink>& sink)
+    {
+        auto lock = std::unique_lock<std::mutex>{drain_mutex};
+        std::erase(sinks, sink);
+    }
+
+    void Logger::clear_sinks()
+    {
+        auto lock = std::unique_lock<std::mutex>{drain_mutex};
+        sinks.clear();
+    }
+
+    void Logger::set_buffer_size(size_t value) noexcept
+    {
+        buffer_size = value;
+    }
+
+    size_t Logger::get_buffer_size() const noexcept
+    {
+        return buffer_size;
+    }
+
+    void Logger::set_overflow(LogOverflow value) noexcept
+    {
+        overflow = value;
+    }
+
+    LogOverflow Logger::get_overflow() const noexcept
+    {
+        return overflow;
+    }
+
+    void Logger::write(const std::string_view text, const std::source_location& location, LogLevel level, const char* category) noexcept
+    {
+        auto ring = get_ring();
+        if (ring == nullptr)
+        {
+            return;
+        }
+
+        const auto length = std::min(text.size(), ring->buffer.get_capacity() / 4u - sizeof(LogEntry));
+
+        auto dst = static_cast<std::byte*>(nullptr);
+        while ((dst = ring->buffer.reserve(sizeof(LogEntry) + length)) == nullptr)
+        {
+            wake();
+            // in a forked child no log thread makes room
+            if (overflow.load(std::memory_order_relaxed) == LogOverflow::DROP || is_forked())
+            {
+                ring->dropped.fetch_add(1u, std::memory_order_relaxed);
+                return;
+            }
+            std::this_thread::yield();
+        }
+
+        auto entry = LogEntry{};
+        entry.line     = location.line();
+        entry.length   = static_cast<uint32_t>(length);
+        entry.file     = location.file_name();
+        entry.function = location.function_name();
+        entry.category = category;
+        entry.time     = std::chrono::system_clock::now().time_since_epoch().count();
+        entry.level    = level;
+
+        std::memcpy(dst, &entry, sizeof(LogEntry));
+        std::memcpy(dst + sizeof(LogEntry), text.data(), length);
+        ring->buffer.commit();
+    }
+
+    void Logger::flush() noexcept
+    {
+        drain();
+    }
+
+    LogStats Logger::get_stats() const noexcept
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+
+        auto result = LogStats{};
+        result.written = written;
+        result.dropped = dropped;
+        for (const auto& ring : rings)
+        {
+            result.dropped += ring->dropped.load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    LogRing* Logger::get_ring() noexcept
+    {
+        if (thread_ring.ring)
+        {
+            return thread_ring.ring.get();
+        }
+
+        try
+        {
+            auto ring = std::make_shared<LogRing>(std::max(buffer_size.load(), size_t{1024u}));
+            ring->thread = next_thread++;
+
+            auto lock = std::unique_lock<std::mutex>{mutex};
+            rings.push_back(ring);
+            thread_ring.ring = ring;
+            return ring.get();
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+
+    void Logger::wake() noexcept
+    {
+        if (!wake_requested.exchange(true, std::memory_order_relaxed))
+        {
+            wakeup->cond.notify_one();
+        }
+    }
+
+    void Logger::drain() noexcept
+    {
+        // a thread that was not copied into a forked child may have held the locks
+        const auto forked = is_forked();
+
+        auto lock = std::unique_lock<std::mutex>{drain_mutex, std::defer_lock};
+        if (!acquire(lock, forked))
+        {
+            return;
+        }
+
+        auto current = std::vector<std::shared_ptr<LogRing>>{};
+        {
+            auto rings_lock = std::unique_lock<std::mutex>{mutex, std::defer_lock};
+            if (!acquire(rings_lock, forked))
+            {
+                return;
+            }
+            current = rings;
+        }
+
+        auto count = size_t{0u};
+        for (auto& ring : current)
+        {
+            // only drain what is there now, a busy thread could keep us here
+            auto pending = ring->buffer.get_capacity();
+            auto record  = ring->buffer.peek();
+            while (!record.empty() && pending >= record.size())
+            {
+                pending -= record.size();
+
+                auto entry = LogEntry{};
+                std::memcpy(&entry, record.data(), sizeof(LogEntry));
+
+                auto message = LogMessage{};
+                message.time     = std::chrono::system_clock::time_point{std::chrono::system_clock::duration{entry.time}};
+                message.thread   = ring->thread;
+                message.file     = entry.file;
+                message.function = entry.function;
+                message.line     = entry.line;
+                message.category = entry.category != nullptr ? entry.category : "";
+                message.level    = entry.level;
+                message.text     = {reinterpret_cast<const char*>(record.data() + sizeof(LogEntry)), entry.length};
+
+                for (auto& sink : sinks)
+                {
+                    try
+                    {
+                        sink->write(message);
+                    }
+                    catch (...) {}
+                }
+                count++;
+
+                ring->buffer.pop();
+                record = ring->buffer.peek();
+            }
+        }
+
+        for (auto& sink : sinks)
+        {
+            try
+            {
+                sink->flush();
+            }
+            catch (...) {}
+        }
+        written += count;
+
+        // forget the rings of threads that are gone
+        auto rings_lock = std::unique_lock<std::mutex>{mutex, std::defer_lock};
+        if (!acquire(rings_lock, forked))
+        {
+            return;
+        }
+        std::erase_if(rings, [this] (const auto& ring) {
+            if (ring->closed && ring->buffer.is_empty())
+            {
+                dropped += ring->dropped.load(std::memory_order_relaxed);
+                return true;
+            }
+            return false;
+        });
+    }
+
+    void Logger::run() noexcept
+    {
+        while (true)
+        {
+            {
+                auto lock = std::unique_lock<std::mutex>{wakeup->mutex};
+                wakeup->cond.wait_for(lock, std::chrono::milliseconds(10), [this] () {
+                    return !wakeup->running || wake_requested.load(std::memory_order_relaxed);
+                });
+                if (!wakeup->running)
+                {
+                    return;
+                }
+            }
+            wake_requested.store(false, std::memory_order_relaxed);
+            drain();
+        }
+    }
+}
@@ -0,0 +1,263 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <source_location>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "defines.h"
+#include "utils.h"
+
+namespace ice
+{
+    //! Log Message
+    //!
+    //! The views are only valid during the call to the sink.
+    struct LogMessage
+    {
+        std::chrono::system_clock::time_point time;
+        uint32_t                              thread = 0u;
+        std::string_view                      file;
+        std::string_view                      function;
+        uint32_t                              line = 0u;
+        //! The category, empty for messages passed to trace.
+        std::string_view                      category;
+        LogLevel                              level = LogLevel::INFO;
+        std::string_view                      text;
+    };
+
+    //! Format a message the way trace always did.
+    //!
+    //! The line reads "file(line): function: text" followed by a newline.
+    //! Messages with a category get "[category] level: " before the text.
+    ICE_EXPORT std::string format_log_line(const LogMessage& message);
+
+    //! Log Sink
+    //!
+    //! Sinks are called on the log thread only.
+    class ICE_EXPORT LogSink : private non_copyable
+    {
+    public:
+        virtual ~LogSink() = default;
+
+        //! Write one message.
+        virtual void write(const LogMessage& message) = 0;
+
+        //! Flush buffered output, called after each batch of messages.
+        virtual void flush() {}
+    };
+
+    //! Debug Output Sink
+    //!
+    //! Writes to OutputDebugString on Windows and to std::clog elsewhere.
+    class ICE_EXPORT DebugSink : public LogSink
+    {
+    public:
+        void write(const LogMessage& message) override;
+        void flush() override;
+    };
+
+    //! Standard Error Sink
+    class ICE_EXPORT StderrSink : public LogSink
+    {
+    public:
+        void write(const LogMessage& message) override;
+        void flush() override;
+    };
+
+    //! Rotating File Sink
+    //!
+    //! When the file grows beyond the maximum size, it is renamed to
+    //! name.1.ext, older files are moved up by one and the oldest is removed.
+    class ICE_EXPORT RotatingFileSink : public LogSink
+    {
+    public:
+        //! Open Log File
+        //!
+        //! @param file the log file
+        //! @param max_size the size after which the file is rotated
+        //! @param max_files the number of old files kept
+        //!
+        //! @throws std::runtime_error if the file can't be written
+        RotatingFileSink(const std::filesystem::path& file, size_t max_size = 8u << 20u, unsigned int max_files = 3u);
+
+        void write(const LogMessage& message) override;
+        void flush() override;
+
+    private:
+        std::filesystem::path file;
+        size_t                max_size;
+        unsigned int          max_files;
+        std::ofstream         output;
+        size_t                size = 0u;
+
+        std::filesystem::path get_backup(unsigned int index) const;
+        void rotate();
+    };
+
+    //! Memory Sink
+    //!
+    //! Keeps the formatted lines, meant for tests.
+    class ICE_EXPORT MemorySink : public LogSink
+    {
+    public:
+        void write(const LogMessage& message) override;
+
+        //! Get a copy of the lines written so far.
+        [[nodiscard]] std::vector<std::string> get_lines() const;
+
+        //! Discard the lines.
+        void clear() noexcept;
+
+    private:
+        mutable std::mutex       mutex;
+        std::vector<std::string> lines;
+    };
+
+    //! Log Overflow Policy
+    enum class LogOverflow
+    {
+        //! Drop the message and count it.
+        DROP,
+        //! Wait until the log thread made room.
+        BLOCK
+    };
+
+    //! Log Statistics
+    struct LogStats
+    {
+        //! The number of messages passed to the sinks.
+        size_t written = 0u;
+        //! The number of messages dropped because a buffer was full.
+        size_t dropped = 0u;
+    };
+
+    //! Wakes a log thread.
+    //!
+    //! Allocated on its own, so a forked child can leak it. The child
+    //! inherits the condition in the state the parent's log thread left it
+    //! and destroying it would wait for that thread forever.
+    struct LogWakeup
+    {
+        std::mutex              mutex;
+        std::condition_variable cond;
+        bool                    running = true;
+    };
+
+    struct LogRing;
+
+    //! Logger
+    //!
+    //! The logger is the backend of trace. Each thread writes its messages
+    //! unformatted into its own ring buffer without locking or allocating;
+    //! the log thread drains the rings, formats the messages and passes them
+    //! to the sinks.
+    //!
+    //! Sinks must not call trace, the log thread would wait on itself.
+    //!
+    //! In a child created with fork the log thread does not exist. The
+    //! child's messages are only written by flush and the logger is not
+    //! joined when the child exits.
+    class ICE_EXPORT Logger : private non_copyable
+    {
+    public:
+        //! Get the logger.
+        [[nodiscard]] static Logger& get() noexcept;
+
+        //! Get the logger unless it was destroyed.
+        //!
+        //! Threads still running during static destruction use this to not
+        //! touch the logger after it is gone.
+        //!
+        //! @returns the logger or nullptr
+        [[nodiscard]] static Logger* try_get() noexcept;
+
+        ~Logger();
+
+        //! Add a sink.
+        void add_sink(const std::shared_ptr<LogSink>& sink);
+        //! Remove a sink.
+        void remove_sink(const std::shared_ptr<LogSink>& sink);
+        //! Remove all sinks, including the default debug sink.
+        void clear_sinks();
+
+        //! Set the buffer size in bytes of threads that log for the first time.
+        //!
+        //! The size is rounded up to a power of two. Longer messages are cut.
+        void set_buffer_size(size_t value) noexcept;
+        //! Get the buffer size in bytes of new threads.
+        [[nodiscard]] size_t get_buffer_size() const noexcept;
+
+        //! Set what happens when a thread's buffer is full.
+        void set_overflow(LogOverflow value) noexcept;
+        //! Get what happens when a thread's buffer is full.
+        [[nodiscard]] LogOverflow get_overflow() const noexcept;
+
+        //! Queue a message.
+        //!
+        //! @param category a string that outlives the logger, usually a literal
+        void write(const std::string_view text, const std::source_location& location, LogLevel level = LogLevel::INFO, const char* category = nullptr) noexcept;
+
+        //! Pass all queued messages to the sinks.
+        //!
+        //! This runs on the calling thread and returns when the messages
+        //! are written.
+        void flush() noexcept;
+
+        //! Get the statistics.
+        [[nodiscard]] LogStats get_stats() const noexcept;
+
+    private:
+        mutable std::mutex                    mutex;
+        std::vector<std::shared_ptr<LogRing>> rings;
+        std::atomic<size_t>                   buffer_size = 64u << 10u;
+        std::atomic<LogOverflow>              overflow    = LogOverflow::DROP;
+        size_t                                dropped     = 0u;
+
+        std::mutex                            drain_mutex;
+        std::vector<std::shared_ptr<LogSink>> sinks;
+        std::atomic<size_t>                   written = 0u;
+
+        std::unique_ptr<LogWakeup> wakeup;
+        std::atomic<bool>          wake_requested = false;
+        std::thread                thread;
+        int                        process = 0;
+
+        Logger();
+        bool is_forked() const noexcept;
+        LogRing* get_ring() noexcept;
+        void wake() noexcept;
+        void drain() noexcept;
+        void run() noexcept;
+    };
+}
@@ -27,6 +27,26 @@
 
 namespace ice
 {
+    bool Mouse::is_pressed(MouseButton button) const noexcept
+    {
+        return pressed.test(static_cast<size_t>(button));
+    }
+
+    bool Mouse::was_pressed_this_frame(MouseButton button) const noexcept
+    {
+        return went_down.test(static_cast<size_t>(button));
+    }
+
+    bool Mouse::was_released_this_frame(MouseButton button) const noexcept
+    {
+        return went_up.test(static_cast<size_t>(button));
+    }
+
+    const MouseButtonMask& Mouse::get_pressed() const noexcept
+    {
+        return pressed;
+    }
+
     void Mouse::set_cursor_visible(bool value) noexcept
     {
         if (value)
@@ -58,46 +78,52 @@ namespace ice
         SDL_WarpMouseInWindow(window.window, x, y);
     }
 
-    rsig::signal<MouseButton, glm::ivec2>& Mouse::get_button_down_signal() noexcept
+    Signal<MouseButton, glm::ivec2>& Mouse::get_button_down_signal() noexcept
     {
         return button_down_signal;
     }
 
-    rsig::connection Mouse::on_button_down(const std::function<void(MouseButton, glm::ivec2)>& cb) noexcept
+    Connection Mouse::on_button_down(const Delegate<void (MouseButton, glm::ivec2)>& cb) noexcept
     {
         return button_down_signal.connect(cb);
     }
 
-    rsig::signal<MouseButton, glm::ivec2>& Mouse::get_button_up_signal() noexcept
+    Signal<MouseButton, glm::ivec2>& Mouse::get_button_up_signal() noexcept
     {
         return button_up_signal;
     }
 
-    rsig::connection Mouse::on_button_up(const std::function<void(MouseButton, glm::ivec2)>& cb) noexcept
+    Connection Mouse::on_button_up(const Delegate<void (MouseButton, glm::ivec2)>& cb) noexcept
     {
         return button_up_signal.connect(cb);
     }
 
-    rsig::signal<glm::ivec2, glm::ivec2>& Mouse::get_move_signal() noexcept
+    Signal<glm::ivec2, glm::ivec2>& Mouse::get_move_signal() noexcept
     {
         return move_signal;
     }
 
-    rsig::connection Mouse::on_move(const std::function<void(glm::ivec2, glm::ivec2)>& cb) noexcept
+    Connection Mouse::on_move(const Delegate<void (glm::ivec2, glm::ivec2)>& cb) noexcept
     {
         return move_signal.connect(cb);
     }
 
-    rsig::signal<glm::ivec2>& Mouse::get_wheel_signal() noexcept
+    Signal<glm::ivec2>& Mouse::get_wheel_signal() noexcept
     {
         return wheel_signal;
     }
 
-    rsig::connection Mouse::on_wheel(const std::function<void(glm::ivec2)>& cb) noexcept
+    Connection Mouse::on_wheel(const Delegate<void (glm::ivec2)>& cb) noexcept
     {
         return wheel_signal.connect(cb);
     }
 
+    void Mouse::begin_frame() noexcept
+    {
+        went_down.reset();
+        went_up.reset();
+    }
+
     void Mouse::handle_event(SDL_Event& event)
     {
         switch (event.type)
@@ -106,9 +132,19 @@ namespace ice
             move_signal.emit({event.motion.x, event.motion.y}, {event.motion.xrel, event.motion.yrel});
             break;
         case SDL_MOUSEBUTTONDOWN:
+            if (event.button.button < MOUSE_BUTTON_COUNT)
+            {
+                pressed.set(event.button.button);
+                went_down.set(event.button.button);
+            }
             button_down_signal.emit(MouseButton(event.button.button), {event.button.x, event.button.y});
             break;
         case SDL_MOUSEBUTTONUP:
+            if (event.button.button < MOUSE_BUTTON_COUNT)
+            {
+                pressed.reset(event.button.button);
+                went_up.set(event.button.button);
+            }
             button_up_signal.emit(MouseButton(event.button.button), {event.button.x, event.button.y});
             break;
         case SDL_MOUSEWHEEL:
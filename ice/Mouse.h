@@ -21,12 +21,13 @@
 
 #pragma once
 
+#include <bitset>
 #include <functional>
 #include <glm/fwd.hpp>
-#include <rsig/rsig.h>
 
 #include "defines.h"
 #include "utils.h"
+#include "Signal.h"
 
 union SDL_Event;
 
@@ -45,10 +46,31 @@ namespace ice
         BUTTON5
     };
 
+    //! The number of distinct mouse buttons.
+    constexpr size_t MOUSE_BUTTON_COUNT = 6u;
+
+    //! Set of Mouse Buttons
+    using MouseButtonMask = std::bitset<MOUSE_BUTTON_COUNT>;
+
     //! Mouse
+    //!
+    //! The button state is tracked from the button events of each frame,
+    //! like the Keyboard state.
     class ICE_EXPORT Mouse : private non_copyable
     {
     public:
+        //! Check if a button is pressed.
+        [[nodiscard]] bool is_pressed(MouseButton button) const noexcept;
+
+        //! Check if a button went down this frame.
+        [[nodiscard]] bool was_pressed_this_frame(MouseButton button) const noexcept;
+
+        //! Check if a button went up this frame.
+        [[nodiscard]] bool was_released_this_frame(MouseButton button) const noexcept;
+
+        //! Get the buttons that are pressed.
+        [[nodiscard]] const MouseButtonMask& get_pressed() const noexcept;
+
         //! Set cursor visibility.
         void set_cursor_visible(bool value) noexcept;
         //! Get the cursor visibility.
@@ -62,37 +84,42 @@ namespace ice
         //! Button Down Signal
         //!
         //! @{
-        rsig::signal<MouseButton, glm::ivec2>& get_button_down_signal() noexcept;
-        rsig::connection on_button_down(const std::function<void (MouseButton, glm::ivec2)>& cb) noexcept;
+        Signal<MouseButton, glm::ivec2>& get_button_down_signal() noexcept;
+        Connection on_button_down(const Delegate<void (MouseButton, glm::ivec2)>& cb) noexcept;
         //! @}
 
         //! Button Up Signal
         //!
         //! @{
-        rsig::signal<MouseButton, glm::ivec2>& get_button_up_signal() noexcept;
-        rsig::connection on_button_up(const std::function<void (MouseButton, glm::ivec2)>& cb) noexcept;
+        Signal<MouseButton, glm::ivec2>& get_button_up_signal() noexcept;
+        Connection on_button_up(const Delegate<void (MouseButton, glm::ivec2)>& cb) noexcept;
         //! @}
 
         //! Move Signal
         //!
         //! @{
-        rsig::signal<glm::ivec2, glm::ivec2>& get_move_signal() noexcept;
-        rsig::connection on_move(const std::function<void (glm::ivec2, glm::ivec2)>& cb) noexcept;
+        Signal<glm::ivec2, glm::ivec2>& get_move_signal() noexcept;
+        Connection on_move(const Delegate<void (glm::ivec2, glm::ivec2)>& cb) noexcept;
         //! @}
 
         //! Wheel Signal
         //!
         //! @{
-        rsig::signal<glm::ivec2>& get_wheel_signal() noexcept;
-        rsig::connection on_wheel(const std::function<void (glm::ivec2)>& cb) noexcept;
+        Signal<glm::ivec2>& get_wheel_signal() noexcept;
+        Connection on_wheel(const Delegate<void (glm::ivec2)>& cb) noexcept;
         //! @}
 
     private:
-        rsig::signal<MouseButton, glm::ivec2> button_down_signal;
-        rsig::signal<MouseButton, glm::ivec2> button_up_signal;
-        rsig::signal<glm::ivec2, glm::ivec2>  move_signal;
-        rsig::signal<glm::ivec2>              wheel_signal;
+        Signal<MouseButton, glm::ivec2> button_down_signal;
+        Signal<MouseButton, glm::ivec2> button_up_signal;
+        Signal<glm::ivec2, glm::ivec2>  move_signal;
+        Signal<glm::ivec2>              wheel_signal;
+
+        MouseButtonMask pressed;
+        MouseButtonMask went_down;
+        MouseButtonMask went_up;
 
+        void begin_frame() noexcept;
         void handle_event(SDL_Event& event);
 
         friend class Engine;
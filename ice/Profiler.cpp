@@ -0,0 +1,354 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define ICE_PROFILE_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define ICE_PROFILE_RDTSC 1
+#endif
+
+namespace ice
+{
+    //! The events of one thread.
+    //!
+    //! The owning thread is the only writer of head, the collector the
+    //! only writer of tail.
+    struct ProfileRing
+    {
+        std::array<ProfileEvent, PROFILE_RING_SIZE> events;
+        std::atomic<uint64_t>                       head    = 0u;
+        std::atomic<uint64_t>                       tail    = 0u;
+        std::atomic<uint64_t>                       dropped = 0u;
+        std::atomic<bool>                           closed  = false;
+        uint32_t                                    thread  = 0u;
+    };
+
+    namespace
+    {
+        //! Marks the ring as closed when the thread exits.
+        struct ProfileThread
+        {
+            std::shared_ptr<ProfileRing> ring;
+            std::string                  name;
+
+            ~ProfileThread()
+            {
+                if (ring)
+                {
+                    ring->closed.store(true, std::memory_order_release);
+                }
+            }
+        };
+
+        std::atomic<bool>          profile_enabled = false;
+        thread_local ProfileThread profile_thread;
+        thread_local ProfileRing*  thread_ring     = nullptr;
+        thread_local uint32_t      zone_depth      = 0u;
+
+        uint64_t get_ticks() noexcept
+        {
+            #ifdef ICE_PROFILE_RDTSC
+            return __rdtsc();
+            #else
+            return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+            #endif
+        }
+
+        int64_t get_time() noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    Profiler& Profiler::get() noexcept
+    {
+        static auto profiler = Profiler{};
+        return profiler;
+    }
+
+    Profiler::Profiler() noexcept
+    {
+        start_ticks = get_ticks();
+        start_time  = get_time();
+    }
+
+    void Profiler::start(unsigned int frames) noexcept
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        frame_limit = frames;
+        frame_count = 0u;
+        profile_enabled.store(true, std::memory_order_relaxed);
+    }
+
+    void Profiler::stop() noexcept
+    {
+        profile_enabled.store(false, std::memory_order_relaxed);
+    }
+
+    bool Profiler::is_recording() const noexcept
+    {
+        return profile_enabled.load(std::memory_order_relaxed);
+    }
+
+    void Profiler::begin_frame() noexcept
+    {
+        if (!is_recording())
+        {
+            return;
+        }
+
+        collect();
+
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        if (frame_limit != 0u && frame_count == frame_limit)
+        {
+            profile_enabled.store(false, std::memory_order_relaxed);
+        }
+        else
+        {
+            frame_count++;
+        }
+    }
+
+    void Profiler::set_thread_name(const std::string_view name)
+    {
+        profile_thread.name = name;
+        if (profile_thread.ring)
+        {
+            auto lock = std::unique_lock<std::mutex>{mutex};
+            thread_names[profile_thread.ring->thread] = name;
+        }
+    }
+
+    void Profiler::collect() noexcept
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        std::erase_if(rings, [this] (const auto& ring) {
+            // closed before the head is read, so nothing is written after
+            const auto closed = ring->closed.load(std::memory_order_acquire);
+            const auto head   = ring->head.load(std::memory_order_acquire);
+            auto       tail   = ring->tail.load(std::memory_order_relaxed);
+            for (; tail != head; tail++)
+            {
+                events.push_back(ring->events[tail % PROFILE_RING_SIZE]);
+            }
+            ring->tail.store(tail, std::memory_order_release);
+            dropped += ring->dropped.exchange(0u, std::memory_order_relaxed);
+            // forget the rings of threads that are gone
+            return closed;
+        });
+        calibrate();
+    }
+
+    const std::vector<ProfileEvent>& Profiler::get_events() const noexcept
+    {
+        return events;
+    }
+
+    void Profiler::clear() noexcept
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        events.clear();
+        dropped = 0u;
+
+        // no event refers to the threads that are gone any more
+        std::erase_if(thread_names, [this] (const auto& entry) {
+            return std::none_of(rings.begin(), rings.end(), [&] (const auto& ring) {
+                return ring->thread == entry.first;
+            });
+        });
+    }
+
+    ProfilerStats Profiler::get_stats() const noexcept
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        return {events.size(), dropped, next_thread};
+    }
+
+    double Profiler::to_microseconds(uint64_t ticks) const noexcept
+    {
+        return static_cast<double>(ticks) * tick_scale;
+    }
+
+    void write_json_string(std::ostream& output, const char* value)
+    {
+        output << '"';
+        for (auto c = value; c != nullptr && *c != 0; c++)
+        {
+            switch (*c)
+            {
+            case '"':  output << "\\\""; break;
+            case '\\': output << "\\\\"; break;
+            case '\n': output << "\\n";  break;
+            case '\t': output << "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(*c) >= 0x20)
+                {
+                    output << *c;
+                }
+                break;
+            }
+        }
+        output << '"';
+    }
+
+    void Profiler::write_trace(std::ostream& output)
+    {
+        collect();
+
+        auto lock = std::unique_lock<std::mutex>{mutex};
+
+        auto first = std::numeric_limits<uint64_t>::max();
+        for (const auto& event : events)
+        {
+            first = std::min(first, event.begin);
+        }
+
+        output << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        auto separator = "";
+        for (const auto& [thread, name] : thread_names)
+        {
+            output << separator << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << thread << ",\"args\":{\"name\":";
+            write_json_string(output, name.c_str());
+            output << "}}";
+            separator = ",\n";
+        }
+        for (const auto& event : events)
+        {
+            output << separator << "{\"ph\":\"X\",\"cat\":\"ice\",\"name\":";
+            write_json_string(output, event.name);
+            output << ",\"pid\":1,\"tid\":" << event.thread
+                   << ",\"ts\":" << to_microseconds(event.begin - first)
+                   << ",\"dur\":" << to_microseconds(event.end - event.begin)
+                   << ",\"args\":{\"file\":";
+            write_json_string(output, event.file);
+            output << ",\"line\":" << event.line << "}}";
+            separator = ",\n";
+        }
+        output << "\n]}\n";
+    }
+
+    void Profiler::write_trace(const std::filesystem::path& file)
+    {
+        auto output = std::ofstream(file);
+        if (!output)
+        {
+            throw std::runtime_error("Failed to open profiler trace.");
+        }
+        write_trace(output);
+    }
+
+    ProfileRing& Profiler::get_ring()
+    {
+        if (thread_ring == nullptr)
+        {
+            auto ring = std::make_shared<ProfileRing>();
+            auto lock = std::unique_lock<std::mutex>{mutex};
+            ring->thread = next_thread++;
+            rings.push_back(ring);
+            if (!profile_thread.name.empty())
+            {
+                thread_names[ring->thread] = profile_thread.name;
+            }
+            // the profiler keeps the ring alive until its last events are collected
+            profile_thread.ring = ring;
+            thread_ring = ring.get();
+        }
+        return *thread_ring;
+    }
+
+    void Profiler::calibrate() noexcept
+    {
+        const auto ticks = get_ticks() - start_ticks;
+        const auto time  = get_time() - start_time;
+        if (ticks > 0u && time > 0)
+        {
+            tick_scale = static_cast<double>(time) / static_cast<double>(ticks) / 1000.0;
+        }
+    }
+
+    ProfileZone::ProfileZone(const std::source_location location) noexcept
+    : ProfileZone(location.function_name(), location) {}
+
+    ProfileZone::ProfileZone(const char* n, const std::source_location location) noexcept
+    : name(n), file(location.file_name()), line(location.line())
+    {
+        if (profile_enabled.load(std::memory_order_relaxed))
+        {
+            zone_depth++;
+            begin = get_ticks();
+        }
+    }
+
+    ProfileZone::~ProfileZone()
+    {
+        if (begin == 0u)
+        {
+            return;
+        }
+
+        const auto end = get_ticks();
+        zone_depth--;
+
+        ProfileRing* ring = thread_ring;
+        if (ring == nullptr)
+        {
+            try
+            {
+                ring = &Profiler::get().get_ring();
+            }
+            catch (...)
+            {
+                return;
+            }
+        }
+
+        const auto head = ring->head.load(std::memory_order_relaxed);
+        if (head - ring->tail.load(std::memory_order_acquire) >= PROFILE_RING_SIZE)
+        {
+            ring->dropped.fetch_add(1u, std::memory_order_relaxed);
+            return;
+        }
+
+        auto& event = ring->events[head % PROFILE_RING_SIZE];
+        event.name   = name;
+        event.file   = file;
+        event.line   = line;
+        event.depth  = zone_depth;
+        event.thread = ring->thread;
+        event.begin  = begin;
+        event.end    = end;
+        ring->head.store(head + 1u, std::memory_order_release);
+    }
+}
@@ -0,0 +1,190 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <source_location>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "defines.h"
+#include "utils.h"
+
+namespace ice
+{
+    //! The number of events each thread can buffer between collections.
+    constexpr size_t PROFILE_RING_SIZE = 1u << 15u;
+
+    //! Profile Event
+    //!
+    //! A finished zone; begin and end are in profiler ticks.
+    struct ProfileEvent
+    {
+        const char* name   = nullptr;
+        const char* file   = nullptr;
+        uint32_t    line   = 0u;
+        uint32_t    depth  = 0u;
+        uint32_t    thread = 0u;
+        uint64_t    begin  = 0u;
+        uint64_t    end    = 0u;
+    };
+
+    //! Profiler Statistics
+    struct ProfilerStats
+    {
+        //! The number of collected events.
+        size_t events = 0u;
+        //! The number of events lost because a thread's ring was full.
+        size_t dropped = 0u;
+        //! The number of threads that recorded events.
+        size_t threads = 0u;
+    };
+
+    struct ProfileRing;
+
+    //! Profiler
+    //!
+    //! The profiler collects the zones of all threads. Each thread writes
+    //! its zones into its own ring without locking; the rings are drained
+    //! once per frame in begin_frame and by collect. A thread gets its ring
+    //! with the first zone it records, the ring is freed when the thread
+    //! exited and its events are collected.
+    //!
+    //! Recording is started for a number of frames and the result is
+    //! written as Chrome trace JSON, which can be loaded in Perfetto or
+    //! chrome://tracing.
+    class ICE_EXPORT Profiler : private non_copyable
+    {
+    public:
+        //! Get the profiler.
+        [[nodiscard]] static Profiler& get() noexcept;
+
+        //! Start recording.
+        //!
+        //! @param frames the number of frames to record, 0 records until stop
+        void start(unsigned int frames = 0u) noexcept;
+
+        //! Stop recording.
+        void stop() noexcept;
+
+        //! Check if zones are recorded.
+        [[nodiscard]] bool is_recording() const noexcept;
+
+        //! Mark the start of a frame.
+        //!
+        //! This is called by the engine at the start of each tick. It drains
+        //! the rings and stops recording when the requested frames are done.
+        void begin_frame() noexcept;
+
+        //! Name the calling thread in the trace.
+        //!
+        //! This does not allocate a ring, threads that record nothing cost nothing.
+        void set_thread_name(const std::string_view name);
+
+        //! Move the buffered events of all threads to the collected events.
+        void collect() noexcept;
+
+        //! Get the collected events.
+        //!
+        //! @warning Call collect first to get the latest events.
+        [[nodiscard]] const std::vector<ProfileEvent>& get_events() const noexcept;
+
+        //! Discard the collected events.
+        void clear() noexcept;
+
+        //! Get the statistics.
+        [[nodiscard]] ProfilerStats get_stats() const noexcept;
+
+        //! Convert profiler ticks to microseconds.
+        [[nodiscard]] double to_microseconds(uint64_t ticks) const noexcept;
+
+        //! Write the collected events as Chrome trace.
+        //!
+        //! @{
+        void write_trace(std::ostream& output);
+        void write_trace(const std::filesystem::path& file);
+        //! @}
+
+    private:
+        mutable std::mutex                        mutex;
+        std::vector<std::shared_ptr<ProfileRing>> rings;
+        std::map<uint32_t, std::string>           thread_names;
+        uint32_t                                  next_thread = 0u;
+        std::vector<ProfileEvent>                 events;
+        size_t                                    dropped = 0u;
+
+        unsigned int frame_limit = 0u;
+        unsigned int frame_count = 0u;
+
+        uint64_t start_ticks = 0u;
+        int64_t  start_time  = 0;
+        double   tick_scale  = 0.001;
+
+        Profiler() noexcept;
+        ProfileRing& get_ring();
+        void calibrate() noexcept;
+
+        friend class ProfileZone;
+    };
+
+    //! Profile Zone
+    //!
+    //! A zone measures the time from its construction to its destruction.
+    //! Zones nest and are named after the function they are in, unless a
+    //! name is given. The name must be a string literal.
+    //!
+    //! Use the ICE_PROFILE_ZONE macros, so that the zones are compiled out
+    //! when ICE_PROFILE is 0.
+    class ICE_EXPORT ProfileZone : private non_copyable
+    {
+    public:
+        explicit ProfileZone(const std::source_location location = std::source_location::current()) noexcept;
+        explicit ProfileZone(const char* name, const std::source_location location = std::source_location::current()) noexcept;
+        ~ProfileZone();
+
+    private:
+        const char* name;
+        const char* file;
+        uint32_t    line;
+        uint64_t    begin = 0u;
+    };
+}
+
+#define ICE_PROFILE_CONCAT_IMPL(A, B) A ## B
+#define ICE_PROFILE_CONCAT(A, B) ICE_PROFILE_CONCAT_IMPL(A, B)
+
+#if ICE_PROFILE
+//! Profile the rest of the scope under the function name.
+#define ICE_PROFILE_ZONE() ::ice::ProfileZone ICE_PROFILE_CONCAT(ice_profile_zone_, __LINE__)
+//! Profile the rest of the scope under the given name.
+#define ICE_PROFILE_ZONE_NAMED(NAME) ::ice::ProfileZone ICE_PROFILE_CONCAT(ice_profile_zone_, __LINE__){NAME}
+#else
+#define ICE_PROFILE_ZONE()
+#define ICE_PROFILE_ZONE_NAMED(NAME)
+#endif
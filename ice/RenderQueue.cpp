@@ -0,0 +1,171 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <array>
+
+namespace ice
+{
+    size_t count_state_changes(uint64_t a, uint64_t b) noexcept
+    {
+        return (get_sort_shader(a) != get_sort_shader(b) ? 1u : 0u) +
+               (get_sort_material(a) != get_sort_material(b) ? 1u : 0u);
+    }
+
+    void CommandBuffer::add(uint64_t key, const DrawCommand& command)
+    {
+        keys.push_back(key);
+        commands.push_back(command);
+    }
+
+    size_t CommandBuffer::get_size() const noexcept
+    {
+        return keys.size();
+    }
+
+    void CommandBuffer::clear() noexcept
+    {
+        keys.clear();
+        commands.clear();
+    }
+
+    CommandBuffer& RenderQueue::get_buffer()
+    {
+        const auto id = std::this_thread::get_id();
+
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        for (auto i = 0u; i < threads.size(); i++)
+        {
+            if (threads[i] == id)
+            {
+                return *buffers[i];
+            }
+        }
+
+        threads.push_back(id);
+        buffers.push_back(std::make_unique<CommandBuffer>());
+        return *buffers.back();
+    }
+
+    size_t RenderQueue::get_command_count() const noexcept
+    {
+        auto count = size_t{0};
+        for (const auto& buffer : buffers)
+        {
+            count += buffer->get_size();
+        }
+        return count;
+    }
+
+    void RenderQueue::execute()
+    {
+        stats = {};
+
+        entries.clear();
+        for (auto b = 0u; b < buffers.size(); b++)
+        {
+            const auto& keys = buffers[b]->keys;
+            for (auto i = 0u; i < keys.size(); i++)
+            {
+                if (!entries.empty())
+                {
+                    stats.unsorted_state_changes += count_state_changes(entries.back().key, keys[i]);
+                }
+                entries.push_back({keys[i], b, i});
+            }
+        }
+
+        sort();
+        ICE_CHECK_PARANOID(std::is_sorted(entries.begin(), entries.end(), [] (const auto& a, const auto& b) { return a.key < b.key; }));
+
+        auto previous = ~uint64_t{0};
+        for (const auto& entry : entries)
+        {
+            if (previous != ~uint64_t{0})
+            {
+                stats.state_changes += count_state_changes(previous, entry.key);
+            }
+            buffers[entry.buffer]->commands[entry.index](entry.key, previous);
+            previous = entry.key;
+        }
+
+        stats.commands            = entries.size();
+        stats.saved_state_changes = stats.unsorted_state_changes > stats.state_changes ? stats.unsorted_state_changes - stats.state_changes : 0u;
+    }
+
+    void RenderQueue::clear() noexcept
+    {
+        for (auto& buffer : buffers)
+        {
+            buffer->clear();
+        }
+    }
+
+    const RenderQueueStats& RenderQueue::get_stats() const noexcept
+    {
+        return stats;
+    }
+
+    void RenderQueue::swap(RenderQueue& other) noexcept
+    {
+        std::swap(threads, other.threads);
+        std::swap(buffers, other.buffers);
+        std::swap(entries, other.entries);
+        std::swap(scratch, other.scratch);
+        std::swap(stats, other.stats);
+    }
+
+    void RenderQueue::sort() noexcept
+    {
+        // LSD radix sort over the key bytes; passes where all keys share the
+        // same byte are skipped, which is common for layer and depth.
+        scratch.resize(entries.size());
+        for (auto shift = 0u; shift < 64u; shift += 8u)
+        {
+            auto counts = std::array<size_t, 256u>{};
+            for (const auto& entry : entries)
+            {
+                counts[(entry.key >> shift) & 0xFFu]++;
+            }
+
+            if (entries.empty() || counts[(entries.front().key >> shift) & 0xFFu] == entries.size())
+            {
+                continue;
+            }
+
+            auto offset = size_t{0};
+            for (auto& count : counts)
+            {
+                const auto c = count;
+                count   = offset;
+                offset += c;
+            }
+
+            for (const auto& entry : entries)
+            {
+                scratch[counts[(entry.key >> shift) & 0xFFu]++] = entry;
+            }
+            std::swap(entries, scratch);
+        }
+    }
+}
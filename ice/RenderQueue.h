@@ -0,0 +1,162 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "defines.h"
+#include "utils.h"
+#include "Signal.h"
+
+namespace ice
+{
+    //! Render Sort Key
+    //!
+    //! The key orders the draw commands by layer, then shader, then
+    //! material and last depth. From the most significant bit the key holds
+    //! 8 bits layer, 16 bits shader, 16 bits material and 24 bits depth.
+    //!
+    //! @{
+    constexpr uint64_t make_sort_key(unsigned int layer, unsigned int shader, unsigned int material, unsigned int depth) noexcept
+    {
+        return (static_cast<uint64_t>(layer & 0xFFu) << 56u) |
+               (static_cast<uint64_t>(shader & 0xFFFFu) << 40u) |
+               (static_cast<uint64_t>(material & 0xFFFFu) << 24u) |
+               static_cast<uint64_t>(depth & 0xFFFFFFu);
+    }
+
+    constexpr unsigned int get_sort_layer(uint64_t key) noexcept
+    {
+        return static_cast<unsigned int>(key >> 56u);
+    }
+
+    constexpr unsigned int get_sort_shader(uint64_t key) noexcept
+    {
+        return static_cast<unsigned int>((key >> 40u) & 0xFFFFu);
+    }
+
+    constexpr unsigned int get_sort_material(uint64_t key) noexcept
+    {
+        return static_cast<unsigned int>((key >> 24u) & 0xFFFFu);
+    }
+
+    constexpr unsigned int get_sort_depth(uint64_t key) noexcept
+    {
+        return static_cast<unsigned int>(key & 0xFFFFFFu);
+    }
+    //! @}
+
+    //! Draw Command
+    //!
+    //! The command is called with its own key and the key of the command
+    //! run before it, so that it only needs to bind the state that changed.
+    //! The first command of a frame gets ~0 as previous key.
+    using DrawCommand = Delegate<void (uint64_t key, uint64_t previous)>;
+
+    //! Command Buffer
+    //!
+    //! A command buffer records draw commands of one thread.
+    class ICE_EXPORT CommandBuffer : private non_copyable
+    {
+    public:
+        //! Record a draw command.
+        void add(uint64_t key, const DrawCommand& command);
+
+        //! Get the number of recorded commands.
+        [[nodiscard]] size_t get_size() const noexcept;
+
+        //! Remove all commands, keeping the memory.
+        void clear() noexcept;
+
+    private:
+        std::vector<uint64_t>    keys;
+        std::vector<DrawCommand> commands;
+
+        friend class RenderQueue;
+    };
+
+    //! Render Queue Statistics
+    struct RenderQueueStats
+    {
+        //! The number of commands run.
+        size_t commands = 0u;
+        //! The number of shader and material changes in sorted order.
+        size_t state_changes = 0u;
+        //! The number of shader and material changes in recorded order.
+        size_t unsorted_state_changes = 0u;
+        //! The number of state changes saved by sorting.
+        size_t saved_state_changes = 0u;
+    };
+
+    //! Render Queue
+    //!
+    //! The render queue collects the command buffers of all threads. When
+    //! executed, the commands of all buffers are radix sorted by key and
+    //! run in order. Commands with equal keys run in recorded order.
+    class ICE_EXPORT RenderQueue : private non_copyable
+    {
+    public:
+        //! Get the command buffer of the calling thread.
+        //!
+        //! This function may be called from any thread; the returned buffer
+        //! must only be used by the calling thread.
+        CommandBuffer& get_buffer();
+
+        //! Get the number of recorded commands.
+        [[nodiscard]] size_t get_command_count() const noexcept;
+
+        //! Sort and run all commands.
+        void execute();
+
+        //! Remove all commands.
+        void clear() noexcept;
+
+        //! Get the statistics of the last execute.
+        [[nodiscard]] const RenderQueueStats& get_stats() const noexcept;
+
+        //! Swap the contents with another queue.
+        //!
+        //! No thread may record into either queue while swapping.
+        void swap(RenderQueue& other) noexcept;
+
+    private:
+        struct Entry
+        {
+            uint64_t key;
+            uint32_t buffer;
+            uint32_t index;
+        };
+
+        std::mutex                                  mutex;
+        std::vector<std::thread::id>                threads;
+        std::vector<std::unique_ptr<CommandBuffer>> buffers;
+        std::vector<Entry>                          entries;
+        std::vector<Entry>                          scratch;
+        RenderQueueStats                            stats;
+
+        void sort() noexcept;
+    };
+}
@@ -0,0 +1,115 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "RenderThread.h"
+
+#include "Profiler.h"
+
+namespace ice
+{
+    RenderThread::RenderThread(const DrawFunction& d, const ContextFunction& a, const ContextFunction& de)
+    : draw(d), attach(a), detach(de)
+    {
+        check(static_cast<bool>(draw));
+        thread = std::thread([this] () { run(); });
+    }
+
+    RenderThread::~RenderThread()
+    {
+        {
+            auto lock = std::unique_lock<std::mutex>{mutex};
+            running = false;
+        }
+        cond.notify_all();
+        thread.join();
+    }
+
+    void RenderThread::submit(FramePacket& next)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        cond.wait(lock, [this] () { return !pending; });
+        wait_time = std::chrono::steady_clock::now() - start;
+
+        packet.swap(next);
+        pending = true;
+        lock.unlock();
+        cond.notify_all();
+
+        // the render thread is done with the old packet
+        next.clear();
+    }
+
+    void RenderThread::wait()
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        cond.wait(lock, [this] () { return !pending; });
+    }
+
+    uint64_t RenderThread::get_frame_count() const noexcept
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        return frames;
+    }
+
+    std::chrono::steady_clock::duration RenderThread::get_wait_time() const noexcept
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        return wait_time;
+    }
+
+    void RenderThread::run()
+    {
+        Profiler::get().set_thread_name("render");
+        prepare_crash_thread();
+
+        if (attach)
+        {
+            attach();
+        }
+
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        while (true)
+        {
+            cond.wait(lock, [this] () { return pending || !running; });
+            if (!pending)
+            {
+                break;
+            }
+
+            // the main thread does not touch the packet while it is pending
+            lock.unlock();
+            draw(packet);
+            lock.lock();
+
+            frames++;
+            pending = false;
+            cond.notify_all();
+        }
+        lock.unlock();
+
+        if (detach)
+        {
+            detach();
+        }
+    }
+}
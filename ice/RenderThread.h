@@ -0,0 +1,97 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "defines.h"
+#include "utils.h"
+#include "FramePacket.h"
+
+namespace ice
+{
+    //! Render Thread
+    //!
+    //! The render thread draws frame packets on its own thread. The main
+    //! thread submits the finished packet of a tick and continues with the
+    //! next one while the render thread draws. At most one frame is in
+    //! flight; submit blocks until the previous frame was drawn.
+    //!
+    //! The thread runs the attach function before the first and the detach
+    //! function after the last frame; the Engine uses these to move the GL
+    //! context to the render thread and back.
+    class ICE_EXPORT RenderThread : private non_copyable
+    {
+    public:
+        using DrawFunction = std::function<void (FramePacket&)>;
+        using ContextFunction = std::function<void ()>;
+
+        //! Start Render Thread
+        //!
+        //! @param draw the function drawing a frame
+        //! @param attach the function run on the render thread before the first frame
+        //! @param detach the function run on the render thread after the last frame
+        RenderThread(const DrawFunction& draw, const ContextFunction& attach = {}, const ContextFunction& detach = {});
+
+        //! Stop Render Thread
+        //!
+        //! The frame in flight is drawn before the thread ends.
+        ~RenderThread();
+
+        //! Submit a frame.
+        //!
+        //! Waits until the previous frame was drawn, then hands the packet
+        //! to the render thread. The packet is swapped with the drawn one and
+        //! cleared, so that it can be filled with the next frame.
+        void submit(FramePacket& packet);
+
+        //! Wait until the submitted frame was drawn.
+        void wait();
+
+        //! Get the number of frames drawn.
+        [[nodiscard]] uint64_t get_frame_count() const noexcept;
+
+        //! Get the time the last submit waited for the render thread.
+        [[nodiscard]] std::chrono::steady_clock::duration get_wait_time() const noexcept;
+
+    private:
+        DrawFunction    draw;
+        ContextFunction attach;
+        ContextFunction detach;
+
+        mutable std::mutex                  mutex;
+        std::condition_variable             cond;
+        FramePacket                         packet;
+        bool                                pending   = false;
+        bool                                running   = true;
+        uint64_t                            frames    = 0u;
+        std::chrono::steady_clock::duration wait_time = {};
+
+        std::thread thread;
+
+        void run();
+    };
+}
@@ -0,0 +1,491 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "defines.h"
+#include "utils.h"
+
+namespace ice
+{
+    template <typename Signature>
+    class Delegate;
+
+    //! Delegate
+    //!
+    //! The Delegate is a replacement for std::function that stores small
+    //! callables, such as lambdas capturing a few pointers, inline. Only
+    //! callables larger than INLINE_SIZE are allocated on the heap. Trivially
+    //! copyable callables are copied without an indirect call.
+    template <typename R, typename... Args>
+    class Delegate<R (Args...)>
+    {
+    public:
+        //! The size of callables that are stored inline.
+        static constexpr size_t INLINE_SIZE = 3u * sizeof(void*);
+
+        Delegate() noexcept = default;
+
+        template <typename Fun>
+        requires (!std::same_as<std::decay_t<Fun>, Delegate>) && std::invocable<std::decay_t<Fun>&, Args...>
+        Delegate(Fun&& fun);
+
+        Delegate(const Delegate& other);
+        Delegate(Delegate&& other) noexcept;
+        ~Delegate();
+
+        Delegate& operator = (const Delegate& other);
+        Delegate& operator = (Delegate&& other) noexcept;
+
+        //! Check if the delegate holds a callable.
+        explicit operator bool () const noexcept;
+
+        //! Call the callable.
+        //!
+        //! Calling an empty delegate fails in debug builds.
+        R operator () (Args... args) const;
+
+    private:
+        enum class Op
+        {
+            COPY,
+            MOVE,
+            DESTROY
+        };
+
+        using Invoke = R (*)(void* storage, Args&&... args);
+        using Manage = void (*)(Op op, void* dst, void* src);
+
+        alignas(std::max_align_t) mutable std::byte storage[INLINE_SIZE];
+        Invoke invoke = nullptr;
+        Manage manage = nullptr;
+
+        void reset() noexcept;
+        void copy_from(const Delegate& other);
+        void move_from(Delegate& other) noexcept;
+    };
+
+    template <typename... Args>
+    class Signal;
+
+    class SignalBase
+    {
+    public:
+        virtual ~SignalBase() = default;
+        virtual void disconnect(unsigned int id) noexcept = 0;
+        virtual bool is_connected(unsigned int id) const noexcept = 0;
+    };
+
+    //! Signal Connection
+    //!
+    //! The connection is a handle to a slot connected to a signal. It may
+    //! outlive the signal. It takes the place of rsig::connection in the
+    //! engine's on_* functions; a slot is disconnected either through the
+    //! connection or with Signal::disconnect.
+    class ICE_EXPORT Connection
+    {
+    public:
+        Connection() noexcept = default;
+        Connection(const std::weak_ptr<SignalBase>& signal, unsigned int id) noexcept;
+
+        //! Disconnect the slot from the signal.
+        void disconnect() noexcept;
+
+        //! Check if the slot is still connected.
+        [[nodiscard]] bool is_connected() const noexcept;
+
+    private:
+        std::weak_ptr<SignalBase> signal;
+        unsigned int              id = 0u;
+
+        template <typename... Args>
+        friend class Signal;
+    };
+
+    //! Signal
+    //!
+    //! The Signal calls all connected slots in order of connection. The slots
+    //! are stored contiguously and are called directly, without going through
+    //! std::function.
+    //!
+    //! Slots may be connected and disconnected while the signal is emitted.
+    //! Slots connected during emit are first called on the next emit, slots
+    //! disconnected during emit are not called anymore.
+    template <typename... Args>
+    class Signal : private non_copyable
+    {
+    public:
+        using Slot = Delegate<void (Args...)>;
+
+        Signal();
+
+        //! Connect a slot.
+        //!
+        //! The slot must not be empty.
+        Connection connect(const Slot& slot);
+
+        //! Disconnect a slot.
+        //!
+        //! Connections of other signals are ignored.
+        void disconnect(const Connection& connection) noexcept;
+
+        //! Get the number of connected slots.
+        [[nodiscard]] size_t get_slot_count() const noexcept;
+
+        //! Call all connected slots.
+        void emit(Args... args) const;
+
+    private:
+        struct Entry
+        {
+            unsigned int id;
+            Slot         slot;
+        };
+
+        struct State : public SignalBase
+        {
+            std::vector<Entry> slots;
+            std::vector<Entry> pending;
+            unsigned int       next_id = 1u;
+            unsigned int       depth   = 0u;
+            bool               dirty   = false;
+
+            void disconnect(unsigned int id) noexcept override;
+            bool is_connected(unsigned int id) const noexcept override;
+            void flush() noexcept;
+        };
+
+        std::shared_ptr<State> state;
+    };
+
+    template <typename R, typename... Args>
+    template <typename Fun>
+    requires (!std::same_as<std::decay_t<Fun>, Delegate<R (Args...)>>) && std::invocable<std::decay_t<Fun>&, Args...>
+    Delegate<R (Args...)>::Delegate(Fun&& fun)
+    {
+        using F = std::decay_t<Fun>;
+
+        if constexpr (std::is_pointer_v<F> || std::is_member_pointer_v<F> || requires (const F& f) { static_cast<bool>(f); })
+        {
+            if (!static_cast<bool>(fun))
+            {
+                return;
+            }
+        }
+
+        constexpr auto is_inline = sizeof(F) <= INLINE_SIZE && alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<F>;
+        if constexpr (is_inline)
+        {
+            new (storage) F(std::forward<Fun>(fun));
+            invoke = [] (void* s, Args&&... args) -> R {
+                return std::invoke(*std::launder(static_cast<F*>(s)), std::forward<Args>(args)...);
+            };
+
+            if constexpr (!(std::is_trivially_copyable_v<F> && std::is_trivially_destructible_v<F>))
+            {
+                manage = [] (Op op, void* dst, void* src) {
+                    auto s = std::launder(static_cast<F*>(src));
+                    switch (op)
+                    {
+                        case Op::COPY:
+                            new (dst) F(*s);
+                            break;
+                        case Op::MOVE:
+                            new (dst) F(std::move(*s));
+                            s->~F();
+                            break;
+                        case Op::DESTROY:
+                            s->~F();
+                            break;
+                    }
+                };
+            }
+        }
+        else
+        {
+            auto ptr = new F(std::forward<Fun>(fun));
+            std::memcpy(storage, &ptr, sizeof(ptr));
+            invoke = [] (void* s, Args&&... args) -> R {
+                F* f = nullptr;
+                std::memcpy(&f, s, sizeof(f));
+                return std::invoke(*f, std::forward<Args>(args)...);
+            };
+            manage = [] (Op op, void* dst, void* src) {
+                F* f = nullptr;
+                std::memcpy(&f, src, sizeof(f));
+                switch (op)
+                {
+                    case Op::COPY:
+                    {
+                        auto copy = new F(*f);
+                        std::memcpy(dst, &copy, sizeof(copy));
+                        break;
+                    }
+                    case Op::MOVE:
+                        std::memcpy(dst, &f, sizeof(f));
+                        break;
+                    case Op::DESTROY:
+                        delete f;
+                        break;
+                }
+            };
+        }
+    }
+
+    template <typename R, typename... Args>
+    Delegate<R (Args...)>::Delegate(const Delegate& other)
+    {
+        copy_from(other);
+    }
+
+    template <typename R, typename... Args>
+    Delegate<R (Args...)>::Delegate(Delegate&& other) noexcept
+    {
+        move_from(other);
+    }
+
+    template <typename R, typename... Args>
+    Delegate<R (Args...)>::~Delegate()
+    {
+        reset();
+    }
+
+    template <typename R, typename... Args>
+    Delegate<R (Args...)>& Delegate<R (Args...)>::operator = (const Delegate& other)
+    {
+        if (this != &other)
+        {
+            reset();
+            copy_from(other);
+        }
+        return *this;
+    }
+
+    template <typename R, typename... Args>
+    Delegate<R (Args...)>& Delegate<R (Args...)>::operator = (Delegate&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            move_from(other);
+        }
+        return *this;
+    }
+
+    template <typename R, typename... Args>
+    Delegate<R (Args...)>::operator bool () const noexcept
+    {
+        return invoke != nullptr;
+    }
+
+    template <typename R, typename... Args>
+    R Delegate<R (Args...)>::operator () (Args... args) const
+    {
+        ICE_CHECK_DEBUG(invoke != nullptr);
+        return invoke(storage, std::forward<Args>(args)...);
+    }
+
+    template <typename R, typename... Args>
+    void Delegate<R (Args...)>::reset() noexcept
+    {
+        if (manage != nullptr)
+        {
+            manage(Op::DESTROY, nullptr, storage);
+        }
+        invoke = nullptr;
+        manage = nullptr;
+    }
+
+    template <typename R, typename... Args>
+    void Delegate<R (Args...)>::copy_from(const Delegate& other)
+    {
+        if (other.manage != nullptr)
+        {
+            other.manage(Op::COPY, storage, other.storage);
+        }
+        else
+        {
+            std::memcpy(storage, other.storage, INLINE_SIZE);
+        }
+        invoke = other.invoke;
+        manage = other.manage;
+    }
+
+    template <typename R, typename... Args>
+    void Delegate<R (Args...)>::move_from(Delegate& other) noexcept
+    {
+        if (other.manage != nullptr)
+        {
+            other.manage(Op::MOVE, storage, other.storage);
+        }
+        else
+        {
+            std::memcpy(storage, other.storage, INLINE_SIZE);
+        }
+        invoke = other.invoke;
+        manage = other.manage;
+        other.invoke = nullptr;
+        other.manage = nullptr;
+    }
+
+    template <typename... Args>
+    Signal<Args...>::Signal()
+    : state(std::make_shared<State>()) {}
+
+    template <typename... Args>
+    Connection Signal<Args...>::connect(const Slot& slot)
+    {
+        check(static_cast<bool>(slot));
+        const auto id = state->next_id++;
+        if (state->depth == 0u)
+        {
+            state->slots.push_back({id, slot});
+        }
+        else
+        {
+            // don't invalidate the slots while they are called
+            state->pending.push_back({id, slot});
+        }
+        return Connection(state, id);
+    }
+
+    template <typename... Args>
+    void Signal<Args...>::disconnect(const Connection& connection) noexcept
+    {
+        if (connection.signal.lock() == state)
+        {
+            state->disconnect(connection.id);
+        }
+    }
+
+    template <typename... Args>
+    size_t Signal<Args...>::get_slot_count() const noexcept
+    {
+        auto count = size_t{0u};
+        for (const auto& entry : state->slots)
+        {
+            if (entry.id != 0u)
+            {
+                count++;
+            }
+        }
+        return count + state->pending.size();
+    }
+
+    template <typename... Args>
+    void Signal<Args...>::emit(Args... args) const
+    {
+        // Destroying the signal from one of its slots is not supported.
+        auto& s = *state;
+
+        struct Guard
+        {
+            State& state;
+            Guard(State& st) noexcept : state(st) { state.depth++; }
+            ~Guard() { if (--state.depth == 0u) { state.flush(); } }
+        } guard(s);
+
+        const auto count = s.slots.size();
+        for (auto i = size_t{0u}; i < count; i++)
+        {
+            const auto& entry = s.slots[i];
+            if (entry.id != 0u)
+            {
+                entry.slot(args...);
+            }
+        }
+    }
+
+    template <typename... Args>
+    void Signal<Args...>::State::disconnect(unsigned int id) noexcept
+    {
+        for (auto& entry : slots)
+        {
+            if (entry.id == id)
+            {
+                // The slot may be the one currently called; only mark it
+                // and remove it once the emit is done.
+                entry.id = 0u;
+                dirty    = true;
+                if (depth == 0u)
+                {
+                    flush();
+                }
+                return;
+            }
+        }
+
+        std::erase_if(pending, [id] (const Entry& entry) {
+            return entry.id == id;
+        });
+    }
+
+    template <typename... Args>
+    bool Signal<Args...>::State::is_connected(unsigned int id) const noexcept
+    {
+        for (const auto& entry : slots)
+        {
+            if (entry.id == id)
+            {
+                return true;
+            }
+        }
+        for (const auto& entry : pending)
+        {
+            if (entry.id == id)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename... Args>
+    void Signal<Args...>::State::flush() noexcept
+    {
+        if (dirty)
+        {
+            std::erase_if(slots, [] (const Entry& entry) {
+                return entry.id == 0u;
+            });
+            dirty = false;
+        }
+
+        if (!pending.empty())
+        {
+            for (auto& entry : pending)
+            {
+                slots.push_back(std::move(entry));
+            }
+            pending.clear();
+        }
+    }
+}
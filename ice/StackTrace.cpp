@@ -0,0 +1,424 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "StackTrace.h"
+
+#include <algorithm>
+#include <string>
+
+#if _WIN32
+#include <windows.h>
+#include <dbghelp.h>
+#endif
+
+#ifdef __linux__
+#include <cxxabi.h>
+#include <link.h>
+#include <unwind.h>
+
+#include <cstdlib>
+#include <filesystem>
+
+#include "ElfFile.h"
+#endif
+
+namespace ice
+{
+    #ifdef __linux__
+    //! The state passed through _Unwind_Backtrace.
+    struct UnwindState
+    {
+        std::span<uintptr_t> addresses;
+        size_t               skip;
+        size_t               count;
+    };
+
+    _Unwind_Reason_Code unwind_callback(_Unwind_Context* context, void* arg) noexcept
+    {
+        auto state = static_cast<UnwindState*>(arg);
+        const auto address = static_cast<uintptr_t>(_Unwind_GetIP(context));
+        if (address == 0u)
+        {
+            return _URC_END_OF_STACK;
+        }
+        if (state->skip > 0u)
+        {
+            state->skip--;
+            return _URC_NO_REASON;
+        }
+        if (state->count == state->addresses.size())
+        {
+            return _URC_END_OF_STACK;
+        }
+        state->addresses[state->count++] = address;
+        return _URC_NO_REASON;
+    }
+    #endif
+
+    size_t capture_stack(std::span<uintptr_t> addresses, size_t skip) noexcept
+    {
+        #if _WIN32
+        // skip capture_stack itself
+        const auto count = RtlCaptureStackBackTrace(static_cast<DWORD>(skip + 1u), static_cast<DWORD>(std::min<size_t>(addresses.size(), 0xffffu)), reinterpret_cast<void**>(addresses.data()), nullptr);
+        return count;
+        #elif __linux__
+        auto state = UnwindState{addresses, skip + 1u, 0u};
+        _Unwind_Backtrace(unwind_callback, &state);
+        return state.count;
+        #else
+        return 0u;
+        #endif
+    }
+
+    RawStackTrace RawStackTrace::capture(size_t skip) noexcept
+    {
+        auto result = RawStackTrace{};
+        result.count = capture_stack(result.addresses, skip + 1u);
+        return result;
+    }
+
+    std::span<const uintptr_t> RawStackTrace::get_addresses() const noexcept
+    {
+        return {addresses.data(), count};
+    }
+
+    size_t RawStackTrace::size() const noexcept
+    {
+        return count;
+    }
+
+    bool RawStackTrace::empty() const noexcept
+    {
+        return count == 0u;
+    }
+
+    bool RawStackTrace::operator == (const RawStackTrace& other) const noexcept
+    {
+        return std::ranges::equal(get_addresses(), other.get_addresses());
+    }
+
+    #if _WIN32
+    //! DbgHelp with the module names cached.
+    //!
+    //! DbgHelp is not thread safe, the symbolizer serializes all calls.
+    struct SymbolizerBackend
+    {
+        HANDLE                                   process     = GetCurrentProcess();
+        bool                                     initialized = false;
+        std::unordered_map<DWORD64, std::string> modules;
+
+        SymbolizerBackend()
+        {
+            SymSetOptions(SYMOPT_LOAD_LINES | SYMOPT_UNDNAME | SYMOPT_DEFERRED_LOADS);
+            initialized = SymInitialize(process, nullptr, TRUE) != FALSE;
+            if (!initialized)
+            {
+                trace("Failed to call SymInitialize.");
+            }
+        }
+
+        ~SymbolizerBackend()
+        {
+            if (initialized)
+            {
+                SymCleanup(process);
+            }
+        }
+
+        size_t get_module_count() const noexcept
+        {
+            return modules.size();
+        }
+
+        void resolve(uintptr_t address, StackFrame& frame)
+        {
+            if (!initialized)
+            {
+                return;
+            }
+
+            // the return address may already be the next line
+            const auto lookup = static_cast<DWORD64>(address - 1u);
+
+            auto base = SymGetModuleBase64(process, lookup);
+            if (base == 0u)
+            {
+                // modules loaded after SymInitialize
+                SymRefreshModuleList(process);
+                base = SymGetModuleBase64(process, lookup);
+            }
+            if (base != 0u)
+            {
+                auto i = modules.find(base);
+                if (i == modules.end())
+                {
+                    auto buffer = std::array<char, MAX_PATH>{};
+                    const auto length = GetModuleFileNameA(reinterpret_cast<HMODULE>(base), buffer.data(), static_cast<DWORD>(buffer.size()));
+                    auto path = std::string_view{buffer.data(), length};
+                    auto k    = path.find_last_of("\\/");
+                    i = modules.emplace(base, std::string{k == std::string_view::npos ? path : path.substr(k + 1u)}).first;
+                }
+                if (!i->second.empty())
+                {
+                    frame.module = i->second;
+                }
+            }
+
+            auto buffer = std::array<char, sizeof(SYMBOL_INFO) + MAX_SYM_NAME>{};
+            auto symbol = reinterpret_cast<SYMBOL_INFO*>(buffer.data());
+            symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+            symbol->MaxNameLen   = MAX_SYM_NAME;
+            auto displacement = DWORD64{0u};
+            if (SymFromAddr(process, lookup, &displacement, symbol))
+            {
+                frame.name = std::string{symbol->Name, symbol->NameLen};
+            }
+
+            auto line = IMAGEHLP_LINE64{};
+            line.SizeOfStruct = sizeof(IMAGEHLP_LINE64);
+            auto line_displacement = DWORD{0u};
+            if (SymGetLineFromAddr64(process, lookup, &line_displacement, &line))
+            {
+                frame.file = line.FileName;
+                frame.line = line.LineNumber;
+            }
+        }
+    };
+    #elif __linux__
+    //! A loaded ELF object.
+    struct ElfModule
+    {
+        std::string              path;
+        std::string              name;
+        uintptr_t                bias  = 0u;
+        uintptr_t                begin = 0u;
+        uintptr_t                end   = 0u;
+        std::unique_ptr<ElfFile> elf;
+        bool                     loaded = false;
+    };
+
+    //! The symbols and lines of the ELF objects, read on first use.
+    struct SymbolizerBackend
+    {
+        std::vector<ElfModule> modules;
+        size_t                 loaded = 0u;
+
+        size_t get_module_count() const noexcept
+        {
+            return loaded;
+        }
+
+        void refresh()
+        {
+            auto current = std::vector<ElfModule>{};
+            dl_iterate_phdr([] (dl_phdr_info* info, size_t, void* arg) -> int {
+                auto& current = *static_cast<std::vector<ElfModule>*>(arg);
+
+                auto module = ElfModule{};
+                module.bias  = info->dlpi_addr;
+                module.begin = UINTPTR_MAX;
+                for (auto i = 0u; i < info->dlpi_phnum; i++)
+                {
+                    const auto& header = info->dlpi_phdr[i];
+                    if (header.p_type == PT_LOAD)
+                    {
+                        module.begin = std::min<uintptr_t>(module.begin, info->dlpi_addr + header.p_vaddr);
+                        module.end   = std::max<uintptr_t>(module.end, info->dlpi_addr + header.p_vaddr + header.p_memsz);
+                    }
+                }
+
+                // the executable comes without a name
+                const auto name = std::string_view{info->dlpi_name != nullptr ? info->dlpi_name : ""};
+                module.path = name.empty() ? "/proc/self/exe" : std::string{name};
+
+                auto ec   = std::error_code{};
+                auto path = name.empty() ? std::filesystem::read_symlink(module.path, ec) : std::filesystem::path{name};
+                module.name = path.filename().string();
+
+                if (module.begin < module.end)
+                {
+                    current.push_back(std::move(module));
+                }
+                return 0;
+            }, &current);
+
+            // keep what was already loaded
+            for (auto& module : current)
+            {
+                auto i = std::find_if(modules.begin(), modules.end(), [&] (const ElfModule& m) {
+                    return m.loaded && m.path == module.path && m.bias == module.bias;
+                });
+                if (i != modules.end())
+                {
+                    module.elf    = std::move(i->elf);
+                    module.loaded = true;
+                }
+            }
+            modules = std::move(current);
+        }
+
+        ElfModule* find_module(uintptr_t address)
+        {
+            auto find = [&] () -> ElfModule* {
+                auto i = std::find_if(modules.begin(), modules.end(), [address] (const ElfModule& m) {
+                    return address >= m.begin && address < m.end;
+                });
+                return i != modules.end() ? &*i : nullptr;
+            };
+
+            auto module = find();
+            if (module == nullptr)
+            {
+                refresh();
+                module = find();
+            }
+            return module;
+        }
+
+        void resolve(uintptr_t address, StackFrame& frame)
+        {
+            // the return address may already be the next line
+            const auto lookup = address - 1u;
+
+            auto module = find_module(lookup);
+            if (module == nullptr)
+            {
+                return;
+            }
+            if (!module->name.empty())
+            {
+                frame.module = module->name;
+            }
+
+            if (!module->loaded)
+            {
+                module->loaded = true;
+                try
+                {
+                    module->elf = std::make_unique<ElfFile>(module->path);
+                    loaded++;
+                }
+                catch (...)
+                {
+                    // the vdso has no file, others may be gone
+                }
+            }
+            if (!module->elf)
+            {
+                return;
+            }
+
+            const auto offset = static_cast<uint64_t>(lookup - module->bias);
+            if (auto symbol = module->elf->find_symbol(offset))
+            {
+                auto status    = 0;
+                auto demangled = abi::__cxa_demangle(symbol, nullptr, nullptr, &status);
+                frame.name = status == 0 && demangled != nullptr ? demangled : symbol;
+                std::free(demangled);
+            }
+
+            const auto line = module->elf->find_line(offset);
+            if (line.line != 0u)
+            {
+                frame.file = line.file;
+                frame.line = line.line;
+            }
+        }
+    };
+    #else
+    struct SymbolizerBackend
+    {
+        size_t get_module_count() const noexcept
+        {
+            return 0u;
+        }
+
+        void resolve(uintptr_t, StackFrame&) {}
+    };
+    #endif
+
+    Symbolizer& Symbolizer::get() noexcept
+    {
+        static auto symbolizer = Symbolizer{};
+        return symbolizer;
+    }
+
+    Symbolizer::Symbolizer()
+    : backend(std::make_unique<SymbolizerBackend>())
+    {}
+
+    Symbolizer::~Symbolizer() = default;
+
+    StackFrame Symbolizer::resolve(uintptr_t address)
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        stats.lookups++;
+
+        auto i = cache.find(address);
+        if (i != cache.end())
+        {
+            stats.hits++;
+            return i->second;
+        }
+
+        auto frame = StackFrame{};
+        frame.address = address;
+        frame.name    = "Unknown Function";
+        frame.module  = "Unknown Module";
+        frame.line    = 0u;
+        backend->resolve(address, frame);
+
+        cache.emplace(address, frame);
+        return frame;
+    }
+
+    std::vector<StackFrame> Symbolizer::resolve(std::span<const uintptr_t> addresses)
+    {
+        auto frames = std::vector<StackFrame>{};
+        frames.reserve(addresses.size());
+        for (const auto address : addresses)
+        {
+            frames.push_back(resolve(address));
+        }
+        return frames;
+    }
+
+    std::vector<StackFrame> Symbolizer::resolve(const RawStackTrace& trace)
+    {
+        return resolve(trace.get_addresses());
+    }
+
+    void Symbolizer::clear()
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        cache.clear();
+        backend = std::make_unique<SymbolizerBackend>();
+        stats   = {};
+    }
+
+    SymbolizerStats Symbolizer::get_stats() const noexcept
+    {
+        auto lock = std::unique_lock<std::mutex>{mutex};
+        auto result = stats;
+        result.modules = backend->get_module_count();
+        return result;
+    }
+}
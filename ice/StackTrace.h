@@ -0,0 +1,135 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "defines.h"
+#include "debug.h"
+#include "utils.h"
+
+namespace ice
+{
+    //! The most frames a raw stack trace holds.
+    constexpr size_t MAX_STACK_DEPTH = 64u;
+
+    //! Capture the return addresses of the calling thread.
+    //!
+    //! This only walks the stack, nothing is resolved or allocated. The
+    //! first address is the return address into the caller of capture_stack.
+    //!
+    //! @param addresses where the addresses go
+    //! @param skip the number of frames to leave out
+    //! @returns the number of addresses written
+    ICE_EXPORT ICE_NOINLINE size_t capture_stack(std::span<uintptr_t> addresses, size_t skip = 0u) noexcept;
+
+    //! Raw Stack Trace
+    //!
+    //! The return addresses of a stack, cheap enough to keep with every
+    //! allocation. Pass them to a Symbolizer to get names and lines.
+    class ICE_EXPORT RawStackTrace
+    {
+    public:
+        //! Capture the stack of the calling thread.
+        //!
+        //! @param skip the number of frames to leave out, the caller is 0
+        [[nodiscard]] ICE_NOINLINE static RawStackTrace capture(size_t skip = 0u) noexcept;
+
+        //! Get the addresses, the innermost first.
+        [[nodiscard]] std::span<const uintptr_t> get_addresses() const noexcept;
+
+        //! Get the number of frames.
+        [[nodiscard]] size_t size() const noexcept;
+
+        //! Check if nothing was captured.
+        [[nodiscard]] bool empty() const noexcept;
+
+        [[nodiscard]] bool operator == (const RawStackTrace& other) const noexcept;
+
+    private:
+        std::array<uintptr_t, MAX_STACK_DEPTH> addresses = {};
+        size_t                                 count     = 0u;
+    };
+
+    //! Symbolizer Statistics
+    struct SymbolizerStats
+    {
+        //! The number of addresses resolved.
+        size_t lookups = 0u;
+        //! The number of addresses found in the cache.
+        size_t hits    = 0u;
+        //! The number of modules that had their symbols loaded.
+        size_t modules = 0u;
+    };
+
+    struct SymbolizerBackend;
+
+    //! Symbolizer
+    //!
+    //! Turns return addresses into function names, modules, files and
+    //! lines. Modules are loaded on first use and every resolved address is
+    //! cached, so resolving the same stacks again is cheap.
+    //!
+    //! On Windows this uses DbgHelp, on Linux it reads the symbol tables and
+    //! the DWARF line tables of the loaded ELF files. The symbolizer is
+    //! thread safe.
+    class ICE_EXPORT Symbolizer : private non_copyable
+    {
+    public:
+        //! Get the shared symbolizer.
+        [[nodiscard]] static Symbolizer& get() noexcept;
+
+        Symbolizer();
+        ~Symbolizer();
+
+        //! Resolve one return address.
+        //!
+        //! Unknown functions and modules are reported as such, the line is 0
+        //! if there is no line information.
+        [[nodiscard]] StackFrame resolve(uintptr_t address);
+
+        //! Resolve a stack.
+        [[nodiscard]] std::vector<StackFrame> resolve(std::span<const uintptr_t> addresses);
+
+        //! Resolve a raw stack trace.
+        [[nodiscard]] std::vector<StackFrame> resolve(const RawStackTrace& trace);
+
+        //! Forget all cached symbols and modules.
+        void clear();
+
+        //! Get the statistics.
+        [[nodiscard]] SymbolizerStats get_stats() const noexcept;
+
+    private:
+        mutable std::mutex                        mutex;
+        std::unique_ptr<SymbolizerBackend>        backend;
+        std::unordered_map<uintptr_t, StackFrame> cache;
+        SymbolizerStats                           stats;
+    };
+}
@@ -0,0 +1,134 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "SystemScheduler.h"
+
+#include "debug.h"
+
+namespace ice
+{
+    bool conflicts(const SystemAccess& a, const SystemAccess& b) noexcept
+    {
+        return (a.writes & (b.reads | b.writes)).any() || (b.writes & a.reads).any();
+    }
+
+    void SystemScheduler::add(const std::string_view name, const SystemAccess& access, const SystemFunction& fun)
+    {
+        check(static_cast<bool>(fun));
+
+        auto node = std::make_unique<Node>();
+        node->name   = name;
+        node->access = access;
+        node->fun    = fun;
+        nodes.push_back(std::move(node));
+        dirty = true;
+    }
+
+    size_t SystemScheduler::get_system_count() const noexcept
+    {
+        return nodes.size();
+    }
+
+    const std::string& SystemScheduler::get_name(size_t index) const noexcept
+    {
+        check(index < nodes.size());
+        return nodes[index]->name;
+    }
+
+    const std::vector<size_t>& SystemScheduler::get_dependencies(size_t index) noexcept
+    {
+        check(index < nodes.size());
+        build();
+        return nodes[index]->dependencies;
+    }
+
+    void SystemScheduler::run(JobSystem& jobs, World& world, float dt)
+    {
+        build();
+
+        for (auto& node : nodes)
+        {
+            node->remaining = static_cast<unsigned int>(node->dependencies.size());
+        }
+
+        auto counter = JobCounter{};
+        for (auto i = size_t{0u}; i < nodes.size(); i++)
+        {
+            if (nodes[i]->dependencies.empty())
+            {
+                schedule(jobs, counter, world, dt, i);
+            }
+        }
+        jobs.wait(counter);
+    }
+
+    void SystemScheduler::build() noexcept
+    {
+        if (!dirty)
+        {
+            return;
+        }
+
+        for (auto& node : nodes)
+        {
+            node->dependencies.clear();
+            node->dependents.clear();
+        }
+
+        // Each system waits on all earlier systems it conflicts with; this
+        // keeps the order of conflicting systems deterministic.
+        for (auto j = size_t{0u}; j < nodes.size(); j++)
+        {
+            for (auto i = size_t{0u}; i < j; i++)
+            {
+                if (conflicts(nodes[i]->access, nodes[j]->access))
+                {
+                    nodes[j]->dependencies.push_back(i);
+                    nodes[i]->dependents.push_back(j);
+                }
+            }
+        }
+
+        dirty = false;
+    }
+
+    void SystemScheduler::schedule(JobSystem& jobs, JobCounter& counter, World& world, float dt, size_t index)
+    {
+        jobs.schedule(counter, [this, &jobs, &counter, &world, dt, index] () {
+            auto& node = *nodes[index];
+
+            // a system waiting on jobs may run another system on this thread
+            const auto previous = World::set_thread_access(&node.access);
+            node.fun(world, dt);
+            World::set_thread_access(previous);
+
+            // The dependents are scheduled before this job completes, so the
+            // counter can not reach zero in between.
+            for (auto dependent : node.dependents)
+            {
+                if (nodes[dependent]->remaining.fetch_sub(1u) == 1u)
+                {
+                    schedule(jobs, counter, world, dt, dependent);
+                }
+            }
+        });
+    }
+}
@@ -0,0 +1,91 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "defines.h"
+#include "utils.h"
+#include "World.h"
+#include "JobSystem.h"
+
+namespace ice
+{
+    //! System Function
+    //!
+    //! A system is called with the world and the step time in seconds.
+    using SystemFunction = std::function<void (World&, float)>;
+
+    //! System Scheduler
+    //!
+    //! The SystemScheduler runs systems in parallel based on their declared
+    //! component access. Two systems conflict if one of them writes a
+    //! component that the other reads or writes. Conflicting systems run in
+    //! the order they were added, all other systems may run concurrently.
+    //!
+    //! In debug builds, a system that accesses components it did not declare
+    //! or that structurally changes the world fails.
+    class ICE_EXPORT SystemScheduler : private non_copyable
+    {
+    public:
+        //! Add a system.
+        //!
+        //! The access is built with World::get_mask, which registers the
+        //! components before the systems run. Systems can't register
+        //! components, they run in parallel.
+        void add(const std::string_view name, const SystemAccess& access, const SystemFunction& fun);
+
+        //! Get the number of systems.
+        [[nodiscard]] size_t get_system_count() const noexcept;
+
+        //! Get the name of a system.
+        [[nodiscard]] const std::string& get_name(size_t index) const noexcept;
+
+        //! Get the systems a system has to wait for.
+        [[nodiscard]] const std::vector<size_t>& get_dependencies(size_t index) noexcept;
+
+        //! Run all systems once and wait for them to complete.
+        void run(JobSystem& jobs, World& world, float dt);
+
+    private:
+        struct Node
+        {
+            std::string               name;
+            SystemAccess              access;
+            SystemFunction            fun;
+            std::vector<size_t>       dependencies;
+            std::vector<size_t>       dependents;
+            std::atomic<unsigned int> remaining = 0u;
+        };
+
+        std::vector<std::unique_ptr<Node>> nodes;
+        bool                               dirty = false;
+
+        void build() noexcept;
+        void schedule(JobSystem& jobs, JobCounter& counter, World& world, float dt, size_t index);
+    };
+}
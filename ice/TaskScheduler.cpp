@@ -0,0 +1,159 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "TaskScheduler.h"
+
+#include <algorithm>
+
+#include "debug.h"
+
+namespace ice
+{
+    TaskScheduler::TaskScheduler(duration frame_budget, const Clock& clock_func) noexcept
+    : budget(frame_budget), clock(clock_func)
+    {
+        check(static_cast<bool>(clock));
+    }
+
+    void TaskScheduler::set_budget(duration value) noexcept
+    {
+        budget = value;
+    }
+
+    TaskScheduler::duration TaskScheduler::get_budget() const noexcept
+    {
+        return budget;
+    }
+
+    void TaskScheduler::set_max_age(unsigned int value) noexcept
+    {
+        max_age = value;
+    }
+
+    unsigned int TaskScheduler::get_max_age() const noexcept
+    {
+        return max_age;
+    }
+
+    void TaskScheduler::set_clock(const Clock& value) noexcept
+    {
+        check(static_cast<bool>(value));
+        clock = value;
+    }
+
+    void TaskScheduler::enqueue(TaskPriority priority, const Task& task)
+    {
+        check(static_cast<bool>(task));
+        queues[static_cast<size_t>(priority)].push_back({task, frame});
+    }
+
+    size_t TaskScheduler::get_pending() const noexcept
+    {
+        auto count = size_t{0u};
+        for (const auto& queue : queues)
+        {
+            count += queue.size();
+        }
+        return count;
+    }
+
+    void TaskScheduler::run() noexcept
+    {
+        frame++;
+
+        stats        = {};
+        stats.budget = budget;
+
+        const auto start = clock();
+        auto now = start;
+        do
+        {
+            auto queue = pick();
+            if (queue == nullptr)
+            {
+                break;
+            }
+
+            auto entry = std::move(queue->front());
+            queue->pop_front();
+
+            stats.slices++;
+            if (entry.task())
+            {
+                stats.finished++;
+            }
+            else
+            {
+                entry.last_frame = frame;
+                queue->push_back(std::move(entry));
+            }
+
+            now = clock();
+        }
+        while (now - start < budget);
+
+        stats.used    = now - start;
+        stats.pending = get_pending();
+        for (const auto& queue : queues)
+        {
+            if (!queue.empty())
+            {
+                const auto wait = static_cast<unsigned int>(frame - queue.front().last_frame);
+                stats.max_wait = std::max(stats.max_wait, wait);
+            }
+        }
+    }
+
+    const TaskStats& TaskScheduler::get_stats() const noexcept
+    {
+        return stats;
+    }
+
+    std::deque<TaskScheduler::Entry>* TaskScheduler::pick() noexcept
+    {
+        // The front of each queue is the task that waited longest in that
+        // queue; if any of them starves, run the oldest.
+        std::deque<Entry>* oldest = nullptr;
+        for (auto& queue : queues)
+        {
+            if (!queue.empty() && frame - queue.front().last_frame > max_age)
+            {
+                if (oldest == nullptr || queue.front().last_frame < oldest->front().last_frame)
+                {
+                    oldest = &queue;
+                }
+            }
+        }
+        if (oldest != nullptr)
+        {
+            return oldest;
+        }
+
+        for (auto i = queues.size(); i > 0u; i--)
+        {
+            if (!queues[i - 1u].empty())
+            {
+                return &queues[i - 1u];
+            }
+        }
+        return nullptr;
+    }
+}
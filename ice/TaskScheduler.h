@@ -0,0 +1,129 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <functional>
+
+#include "defines.h"
+#include "utils.h"
+#include "FixedTimestep.h"
+
+namespace ice
+{
+    //! Task Priority
+    enum class TaskPriority
+    {
+        LOW,
+        NORMAL,
+        HIGH
+    };
+
+    //! Resumable Task
+    //!
+    //! A task does a small slice of work each time it is called and returns
+    //! true once it is finished. Tasks that return false are resumed in a
+    //! later slice.
+    using Task = std::function<bool ()>;
+
+    //! Task Scheduler Statistics
+    struct TaskStats
+    {
+        //! The time budget of the last frame.
+        std::chrono::steady_clock::duration budget = {};
+        //! The time used in the last frame.
+        std::chrono::steady_clock::duration used = {};
+        //! The number of task slices run in the last frame.
+        size_t slices = 0u;
+        //! The number of tasks finished in the last frame.
+        size_t finished = 0u;
+        //! The number of tasks still queued.
+        size_t pending = 0u;
+        //! The number of frames the longest waiting task has waited.
+        unsigned int max_wait = 0u;
+    };
+
+    //! Task Scheduler
+    //!
+    //! The TaskScheduler runs deferrable work in slices within a per-frame
+    //! time budget. Tasks are picked by priority and in order of arrival
+    //! within a priority. To prevent starvation, a task that has waited for
+    //! more than the maximum age is run before any other task.
+    //!
+    //! At least one slice is run each frame, so that the queue always makes
+    //! progress, even if a single slice exceeds the budget.
+    class ICE_EXPORT TaskScheduler : private non_copyable
+    {
+    public:
+        using duration = std::chrono::steady_clock::duration;
+
+        //! Construct Task Scheduler
+        //!
+        //! @param frame_budget the time to spend on tasks each frame
+        //! @param clock_func the clock to measure the time with
+        TaskScheduler(duration frame_budget = std::chrono::milliseconds(2), const Clock& clock_func = std::chrono::steady_clock::now) noexcept;
+
+        //! Set the time to spend on tasks each frame.
+        void set_budget(duration value) noexcept;
+        //! Get the time to spend on tasks each frame.
+        [[nodiscard]] duration get_budget() const noexcept;
+
+        //! Set the number of frames after which a waiting task is run first.
+        void set_max_age(unsigned int value) noexcept;
+        //! Get the number of frames after which a waiting task is run first.
+        [[nodiscard]] unsigned int get_max_age() const noexcept;
+
+        //! Replace the clock.
+        void set_clock(const Clock& value) noexcept;
+
+        //! Queue a task.
+        void enqueue(TaskPriority priority, const Task& task);
+
+        //! Get the number of queued tasks.
+        [[nodiscard]] size_t get_pending() const noexcept;
+
+        //! Run task slices until the budget is used up.
+        void run() noexcept;
+
+        //! Get the statistics of the last run.
+        [[nodiscard]] const TaskStats& get_stats() const noexcept;
+
+    private:
+        struct Entry
+        {
+            Task          task;
+            unsigned long last_frame = 0u;
+        };
+
+        duration     budget  = std::chrono::milliseconds(2);
+        unsigned int max_age = 30u;
+        Clock        clock;
+
+        unsigned long                     frame = 0u;
+        std::array<std::deque<Entry>, 3u> queues;
+        TaskStats                         stats;
+
+        std::deque<Entry>* pick() noexcept;
+    };
+}
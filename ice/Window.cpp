@@ -25,6 +25,7 @@
 #include <SDL2/SDL_opengl.h>
 
 #include "debug.h"
+#include "Profiler.h"
 
 namespace ice
 {
@@ -66,10 +67,15 @@ namespace ice
         {
             throw std::runtime_error(SDL_GetError());
         }
+
+        gl.set_functions(load_gl_functions());
+        readback = std::make_unique<FrameReadback>(load_readback_functions());
+        update_state();
     }
 
     Window::~Window()
     {
+        readback = nullptr;
         SDL_GL_DeleteContext(glcontext);
         SDL_DestroyWindow(window);
     }
@@ -92,36 +98,36 @@ namespace ice
         }
     }
 
-    void Window::resize(const glm::uvec2& size, WindowMode mode) noexcept
+    void Window::resize(const glm::uvec2& new_size, WindowMode new_mode) noexcept
     {
-        if (mode == get_mode())
+        if (new_mode == get_mode())
         {
-            SDL_SetWindowSize(window, size.x, size.y);
+            SDL_SetWindowSize(window, new_size.x, new_size.y);
         }
         else
         {
-            switch (mode)
+            switch (new_mode)
             {
                 case WindowMode::STATIC:
                     SDL_SetWindowFullscreen(window, 0);
                     SDL_SetWindowResizable(window, SDL_FALSE);
                     SDL_SetWindowBordered(window, SDL_FALSE);
-                    SDL_SetWindowSize(window, size.x, size.y);
+                    SDL_SetWindowSize(window, new_size.x, new_size.y);
                     break;
                 case WindowMode::RESIZABLE:
                     SDL_SetWindowFullscreen(window, 0);
                     SDL_SetWindowResizable(window, SDL_TRUE);
                     SDL_SetWindowBordered(window, SDL_FALSE);
-                    SDL_SetWindowSize(window, size.x, size.y);
+                    SDL_SetWindowSize(window, new_size.x, new_size.y);
                     break;
                 case WindowMode::BORDERLESS:
                     SDL_SetWindowFullscreen(window, 0);
                     SDL_SetWindowResizable(window, SDL_FALSE);
                     SDL_SetWindowBordered(window, SDL_TRUE);
-                    SDL_SetWindowSize(window, size.x, size.y);
+                    SDL_SetWindowSize(window, new_size.x, new_size.y);
                     break;
                 case WindowMode::FULLSCREEN:
-                    SDL_SetWindowSize(window, size.x, size.y);
+                    SDL_SetWindowSize(window, new_size.x, new_size.y);
                     SDL_SetWindowFullscreen(window, SDL_WINDOW_FULLSCREEN);
                     break;
                 case WindowMode::DESKTOP_FULLSCREEN:
@@ -129,25 +135,28 @@ namespace ice
                     break;
             }
 
-            SDL_SetWindowResizable(window, (mode == WindowMode::RESIZABLE) ? SDL_TRUE : SDL_FALSE);
+            SDL_SetWindowResizable(window, (new_mode == WindowMode::RESIZABLE) ? SDL_TRUE : SDL_FALSE);
         }
+
+        update_state();
     }
 
     glm::uvec2 Window::get_size() const noexcept
     {
-        int w, h;
-        SDL_GetWindowSize(window, &w, &h);
-        return {w, h};
+        return size;
     }
 
     glm::uvec2 Window::get_drawable_size() const noexcept
     {
-        int w, h;
-        SDL_GL_GetDrawableSize(window, &w, &h);
-        return {w, h};
+        return drawable_size;
     }
 
     WindowMode Window::get_mode() const noexcept
+    {
+        return mode;
+    }
+
+    WindowMode get_window_mode(SDL_Window* window) noexcept
     {
         auto sdl_flags = SDL_GetWindowFlags(window);
         if (sdl_flags & SDL_WINDOW_FULLSCREEN)
@@ -176,67 +185,176 @@ namespace ice
 
     void Window::draw() const noexcept
     {
-        int w, h;
-        SDL_GL_GetDrawableSize(window, &w, &h);
-        glViewport(0, 0, w, h);
+        auto frame = FramePacket{};
+        draw(frame);
+    }
+
+    void Window::draw(FramePacket& frame) const noexcept
+    {
+        ICE_PROFILE_ZONE();
+        const auto start = std::chrono::steady_clock::now();
+        const auto ds    = get_drawable_size();
+        gl.viewport({0, 0, ds.x, ds.y});
         glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
 
+        frame.execute();
         draw_signal.emit();
 
-        SDL_GL_SwapWindow(window);
+        auto requests = std::vector<ReadbackCallback>{};
+        auto frame_capture = std::shared_ptr<FrameCapture>{};
+        {
+            auto lock = std::unique_lock<std::mutex>{save_mutex};
+            requests.swap(save_requests);
+            frame_capture = capture;
+        }
+        // requests that find all slots busy wait for the next frame
+        std::erase_if(requests, [&] (const auto& callback) {
+            return readback->read(ds, frame.get_frame(), callback);
+        });
+        if (!requests.empty())
+        {
+            auto lock = std::unique_lock<std::mutex>{save_mutex};
+            save_requests.insert(save_requests.begin(), requests.begin(), requests.end());
+        }
+        if (frame_capture && frame_capture->want_frame(frame.get_frame()))
+        {
+            auto pushed = readback->read(ds, frame.get_frame(), [frame_capture] (Image&& image) {
+                frame_capture->push(std::move(image));
+            }, [frame_capture] () {
+                frame_capture->drop_readback();
+            }, frame_capture->get_settings().downscale);
+            if (!pushed)
+            {
+                frame_capture->drop_readback();
+            }
+        }
+
+        const auto swap_start = std::chrono::steady_clock::now();
+        {
+            ICE_PROFILE_ZONE_NAMED("SDL_GL_SwapWindow");
+            SDL_GL_SwapWindow(window);
+        }
+        const auto swap_end = std::chrono::steady_clock::now();
+        gl.end_frame();
+        readback->update();
+
+        draw_time = (swap_start - start) + (std::chrono::steady_clock::now() - swap_end);
+        swap_time = swap_end - swap_start;
+    }
+
+    std::chrono::steady_clock::duration Window::get_draw_time() const noexcept
+    {
+        return draw_time;
+    }
+
+    std::chrono::steady_clock::duration Window::get_swap_time() const noexcept
+    {
+        return swap_time;
+    }
+
+    GLState& Window::get_gl_state() noexcept
+    {
+        return gl;
+    }
+
+    void Window::save(const ReadbackCallback& callback)
+    {
+        auto lock = std::unique_lock<std::mutex>{save_mutex};
+        save_requests.push_back(callback);
+    }
+
+    void Window::set_capture(const std::shared_ptr<FrameCapture>& value) noexcept
+    {
+        auto lock = std::unique_lock<std::mutex>{save_mutex};
+        capture = value;
+    }
+
+    std::shared_ptr<FrameCapture> Window::get_capture() const noexcept
+    {
+        auto lock = std::unique_lock<std::mutex>{save_mutex};
+        return capture;
     }
 
-    /*Texture Window::save() const noexcept
+    FrameReadback& Window::get_frame_readback() noexcept
     {
-        auto s = get_size();
-        std::vector<std::byte> buffer(s.x * s.y * 3);
-        glReadPixels(0, 0, s.x, s.y, GL_BGR, GL_UNSIGNED_BYTE, buffer.data());
-        return Texture(s, ColorMode::RGB, DataType::UINT8, buffer.data(), "screen");
-    }*/
+        check(readback != nullptr);
+        return *readback;
+    }
 
-    rsig::signal<>& Window::get_draw_sginal() noexcept
+    Signal<>& Window::get_draw_sginal() noexcept
     {
         return draw_signal;
     }
 
-    rsig::connection Window::on_draw(const std::function<void()>& cb) noexcept
+    Connection Window::on_draw(const Delegate<void ()>& cb) noexcept
     {
         return draw_signal.connect(cb);
     }
 
-    rsig::signal<>& Window::get_close_sginal() noexcept
+    Signal<>& Window::get_close_sginal() noexcept
     {
         return close_signal;
     }
 
-    rsig::connection Window::on_close(const std::function<void()>& cb) noexcept
+    Connection Window::on_close(const Delegate<void ()>& cb) noexcept
     {
         return close_signal.connect(cb);
     }
 
-    rsig::signal<glm::uvec2>& Window::get_resize_sginal() noexcept
+    Signal<glm::uvec2>& Window::get_resize_sginal() noexcept
     {
         return resize_signal;
     }
 
-    rsig::connection Window::on_resize(const std::function<void(glm::uvec2)>& cb) noexcept
+    Connection Window::on_resize(const Delegate<void (glm::uvec2)>& cb) noexcept
     {
         return resize_signal.connect(cb);
     }
 
+    void Window::make_current() noexcept
+    {
+        auto r = SDL_GL_MakeCurrent(window, glcontext);
+        check(r == 0);
+    }
+
+    void Window::release_current() noexcept
+    {
+        auto r = SDL_GL_MakeCurrent(window, nullptr);
+        check(r == 0);
+    }
+
     void Window::handle_event(SDL_Event& event)
     {
-        switch (event.type)
+        check(event.type == SDL_WINDOWEVENT);
+
+        switch (event.window.event)
         {
-        case SDL_WINDOWEVENT_RESIZED:
         case SDL_WINDOWEVENT_SIZE_CHANGED:
-            resize_signal.emit({event.window.data1, event.window.data2});
+            update_state();
+            resize_signal.emit(get_size());
+            break;
+        case SDL_WINDOWEVENT_MAXIMIZED:
+        case SDL_WINDOWEVENT_RESTORED:
+            update_state();
             break;
         case SDL_WINDOWEVENT_CLOSE:
             close_signal.emit();
             break;
         default:
-            fail("Unexpected SDL event.");
+            // nothing to do
+            break;
         }
     }
+
+    void Window::update_state() noexcept
+    {
+        int w, h;
+        SDL_GetWindowSize(window, &w, &h);
+        size = glm::uvec2(w, h);
+
+        SDL_GL_GetDrawableSize(window, &w, &h);
+        drawable_size = glm::uvec2(w, h);
+
+        mode = get_window_mode(window);
+    }
 }
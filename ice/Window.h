@@ -21,14 +21,22 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <string_view>
+#include <vector>
 
 #include <glm/glm.hpp>
-#include <rsig/rsig.h>
 
 #include "defines.h"
 #include "utils.h"
+#include "Signal.h"
+#include "FramePacket.h"
+#include "GLState.h"
+#include "FrameReadback.h"
+#include "FrameCapture.h"
 
 struct SDL_Window;
 typedef void *SDL_GLContext;
@@ -49,6 +57,9 @@ namespace ice
     };
 
     //! System Window
+    //!
+    //! The window size and mode are cached and kept up to date from the
+    //! window events, so querying them does not call into SDL.
     class ICE_EXPORT Window : private non_copyable
     {
     public:
@@ -68,6 +79,7 @@ namespace ice
         //! Get size.
         glm::uvec2 get_size() const noexcept;
 
+        //! Get the size of the drawable area in pixels.
         glm::uvec2 get_drawable_size() const noexcept;
 
         //! Get the window mode.
@@ -79,36 +91,93 @@ namespace ice
         //! Draw frame
         void draw() const noexcept;
 
-        //! Save the current window contents as texture.
-        //std::shared_ptr<Texture> save() const noexcept;
+        //! Draw frame
+        //!
+        //! The commands and the sorted render queue of the frame packet are
+        //! run before the draw signal is emitted. When the engine uses a
+        //! render thread, this is called on the render thread.
+        void draw(FramePacket& frame) const noexcept;
+
+        //! Get the time the last frame took to draw, without the swap.
+        [[nodiscard]] std::chrono::steady_clock::duration get_draw_time() const noexcept;
+
+        //! Get the time the last buffer swap took.
+        [[nodiscard]] std::chrono::steady_clock::duration get_swap_time() const noexcept;
+
+        //! Get the GL state cache.
+        //!
+        //! GL state changes should go through the cache, so that redundant
+        //! driver calls are skipped. Only use the cache on the thread that
+        //! draws.
+        GLState& get_gl_state() noexcept;
+
+        //! Save the window contents.
+        //!
+        //! The next drawn frame with a free readback slot is read back
+        //! without stalling the GPU and the image is passed to the callback
+        //! on the readback thread, usually a few frames later. This may be
+        //! called from any thread.
+        void save(const ReadbackCallback& callback);
+
+        //! Stream the drawn frames to a capture.
+        //!
+        //! Each drawn frame is read back asynchronously and pushed to the
+        //! capture, scaled down on the GPU by the capture's downscale factor.
+        //! Frames the readback can't take or loses are counted as dropped.
+        //! Pass nullptr to stop capturing; the capture is released when the
+        //! frames in flight are done. This may be called from any thread.
+        void set_capture(const std::shared_ptr<FrameCapture>& value) noexcept;
+        //! Get the current capture.
+        [[nodiscard]] std::shared_ptr<FrameCapture> get_capture() const noexcept;
+
+        //! Get the frame readback.
+        //!
+        //! Only use the readback on the thread that draws.
+        FrameReadback& get_frame_readback() noexcept;
 
         //! Signal emitted each time the window needs to be redrawn
         //! @{
-        rsig::signal<>& get_draw_sginal() noexcept;
-        rsig::connection on_draw(const std::function<void ()>& cb) noexcept;
+        Signal<>& get_draw_sginal() noexcept;
+        Connection on_draw(const Delegate<void ()>& cb) noexcept;
         //! @}
 
         //! Signal emitted when the window is closed.
         //! @{
-        rsig::signal<>& get_close_sginal() noexcept;
-        rsig::connection on_close(const std::function<void ()>& cb) noexcept;
+        Signal<>& get_close_sginal() noexcept;
+        Connection on_close(const Delegate<void ()>& cb) noexcept;
         //! @}
 
         //! Signal emitted when the window is resized.
         //! @{
-        rsig::signal<glm::uvec2>& get_resize_sginal() noexcept;
-        rsig::connection on_resize(const std::function<void (glm::uvec2)>& cb) noexcept;
+        Signal<glm::uvec2>& get_resize_sginal() noexcept;
+        Connection on_resize(const Delegate<void (glm::uvec2)>& cb) noexcept;
         //! @}
 
     private:
         SDL_Window*    window    = nullptr;
         SDL_GLContext  glcontext = nullptr;
 
-        rsig::signal<> draw_signal;
-        rsig::signal<> close_signal;
-        rsig::signal<glm::uvec2> resize_signal;
+        std::atomic<glm::uvec2> size;
+        std::atomic<glm::uvec2> drawable_size;
+        std::atomic<WindowMode> mode;
+        mutable GLState         gl;
+
+        mutable std::atomic<std::chrono::steady_clock::duration> draw_time = {};
+        mutable std::atomic<std::chrono::steady_clock::duration> swap_time = {};
+
+        std::unique_ptr<FrameReadback>        readback;
+        mutable std::mutex                    save_mutex;
+        mutable std::vector<ReadbackCallback> save_requests;
+        std::shared_ptr<FrameCapture>         capture;
+
+        Signal<> draw_signal;
+        Signal<> close_signal;
+        Signal<glm::uvec2> resize_signal;
 
         void handle_event(SDL_Event& event);
+        void update_state() noexcept;
+        void make_current() noexcept;
+        void release_current() noexcept;
 
         friend class Engine;
         friend class Mouse;
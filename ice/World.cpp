@@ -0,0 +1,406 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "World.h"
+
+#include <algorithm>
+#include <format>
+#include <utility>
+
+namespace ice
+{
+    constexpr auto CHUNK_ALIGNMENT = std::align_val_t{64u};
+
+    namespace
+    {
+        thread_local const SystemAccess* thread_access = nullptr;
+    }
+
+    constexpr size_t align_up(size_t value, size_t alignment) noexcept
+    {
+        return (value + alignment - 1u) & ~(alignment - 1u);
+    }
+
+    Archetype::Archetype(const ComponentMask& m, const ComponentInfo* i)
+    : mask(m), infos(i)
+    {
+        offsets.fill(SIZE_MAX);
+
+        auto row_size = sizeof(Entity);
+        for (auto id = ComponentId{0u}; id < MAX_COMPONENTS; id++)
+        {
+            if (mask.test(id))
+            {
+                components.push_back(id);
+                row_size += infos[id].size;
+            }
+        }
+
+        // Start with the optimistic capacity and shrink it until the
+        // arrays fit with their alignment padding.
+        capacity = CHUNK_SIZE / row_size;
+        while (capacity > 0u)
+        {
+            auto end = sizeof(Entity) * capacity;
+            for (auto id : components)
+            {
+                offsets[id] = align_up(end, infos[id].align);
+                end = offsets[id] + infos[id].size * capacity;
+            }
+            if (end <= CHUNK_SIZE)
+            {
+                break;
+            }
+            capacity--;
+        }
+        check(capacity > 0u);
+    }
+
+    Archetype::~Archetype()
+    {
+        for (auto& chunk : chunks)
+        {
+            for (auto id : components)
+            {
+                for (auto row = size_t{0u}; row < chunk.count; row++)
+                {
+                    infos[id].destroy(chunk.data + offsets[id] + row * infos[id].size);
+                }
+            }
+            ::operator delete(chunk.data, CHUNK_ALIGNMENT);
+        }
+    }
+
+    const ComponentMask& Archetype::get_mask() const noexcept
+    {
+        return mask;
+    }
+
+    size_t Archetype::get_capacity() const noexcept
+    {
+        return capacity;
+    }
+
+    size_t Archetype::get_chunk_count() const noexcept
+    {
+        return chunks.size();
+    }
+
+    size_t Archetype::get_count(size_t chunk) const noexcept
+    {
+        return chunks[chunk].count;
+    }
+
+    size_t Archetype::get_size() const noexcept
+    {
+        if (chunks.empty())
+        {
+            return 0u;
+        }
+        return (chunks.size() - 1u) * capacity + chunks.back().count;
+    }
+
+    size_t Archetype::get_offset(ComponentId id) const noexcept
+    {
+        ICE_CHECK_DEBUG(mask.test(id));
+        return offsets[id];
+    }
+
+    const Entity* Archetype::get_entities(size_t chunk) const noexcept
+    {
+        return reinterpret_cast<const Entity*>(chunks[chunk].data);
+    }
+
+    std::byte* Archetype::get_column(size_t chunk, size_t offset) const noexcept
+    {
+        return chunks[chunk].data + offset;
+    }
+
+    void* Archetype::get_component(size_t chunk, size_t row, ComponentId id) const noexcept
+    {
+        return chunks[chunk].data + offsets[id] + row * infos[id].size;
+    }
+
+    std::pair<size_t, size_t> Archetype::allocate(Entity entity)
+    {
+        if (chunks.empty() || chunks.back().count == capacity)
+        {
+            auto data = static_cast<std::byte*>(::operator new(CHUNK_SIZE, CHUNK_ALIGNMENT));
+            chunks.push_back({data, 0u});
+        }
+
+        auto& chunk = chunks.back();
+        const auto row = chunk.count++;
+        reinterpret_cast<Entity*>(chunk.data)[row] = entity;
+        return {chunks.size() - 1u, row};
+    }
+
+    Entity Archetype::release(size_t chunk, size_t row) noexcept
+    {
+        // The components at chunk/row are already moved out or destroyed;
+        // fill the hole with the last entity to keep the chunks packed.
+        auto& last = chunks.back();
+        const auto last_chunk = chunks.size() - 1u;
+        const auto last_row   = last.count - 1u;
+
+        auto moved = Entity{};
+        if (chunk != last_chunk || row != last_row)
+        {
+            for (auto id : components)
+            {
+                infos[id].move(get_component(chunk, row, id), get_component(last_chunk, last_row, id));
+            }
+            auto entities = reinterpret_cast<Entity*>(chunks[chunk].data);
+            entities[row] = reinterpret_cast<Entity*>(last.data)[last_row];
+            moved = entities[row];
+        }
+
+        last.count--;
+        if (last.count == 0u)
+        {
+            ::operator delete(last.data, CHUNK_ALIGNMENT);
+            chunks.pop_back();
+        }
+
+        return moved;
+    }
+
+    World::World()
+    {
+        find_archetype(ComponentMask{});
+    }
+
+    World::~World() = default;
+
+    Entity World::create()
+    {
+        #ifndef NDEBUG
+        check_structural();
+        #endif
+
+        auto index = uint32_t{0u};
+        if (!free_indices.empty())
+        {
+            index = free_indices.back();
+            free_indices.pop_back();
+        }
+        else
+        {
+            index = static_cast<uint32_t>(records.size());
+            records.push_back({});
+        }
+
+        auto& record = records[index];
+        const auto entity = Entity{index, record.generation};
+
+        record.archetype = archetypes.front().get();
+        std::tie(record.chunk, record.row) = record.archetype->allocate(entity);
+
+        entity_count++;
+        return entity;
+    }
+
+    void World::destroy(Entity entity) noexcept
+    {
+        if (!is_alive(entity))
+        {
+            return;
+        }
+
+        #ifndef NDEBUG
+        check_structural();
+        #endif
+
+        auto& record    = records[entity.index];
+        auto  archetype = record.archetype;
+
+        for (auto id : archetype->components)
+        {
+            infos[id].destroy(archetype->get_component(record.chunk, record.row, id));
+        }
+
+        const auto moved = archetype->release(record.chunk, record.row);
+        if (moved.generation != 0u)
+        {
+            records[moved.index].chunk = record.chunk;
+            records[moved.index].row   = record.row;
+        }
+
+        record.archetype = nullptr;
+        record.generation++;
+        free_indices.push_back(entity.index);
+        entity_count--;
+    }
+
+    bool World::is_alive(Entity entity) const noexcept
+    {
+        return entity.index < records.size() &&
+               records[entity.index].generation == entity.generation &&
+               records[entity.index].archetype != nullptr;
+    }
+
+    size_t World::get_entity_count() const noexcept
+    {
+        return entity_count;
+    }
+
+    size_t World::get_archetype_count() const noexcept
+    {
+        return archetypes.size();
+    }
+
+    const Archetype& World::get_archetype(size_t index) const noexcept
+    {
+        check(index < archetypes.size());
+        return *archetypes[index];
+    }
+
+    const SystemAccess* World::set_thread_access(const SystemAccess* access) noexcept
+    {
+        return std::exchange(thread_access, access);
+    }
+
+    const SystemAccess* World::get_thread_access() noexcept
+    {
+        return thread_access;
+    }
+
+    ComponentId World::register_component(std::type_index type, const ComponentInfo& info)
+    {
+        if (ids.size() >= MAX_COMPONENTS)
+        {
+            throw std::runtime_error("Too many component types.");
+        }
+
+        const auto id = static_cast<ComponentId>(ids.size());
+        infos[id] = info;
+        ids[type] = id;
+        return id;
+    }
+
+    Archetype* World::find_archetype(const ComponentMask& mask)
+    {
+        auto i = archetype_index.find(mask);
+        if (i != archetype_index.end())
+        {
+            return i->second;
+        }
+
+        archetypes.push_back(std::make_unique<Archetype>(mask, infos.data()));
+        auto archetype = archetypes.back().get();
+        archetype_index[mask] = archetype;
+        return archetype;
+    }
+
+    Archetype* World::transition_add(Archetype* from, ComponentId id)
+    {
+        auto& edge = from->add_edges[id];
+        if (edge == nullptr)
+        {
+            auto mask = from->mask;
+            mask.set(id);
+            edge = find_archetype(mask);
+            edge->remove_edges[id] = from;
+        }
+        return edge;
+    }
+
+    Archetype* World::transition_remove(Archetype* from, ComponentId id)
+    {
+        auto& edge = from->remove_edges[id];
+        if (edge == nullptr)
+        {
+            auto mask = from->mask;
+            mask.reset(id);
+            edge = find_archetype(mask);
+            edge->add_edges[id] = from;
+        }
+        return edge;
+    }
+
+    World::Record& World::get_record(Entity entity) noexcept
+    {
+        ICE_CHECK_DEBUG(is_alive(entity));
+        return records[entity.index];
+    }
+
+    void World::move_entity(Entity entity, Archetype* to)
+    {
+        auto& record = records[entity.index];
+        auto  from   = record.archetype;
+
+        const auto [chunk, row] = to->allocate(entity);
+
+        for (auto id : from->components)
+        {
+            auto src = from->get_component(record.chunk, record.row, id);
+            if (to->mask.test(id))
+            {
+                infos[id].move(to->get_component(chunk, row, id), src);
+            }
+            else
+            {
+                infos[id].destroy(src);
+            }
+        }
+
+        const auto moved = from->release(record.chunk, record.row);
+        if (moved.generation != 0u)
+        {
+            records[moved.index].chunk = record.chunk;
+            records[moved.index].row   = record.row;
+        }
+
+        record.archetype = to;
+        record.chunk     = chunk;
+        record.row       = row;
+    }
+
+    void World::check_access(ComponentId id, bool write) const noexcept
+    {
+        if (thread_access == nullptr)
+        {
+            return;
+        }
+
+        const auto allowed = write ? thread_access->writes.test(id) : (thread_access->reads.test(id) || thread_access->writes.test(id));
+        if (!allowed)
+        {
+            fail(std::format("Undeclared {} access to component {}.", write ? "write" : "read", infos[id].name));
+        }
+    }
+
+    void World::check_structural() const noexcept
+    {
+        if (thread_access != nullptr)
+        {
+            fail("Structural change to the world while a system runs.");
+        }
+    }
+
+    void World::check_unregistered(const char* name) const noexcept
+    {
+        if (thread_access != nullptr)
+        {
+            fail(std::format("Component {} registered while a system runs.", name));
+        }
+    }
+}
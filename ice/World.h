@@ -0,0 +1,513 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#include "defines.h"
+#include "debug.h"
+#include "utils.h"
+
+namespace ice
+{
+    //! The maximum number of component types in a World.
+    constexpr size_t MAX_COMPONENTS = 64u;
+
+    //! The size of a chunk of component storage in bytes.
+    constexpr size_t CHUNK_SIZE = 16u * 1024u;
+
+    using ComponentId   = unsigned int;
+    using ComponentMask = std::bitset<MAX_COMPONENTS>;
+
+    //! Entity
+    //!
+    //! An entity is a handle into a World. The generation is used to detect
+    //! handles to destroyed entities.
+    struct Entity
+    {
+        uint32_t index      = 0u;
+        uint32_t generation = 0u;
+
+        auto operator <=> (const Entity&) const noexcept = default;
+    };
+
+    //! Type erased component operations.
+    struct ComponentInfo
+    {
+        const char* name  = nullptr;
+        size_t      size  = 0u;
+        size_t      align = 0u;
+        //! Move construct dst from src and destroy src.
+        void (*move)(void* dst, void* src) noexcept = nullptr;
+        //! Destroy the component.
+        void (*destroy)(void* ptr) noexcept = nullptr;
+    };
+
+    //! Declared component access of a system.
+    struct SystemAccess
+    {
+        ComponentMask reads;
+        ComponentMask writes;
+    };
+
+    //! Archetype
+    //!
+    //! An archetype stores all entities that have exactly the same set of
+    //! components. The components are stored in chunks of CHUNK_SIZE bytes
+    //! in structure of arrays layout; each chunk holds one array per
+    //! component and one array of entities. All chunks but the last are full.
+    class ICE_EXPORT Archetype : private non_copyable
+    {
+    public:
+        Archetype(const ComponentMask& mask, const ComponentInfo* infos);
+        ~Archetype();
+
+        //! Get the component mask.
+        [[nodiscard]] const ComponentMask& get_mask() const noexcept;
+
+        //! Get the number of entities per chunk.
+        [[nodiscard]] size_t get_capacity() const noexcept;
+
+        //! Get the number of chunks.
+        [[nodiscard]] size_t get_chunk_count() const noexcept;
+
+        //! Get the number of entities in a chunk.
+        [[nodiscard]] size_t get_count(size_t chunk) const noexcept;
+
+        //! Get the number of entities in this archetype.
+        [[nodiscard]] size_t get_size() const noexcept;
+
+        //! Get the offset of a component's array in the chunks.
+        [[nodiscard]] size_t get_offset(ComponentId id) const noexcept;
+
+        //! Get the entities of a chunk.
+        [[nodiscard]] const Entity* get_entities(size_t chunk) const noexcept;
+
+        //! Get the array of a component in a chunk.
+        [[nodiscard]] std::byte* get_column(size_t chunk, size_t offset) const noexcept;
+
+    private:
+        struct Chunk
+        {
+            std::byte* data  = nullptr;
+            size_t     count = 0u;
+        };
+
+        ComponentMask                          mask;
+        const ComponentInfo*                   infos        = nullptr;
+        std::vector<ComponentId>               components;
+        std::array<size_t, MAX_COMPONENTS>     offsets      = {};
+        size_t                                 capacity     = 0u;
+        std::vector<Chunk>                     chunks;
+        std::array<Archetype*, MAX_COMPONENTS> add_edges    = {};
+        std::array<Archetype*, MAX_COMPONENTS> remove_edges = {};
+
+        void* get_component(size_t chunk, size_t row, ComponentId id) const noexcept;
+        std::pair<size_t, size_t> allocate(Entity entity);
+        Entity release(size_t chunk, size_t row) noexcept;
+
+        friend class World;
+    };
+
+    template <typename... Components>
+    class Query;
+
+    //! World
+    //!
+    //! The World holds all entities and their components. Components are
+    //! plain movable types and are registered on first use.
+    //!
+    //! Adding or removing a component moves the entity to another archetype.
+    //! The transitions between archetypes are cached on the archetypes, so
+    //! that repeated changes do not need to look up the target archetype.
+    class ICE_EXPORT World : private non_copyable
+    {
+    public:
+        World();
+        ~World();
+
+        //! Create an entity without components.
+        [[nodiscard]] Entity create();
+
+        //! Destroy an entity and its components.
+        void destroy(Entity entity) noexcept;
+
+        //! Check if an entity handle is valid.
+        [[nodiscard]] bool is_alive(Entity entity) const noexcept;
+
+        //! Get the number of living entities.
+        [[nodiscard]] size_t get_entity_count() const noexcept;
+
+        //! Get the number of archetypes.
+        [[nodiscard]] size_t get_archetype_count() const noexcept;
+
+        //! Get an archetype.
+        [[nodiscard]] const Archetype& get_archetype(size_t index) const noexcept;
+
+        //! Get the id of a component type.
+        //!
+        //! The component is registered on first use. Registering is not
+        //! thread safe, a system that uses a component that is not
+        //! registered fails.
+        template <typename T>
+        [[nodiscard]] ComponentId get_component_id();
+
+        //! Get the mask of a set of component types.
+        template <typename... Components>
+        [[nodiscard]] ComponentMask get_mask();
+
+        //! Add a component to an entity.
+        //!
+        //! If the entity already has the component, the value is replaced.
+        template <typename T, typename... Args>
+        T& add(Entity entity, Args&&... args);
+
+        //! Remove a component from an entity.
+        template <typename T>
+        void remove(Entity entity);
+
+        //! Check if an entity has a component.
+        template <typename T>
+        [[nodiscard]] bool has(Entity entity);
+
+        //! Get a component of an entity.
+        //!
+        //! Use a const component type for read only access.
+        //!
+        //! @returns the component or nullptr if the entity has no such component
+        template <typename T>
+        [[nodiscard]] T* get(Entity entity);
+
+        //! Create a query over entities with the given components.
+        //!
+        //! The query caches the matching archetypes and should be kept
+        //! around rather than recreated each frame.
+        template <typename... Components>
+        [[nodiscard]] Query<Components...> query();
+
+        //! Set the declared access of the system running on this thread.
+        //!
+        //! In debug builds any access to components outside of the declared
+        //! access and any structural change while a system runs fails. Pass
+        //! nullptr when the system is done.
+        //!
+        //! @returns the previously set access
+        static const SystemAccess* set_thread_access(const SystemAccess* access) noexcept;
+
+        //! Get the declared access of the system running on this thread.
+        //!
+        //! @returns the access or nullptr if no system runs
+        [[nodiscard]] static const SystemAccess* get_thread_access() noexcept;
+
+    private:
+        struct Record
+        {
+            Archetype* archetype  = nullptr;
+            size_t     chunk      = 0u;
+            size_t     row        = 0u;
+            uint32_t   generation = 1u;
+        };
+
+        std::array<ComponentInfo, MAX_COMPONENTS>        infos;
+        std::unordered_map<std::type_index, ComponentId> ids;
+        std::vector<std::unique_ptr<Archetype>>          archetypes;
+        std::unordered_map<ComponentMask, Archetype*>    archetype_index;
+        std::vector<Record>                              records;
+        std::vector<uint32_t>                            free_indices;
+        size_t                                           entity_count = 0u;
+
+        ComponentId register_component(std::type_index type, const ComponentInfo& info);
+        Archetype* find_archetype(const ComponentMask& mask);
+        Archetype* transition_add(Archetype* from, ComponentId id);
+        Archetype* transition_remove(Archetype* from, ComponentId id);
+        Record& get_record(Entity entity) noexcept;
+        void move_entity(Entity entity, Archetype* to);
+
+        void check_access(ComponentId id, bool write) const noexcept;
+        void check_structural() const noexcept;
+        void check_unregistered(const char* name) const noexcept;
+
+        template <typename... Components>
+        friend class Query;
+    };
+
+    //! Query
+    //!
+    //! A query iterates all entities that have at least the given components.
+    //! The iteration walks the chunks of each matching archetype and passes
+    //! contiguous arrays of components. The matching archetypes are cached
+    //! and only new archetypes are checked when the query is run.
+    //!
+    //! Use const component types for read only access. The world must not be
+    //! structurally changed while iterating.
+    template <typename... Components>
+    class Query
+    {
+    public:
+        Query(World& world) noexcept;
+
+        //! Call a function for each matching entity.
+        //!
+        //! The function is called with references to the components.
+        template <typename Fun>
+        void each(Fun&& fun);
+
+        //! Call a function for each chunk of matching entities.
+        //!
+        //! The function is called with the number of entities, the entities
+        //! and pointers to the component arrays.
+        template <typename Fun>
+        void each_chunk(Fun&& fun);
+
+        //! Count the matching entities.
+        [[nodiscard]] size_t count();
+
+    private:
+        using Offsets = std::array<size_t, sizeof...(Components)>;
+
+        struct Match
+        {
+            Archetype* archetype;
+            Offsets    offsets;
+        };
+
+        World&                                         world;
+        ComponentMask                                  mask;
+        std::array<ComponentId, sizeof...(Components)> ids;
+        std::vector<Match>                             matches;
+        size_t                                         checked = 0u;
+
+        void refresh();
+
+        template <size_t... I>
+        void check_access(std::index_sequence<I...>) const noexcept;
+
+        template <typename Fun, size_t... I>
+        void call_chunk(Fun& fun, const Match& match, size_t chunk, std::index_sequence<I...>);
+    };
+
+    template <typename Component>
+    ComponentId World::get_component_id()
+    {
+        using T = std::remove_cv_t<Component>;
+        static_assert(std::is_nothrow_move_constructible_v<T>, "Components must be nothrow move constructible.");
+        static_assert(alignof(T) <= 64u, "Components must not be over aligned.");
+
+        // systems only look up, they may run in parallel
+        auto i = ids.find(std::type_index(typeid(T)));
+        if (i != ids.end())
+        {
+            return i->second;
+        }
+        check_unregistered(typeid(T).name());
+
+        auto info = ComponentInfo{};
+        info.name    = typeid(T).name();
+        info.size    = sizeof(T);
+        info.align   = alignof(T);
+        info.move    = [] (void* dst, void* src) noexcept {
+            auto s = static_cast<T*>(src);
+            new (dst) T(std::move(*s));
+            s->~T();
+        };
+        info.destroy = [] (void* ptr) noexcept {
+            static_cast<T*>(ptr)->~T();
+        };
+        return register_component(std::type_index(typeid(T)), info);
+    }
+
+    template <typename... Components>
+    ComponentMask World::get_mask()
+    {
+        auto mask = ComponentMask{};
+        (mask.set(get_component_id<Components>()), ...);
+        return mask;
+    }
+
+    template <typename T, typename... Args>
+    T& World::add(Entity entity, Args&&... args)
+    {
+        const auto id = get_component_id<T>();
+        auto& record  = get_record(entity);
+
+        #ifndef NDEBUG
+        check_access(id, true);
+        #endif
+
+        if (record.archetype->mask.test(id))
+        {
+            auto ptr = static_cast<T*>(record.archetype->get_component(record.chunk, record.row, id));
+            *ptr = T{std::forward<Args>(args)...};
+            return *ptr;
+        }
+
+        #ifndef NDEBUG
+        check_structural();
+        #endif
+
+        move_entity(entity, transition_add(record.archetype, id));
+        auto ptr = record.archetype->get_component(record.chunk, record.row, id);
+        return *new (ptr) T{std::forward<Args>(args)...};
+    }
+
+    template <typename T>
+    void World::remove(Entity entity)
+    {
+        const auto id = get_component_id<T>();
+        auto& record  = get_record(entity);
+
+        if (record.archetype->mask.test(id))
+        {
+            #ifndef NDEBUG
+            check_structural();
+            #endif
+
+            move_entity(entity, transition_remove(record.archetype, id));
+        }
+    }
+
+    template <typename T>
+    bool World::has(Entity entity)
+    {
+        const auto id = get_component_id<T>();
+        return get_record(entity).archetype->mask.test(id);
+    }
+
+    template <typename T>
+    T* World::get(Entity entity)
+    {
+        const auto id = get_component_id<T>();
+        auto& record  = get_record(entity);
+
+        #ifndef NDEBUG
+        check_access(id, !std::is_const_v<T>);
+        #endif
+
+        if (!record.archetype->mask.test(id))
+        {
+            return nullptr;
+        }
+        return static_cast<T*>(record.archetype->get_component(record.chunk, record.row, id));
+    }
+
+    template <typename... Components>
+    Query<Components...> World::query()
+    {
+        return Query<Components...>(*this);
+    }
+
+    template <typename... Components>
+    Query<Components...>::Query(World& w) noexcept
+    : world(w), ids{w.get_component_id<Components>()...}
+    {
+        for (auto id : ids)
+        {
+            mask.set(id);
+        }
+    }
+
+    template <typename... Components>
+    template <typename Fun>
+    void Query<Components...>::each(Fun&& fun)
+    {
+        each_chunk([&fun] (size_t count, const Entity*, Components*... columns) {
+            for (auto i = size_t{0u}; i < count; i++)
+            {
+                fun(columns[i]...);
+            }
+        });
+    }
+
+    template <typename... Components>
+    template <typename Fun>
+    void Query<Components...>::each_chunk(Fun&& fun)
+    {
+        #ifndef NDEBUG
+        check_access(std::index_sequence_for<Components...>{});
+        #endif
+
+        refresh();
+        for (const auto& match : matches)
+        {
+            const auto chunk_count = match.archetype->get_chunk_count();
+            for (auto c = size_t{0u}; c < chunk_count; c++)
+            {
+                call_chunk(fun, match, c, std::index_sequence_for<Components...>{});
+            }
+        }
+    }
+
+    template <typename... Components>
+    size_t Query<Components...>::count()
+    {
+        refresh();
+        auto result = size_t{0u};
+        for (const auto& match : matches)
+        {
+            result += match.archetype->get_size();
+        }
+        return result;
+    }
+
+    template <typename... Components>
+    void Query<Components...>::refresh()
+    {
+        for (; checked < world.archetypes.size(); checked++)
+        {
+            auto archetype = world.archetypes[checked].get();
+            if ((archetype->get_mask() & mask) == mask)
+            {
+                auto match = Match{archetype, {}};
+                for (auto i = size_t{0u}; i < ids.size(); i++)
+                {
+                    match.offsets[i] = archetype->get_offset(ids[i]);
+                }
+                matches.push_back(match);
+            }
+        }
+    }
+
+    template <typename... Components>
+    template <size_t... I>
+    void Query<Components...>::check_access(std::index_sequence<I...>) const noexcept
+    {
+        // uses the cached ids, the world's type map is not safe to read while systems run
+        (world.check_access(ids[I], !std::is_const_v<Components>), ...);
+    }
+
+    template <typename... Components>
+    template <typename Fun, size_t... I>
+    void Query<Components...>::call_chunk(Fun& fun, const Match& match, size_t chunk, std::index_sequence<I...>)
+    {
+        const auto count = match.archetype->get_count(chunk);
+        fun(count, match.archetype->get_entities(chunk), reinterpret_cast<Components*>(match.archetype->get_column(chunk, match.offsets[I]))...);
+    }
+}
@@ -23,43 +23,60 @@
 
 #include <format>
 #include <array>
+#include <cstdlib>
 
 #if _WIN32
 #include <intrin.h>
 #include <dbghelp.h>
+#include <process.h>
+#else
+#include <unistd.h>
 #endif
 
 #include <ice/strconv.h>
+#include "Log.h"
+#include "StackTrace.h"
+#include "CrashReporter.h"
 
 namespace ice {
 
-    constexpr std::string basename(const std::string& file) noexcept
+    void trace(const std::string_view message, const std::source_location location)
     {
-        auto i = file.find_last_of("\\/");
-        if (i == std::string::npos)
+        if (auto logger = Logger::try_get())
         {
-            return file;
+            logger->write(message, location);
         }
-        else
+    }
+
+    const char* get_level_name(LogLevel level) noexcept
+    {
+        switch (level)
         {
-            return file.substr(i + 1);
+        case LogLevel::DEBUG:    return "debug";
+        case LogLevel::INFO:     return "info";
+        case LogLevel::WARNING:  return "warning";
+        case LogLevel::CRITICAL: return "critical";
+        default:                 return "none";
         }
     }
 
-    void trace(const std::string_view message, const std::source_location location)
+    void log(const LogCategory& category, LogLevel level, const std::string_view message, const std::source_location location)
     {
-        const auto line = std::format("{}({}): {}: {}\n", basename(location.file_name()), location.line(), location.function_name(), message);
-        #ifdef _WIN32
-        OutputDebugStringA(line.c_str());
-        #else
-        std::clog << line;
-        #endif
+        if (auto logger = Logger::try_get())
+        {
+            logger->write(message, location, level, category.name);
+        }
     }
 
-    [[noreturn]]
+    [[noreturn]] ICE_COLD
     void do_fail(const std::source_location location, const std::string_view message, bool write_dump = true)
     {
         trace(message, location);
+        // the process is about to end, get the message out now
+        if (auto logger = Logger::try_get())
+        {
+            logger->flush();
+        }
 
         #ifdef _WIN32
         if (IsDebuggerPresent())
@@ -73,9 +90,16 @@ namespace ice {
                 write_crash_dump();
             }
         }
+        #else
+        if (write_dump)
+        {
+            // the crash reporter's SIGABRT handler writes the report with this stack
+            std::abort();
+        }
         #endif
 
-        std::exit(EXIT_FAILURE);
+        // static destructors join the log and writer threads, which may be this thread
+        std::_Exit(EXIT_FAILURE);
     }
 
      void fail(const std::string_view message, const std::source_location location) noexcept
@@ -83,136 +107,19 @@ namespace ice {
         do_fail(location, message);
      }
 
-    void check(bool condition, const std::source_location location) noexcept
-    {
-        if (!condition)
-        {
-            fail("require failed", location);
-        }
-    }
 
-    #ifdef _WIN32
-    std::vector<StackFrame> get_stack_trace_win32() noexcept
+    std::vector<StackFrame> get_stack_trace() noexcept
     {
-        #ifdef _WIN64
-        auto machine = IMAGE_FILE_MACHINE_AMD64;
-        #else
-        auto machine = IMAGE_FILE_MACHINE_I386;
-        #endif
-        auto process = GetCurrentProcess();
-        auto thread  = GetCurrentThread();
-
-        if (SymInitialize(process, nullptr, TRUE) == FALSE)
+        try
         {
-            trace("Failed to call SymInitialize.");
-            return {};
+            // leave out get_stack_trace itself
+            const auto stack = RawStackTrace::capture(1u);
+            return Symbolizer::get().resolve(stack);
         }
-
-        SymSetOptions(SYMOPT_LOAD_LINES);
-
-        auto context = CONTEXT{};
-        context.ContextFlags = CONTEXT_FULL;
-        RtlCaptureContext(&context);
-
-        #ifdef _WIN64
-        auto frame = STACKFRAME{};
-        frame.AddrPC.Offset = context.Rip;
-        frame.AddrPC.Mode = AddrModeFlat;
-        frame.AddrFrame.Offset = context.Rbp;
-        frame.AddrFrame.Mode = AddrModeFlat;
-        frame.AddrStack.Offset = context.Rsp;
-        frame.AddrStack.Mode = AddrModeFlat;
-        #else
-        auto frame = STACKFRAME{};
-        frame.AddrPC.Offset = context.Eip;
-        frame.AddrPC.Mode = AddrModeFlat;
-        frame.AddrFrame.Offset = context.Ebp;
-        frame.AddrFrame.Mode = AddrModeFlat;
-        frame.AddrStack.Offset = context.Esp;
-        frame.AddrStack.Mode = AddrModeFlat;
-        #endif
-
-
-        auto first = true;
-
-        auto frames = std::vector<StackFrame>{};
-        while (StackWalk(machine, process, thread, &frame, &context , nullptr, SymFunctionTableAccess, SymGetModuleBase, nullptr))
+        catch (...)
         {
-            auto f = StackFrame{};
-            f.address = frame.AddrPC.Offset;
-
-            #ifdef _WIN64
-            auto moduleBase = DWORD64{0};
-            #else
-            auto moduleBase = DWORD{0};
-            #endif
-
-            moduleBase = SymGetModuleBase(process, frame.AddrPC.Offset);
-
-            auto moduelBuff = std::array<char, MAX_PATH>{};
-            if (moduleBase && GetModuleFileNameA(reinterpret_cast<HINSTANCE>(moduleBase), moduelBuff.data(), static_cast<DWORD>(moduelBuff.size())))
-            {
-                f.module = basename(moduelBuff.data());
-            }
-            else
-            {
-                f.module = "Unknown Module";
-            }
-            #ifdef _WIN64
-            auto offset = DWORD64{0};
-            #else
-            auto offset = DWORD{0};
-            #endif
-            auto symbolBuffer = std::array<char, sizeof(IMAGEHLP_SYMBOL) + 255>{};
-            PIMAGEHLP_SYMBOL symbol = (PIMAGEHLP_SYMBOL)symbolBuffer.data();
-            symbol->SizeOfStruct = static_cast<DWORD>(symbolBuffer.size());
-            symbol->MaxNameLength = 254;
-
-            if (SymGetSymFromAddr(process, frame.AddrPC.Offset, &offset, symbol))
-            {
-                f.name = symbol->Name;
-            }
-            else
-            {
-                f.name = "Unknown Function";
-            }
-
-            auto line = IMAGEHLP_LINE{};
-            line.SizeOfStruct = sizeof(IMAGEHLP_LINE);
-
-            auto offset_ln = DWORD{0};
-            if (SymGetLineFromAddr(process, frame.AddrPC.Offset, &offset_ln, &line))
-            {
-                f.file = line.FileName;
-                f.line = line.LineNumber;
-            }
-            else
-            {
-                f.line = 0;
-            }
-
-            if (!first)
-            {
-                frames.push_back(f);
-            }
-            first = false;
+            return {};
         }
-
-        SymCleanup(process);
-
-        return frames;
-    }
-    #endif
-
-
-    std::vector<StackFrame> get_stack_trace() noexcept
-    {
-        #ifdef _WIN32
-        return get_stack_trace_win32();
-        #else
-        trace("Stack trace not implemented for this platform.");
-        return {};
-        #endif
     }
 
     std::ostream& operator << (std::ostream& os, const StackFrame& frame) noexcept
@@ -232,16 +139,21 @@ namespace ice {
 
     std::string get_env_variable(const std::string_view name) noexcept
     {
+        #ifdef _WIN32
         auto buffer = std::array<char, MAX_PATH>{};
         auto len    = size_t{0};
 
-        const auto err = getenv_s(&len, buffer.data(), buffer.size(), name.data());
-        if (err == 0) // was found
+        const auto err = getenv_s(&len, buffer.data(), buffer.size(), std::string{name}.c_str());
+        if (err == 0 && len > 0) // was found, len counts the terminator
         {
-            return std::string(buffer.data(), len);
+            return std::string(buffer.data(), len - 1);
         }
 
         return {};
+        #else
+        const auto value = std::getenv(std::string{name}.c_str());
+        return value != nullptr ? value : "";
+        #endif
     }
 
     std::filesystem::path get_temp_folder() noexcept
@@ -253,9 +165,20 @@ namespace ice {
         {
             return buff.data();
         }
+        return get_env_variable("TEMP");
+        #else
+        auto ec = std::error_code{};
+        return std::filesystem::temp_directory_path(ec);
         #endif
+    }
 
-        return get_env_variable("TEMP");
+    int get_process_id() noexcept
+    {
+        #ifdef _WIN32
+        return _getpid();
+        #else
+        return static_cast<int>(getpid());
+        #endif
     }
 
     std::filesystem::path create_crash_dump_name(const std::string& prefix) noexcept
@@ -327,8 +250,10 @@ namespace ice {
     {
         #ifdef _WIN32
         write_crash_dump_win32(filename);
+        #elif __linux__
+        CrashReporter::write_report(filename);
         #else
-        trace("Stack trace not implemented for this platform.");
+        trace("Crash dumps are not implemented for this platform.");
         #endif
     }
 
@@ -340,27 +265,49 @@ namespace ice {
         do_fail(std::source_location::current(), "Process Crashed.", false);
     }
     #else
-    voi handle_termiante()
+    void handle_terminate()
     {
-        fail("Unexpectged Termination.");
+        fail("Unexpected Termination.");
     }
     #endif
 
+    void prepare_crash_thread() noexcept
+    {
+        #ifdef __linux__
+        CrashReporter::prepare_thread();
+        #endif
+    }
+
     CrashHandler::CrashHandler()
     {
         #ifdef _WIN32
         old_handler = SetUnhandledExceptionFilter(HandleUnhendledExceptionFilter);
         #else
-        old_handler = set_terminate(handle_termiante);
+        old_handler = std::set_terminate(handle_terminate);
+        #endif
+
+        #ifdef __linux__
+        try
+        {
+            reporter = std::make_unique<CrashReporter>(create_crash_dump_name().replace_extension(".txt"));
+        }
+        catch (const std::exception& ex)
+        {
+            trace(std::format("Crash reports are disabled: {}", ex.what()));
+        }
         #endif
     }
 
     CrashHandler::~CrashHandler()
     {
+        #ifdef __linux__
+        reporter.reset();
+        #endif
+
         #ifdef _WIN32
         SetUnhandledExceptionFilter(old_handler);
         #else
-        set_terminate(old_handler);
+        std::set_terminate(old_handler);
         #endif
     }
 }
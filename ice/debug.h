@@ -22,6 +22,8 @@
 #pragma once
 
 #include <functional>
+#include <memory>
+#include <format>
 #include <string_view>
 #include <filesystem>
 #include <source_location>
@@ -37,15 +39,82 @@ namespace ice
     //! Output diagnostic message.
     ICE_EXPORT void trace(const std::string_view message, const std::source_location location = std::source_location::current());
 
+    //! Log Level
+    //!
+    //! There is no ERROR, windows.h defines it as macro.
+    enum class LogLevel
+    {
+        DEBUG,
+        INFO,
+        WARNING,
+        CRITICAL,
+        NONE
+    };
+
+    //! The lowest level compiled in, set with ICE_LOG_LEVEL.
+    constexpr LogLevel LOG_LEVEL = static_cast<LogLevel>(ICE_LOG_LEVEL);
+
+    //! Get the name of a log level.
+    ICE_EXPORT const char* get_level_name(LogLevel level) noexcept;
+
+    //! Log Category
+    //!
+    //! Categories are constexpr variables with their own lowest level, so
+    //! for example rendering can be limited to warnings at compile time.
+    struct LogCategory
+    {
+        const char* name  = "general";
+        LogLevel    level = LogLevel::DEBUG;
+    };
+
+    constexpr LogCategory LOG_GENERAL = {"general"};
+    constexpr LogCategory LOG_ENGINE  = {"engine"};
+    constexpr LogCategory LOG_INPUT   = {"input"};
+    constexpr LogCategory LOG_RENDER  = {"render"};
+
+    //! Check if a level of a category is compiled in.
+    constexpr bool is_log_enabled(const LogCategory& category, LogLevel level) noexcept
+    {
+        return level != LogLevel::NONE && level >= LOG_LEVEL && level >= category.level;
+    }
+
+    //! Output diagnostic message with category and level.
+    //!
+    //! Use the ICE_LOG macros, they drop disabled messages at compile time.
+    ICE_EXPORT void log(const LogCategory& category, LogLevel level, const std::string_view message, const std::source_location location = std::source_location::current());
+
     //! Report failure.
-    [[ noreturn ]] ICE_EXPORT void fail(const std::string_view message = "failed", const std::source_location location = std::source_location::current()) noexcept;
+    [[ noreturn ]] ICE_EXPORT ICE_COLD void fail(const std::string_view message = "failed", const std::source_location location = std::source_location::current()) noexcept;
 
     //! Check.
     //!
     //! This function will check the condition and if false call the failure handler.
     //! If the failure handler is not overwritten, the handler will call trace and
     //! then either break in the debugger or pull a crash dump and exit.
-    ICE_EXPORT void check(bool condition, const std::source_location location = std::source_location::current()) noexcept;
+    //!
+    //! The check is always compiled in, see ICE_CHECK_DEBUG and ICE_CHECK_PARANOID
+    //! for checks that are left out of release builds.
+    inline void check(bool condition, const std::source_location location = std::source_location::current()) noexcept
+    {
+        if (!condition) [[unlikely]]
+        {
+            fail("require failed", location);
+        }
+    }
+
+    //! Check Tier
+    enum class CheckLevel
+    {
+        //! Checked in all builds.
+        ALWAYS,
+        //! Checked in debug builds.
+        DEBUG,
+        //! Expensive invariants, only checked when asked for.
+        PARANOID
+    };
+
+    //! The highest tier compiled in, set with ICE_CHECK_LEVEL.
+    constexpr CheckLevel CHECK_LEVEL = static_cast<CheckLevel>(ICE_CHECK_LEVEL);
 
     //! Entry in the Stack Trace
     struct StackFrame
@@ -66,13 +135,28 @@ namespace ice
     //! Write stack trace to output stream.
     ICE_EXPORT std::ostream& operator << (std::ostream& os, const std::vector<StackFrame>& trace) noexcept;
 
+    //! Get the id of the calling process.
+    ICE_EXPORT int get_process_id() noexcept;
+
     //! Create a unique filename for the crash dump.
     ICE_EXPORT std::filesystem::path create_crash_dump_name(const std::string& prefix = "pkzo") noexcept;
 
     //! Write crash dump
     ICE_EXPORT void write_crash_dump(const std::filesystem::path& filename = create_crash_dump_name()) noexcept;
 
+    //! Prepare the calling thread for crash reports.
+    //!
+    //! On Linux this gives the thread an alternate signal stack, so that a
+    //! stack overflow can be reported. Call it when a thread starts.
+    ICE_EXPORT void prepare_crash_thread() noexcept;
+
+    class CrashReporter;
+
     //! Install Crash Handlers
+    //!
+    //! On Windows unhandled exceptions write a mini dump, on Linux fatal
+    //! signals, failed checks and uncaught exceptions write a crash report
+    //! to the temp folder.
     class ICE_EXPORT CrashHandler
     {
     public:
@@ -85,5 +169,38 @@ namespace ice
         #else
         std::terminate_handler old_handler = nullptr;
         #endif
+        #ifdef __linux__
+        std::unique_ptr<CrashReporter> reporter;
+        #endif
     };
 }
+
+//! Log a formatted message, the arguments are not evaluated when the level is compiled out.
+#define ICE_LOG(CATEGORY, LEVEL, ...) \
+    do { \
+        if constexpr (::ice::is_log_enabled(CATEGORY, ::ice::LogLevel::LEVEL)) \
+        { \
+            ::ice::log(CATEGORY, ::ice::LogLevel::LEVEL, std::format(__VA_ARGS__)); \
+        } \
+    } while (false)
+
+#define ICE_DEBUG(CATEGORY, ...)    ICE_LOG(CATEGORY, DEBUG, __VA_ARGS__)
+#define ICE_INFO(CATEGORY, ...)     ICE_LOG(CATEGORY, INFO, __VA_ARGS__)
+#define ICE_WARNING(CATEGORY, ...)  ICE_LOG(CATEGORY, WARNING, __VA_ARGS__)
+#define ICE_CRITICAL(CATEGORY, ...) ICE_LOG(CATEGORY, CRITICAL, __VA_ARGS__)
+
+//! Check a condition of a tier, the condition is not evaluated when the tier is compiled out.
+#define ICE_CHECK_TIER(TIER, CONDITION) \
+    do { \
+        if constexpr (::ice::CHECK_LEVEL >= ::ice::CheckLevel::TIER) \
+        { \
+            if (!(CONDITION)) [[unlikely]] \
+            { \
+                ::ice::fail("check failed: " #CONDITION); \
+            } \
+        } \
+    } while (false)
+
+#define ICE_CHECK(CONDITION)          ICE_CHECK_TIER(ALWAYS, CONDITION)
+#define ICE_CHECK_DEBUG(CONDITION)    ICE_CHECK_TIER(DEBUG, CONDITION)
+#define ICE_CHECK_PARANOID(CONDITION) ICE_CHECK_TIER(PARANOID, CONDITION)
@@ -21,9 +21,57 @@
 
 #pragma once
 
+#ifdef _MSC_VER
 #define ICE_EXPORT __declspec(dllexport)
+#else
+#define ICE_EXPORT __attribute__((visibility("default")))
+#endif
 
 // disable silly warnings
-#ifndef _MSVC
+#ifdef _MSC_VER
 #pragma warning(disable: 4251 4275 26812)
 #endif
+
+// calling convention of OpenGL functions
+#ifdef _WIN32
+#define ICE_APIENTRY __stdcall
+#else
+#define ICE_APIENTRY
+#endif
+
+// profiling zones, build with ICE_PROFILE=0 to compile them out
+#ifndef ICE_PROFILE
+#define ICE_PROFILE 1
+#endif
+
+// keep failure paths out of the hot code
+#ifdef _MSC_VER
+#define ICE_COLD __declspec(noinline)
+#else
+#define ICE_COLD __attribute__((cold, noinline))
+#endif
+
+// functions that must keep their own stack frame
+#ifdef _MSC_VER
+#define ICE_NOINLINE __declspec(noinline)
+#else
+#define ICE_NOINLINE __attribute__((noinline))
+#endif
+
+// log level threshold: 0 debug, 1 info, 2 warning, 3 critical, 4 none
+#ifndef ICE_LOG_LEVEL
+#ifdef NDEBUG
+#define ICE_LOG_LEVEL 1
+#else
+#define ICE_LOG_LEVEL 0
+#endif
+#endif
+
+// check tiers that are compiled in: 0 always, 1 debug, 2 paranoid
+#ifndef ICE_CHECK_LEVEL
+#ifdef NDEBUG
+#define ICE_CHECK_LEVEL 0
+#else
+#define ICE_CHECK_LEVEL 1
+#endif
+#endif
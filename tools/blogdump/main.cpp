@@ -0,0 +1,69 @@
+// Ice Engine
+// Copyright 2023 Sean Farrell
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ice/BinaryLog.h>
+
+#include <exception>
+#include <fstream>
+#include <iostream>
+
+//! Turn a binary log into text.
+//!
+//! usage: blogdump input.blog [output.txt]
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "usage: blogdump input.blog [output.txt]" << std::endl;
+        return 2;
+    }
+
+    try
+    {
+        auto input = std::ifstream{argv[1], std::ios::binary};
+        if (!input)
+        {
+            std::cerr << "Failed to open " << argv[1] << "." << std::endl;
+            return 1;
+        }
+
+        if (argc == 3)
+        {
+            auto output = std::ofstream{argv[2]};
+            if (!output)
+            {
+                std::cerr << "Failed to open " << argv[2] << "." << std::endl;
+                return 1;
+            }
+            ice::decode_binary_log(input, output);
+        }
+        else
+        {
+            ice::decode_binary_log(input, std::cout);
+        }
+        return 0;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+}